@@ -0,0 +1,133 @@
+/*
+ * AlignedAllocator.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_ALIGNED_ALLOCATOR_H
+#define GM_ALIGNED_ALLOCATOR_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Standard allocator which aligns all allocations to the specified byte boundary.
+\tparam T Specifies the element type.
+\tparam Alignment Specifies the alignment (in bytes). This must be a power of two.
+\remarks This is used for the SIMD data streams of this library, e.g. with "AlignedVector".
+Elements are default-initialized, i.e. resizing a container of scalars does not zero the new elements.
+*/
+template <typename T, std::size_t Alignment>
+class AlignedAllocator
+{
+
+    public:
+
+        static_assert((Alignment & (Alignment - 1)) == 0, "alignment must be a power of two");
+        static_assert(Alignment >= sizeof(void*), "alignment must be at least the size of a pointer");
+
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() = default;
+
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&)
+        {
+        }
+
+        /**
+        \brief Allocates uninitialized memory for 'n' elements.
+        \remarks The address returned by 'std::malloc' is stored right before the aligned memory block.
+        \throws std::bad_alloc If the memory allocation failed.
+        */
+        T* allocate(std::size_t n)
+        {
+            if (n > (static_cast<std::size_t>(-1) - Alignment) / sizeof(T))
+                throw std::bad_alloc();
+
+            auto base = std::malloc(n * sizeof(T) + Alignment);
+            if (!base)
+                throw std::bad_alloc();
+
+            /* Align address behind the base pointer (there is always space for it, since malloc aligns to at least the size of a pointer) */
+            auto addr = (reinterpret_cast<std::uintptr_t>(base) + Alignment) & ~static_cast<std::uintptr_t>(Alignment - 1);
+            auto ptr = reinterpret_cast<void**>(addr);
+
+            ptr[-1] = base;
+
+            return reinterpret_cast<T*>(ptr);
+        }
+
+        /**
+        \brief Default-initializes the element at the specified location.
+        \remarks For scalar types this leaves the element uninitialized, so resizing a SIMD data stream,
+        whose elements are always overwritten afterwards, does not write the memory twice.
+        */
+        template <typename U>
+        void construct(U* p)
+        {
+            ::new (static_cast<void*>(p)) U;
+        }
+
+        //! Constructs the element at the specified location with the specified arguments.
+        template <typename U, typename... Args>
+        void construct(U* p, Args&&... args)
+        {
+            ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+        }
+
+        //! Releases the memory which has been allocated by "allocate".
+        void deallocate(T* p, std::size_t)
+        {
+            if (p)
+                std::free(reinterpret_cast<void**>(p)[-1]);
+        }
+
+};
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator == (const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return true;
+}
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator != (const AlignedAllocator<T, Alignment>&, const AlignedAllocator<U, Alignment>&)
+{
+    return false;
+}
+
+
+//! Default alignment (in bytes) for SIMD data streams. This covers 256-bit vector registers.
+static const std::size_t simdAlignment = 32;
+
+//! Vector container whose data is aligned for SIMD instructions.
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, simdAlignment>>;
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
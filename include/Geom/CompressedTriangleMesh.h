@@ -0,0 +1,171 @@
+/*
+ * CompressedTriangleMesh.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_COMPRESSED_TRIANGLE_MESH_H
+#define GM_COMPRESSED_TRIANGLE_MESH_H
+
+
+#include "TriangleMesh.h"
+#include "AlignedAllocator.h"
+#include "Ray.h"
+
+#include <vector>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Triangle mesh with quantized vertex attributes for compact, read-only storage.
+\remarks Each vertex takes 14 bytes instead of "sizeof(TriangleMesh::Vertex)" (32 bytes with single and 64 bytes with double precision):
+- Positions are quantized to 16 bit per component, relative to the bounding box of the mesh.
+- Normals are octahedral encoded with two 16 bit signed components.
+- Texture-coordinates are quantized to 16 bit per component, relative to the range of all texture-coordinates of the mesh.
+
+The quantized components are stored in aligned structure-of-arrays streams (like "TriangleMeshSoA"), so they are decoded with SIMD instructions (if SSE2 is available).
+Queries such as "BoundingBox" and "IntersectionWithRay" decode the positions on the fly, i.e. the mesh never has to be decompressed as a whole.
+\see TriangleMesh
+\see TriangleMeshSoA
+*/
+class CompressedTriangleMesh
+{
+
+    public:
+
+        using Vertex        = TriangleMesh::Vertex;
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using Triangle      = TriangleMesh::Triangle;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+
+        //! Aligned stream of unsigned quantized vertex components.
+        using Stream        = AlignedVector<std::uint16_t>;
+
+        //! Aligned stream of signed quantized vertex components.
+        using SignedStream  = AlignedVector<std::int16_t>;
+
+        //! Maximal errors of the decoded vertex attributes compared to the original mesh.
+        struct ErrorBounds
+        {
+            //! Maximal distance between a decoded and its original position, i.e. half the diagonal of a quantization step.
+            Gs::Real position   = 0;
+
+            //! Maximal angle (in radians) between a decoded and its original normal, measured while compressing. Normals with zero length are not measured.
+            Gs::Real normal     = 0;
+
+            //! Maximal distance between a decoded and its original texture-coordinate, i.e. half the diagonal of a quantization step.
+            Gs::Real texCoord   = 0;
+        };
+
+        CompressedTriangleMesh() = default;
+
+        //! Compresses the specified mesh.
+        explicit CompressedTriangleMesh(const TriangleMesh& mesh);
+
+        /**
+        \brief Replaces all vertices and triangles by the compressed vertices and triangles of the specified mesh.
+        \remarks The vertices are encoded in parallel on the shared thread pool.
+        Each normal is encoded to the closest of its four neighboring octahedral grid points, which minimizes the angular error.
+        \see GetErrorBounds
+        */
+        void Compress(const TriangleMesh& mesh);
+
+        //! Decompresses all vertices and triangles into the specified mesh. Previous content is replaced.
+        void Decompress(TriangleMesh& mesh) const;
+
+        //! Returns the decompressed mesh.
+        TriangleMesh Decompress() const;
+
+        //! Clears all vertices and triangles.
+        void Clear();
+
+        //! Decodes the specified vertex.
+        Vertex GetVertex(VertexIndex vertexIndex) const;
+
+        //! Decodes the position of the specified vertex.
+        Gs::Vector3 GetPosition(VertexIndex vertexIndex) const;
+
+        //! Decodes the normal (in unit length) of the specified vertex.
+        Gs::Vector3 GetNormal(VertexIndex vertexIndex) const;
+
+        //! Decodes the texture-coordinate of the specified vertex.
+        Gs::Vector2 GetTexCoord(VertexIndex vertexIndex) const;
+
+        /**
+        \brief Returns the axis-aligned bounding-box of all decoded positions.
+        \remarks This is the quantization box, i.e. it is not computed from the vertices and takes constant time.
+        */
+        AABB3 BoundingBox() const;
+
+        //! Computes the axis-aligned bounding-box of all decoded positions with the specified transformation matrix. The positions are decoded on the fly in parallel.
+        AABB3 BoundingBox(const Gs::AffineMatrix4& matrix) const;
+
+        /**
+        \brief Computes the closest intersection between the specified ray and all triangles of this mesh.
+        \param[in] ray Specifies the ray in the same coordinate space as the mesh vertices.
+        \param[out] triangleIndex Receives the index of the closest intersected triangle.
+        \param[out] barycentric Receives the barycentric coordinates of the intersection point within that triangle.
+        \return True if the ray intersects a triangle. Otherwise, the output parameters remain unchanged.
+        \remarks The positions are decoded on the fly and the triangles are tested in parallel on the shared thread pool.
+        Like "IntersectionWithTriangleBarycentric", only triangles whose front face is visible from the ray origin are intersected.
+        \see IntersectionWithTriangleBarycentric
+        */
+        bool IntersectionWithRay(const Ray3& ray, TriangleIndex& triangleIndex, Gs::Vector3& barycentric) const;
+
+        //! Returns the number of vertices.
+        inline std::size_t NumVertices() const
+        {
+            return positions_[0].size();
+        }
+
+        //! Returns the list of all triangles.
+        inline const std::vector<Triangle>& GetTriangles() const
+        {
+            return triangles_;
+        }
+
+        //! Returns the maximal errors of the decoded vertex attributes.
+        inline const ErrorBounds& GetErrorBounds() const
+        {
+            return errorBounds_;
+        }
+
+        //! Returns the number of bytes that are used by the vertex streams and the triangles.
+        std::size_t MemoryUsage() const;
+
+    private:
+
+        // Quantization of one vertex component: value = offset + quantized * step.
+        struct Quantization
+        {
+            Gs::Real offset = 0;
+            Gs::Real step   = 0;
+        };
+
+        Quantization            positionQuantization_[3];
+        Quantization            texCoordQuantization_[2];
+
+        Stream                  positions_[3];
+        SignedStream            normals_[2];
+        Stream                  texCoords_[2];
+
+        std::vector<Triangle>   triangles_;
+
+        ErrorBounds             errorBounds_;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -9,11 +9,21 @@
 #define GM_CONFIG_H
 
 
-//! Enables multi-threading features.
-#ifndef __GNUC__
-//#   define GM_ENABLE_MULTI_THREADING
+/**
+Enables multi-threading features, i.e. the shared thread pool gets worker threads.
+This is enabled by default on all compilers, unless 'GM_DISABLE_MULTI_THREADING' is defined.
+*/
+#if !defined(GM_ENABLE_MULTI_THREADING) && !defined(GM_DISABLE_MULTI_THREADING)
+#   define GM_ENABLE_MULTI_THREADING
 #endif
 
+/**
+Specifies the vertex index type of all triangle meshes (see TriangleMesh::VertexIndex). By default std::uint32_t.
+Use std::uint16_t for very compact meshes, or std::size_t for meshes with more than 4G vertices.
+This must be the same for the library and all code that includes its headers.
+*/
+//#define GM_MESH_INDEX_TYPE std::uint32_t
+
 //! Enables the alternative plane euqation as default (i.e. "n*x + d = 0" instead of "n*x = d").
 //#define GM_DEFAULT_PLANE_EQUATION_ALT
 
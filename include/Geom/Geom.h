@@ -23,7 +23,16 @@
 #include "Triangle.h"
 #include "TangentSpace.h"
 
+#include "AlignedAllocator.h"
+#include "MemoryResource.h"
+#include "ThreadPool.h"
 #include "TriangleMesh.h"
+#include "MeshAdjacency.h"
+#include "MeshSilhouette.h"
+#include "MeshletSet.h"
+#include "MeshBSPTree.h"
+#include "TriangleMeshSoA.h"
+#include "CompressedTriangleMesh.h"
 #include "MeshGenerator.h"
 #include "MeshModifier.h"
 
@@ -45,6 +54,8 @@
 
 #include "Playback.h"
 #include "Skeleton.h"
+#include "MeshFile.h"
+#include "MeshIO.h"
 
 
 /**
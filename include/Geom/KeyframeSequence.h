@@ -62,6 +62,21 @@ class KeyframeSequence
             std::vector<ScaleKeyframe>      scaleKeyframes
         );
 
+        /**
+        \brief Sets the pre-computed keys directly, e.g. to restore the keys of another sequence without building them again.
+        \param[in] frameBegin Specifies the first frame. The frame end is 'frameBegin' plus the number of keys.
+        \throws std::invalid_argument If the three key lists have different sizes.
+        \see GetPositionKeys
+        \see GetRotationKeys
+        \see GetScaleKeys
+        */
+        void SetKeys(
+            std::vector<Gs::Vector3>    positionKeys,
+            std::vector<Gs::Quaternion> rotationKeys,
+            std::vector<Gs::Vector3>    scaleKeys,
+            std::size_t                 frameBegin
+        );
+
         /**
         \brief Interpolates the specified keyframes and writes the result into the respective output parameter.
         \param[out] position Specifies the interpolated output position.
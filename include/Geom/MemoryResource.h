@@ -0,0 +1,228 @@
+/*
+ * MemoryResource.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MEMORY_RESOURCE_H
+#define GM_MEMORY_RESOURCE_H
+
+
+#include <cstddef>
+#include <new>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Memory resource interface for polymorphic allocators (like "std::pmr::memory_resource" of C++17).
+\see PolymorphicAllocator
+\see MonotonicArena
+*/
+class MemoryResource
+{
+
+    public:
+
+        virtual ~MemoryResource() = default;
+
+        /**
+        \brief Allocates a memory block of the specified size and alignment.
+        \param[in] size Specifies the size (in bytes).
+        \param[in] alignment Specifies the alignment (in bytes). This must be a power of two.
+        \throws std::bad_alloc If the memory allocation failed.
+        */
+        virtual void* Allocate(std::size_t size, std::size_t alignment) = 0;
+
+        //! Releases the specified memory block, which has been allocated by this resource with the same size and alignment.
+        virtual void Deallocate(void* ptr, std::size_t size, std::size_t alignment) = 0;
+
+        //! Returns true if memory that has been allocated by this resource can be released by the specified resource and vice versa. By default only true for the same resource.
+        virtual bool IsEqual(const MemoryResource& other) const
+        {
+            return (this == &other);
+        }
+
+};
+
+/**
+\brief Returns the default memory resource, which allocates from the global heap. This resource is thread-safe.
+\see PolymorphicAllocator
+*/
+MemoryResource* GetDefaultMemoryResource();
+
+/**
+\brief Standard allocator which forwards all allocations to a memory resource (like "std::pmr::polymorphic_allocator" of C++17).
+\tparam T Specifies the element type.
+\remarks The resource is not propagated on container assignment or swap, and a copy of a container uses the default memory resource.
+So only containers that have been constructed with a resource allocate from it, which makes it easy to keep track of the memory of an arena.
+\see MemoryResource
+*/
+template <typename T>
+class PolymorphicAllocator
+{
+
+    public:
+
+        using value_type = T;
+
+        template <typename U>
+        struct rebind
+        {
+            using other = PolymorphicAllocator<U>;
+        };
+
+        //! Constructs the allocator with the default memory resource.
+        PolymorphicAllocator() :
+            resource_ { GetDefaultMemoryResource() }
+        {
+        }
+
+        //! Constructs the allocator with the specified memory resource. If this is null, the default memory resource is used.
+        PolymorphicAllocator(MemoryResource* resource) :
+            resource_ { resource != nullptr ? resource : GetDefaultMemoryResource() }
+        {
+        }
+
+        template <typename U>
+        PolymorphicAllocator(const PolymorphicAllocator<U>& rhs) :
+            resource_ { rhs.GetResource() }
+        {
+        }
+
+        //! Allocates uninitialized memory for 'n' elements from the memory resource.
+        T* allocate(std::size_t n)
+        {
+            if (n > static_cast<std::size_t>(-1) / sizeof(T))
+                throw std::bad_alloc();
+            return static_cast<T*>(resource_->Allocate(n * sizeof(T), alignof(T)));
+        }
+
+        //! Releases the memory which has been allocated by "allocate".
+        void deallocate(T* p, std::size_t n)
+        {
+            resource_->Deallocate(p, n * sizeof(T), alignof(T));
+        }
+
+        //! Returns an allocator with the default memory resource for copies of a container.
+        PolymorphicAllocator select_on_container_copy_construction() const
+        {
+            return PolymorphicAllocator();
+        }
+
+        //! Returns the memory resource of this allocator. This is never null.
+        inline MemoryResource* GetResource() const
+        {
+            return resource_;
+        }
+
+    private:
+
+        MemoryResource* resource_;
+
+};
+
+template <typename T, typename U>
+bool operator == (const PolymorphicAllocator<T>& lhs, const PolymorphicAllocator<U>& rhs)
+{
+    return (lhs.GetResource() == rhs.GetResource() || lhs.GetResource()->IsEqual(*rhs.GetResource()));
+}
+
+template <typename T, typename U>
+bool operator != (const PolymorphicAllocator<T>& lhs, const PolymorphicAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+
+/**
+\brief Memory resource which allocates from a growing list of blocks and releases all memory at once.
+\remarks Allocations only advance a pointer, and "Deallocate" does nothing. All memory is released by "Reset" or "Release",
+which take time proportional to the number of blocks (and not to the number of allocations).
+Use this for scratch meshes that live for one frame or one request, e.g. as the memory resource of a "TriangleMesh".
+Containers that grow in an arena leave their previous buffers behind until the arena is reset,
+so reserve their final size where it is known. This class is not thread-safe.
+\see TriangleMesh::TriangleMesh(MemoryResource*)
+*/
+class MonotonicArena : public MemoryResource
+{
+
+    public:
+
+        /**
+        \brief Constructs the arena without allocating any memory yet.
+        \param[in] initialBlockSize Specifies the size (in bytes) of the first block. Each further block is twice as large as the previous one. By default 64 KB.
+        \param[in] upstream Specifies the memory resource for the blocks. If this is null, the default memory resource is used.
+        */
+        explicit MonotonicArena(std::size_t initialBlockSize = 65536, MemoryResource* upstream = nullptr);
+
+        MonotonicArena(const MonotonicArena&) = delete;
+        MonotonicArena& operator = (const MonotonicArena&) = delete;
+
+        //! Releases all blocks.
+        ~MonotonicArena();
+
+        void* Allocate(std::size_t size, std::size_t alignment) override;
+
+        //! Does nothing. The memory is only released by "Reset" or "Release".
+        void Deallocate(void* ptr, std::size_t size, std::size_t alignment) override;
+
+        /**
+        \brief Invalidates all allocations, but keeps the memory for further allocations.
+        \remarks If the arena consists of several blocks, they are replaced by a single block of their total size.
+        So after a warm-up (e.g. the first frame), an arena that is reset once per frame does not allocate any more blocks.
+        All containers that use this arena must have been destroyed or cleared with "shrink_to_fit" before.
+        */
+        void Reset();
+
+        //! Invalidates all allocations, and releases all blocks to the upstream memory resource.
+        void Release();
+
+        //! Returns the number of bytes that have been allocated since the last reset (including alignment padding).
+        inline std::size_t GetAllocatedSize() const
+        {
+            return allocatedSize_;
+        }
+
+        //! Returns the total size (in bytes) of all blocks.
+        inline std::size_t GetCapacity() const
+        {
+            return capacity_;
+        }
+
+    private:
+
+        // Header at the beginning of each block.
+        struct Block
+        {
+            Block*      next;
+            std::size_t size;
+        };
+
+        // Allocates a new block for at least the specified number of bytes and makes it the current block.
+        void AllocateBlock(std::size_t minSize);
+
+        // Sets the allocation cursor to the beginning of the specified block.
+        void SetCurrentBlock(Block* block);
+
+        MemoryResource* upstream_       = nullptr;
+        Block*          blocks_         = nullptr;  // Linked list of blocks, the current block first
+        char*           cursor_         = nullptr;
+        char*           end_            = nullptr;
+        std::size_t     nextBlockSize_  = 0;
+        std::size_t     allocatedSize_  = 0;
+        std::size_t     capacity_       = 0;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
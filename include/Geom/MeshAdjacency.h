@@ -0,0 +1,182 @@
+/*
+ * MeshAdjacency.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_ADJACENCY_H
+#define GM_MESH_ADJACENCY_H
+
+
+#include "TriangleMesh.h"
+
+#include <vector>
+#include <limits>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Vertex, edge, and triangle adjacency index of a triangle mesh.
+\remarks All tables are stored as compressed sparse rows (CSR), i.e. one flat index array and one offset array per relation,
+and are built in linear time with respect to the number of triangles.
+The index does not keep a reference to the mesh it was built from. If the mesh changes, the index must be rebuilt.
+\see TriangleMesh::BuildAdjacency
+*/
+class MeshAdjacency
+{
+
+    public:
+
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+        using Edge          = TriangleMesh::Edge;
+        using Triangle      = TriangleMesh::Triangle;
+        using TriangleArray = TriangleMesh::TriangleArray;
+        using EdgeIndex     = std::size_t;
+
+        //! Invalid edge index. This is returned by "FindEdge" if the edge does not exist.
+        static const EdgeIndex invalidEdge = std::numeric_limits<EdgeIndex>::max();
+
+        //! Read-only range [begin, end) within one of the adjacency tables.
+        template <typename T>
+        class Range
+        {
+
+            public:
+
+                Range(const T* begin, const T* end) :
+                    begin_ { begin },
+                    end_   { end   }
+                {
+                }
+
+                inline const T* begin() const
+                {
+                    return begin_;
+                }
+
+                inline const T* end() const
+                {
+                    return end_;
+                }
+
+                inline std::size_t size() const
+                {
+                    return static_cast<std::size_t>(end_ - begin_);
+                }
+
+                inline bool empty() const
+                {
+                    return (begin_ == end_);
+                }
+
+                inline const T& operator [] (std::size_t index) const
+                {
+                    GS_ASSERT(begin_ + index < end_);
+                    return begin_[index];
+                }
+
+            private:
+
+                const T* begin_;
+                const T* end_;
+
+        };
+
+        MeshAdjacency() = default;
+
+        //! Builds the adjacency index for the specified mesh.
+        explicit MeshAdjacency(const TriangleMesh& mesh);
+
+        //! Builds the adjacency index for the specified mesh. Previous content is replaced.
+        void Build(const TriangleMesh& mesh);
+
+        /**
+        \brief Builds the adjacency index for the specified triangles, whose indices must be less than 'numVertices'. Previous content is replaced.
+        \remarks This can be used to build the index for remapped triangles, e.g. with the canonical vertex indices of "MeshModifier::FindCanonicalVertices".
+        */
+        void Build(const TriangleArray& triangles, std::size_t numVertices);
+
+        //! Clears all adjacency tables.
+        void Clear();
+
+        /**
+        \brief Returns the range of all triangles that are connected to the specified vertex (in ascending order).
+        \remarks If the vertex index is out of range (e.g. the vertex was added after this index was built), the range is empty.
+        */
+        Range<TriangleIndex> VertexTriangles(VertexIndex vertexIndex) const;
+
+        //! Returns the range of all triangles that share the specified edge (in ascending order).
+        Range<TriangleIndex> EdgeTriangles(EdgeIndex edgeIndex) const;
+
+        //! Returns the range of all edges that start at the specified vertex, i.e. all edges (a, b) with a = vertexIndex.
+        Range<Edge> VertexEdges(VertexIndex vertexIndex) const;
+
+        //! Returns the three edge indices of the specified triangle, in the order (a, b), (b, c), (c, a). Degenerated edges are 'invalidEdge'.
+        Range<EdgeIndex> TriangleEdges(TriangleIndex triangleIndex) const;
+
+        /**
+        \brief Returns the index of the edge between the two specified vertices, or 'invalidEdge' if there is no such edge.
+        \remarks The order of the two vertices does not matter.
+        */
+        EdgeIndex FindEdge(VertexIndex v0, VertexIndex v1) const;
+
+        /**
+        \brief Returns the list of all unique edges.
+        \remarks Each edge (a, b) satisfies a < b and the list is sorted by 'a' first and 'b' second,
+        i.e. it is equal to the result of "TriangleMesh::Edges".
+        */
+        inline const std::vector<Edge>& GetEdges() const
+        {
+            return edges_;
+        }
+
+        //! Returns the number of vertices of the mesh this index was built from.
+        inline std::size_t NumVertices() const
+        {
+            return numVertices_;
+        }
+
+        //! Returns the number of triangles of the mesh this index was built from.
+        inline std::size_t NumTriangles() const
+        {
+            return numTriangles_;
+        }
+
+        //! Returns the number of unique edges.
+        inline std::size_t NumEdges() const
+        {
+            return edges_.size();
+        }
+
+    private:
+
+        std::size_t                 numVertices_            = 0;
+        std::size_t                 numTriangles_           = 0;
+
+        std::vector<TriangleIndex>  vertexTriangleOffsets_;     // Size: NumVertices() + 1
+        std::vector<TriangleIndex>  vertexTriangles_;
+
+        std::vector<EdgeIndex>      vertexEdgeOffsets_;         // Size: NumVertices() + 1
+        std::vector<Edge>           edges_;
+
+        std::vector<TriangleIndex>  edgeTriangleOffsets_;       // Size: NumEdges() + 1
+        std::vector<TriangleIndex>  edgeTriangles_;
+
+        std::vector<EdgeIndex>      triangleEdges_;             // Size: NumTriangles() * 3
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
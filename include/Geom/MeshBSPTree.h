@@ -0,0 +1,143 @@
+/*
+ * MeshBSPTree.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_BSP_TREE_H
+#define GM_MESH_BSP_TREE_H
+
+
+#include "TriangleMesh.h"
+#include "Plane.h"
+#include "AABB.h"
+
+#include <Gauss/Vector3.h>
+#include <memory>
+#include <vector>
+#include <cstddef>
+
+
+namespace Gm
+{
+
+
+//! BSP tree construction descriptor structure.
+struct BSPTreeDescriptor
+{
+    //! Tolerance (or thickness) of the splitting planes. Vertices within this distance to a plane are treated as onto the plane. By default 1e-5.
+    Gs::Real    epsilon         = Gs::Real(1e-5);
+
+    //! Maximal number of polygon planes which are evaluated as splitting plane per node. By default 8.
+    std::size_t numCandidates   = 8;
+
+    //! Maximal number of polygons which are classified to estimate the cost of a splitting plane. By default 64.
+    std::size_t numSamples      = 64;
+
+    //! Cost of one split polygon, relative to the cost of visiting one polygon. Higher values produce fewer split polygons but deeper trees. By default 4.
+    Gs::Real    splitCost       = Gs::Real(4);
+};
+
+/**
+\brief Solid BSP (Binary Space Partitioning) tree of a closed triangle mesh, used for boolean operations.
+\remarks Each node stores a splitting plane and the polygons which lie onto that plane.
+A missing front child is outside of the solid, and a missing back child is inside of the solid.
+Besides the planes of the polygons, a node may use an axis-aligned plane through the center of its polygons if that is cheaper,
+which keeps the tree balanced even for convex meshes (where each polygon plane has all other polygons behind it).
+The input mesh must be closed and its triangles must be wound consistently (counter-clockwise seen from the outside).
+\see MeshModifier::BooleanMesh
+*/
+class MeshBSPTree
+{
+
+    public:
+
+        MeshBSPTree();
+
+        //! Builds the tree for the specified mesh.
+        explicit MeshBSPTree(const TriangleMesh& mesh, const BSPTreeDescriptor& desc = BSPTreeDescriptor());
+
+        MeshBSPTree(const MeshBSPTree&) = delete;
+        MeshBSPTree& operator = (const MeshBSPTree&) = delete;
+
+        MeshBSPTree(MeshBSPTree&& rhs);
+        MeshBSPTree& operator = (MeshBSPTree&& rhs);
+
+        ~MeshBSPTree();
+
+        /**
+        \brief Builds the tree for the specified mesh. Previous content is replaced.
+        \remarks The splitting plane of each node is selected with a surface-area-heuristic-like cost: the polygon planes of a few candidates
+        and the axis-aligned planes through the center of the polygons (and through the nearest vertex to that center) are classified against a sample of the polygons,
+        and the plane with the lowest sum of the squared polygon counts on both sides (divided by the sample size) plus the weighted number of split polygons is taken. Subtrees of large nodes are built in parallel on the shared thread pool.
+        Degenerated triangles are ignored.
+        \see BSPTreeDescriptor
+        */
+        void Build(const TriangleMesh& mesh, const BSPTreeDescriptor& desc = BSPTreeDescriptor());
+
+        //! Releases all nodes and polygons.
+        void Clear();
+
+        //! Converts the solid into its complement: flips all planes and polygons, and swaps the front and back children of all nodes.
+        void Invert();
+
+        /**
+        \brief Removes all parts of the polygons of this tree which are inside the solid of the specified tree.
+        \remarks Polygons onto a plane of the other tree are kept if they face into the same direction as that plane.
+        The nodes of this tree are clipped in parallel on the shared thread pool, and polygons outside the bounding box of the other tree are not traversed at all.
+        The planes of this tree are not changed.
+        */
+        void ClipTo(const MeshBSPTree& other);
+
+        //! Returns true if the specified point is inside the solid. Points onto the surface are treated as outside.
+        bool IsInside(const Gs::Vector3& point) const;
+
+        /**
+        \brief Triangulates all polygons of this tree into the specified indexed mesh. Previous content of the mesh is replaced.
+        \remarks Vertices with equal attributes are shared between the polygons. Split points are interpolated in the same order on both sides
+        of an edge, so adjacent polygons share the same vertex. T-junctions, which are inherent to BSP clipping, are not removed.
+        */
+        void GetMesh(TriangleMesh& mesh) const;
+
+        //! Returns the number of nodes.
+        std::size_t NumNodes() const;
+
+        //! Returns the number of polygons in all nodes.
+        std::size_t NumPolygons() const;
+
+        //! Returns the maximal depth of the tree, i.e. the number of nodes on the longest path from the root. This is zero for an empty tree.
+        std::size_t Depth() const;
+
+        //! Returns the bounding box of the original mesh.
+        inline const AABB3& GetBoundingBox() const
+        {
+            return boundingBox_;
+        }
+
+        //! Returns true if this tree has been inverted an odd number of times, i.e. the region outside of the bounding box is inside of the solid.
+        inline bool IsInverted() const
+        {
+            return inverted_;
+        }
+
+    private:
+
+        struct Node;
+
+        std::unique_ptr<Node>   root_;
+        BSPTreeDescriptor       desc_;
+        AABB3                   boundingBox_;
+        bool                    inverted_       = false;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,168 @@
+/*
+ * MeshFile.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_FILE_H
+#define GM_MESH_FILE_H
+
+
+#include "TriangleMesh.h"
+#include "Skeleton.h"
+
+#include <string>
+#include <memory>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Read-only view of a triangle mesh whose vertices and triangles are stored elsewhere, e.g. in a memory-mapped file.
+\see MappedMeshFile
+*/
+struct TriangleMeshView
+{
+    //! Copies the vertices and triangles into a new triangle mesh.
+    TriangleMesh ToMesh() const;
+
+    const TriangleMesh::Vertex*     vertices        = nullptr;  //!< Pointer to the first vertex.
+    std::size_t                     numVertices     = 0;        //!< Number of vertices.
+    const TriangleMesh::Triangle*   triangles       = nullptr;  //!< Pointer to the first triangle.
+    std::size_t                     numTriangles    = 0;        //!< Number of triangles.
+};
+
+/**
+\brief Writes the specified mesh (and optionally the specified skeleton) into a binary mesh file.
+\param[in] filename Specifies the output filename.
+\param[in] mesh Specifies the mesh whose vertices and triangles are to be written.
+\param[in] skeleton Optional pointer to a skeleton whose joints, vertex weights, and pre-computed keyframe keys are to be written. By default null.
+\remarks The binary format stores a versioned header, a section table, and 64-byte aligned sections with the vertices and triangles in the native layout of "TriangleMesh",
+followed by a checksum over all sections. Therefore a file can only be loaded with the same floating-point precision, index type, and byte order it has been written with.
+\throws std::runtime_error If the file could not be written.
+\see MappedMeshFile
+*/
+void WriteMeshFile(const std::string& filename, const TriangleMesh& mesh, const Skeleton* skeleton = nullptr);
+
+/**
+\brief Reads a binary mesh file into the specified mesh (and optionally the specified skeleton).
+\param[in] filename Specifies the input filename.
+\param[out] mesh Specifies the output mesh. The previous content is replaced.
+\param[out] skeleton Optional pointer to the output skeleton. If the file has a skeleton, its joints are added as new root joints. By default null.
+\param[in] verifyChecksum Specifies whether to verify the checksum before the data is read. By default true.
+\remarks This maps the file, verifies that all triangles refer to existing vertices, and copies the vertices and triangles in one block each.
+To avoid the copy, use "MappedMeshFile" directly.
+\throws std::runtime_error If the file could not be opened, is not a valid mesh file, fails the checksum verification, or has a vertex index out of range.
+\see WriteMeshFile
+*/
+void ReadMeshFile(const std::string& filename, TriangleMesh& mesh, Skeleton* skeleton = nullptr, bool verifyChecksum = true);
+
+/**
+\brief Binary mesh file that is mapped into memory, to access its vertices and triangles without parsing or copying them.
+\remarks Opening the file only validates the header and the section table; the vertex and triangle data is loaded by the operating system
+on first access (page by page). The mesh view remains valid until the file is closed.
+Unless the indices have been verified, a corrupted file may have triangles that refer to vertices out of range.
+\see WriteMeshFile
+*/
+class MappedMeshFile
+{
+
+    public:
+
+        MappedMeshFile();
+
+        /**
+        \brief Maps the specified mesh file into memory.
+        \see Open
+        */
+        explicit MappedMeshFile(const std::string& filename, bool verifyChecksum = false, bool verifyIndices = false);
+
+        MappedMeshFile(const MappedMeshFile&) = delete;
+        MappedMeshFile& operator = (const MappedMeshFile&) = delete;
+
+        MappedMeshFile(MappedMeshFile&& rhs);
+        MappedMeshFile& operator = (MappedMeshFile&& rhs);
+
+        ~MappedMeshFile();
+
+        /**
+        \brief Maps the specified mesh file into memory. A previously opened file is closed.
+        \param[in] filename Specifies the input filename.
+        \param[in] verifyChecksum Specifies whether to verify the checksum immediately. This reads the entire file. By default false.
+        \param[in] verifyIndices Specifies whether to verify the vertex indices of all triangles immediately. This reads the entire triangle section. By default false.
+        \throws std::runtime_error If the file could not be mapped, is not a valid mesh file, fails the checksum verification, or has a vertex index out of range.
+        \see VerifyChecksum
+        \see VerifyIndices
+        */
+        void Open(const std::string& filename, bool verifyChecksum = false, bool verifyIndices = false);
+
+        //! Unmaps the file. All mesh views of this file become invalid.
+        void Close();
+
+        //! Returns true if a file is currently mapped.
+        bool IsOpen() const;
+
+        /**
+        \brief Returns true if the checksum of the mapped file is valid.
+        \remarks The checksum is computed over blocks of the file in parallel on the shared thread pool.
+        \see GetSharedThreadPool
+        */
+        bool VerifyChecksum() const;
+
+        /**
+        \brief Returns true if all triangles of the mapped file refer to existing vertices.
+        \remarks The triangles are checked in parallel on the shared thread pool.
+        \see GetSharedThreadPool
+        */
+        bool VerifyIndices() const;
+
+        //! Returns the read-only view of the mesh in the mapped file. The view is empty if no file is mapped.
+        inline const TriangleMeshView& GetMesh() const
+        {
+            return meshView_;
+        }
+
+        //! Returns true if the mapped file contains a skeleton.
+        bool HasSkeleton() const;
+
+        /**
+        \brief Reads the skeleton of the mapped file into the specified skeleton. The joints are added as new root joints.
+        \param[out] skeleton Specifies the output skeleton.
+        \param[in] makeSkeletonJoint Specifies an optional callback to create skeleton joints. By default the standard "SkeletonJoint" base class is created.
+        \remarks This has no effect if the file does not contain a skeleton.
+        \see HasSkeleton
+        \see Skeleton::CopyFrom
+        */
+        void ReadSkeleton(Skeleton& skeleton, const MakeSkeletonJointFunction& makeSkeletonJoint = nullptr) const;
+
+    private:
+
+        class FileMapping;
+
+        // Validates the header and section table of the mapped file and sets up the mesh view.
+        void ReadSections();
+
+        std::unique_ptr<FileMapping>    mapping_;
+        TriangleMeshView                meshView_;
+
+        const void*                     joints_         = nullptr;
+        std::size_t                     numJoints_      = 0;
+        const void*                     weights_        = nullptr;
+        std::size_t                     numWeights_     = 0;
+        const void*                     keys_           = nullptr;
+        std::size_t                     numKeys_        = 0;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
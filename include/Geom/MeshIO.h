@@ -0,0 +1,172 @@
+/*
+ * MeshIO.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_IO_H
+#define GM_MESH_IO_H
+
+
+#include "TriangleMesh.h"
+
+#include <string>
+#include <functional>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+//! Namespace with all import and export functions for common text and binary mesh formats.
+namespace MeshIO
+{
+
+
+//! Invalid index for absent attributes of OBJ face corners.
+static const std::uint64_t invalidIndex = ~std::uint64_t(0);
+
+//! PLY file formats.
+enum class PLYFormat
+{
+    ASCII,              //!< Text format.
+    BinaryLittleEndian, //!< Binary format with little-endian byte order.
+    BinaryBigEndian,    //!< Binary format with big-endian byte order.
+};
+
+//! Face corner of an OBJ file with zero-based indices. Relative (negative) indices of the file are already resolved.
+struct OBJCorner
+{
+    std::uint64_t position  = invalidIndex; //!< Index into the positions ('v' statements).
+    std::uint64_t texCoord  = invalidIndex; //!< Index into the texture-coordinates ('vt' statements), or 'invalidIndex'.
+    std::uint64_t normal    = invalidIndex; //!< Index into the normals ('vn' statements), or 'invalidIndex'.
+};
+
+/**
+\brief Callbacks for streaming an OBJ file.
+\remarks All callbacks are optional and called on the calling thread in the order of the file.
+For each block of the file, the attributes are passed first and the triangles afterwards, so a triangle never refers to attributes that have not been passed yet.
+\see StreamOBJ
+*/
+struct OBJStreamCallbacks
+{
+    //! Receives the next vertex positions ('v' statements).
+    std::function<void(const Gs::Vector3* positions, std::size_t count)>            positions;
+
+    //! Receives the next texture-coordinates ('vt' statements).
+    std::function<void(const Gs::Vector2* texCoords, std::size_t count)>            texCoords;
+
+    //! Receives the next normals ('vn' statements).
+    std::function<void(const Gs::Vector3* normals, std::size_t count)>              normals;
+
+    //! Receives the next triangles with three corners each. Polygons are triangulated as triangle fans.
+    std::function<void(const OBJCorner* corners, std::size_t numTriangles)>         triangles;
+
+    //! Receives the progress after each block, i.e. the number of bytes that have been processed so far and the total file size.
+    std::function<void(std::uint64_t bytesProcessed, std::uint64_t fileSize)>       progress;
+};
+
+/**
+\brief Callbacks for streaming a PLY file.
+\remarks All callbacks are optional and called on the calling thread in the order of the file.
+\see StreamPLY
+*/
+struct PLYStreamCallbacks
+{
+    //! Receives the number of vertices and faces declared in the header, before any other callback is called.
+    std::function<void(std::size_t numVertices, std::size_t numFaces)>                  header;
+
+    //! Receives the next vertices. Properties that are not present in the file are zero.
+    std::function<void(const TriangleMesh::Vertex* vertices, std::size_t count)>        vertices;
+
+    //! Receives the next triangles. Polygons are triangulated as triangle fans.
+    std::function<void(const TriangleMesh::Triangle* triangles, std::size_t count)>     triangles;
+
+    //! Receives the progress after each block, i.e. the number of bytes that have been processed so far and the total file size.
+    std::function<void(std::uint64_t bytesProcessed, std::uint64_t fileSize)>           progress;
+};
+
+
+/* --- OBJ files --- */
+
+/**
+\brief Streams the specified Wavefront OBJ file block by block, so the file may be larger than the available memory.
+\param[in] filename Specifies the input filename.
+\param[in] callbacks Specifies the callbacks that receive the content of the file.
+\remarks Only the statements 'v', 'vt', 'vn', and 'f' are read; all other statements are ignored.
+Each block is split at line breaks and the parts are parsed in parallel on the shared thread pool.
+\throws std::runtime_error If the file could not be read or contains an invalid statement or index.
+\see GetSharedThreadPool
+*/
+void StreamOBJ(const std::string& filename, const OBJStreamCallbacks& callbacks);
+
+/**
+\brief Reads the specified Wavefront OBJ file into the specified mesh.
+\param[in] filename Specifies the input filename.
+\param[out] mesh Specifies the output mesh. The previous content is replaced.
+\remarks Each position becomes the vertex with the same index, combined with the texture-coordinate and normal of its first face corner.
+Face corners that combine a position with other attributes are appended as additional vertices.
+\throws std::runtime_error If the file could not be read or contains an invalid statement or index.
+\see StreamOBJ
+*/
+void ReadOBJ(const std::string& filename, TriangleMesh& mesh);
+
+/**
+\brief Writes the specified mesh into a Wavefront OBJ file.
+\param[in] filename Specifies the output filename.
+\param[in] mesh Specifies the mesh whose vertices and triangles are to be written.
+\remarks The text is formatted in parallel on the shared thread pool. Each vertex is written with a position, texture-coordinate, and normal statement,
+all with the same index, and the numbers are written with enough digits to read them back exactly.
+\throws std::runtime_error If the file could not be written.
+*/
+void WriteOBJ(const std::string& filename, const TriangleMesh& mesh);
+
+
+/* --- PLY files --- */
+
+/**
+\brief Streams the specified PLY file (ASCII or binary) block by block, so the file may be larger than the available memory.
+\param[in] filename Specifies the input filename.
+\param[in] callbacks Specifies the callbacks that receive the content of the file.
+\remarks The vertex properties 'x', 'y', 'z', 'nx', 'ny', 'nz', and 's'/'t' (or 'u'/'v', 'texture_u'/'texture_v') are read,
+as well as the face property 'vertex_indices' (or 'vertex_index'). All other elements and properties are skipped.
+Each block is decoded in parallel on the shared thread pool.
+\throws std::runtime_error If the file could not be read, has an invalid header, is truncated, or contains an invalid vertex index.
+\see GetSharedThreadPool
+*/
+void StreamPLY(const std::string& filename, const PLYStreamCallbacks& callbacks);
+
+/**
+\brief Reads the specified PLY file (ASCII or binary) into the specified mesh.
+\param[in] filename Specifies the input filename.
+\param[out] mesh Specifies the output mesh. The previous content is replaced.
+\remarks The vertex and triangle containers are reserved with the element counts of the header.
+\throws std::runtime_error If the file could not be read, has an invalid header, is truncated, or contains an invalid vertex index.
+\see StreamPLY
+*/
+void ReadPLY(const std::string& filename, TriangleMesh& mesh);
+
+/**
+\brief Writes the specified mesh into a PLY file.
+\param[in] filename Specifies the output filename.
+\param[in] mesh Specifies the mesh whose vertices and triangles are to be written.
+\param[in] format Specifies the file format. By default PLYFormat::BinaryLittleEndian.
+\remarks The vertices are written with the properties 'x', 'y', 'z', 'nx', 'ny', 'nz', 's', and 't' of type 'float' (or 'double' if 'Gs::Real' is double),
+and the faces with the property 'vertex_indices' as a list of 'uint' with a 'uchar' counter. The content is encoded in parallel on the shared thread pool.
+\throws std::overflow_error If the mesh has more than 2^32 vertices, since PLY has no 64-bit integer type (see 'GM_MESH_INDEX_TYPE'). In this case, no file is written.
+\throws std::runtime_error If the file could not be written.
+*/
+void WritePLY(const std::string& filename, const TriangleMesh& mesh, const PLYFormat format = PLYFormat::BinaryLittleEndian);
+
+
+} // /namespace MeshIO
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -10,8 +10,16 @@
 
 
 #include "TriangleMesh.h"
+#include "TriangleMeshSoA.h"
 #include "Plane.h"
+#include "ConvexHull.h"
+#include "Frustum.h"
+#include "MeshBSPTree.h"
+#include "AABB.h"
+#include <Gauss/Vector4.h>
+#include <Gauss/AffineMatrix4.h>
 #include <cstdint>
+#include <limits>
 
 
 namespace Gm
@@ -22,16 +30,29 @@ namespace MeshModifier
 {
 
 
+//! Component formats of vertex attributes.
+enum class ComponentFormat
+{
+    Real,       //!< Component of type "Gs::Real", i.e. either 32-bit or 64-bit floating-point.
+    Float32,    //!< 32-bit floating-point.
+    Float16,    //!< 16-bit floating-point (IEEE 754 half precision).
+    UNorm8,     //!< 8-bit unsigned normalized integer in the range [0, 1].
+    SNorm8,     //!< 8-bit signed normalized integer in the range [-1, 1].
+    UNorm16,    //!< 16-bit unsigned normalized integer in the range [0, 1].
+    SNorm16,    //!< 16-bit signed normalized integer in the range [-1, 1].
+};
+
 /**
 \brief Vertex attribute descriptor structure.
-\note This mesh modifier can only handle vertex attributes with components of type "Gs::Real".
+\note The vertex descriptors of "TriangleMesh::Vertex" (such as the seam descriptor of "Simplify") only support the format ComponentFormat::Real.
 */
 struct VertexAttributeDescriptor
 {
     VertexAttributeDescriptor() = default;
-    VertexAttributeDescriptor(std::size_t offset, std::uint32_t components) :
+    VertexAttributeDescriptor(std::size_t offset, std::uint32_t components, ComponentFormat format = ComponentFormat::Real) :
         offset     { offset     },
-        components { components }
+        components { components },
+        format     { format     }
     {
     }
 
@@ -40,6 +61,9 @@ struct VertexAttributeDescriptor
 
     //! Number of components of this vertex attribute. By default 1.
     std::uint32_t   components  = 1;
+
+    //! Format of each component. By default ComponentFormat::Real.
+    ComponentFormat format      = ComponentFormat::Real;
 };
 
 //! Vertex descriptor structure.
@@ -63,6 +87,32 @@ struct VertexDescriptor
 };
 
 
+//! Returns the size (in bytes) of one component of the specified format.
+std::size_t GetComponentSize(ComponentFormat format);
+
+/**
+\brief Converts components of the specified format to "Gs::Real".
+\param[in] format Specifies the format of the input components.
+\param[in] input Specifies the tightly packed input components. This does not need to be aligned.
+\param[in] count Specifies the number of components.
+\param[out] output Specifies the output components.
+\remarks Float16, UNorm8, and UNorm16 components are converted with SSE2 instructions (if available and "Gs::Real" is single precision).
+Normalized integers are scaled by their maximal value, and the negative minimum of signed normalized integers is clamped to -1.
+*/
+void DecodeComponents(ComponentFormat format, const void* input, std::size_t count, Gs::Real* output);
+
+/**
+\brief Converts "Gs::Real" components to the specified format.
+\param[in] format Specifies the format of the output components.
+\param[in] input Specifies the input components.
+\param[in] count Specifies the number of components.
+\param[out] output Specifies the tightly packed output components. This does not need to be aligned.
+\remarks Float16 components are rounded to the nearest even value, and values beyond the half precision range become infinity.
+Normalized integers are clamped to their range and rounded to the nearest value (halfway cases away from zero).
+The same formats as for "DecodeComponents" are vectorized.
+*/
+void EncodeComponents(ComponentFormat format, const Gs::Real* input, std::size_t count, void* output);
+
 /**
 \brief Returns the vertex descriptor for the default vertex format.
 \see TriangleMesh::Vertex
@@ -78,6 +128,9 @@ const VertexDescriptor& GetDefaultVertexDesc();
 \param[in] v1 Specifies the second vertex index for the triangle to interpolate the barycentric coordinates.
 \param[in] v2 Specifies the thrid vertex index for the triangle to interpolate the barycentric coordinates.
 \param[in] barycentricCoords Specifies the barycentric coordinates. The sum of all components must be 1.
+\remarks Attributes with a format other than ComponentFormat::Real are decoded, interpolated in "Gs::Real", and encoded again,
+so packed vertex buffers (e.g. with half precision texture-coordinates or 8-bit colors) can be interpolated in place.
+\see ComponentFormat
 */
 void InterpolateBarycentric(
     const VertexDescriptor& vertexDesc,
@@ -89,11 +142,508 @@ void InterpolateBarycentric(
     const Gs::Vector3&      barycentricCoords
 );
 
+//! Barycentric coordinates within a triangle, for the batch variants of "InterpolateBarycentric".
+struct BarycentricSample
+{
+    //! Index of the triangle to interpolate.
+    TriangleMesh::TriangleIndex triangleIndex       = 0;
+
+    //! Barycentric coordinates within that triangle. The sum of all components must be 1.
+    Gs::Vector3                 barycentricCoords;
+};
+
+/**
+\brief Makes a barycentric interpolation of many samples with a runtime vertex descriptor.
+\param[out] outputVertexBuffer Specifies the output vertex buffer, which receives one vertex per sample.
+\param[in] triangles Specifies the triangles which the samples refer to.
+\remarks Unlike calling the single-vertex variant in a loop, the vertex stride is only determined once,
+and each packed attribute (see ComponentFormat) is gathered over a chunk of samples, so it is converted in long runs of components.
+\see InterpolateBarycentric(const VertexDescriptor&, void*, const void*, std::size_t, std::size_t, std::size_t, const Gs::Vector3&)
+*/
+void InterpolateBarycentric(
+    const VertexDescriptor&         vertexDesc,
+    void*                           outputVertexBuffer,
+    const void*                     inputVertexBuffer,
+    const TriangleMesh::Triangle*   triangles,
+    const BarycentricSample*        samples,
+    std::size_t                     numSamples
+);
+
+/**
+\brief Compile-time vertex layout for the barycentric interpolation of the vertex type 'Vertex'.
+\remarks Specialize this template for custom vertex types with a static function of the following form:
+\code
+static void Interpolate(Vertex& output, const Vertex& v0, const Vertex& v1, const Vertex& v2, const Gs::Vector3& barycentricCoords);
+\endcode
+For vertex types which only consist of "Gs::Real" components (like "TriangleMesh::Vertex"), inherit the specialization from "RealVertexLayout":
+\code
+template <> struct Gm::MeshModifier::VertexLayout<MyVertex> : Gm::MeshModifier::RealVertexLayout<MyVertex> {};
+\endcode
+\see RealVertexLayout
+*/
+template <typename Vertex>
+struct VertexLayout;
+
+/**
+\brief Vertex layout of a vertex type whose first 'NumComponents' components are of type "Gs::Real" without padding.
+\remarks The interpolation is a loop with a constant number of iterations, which the compiler fully unrolls and vectorizes.
+\see VertexLayout
+*/
+template <typename Vertex, std::size_t NumComponents = sizeof(Vertex) / sizeof(Gs::Real)>
+struct RealVertexLayout
+{
+    static_assert(NumComponents > 0 && NumComponents * sizeof(Gs::Real) <= sizeof(Vertex), "invalid number of vertex components");
+
+    static void Interpolate(Vertex& output, const Vertex& v0, const Vertex& v1, const Vertex& v2, const Gs::Vector3& barycentricCoords)
+    {
+        const auto x = barycentricCoords.x;
+        const auto y = barycentricCoords.y;
+        const auto z = barycentricCoords.z;
+
+        auto out = reinterpret_cast<Gs::Real*>(&output);
+        auto in0 = reinterpret_cast<const Gs::Real*>(&v0);
+        auto in1 = reinterpret_cast<const Gs::Real*>(&v1);
+        auto in2 = reinterpret_cast<const Gs::Real*>(&v2);
+
+        for (std::size_t i = 0; i < NumComponents; ++i)
+            out[i] = in0[i] * x + in1[i] * y + in2[i] * z;
+    }
+};
+
+//! Vertex layout of the default vertex format (see "GetDefaultVertexDesc").
+template <>
+struct VertexLayout<TriangleMesh::Vertex> : RealVertexLayout<TriangleMesh::Vertex>
+{
+    static_assert(sizeof(TriangleMesh::Vertex) == 8 * sizeof(Gs::Real), "default vertex format must consist of 8 tightly packed components");
+};
+
+/**
+\brief Makes a barycentric interpolation between the three specified vertices with a compile-time vertex layout.
+\see VertexLayout
+*/
+template <typename Vertex>
+Vertex InterpolateBarycentric(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Gs::Vector3& barycentricCoords)
+{
+    Vertex output;
+    VertexLayout<Vertex>::Interpolate(output, v0, v1, v2, barycentricCoords);
+    return output;
+}
+
+/**
+\brief Makes a barycentric interpolation of many samples with a compile-time vertex layout.
+\param[in] vertices Specifies the input vertices.
+\param[in] triangles Specifies the triangles (with indices into 'vertices') which the samples refer to.
+\param[in] samples Specifies the samples to interpolate.
+\param[in] numSamples Specifies the number of samples.
+\param[out] output Specifies the output vertices, which receive one vertex per sample.
+\see VertexLayout
+*/
+template <typename Vertex, typename TIndex>
+void InterpolateBarycentric(
+    const Vertex*               vertices,
+    const Triangle<TIndex>*     triangles,
+    const BarycentricSample*    samples,
+    std::size_t                 numSamples,
+    Vertex*                     output)
+{
+    for (std::size_t i = 0; i < numSamples; ++i)
+    {
+        const auto& tri = triangles[samples[i].triangleIndex];
+        VertexLayout<Vertex>::Interpolate(output[i], vertices[tri.a], vertices[tri.b], vertices[tri.c], samples[i].barycentricCoords);
+    }
+}
+
 /**
-Clips this triangle mesh into a front- and back sided mesh by the specified clipping plane.
+\brief Makes a barycentric interpolation of many samples of the specified mesh.
+\param[out] output Specifies the output vertices, which receive one vertex per sample.
+\remarks Large batches are split into chunks on the shared thread pool.
+\see TriangleMesh::Barycentric
+*/
+void InterpolateBarycentric(const TriangleMesh& mesh, const BarycentricSample* samples, std::size_t numSamples, TriangleMesh::Vertex* output);
+
+/**
+\brief Clips this triangle mesh into a front- and back sided mesh by the specified clipping plane.
+\param[in] sharedVertices Specifies whether the output triangles share their vertices. By default false.
+If false, each output triangle has its own three vertices; use "WeldVertices" to merge them.
+If true, each input vertex is copied at most once into each output mesh, and each input edge that crosses the plane is split only once,
+so adjacent triangles share the split vertex and both output meshes are as watertight as the input mesh.
+\remarks Both modes classify the vertices with the same tolerance as "ClipTriangle".
+Without shared vertices, chunks of triangles are clipped in parallel on the shared thread pool:
+the output size of each chunk is counted first, and the output offsets are computed by a prefix sum,
+so the output is exactly the same as for a serial loop over all triangles.
+\throws std::overflow_error If an output mesh exceeds the range of the mesh index type.
 \see ClipTriangle
 */
-void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back);
+void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back, bool sharedVertices = false);
+
+/**
+\brief Clips this triangle mesh against all planes of the specified convex hull in a single pass.
+\param[in] mesh Specifies the input mesh.
+\param[in] convexHull Specifies the convex hull, whose plane normals point out of the hull.
+\param[out] inside Specifies the output mesh, which receives the part of the mesh inside the convex hull. Previous content is replaced.
+\remarks Each triangle is clipped against all planes at once (Sutherland-Hodgman), so no intermediate meshes are created.
+Planes which do not intersect the bounding box of the mesh are skipped, and each triangle is only clipped by the planes which intersect its own bounding box.
+Vertices of the input mesh are copied at most once, and the vertices on the planes are interpolated for each clipped triangle; use "WeldVertices" to merge them.
+Vertices within the tolerance of "ClipTriangle" in front of a plane are kept.
+\throws std::overflow_error If the output mesh exceeds the range of the mesh index type.
+\see ClipMesh(const TriangleMesh&, const Plane&, TriangleMesh&, TriangleMesh&, bool)
+*/
+void ClipMesh(const TriangleMesh& mesh, const ConvexHull& convexHull, TriangleMesh& inside);
+
+/**
+\brief Clips this triangle mesh against all planes of the specified frustum in a single pass.
+\see ClipMesh(const TriangleMesh&, const ConvexHull&, TriangleMesh&)
+*/
+void ClipMesh(const TriangleMesh& mesh, const Frustum& frustum, TriangleMesh& inside);
+
+/**
+\brief Computes the signed distances of all vertices of the specified mesh to the specified plane.
+\param[out] distances Specifies the output container. This will be resized to the number of vertices.
+\remarks This is vectorized over the position streams and split into chunks on the shared thread pool for large meshes.
+\see SgnDistanceToPlane
+*/
+void PlaneDistances(const TriangleMeshSoA& mesh, const Plane& plane, AlignedVector<Gs::Real>& distances);
+
+/**
+Clips this structure-of-arrays mesh into a front- and back sided mesh by the specified clipping plane.
+All vertices are classified against the plane in one vectorized pass, and only the triangles which intersect the plane are passed to "ClipTriangle".
+The output is the same as for the array-of-structures variant.
+\see PlaneDistances
+*/
+void ClipMesh(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back);
+
+
+/**
+\brief Finds the canonical vertex for each vertex of the specified mesh, i.e. the vertex with the smallest index at the same position.
+\param[in] mesh Specifies the input mesh.
+\param[in] epsilon Specifies the tolerance for each position component (like "Gs::Equals"). If this is zero, only exactly equal positions are matched.
+\param[out] canonicalIndices Receives one index per vertex. Each entry is less than or equal to its own index and refers to a vertex whose entry refers to itself.
+\remarks The positions are hashed into a uniform grid whose cells are at least twice the tolerance wide, so each vertex is only compared to the vertices of at most 8 cells.
+The grid is built and queried in parallel on the shared thread pool.
+If the tolerance chains several vertices (i.e. a equals b, and b equals c), all of them are mapped to the same canonical vertex.
+\see MeshAdjacency::Build
+*/
+void FindCanonicalVertices(const TriangleMesh& mesh, Gs::Real epsilon, std::vector<TriangleMesh::VertexIndex>& canonicalIndices);
+
+/**
+\brief Merges all vertices of the specified mesh with equal positions.
+\param[in,out] mesh Specifies the mesh whose vertices are to be welded.
+\param[in] epsilon Specifies the tolerance for each position component. By default Gs::Epsilon.
+\param[out] remapTable Optional pointer to the output remap table. Each entry is the new index of the respective old vertex.
+\return Number of removed vertices.
+\remarks The attributes of the first vertex at each position are kept, and the order of the remaining vertices is preserved.
+The number and order of triangles is preserved as well, i.e. triangles which collapse by welding remain as degenerate triangles.
+\see FindCanonicalVertices
+*/
+std::size_t WeldVertices(
+    TriangleMesh&                           mesh,
+    Gs::Real                                epsilon     = Gs::Epsilon<Gs::Real>(),
+    std::vector<TriangleMesh::VertexIndex>* remapTable  = nullptr
+);
+
+//! Post-transform vertex cache statistics of a triangle mesh.
+struct VertexCacheStatistics
+{
+    //! Average cache miss ratio, i.e. the number of transformed vertices per triangle. This is in the range [0.5, 3] for typical meshes, and lower is better.
+    Gs::Real acmr = 0;
+
+    //! Average transformed vertex ratio, i.e. the number of transformed vertices per vertex. The optimum is 1.
+    Gs::Real atvr = 0;
+};
+
+//! Vertex cache statistics before and after an optimization.
+struct VertexCacheReport
+{
+    VertexCacheStatistics before;
+    VertexCacheStatistics after;
+};
+
+/**
+\brief Simulates a FIFO post-transform vertex cache of the specified size for the triangles of the specified mesh.
+\param[in] mesh Specifies the mesh whose triangles are to be analyzed.
+\param[in] cacheSize Specifies the number of vertices in the cache. By default 16.
+*/
+VertexCacheStatistics AnalyzeVertexCache(const TriangleMesh& mesh, std::size_t cacheSize = 16);
+
+/**
+\brief Reorders the triangles of the specified mesh to improve the locality of the vertex references.
+\param[in,out] mesh Specifies the mesh whose triangles are to be reordered. The vertices are not modified.
+\param[in] cacheSize Specifies the cache size for the statistics. By default 16.
+\return Vertex cache statistics before and after the optimization.
+\remarks This uses the "Linear-Speed Vertex Cache Optimisation" by Tom Forsyth, which models an LRU cache of 32 vertices
+and therefore performs well for any actual cache size. The run time is linear in the number of triangles.
+\see AnalyzeVertexCache
+\see OptimizeVertexFetch
+*/
+VertexCacheReport OptimizeVertexCache(TriangleMesh& mesh, std::size_t cacheSize = 16);
+
+/**
+\brief Reorders the vertices of the specified mesh by their first use in the triangle list and remaps the triangle indices.
+\param[in,out] mesh Specifies the mesh whose vertices are to be reordered. Vertices that are not referenced by any triangle are removed.
+\param[in] cacheSize Specifies the cache size for the statistics. By default 16.
+\param[out] remapTable Optional pointer to the output remap table. Each entry is the new index of the respective old vertex,
+or "TriangleMesh::MaxNumVertices" if the vertex has been removed.
+\return Vertex cache statistics before and after the optimization. The ACMR does not change, and the ATVR only changes if unused vertices have been removed.
+\remarks Call this after "OptimizeVertexCache", so vertices are fetched in ascending order while walking through the triangles.
+\see OptimizeVertexCache
+*/
+VertexCacheReport OptimizeVertexFetch(
+    TriangleMesh&                           mesh,
+    std::size_t                             cacheSize   = 16,
+    std::vector<TriangleMesh::VertexIndex>* remapTable  = nullptr
+);
+
+//! Level of detail (LOD) of a simplified mesh.
+struct LODLevel
+{
+    //! Triangles of this level. The indices refer to the vertices of the input mesh, so all levels can share one vertex buffer.
+    std::vector<TriangleMesh::Triangle> triangles;
+
+    /**
+    \brief Geometric error of this level, in the units of the vertex positions. This is zero for the first level.
+    \remarks This is the maximal root-mean-square distance between a collapsed vertex and the planes of the original triangles it represents.
+    To select a level at runtime, project this error onto the screen and take the coarsest level whose projected error is below a pixel threshold.
+    */
+    Gs::Real                            error = 0;
+};
+
+/**
+\brief Simplifies the specified mesh by quadric edge collapses.
+\param[in,out] mesh Specifies the mesh to be simplified. Vertices that are no longer referenced are removed; the order of the remaining vertices and triangles is preserved.
+\param[in] targetTriangleCount Specifies the number of triangles at which the simplification stops.
+\param[in] maxError Specifies the maximal geometric error (see "LODLevel::error"). The simplification stops before a collapse would exceed this error.
+By default the maximal value of "Gs::Real", i.e. only the target triangle count is considered.
+\param[in] seamDesc Specifies the vertex attributes that define seams. Vertices at the same position that differ in any of these attributes
+are seam vertices, and are only collapsed along their seam, so that normal and texture-coordinate discontinuities are preserved.
+Only the offsets and components of the attributes are used; the stride is always the size of "TriangleMesh::Vertex". By default "GetDefaultVertexDesc".
+\return Geometric error of the simplified mesh.
+\remarks Each collapse moves one vertex onto a neighbor vertex (half-edge collapse), so no new vertices or attributes are created.
+Vertices on the mesh border only collapse along the border, vertices on non-manifold edges are never collapsed,
+and collapses that would flip a triangle are rejected. Triangles with less than three distinct positions are removed.
+\see GenerateLODChain
+*/
+Gs::Real Simplify(
+    TriangleMesh&           mesh,
+    std::size_t             targetTriangleCount,
+    Gs::Real                maxError            = std::numeric_limits<Gs::Real>::max(),
+    const VertexDescriptor& seamDesc            = GetDefaultVertexDesc()
+);
+
+/**
+\brief Generates a chain of levels of detail for the specified mesh by successive quadric edge collapses.
+\param[in] mesh Specifies the input mesh. The triangles of all levels refer to its vertices.
+\param[in] numLevels Specifies the maximal number of levels including the first level, which contains the unmodified triangles of the input mesh.
+\param[in] reductionRatio Specifies the ratio of triangles of each level relative to its previous level. Must be in the range (0, 1). By default 0.5.
+\param[in] maxError Specifies the maximal geometric error of all levels. By default the maximal value of "Gs::Real".
+\param[in] seamDesc Specifies the vertex attributes that define seams. By default "GetDefaultVertexDesc".
+\return List of levels with ascending geometric error. The chain ends early if the mesh cannot be simplified any further within the maximal error.
+\remarks The collapses of all levels are computed in a single pass, i.e. each level continues from the previous one.
+\throws std::invalid_argument If 'reductionRatio' is not in the range (0, 1).
+\see Simplify
+*/
+std::vector<LODLevel> GenerateLODChain(
+    const TriangleMesh&     mesh,
+    std::size_t             numLevels,
+    Gs::Real                reductionRatio  = Gs::Real(0.5),
+    Gs::Real                maxError        = std::numeric_limits<Gs::Real>::max(),
+    const VertexDescriptor& seamDesc        = GetDefaultVertexDesc()
+);
+
+/**
+\brief Computes smooth normals for all triangle corners of the specified mesh.
+\param[in] mesh Specifies the input mesh.
+\param[in] creaseAngle Specifies the crease angle (in radians). Only triangles whose normals deviate by at most this angle from the normal of a corner's triangle
+contribute to the normal of that corner. By default pi, i.e. all triangles around a vertex are smoothed.
+\param[out] cornerNormals Receives three normals (in unit length) per triangle, in the order of the triangle indices.
+\remarks Each corner normal is the sum of the face normals around its position, weighted by the angle of each triangle at that position.
+Vertices at the same position (within Gs::Epsilon) share their neighborhood, so texture-coordinate seams are smoothed as well.
+The normals are gathered per corner from a vertex-to-triangle table (CSR) in parallel on the shared thread pool, i.e. without any concurrent accumulation.
+\see ComputeNormals
+*/
+void ComputeCornerNormals(const TriangleMesh& mesh, Gs::Real creaseAngle, std::vector<Gs::Vector3>& cornerNormals);
+
+/**
+\brief Recomputes the normals of all vertices of the specified mesh.
+\param[in,out] mesh Specifies the mesh whose normals are to be recomputed.
+\param[in] creaseAngle Specifies the crease angle (in radians). By default pi, i.e. no vertices are split.
+\return Number of vertices that have been added.
+\remarks The normals are computed by "ComputeCornerNormals". If the corners of a vertex have different normals (i.e. the vertex lies on a crease),
+the vertex is split and the respective triangles refer to the new copies. Vertices that are not referenced by any triangle keep their normal.
+\throws std::overflow_error If splitting the vertices would exceed "TriangleMesh::MaxNumVertices". In this case, the mesh remains unchanged.
+\see ComputeCornerNormals
+*/
+std::size_t ComputeNormals(TriangleMesh& mesh, Gs::Real creaseAngle = Gs::Real(Gs::pi));
+
+/**
+\brief Computes the tangent frames of all vertices of the specified mesh.
+\param[in] mesh Specifies the input mesh. The tangents are aligned to the U direction of the texture-coordinates and orthogonal to the vertex normals.
+\param[out] tangents Receives one tangent per vertex. The XYZ components are the tangent (in unit length),
+and the W component is the handedness (+1 or -1), so that the bitangent is cross(normal, tangent) * w.
+\remarks The tangents of all triangles of a vertex are weighted by the angle of the triangle at that vertex (see "ComputeTangentSpace").
+Unlike the normals, tangents are not shared between vertices at the same position, since texture-coordinate seams require separate tangents.
+The tangents are gathered per vertex from a vertex-to-triangle table (CSR) in parallel on the shared thread pool.
+\see ComputeTangentSpace
+\see ComputeNormals
+*/
+void ComputeTangents(const TriangleMesh& mesh, std::vector<Gs::Vector4>& tangents);
+
+/**
+\brief Labels the connected components of the specified mesh, i.e. the sets of triangles that are connected via shared vertices.
+\param[in] mesh Specifies the input mesh.
+\param[out] componentIDs Receives one component ID per triangle. The IDs are in the range [0, N) and are numbered in the order of the first triangle of each component.
+\param[in] weldEpsilon Specifies the tolerance to connect vertices at equal positions (see "FindCanonicalVertices").
+If this is negative, only shared vertex indices connect triangles. By default -1.
+\return Number of components N.
+\remarks The vertices are joined with a lock-free union-find in parallel on the shared thread pool, so the run time is (almost) linear in the number of triangles.
+The result is deterministic, i.e. independent of the number of threads.
+\see SplitConnectedComponents
+*/
+std::size_t FindConnectedComponents(
+    const TriangleMesh&         mesh,
+    std::vector<std::size_t>&   componentIDs,
+    Gs::Real                    weldEpsilon = Gs::Real(-1)
+);
+
+/**
+\brief Splits the specified mesh into its connected components.
+\param[in] mesh Specifies the input mesh.
+\param[in] weldEpsilon Specifies the tolerance to connect vertices at equal positions. By default -1 (see "FindConnectedComponents").
+\return List of meshes, one for each component in the order of the component IDs.
+Each mesh only contains the vertices that are referenced by its triangles, and the order of triangles and vertices is preserved.
+Vertices that are not referenced by any triangle are dropped.
+\see FindConnectedComponents
+*/
+std::vector<TriangleMesh> SplitConnectedComponents(const TriangleMesh& mesh, Gs::Real weldEpsilon = Gs::Real(-1));
+
+//! Polyline where a mesh intersects a slicing plane.
+struct SliceContour
+{
+    //! Points of the polyline. For closed contours, the last point is connected to the first point (which is not repeated).
+    std::vector<Gs::Vector3>    points;
+
+    //! Specifies whether the contour is closed. Open contours occur at the borders (and non-manifold edges) of the mesh.
+    bool                        closed      = false;
+};
+
+//! Contours of the mesh on one slicing plane.
+struct SliceLayer
+{
+    //! Distance of the slicing plane along the normal (see "SliceMesh").
+    Gs::Real                    offset      = 0;
+
+    //! All contours on this slicing plane.
+    std::vector<SliceContour>   contours;
+};
+
+/**
+\brief Slices the specified mesh with parallel planes into planar contours.
+\param[in] mesh Specifies the input mesh.
+\param[in] normal Specifies the normal of all slicing planes. This does not need to be normalized.
+\param[in] offsets Specifies the distance of each slicing plane along the normalized normal, i.e. the planes are "Plane(normal.Normalized(), offset)".
+\param[in] weldEpsilon Specifies the tolerance to connect vertices at equal positions (see "FindCanonicalVertices"), so the contours are continuous across texture seams.
+If this is negative, only shared vertex indices connect the triangles. By default Gs::Epsilon.
+\return List of layers in the same order as the offsets.
+\remarks The triangles are sorted by the lower end of their projected extent along the normal, and chunks of layers are swept across the sorted triangles
+in parallel on the shared thread pool, so each layer only visits the triangles which span its plane. The sweep state at the first layer of each chunk is stored
+in a single sequential pass beforehand, so no chunk sweeps over the triangles below its first layer again.
+The run time is O(T log T + L + S) for T triangles, L layers, and S segments.
+The crossing point of each edge is computed with "IntersectionWithPlane", and the segments are chained into polylines via a hash map of the crossed edges.
+Vertices exactly on a plane are treated as above the plane, so each crossed triangle contributes exactly one segment and closed meshes yield closed contours.
+The contours of a mesh with consistent winding are oriented consistently, and the output is independent of the number of threads.
+*/
+std::vector<SliceLayer> SliceMesh(
+    const TriangleMesh&             mesh,
+    const Gs::Vector3&              normal,
+    const std::vector<Gs::Real>&    offsets,
+    Gs::Real                        weldEpsilon = Gs::Epsilon<Gs::Real>()
+);
+
+//! Boolean operations between two solid meshes.
+enum class BooleanOperation
+{
+    Union,          //!< Space inside of either mesh.
+    Intersection,   //!< Space inside of both meshes.
+    Difference,     //!< Space inside of the first mesh but outside of the second mesh.
+};
+
+/**
+\brief Computes a boolean operation (CSG) between two closed meshes, e.g. a cuboid minus a cylinder.
+\param[in] lhs Specifies the first mesh. This must be closed and wound consistently (see "MeshBSPTree").
+\param[in] rhs Specifies the second mesh. This must be closed and wound consistently (see "MeshBSPTree").
+\param[in] operation Specifies the boolean operation.
+\param[out] result Specifies the output mesh. Previous content is replaced.
+\param[in] desc Specifies the descriptor for the BSP trees of both meshes.
+\remarks The BSP trees of both meshes are built in parallel, then each tree clips the polygons of the other one,
+and the remaining polygons of both trees are triangulated into one indexed mesh (see "MeshBSPTree::GetMesh").
+The vertex attributes of split polygons are interpolated, and the triangles from the surface of 'rhs' are flipped for a difference.
+\throws std::overflow_error If the result has more than "TriangleMesh::MaxNumVertices" vertices.
+\see MeshBSPTree
+*/
+void BooleanMesh(
+    const TriangleMesh&         lhs,
+    const TriangleMesh&         rhs,
+    const BooleanOperation      operation,
+    TriangleMesh&               result,
+    const BSPTreeDescriptor&    desc        = BSPTreeDescriptor()
+);
+
+//! Loop subdivision descriptor structure.
+struct SubdivisionDescriptor
+{
+    /**
+    \brief Crease angle (in radians). Edges between two triangles whose normals deviate by more than this angle are sharp features,
+    which are preserved as crease curves instead of being smoothed. By default pi, i.e. only border edges are sharp.
+    \remarks The normals of the subdivided mesh are recomputed with the same crease angle (see "ComputeNormals").
+    */
+    Gs::Real                        creaseAngle = Gs::Real(Gs::pi);
+
+    //! Tolerance to connect vertices at equal positions (see "FindCanonicalVertices"). If this is negative, only shared vertex indices connect triangles. By default Gs::Epsilon.
+    Gs::Real                        weldEpsilon = Gs::Epsilon<Gs::Real>();
+
+    //! Additional sharp edges, specified by the vertex indices of the input mesh. Edges that do not exist in the mesh are ignored.
+    std::vector<TriangleMesh::Edge> creaseEdges;
+};
+
+/**
+\brief Subdivides the specified triangle mesh with the Loop scheme, i.e. each level splits every triangle into four triangles and smooths the positions.
+\param[in,out] mesh Specifies the mesh to be subdivided, e.g. a coarse cage of a mesh generator.
+\param[in] levels Specifies the number of subdivision levels. Each level multiplies the number of triangles by four. By default 1.
+\param[in] desc Specifies the subdivision descriptor, e.g. to preserve sharp features.
+\remarks The edge table is built only once for the input mesh; the edges and triangles of each further level are derived from their parents,
+so the run time is proportional to the size of the output. The new edge and vertex points of each level are computed in parallel on the shared thread pool.
+Vertices at equal positions are connected, so texture-coordinate seams are subdivided as one surface but keep their separate vertices.
+Texture-coordinates are interpolated linearly, and the normals are recomputed for the final surface.
+Border edges and crease edges use the crease masks, and vertices with one or more than two sharp edges (corners) keep their position.
+Triangles with less than three distinct positions are removed.
+\throws std::overflow_error If the subdivided mesh would have more than "TriangleMesh::MaxNumVertices" vertices. In this case, the mesh remains unchanged.
+\throws std::invalid_argument If a crease edge refers to a vertex index out of range.
+\see SubdivisionDescriptor
+*/
+void Subdivide(TriangleMesh& mesh, std::size_t levels = 1, const SubdivisionDescriptor& desc = SubdivisionDescriptor());
+
+/**
+\brief Transforms the positions and normals of all vertices of the specified mesh.
+\param[in,out] mesh Specifies the mesh to be transformed.
+\param[in] matrix Specifies the affine transformation matrix.
+\param[out] boundingBox Optional pointer to the output bounding box of the transformed positions, which is computed in the same pass. By default null.
+\remarks The normals are transformed by the inverse-transpose of the upper-left 3x3 matrix (so they stay orthogonal to the surface under non-uniform scaling)
+and are normalized again. The vertices are transformed with SSE2 kernels in parallel on the shared thread pool.
+The triangles are not changed, i.e. a matrix with a negative determinant (a reflection) inverts the winding order of the surface.
+The derived data of the mesh is invalidated (see "TriangleMesh::InvalidateCache").
+\see TriangleMesh::BoundingBox(const Gs::AffineMatrix4&)
+*/
+void Transform(TriangleMesh& mesh, const Gs::AffineMatrix4& matrix, AABB3* boundingBox = nullptr);
+
+/**
+\brief Transforms the specified mesh into another mesh. Previous content of the output mesh is replaced.
+\param[in] mesh Specifies the input mesh.
+\param[in] matrix Specifies the affine transformation matrix.
+\param[out] result Specifies the output mesh. This may be the same as the input mesh. The triangles are copied.
+\param[out] boundingBox Optional pointer to the output bounding box of the transformed positions. By default null.
+\remarks Each vertex is read once from the input mesh and written once into the output mesh, i.e. the input vertices are not copied first.
+\see Transform(TriangleMesh&, const Gs::AffineMatrix4&, AABB3*)
+*/
+void Transform(const TriangleMesh& mesh, const Gs::AffineMatrix4& matrix, TriangleMesh& result, AABB3* boundingBox = nullptr);
 
 
 } // /namespace MeshModifier
@@ -0,0 +1,100 @@
+/*
+ * MeshSilhouette.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_SILHOUETTE_H
+#define GM_MESH_SILHOUETTE_H
+
+
+#include "TriangleMesh.h"
+
+#include <Gauss/Vector3.h>
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Silhouette and crease edge extraction for triangle meshes.
+\remarks The edge-to-triangle map, the face normals, and the dihedral deviation of each edge are computed once by "Build".
+Afterwards, crease edges can be extracted for any number of tolerance angles,
+and silhouette edges for any number of view points, in linear time each.
+\see TriangleMesh::SilhouetteEdges
+*/
+class MeshSilhouette
+{
+
+    public:
+
+        using Edge          = TriangleMesh::Edge;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+
+        MeshSilhouette() = default;
+
+        //! Builds the edge map for the specified mesh.
+        explicit MeshSilhouette(const TriangleMesh& mesh);
+
+        /**
+        \brief Builds the edge-to-triangle map and face normals for the specified mesh.
+        \remarks If the mesh has an adjacency index, it is used instead of building a temporary one.
+        Likewise, the face normals are taken from the derived-data cache of the mesh if it is enabled.
+        The dihedral test is evaluated for all edges in parallel (if multi-threading is enabled).
+        \see TriangleMesh::BuildAdjacency
+        \see TriangleMesh::EnableCache
+        */
+        void Build(const TriangleMesh& mesh);
+
+        //! Releases all internal data.
+        void Clear();
+
+        /**
+        \brief Returns all edges whose adjacent triangles deviate by the specified tolerance angle, and all border edges.
+        \param[in] toleranceAngle Specifies the tolerance angle (in radians) to reject edges. Must be in the range [0, pi].
+        \remarks This is equivalent to "TriangleMesh::SilhouetteEdges".
+        */
+        std::vector<Edge> CreaseEdges(Gs::Real toleranceAngle = Gs::Real(0)) const;
+
+        /**
+        \brief Returns all edges that separate front-facing from back-facing triangles, as seen from the specified view point, and all border edges.
+        \param[in] viewPoint Specifies the view point in the same coordinate space as the mesh vertices.
+        */
+        std::vector<Edge> SilhouetteEdges(const Gs::Vector3& viewPoint) const;
+
+        //! Returns the list of all unique edges of the mesh. The crease and silhouette queries return subsets of this list.
+        inline const std::vector<Edge>& GetEdges() const
+        {
+            return edges_;
+        }
+
+        //! Returns the normal vectors (in unit length) of all triangles.
+        inline const std::vector<Gs::Vector3>& GetFaceNormals() const
+        {
+            return faceNormals_;
+        }
+
+    private:
+
+        std::vector<Edge>           edges_;
+        std::vector<Gs::Real>       edgeDeviations_;        // Maximal deviation |dot(n_i, n_0) - 1| of the triangles per edge
+        std::vector<TriangleIndex>  edgeTriangleOffsets_;   // CSR offsets into 'edgeTriangles_' (size = edges_.size() + 1)
+        std::vector<TriangleIndex>  edgeTriangles_;
+
+        std::vector<Gs::Vector3>    faceNormals_;
+        std::vector<Gs::Real>       faceDistances_;         // Plane distance of each triangle, i.e. dot(normal, a)
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,164 @@
+/*
+ * MeshletSet.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESHLET_SET_H
+#define GM_MESHLET_SET_H
+
+
+#include "TriangleMesh.h"
+#include "Sphere.h"
+#include "Cone.h"
+#include "Frustum.h"
+
+#include <Gauss/Vector3.h>
+#include <vector>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+
+//! Meshlet partitioning descriptor structure.
+struct MeshletDescriptor
+{
+    //! Maximal number of vertices per meshlet. Must be in the range [3, 256]. By default 64.
+    std::size_t maxVertices     = 64;
+
+    //! Maximal number of triangles per meshlet. Must be greater than zero. By default 124.
+    std::size_t maxTriangles    = 124;
+
+    /**
+    \brief Specifies how much the normal deviation of a candidate triangle is weighted against its distance to the meshlet center. By default 0.5.
+    \remarks A higher weight produces narrower normal cones (i.e. more meshlets can be back-face culled) at the expense of less compact bounding spheres.
+    */
+    Gs::Real    coneWeight      = Gs::Real(0.5);
+};
+
+/**
+\brief Meshlet (or cluster) of a triangle mesh with a bounded number of vertices and triangles.
+\remarks The vertices and triangles of all meshlets are stored in the shared arrays of the "MeshletSet" this meshlet belongs to.
+\see MeshletSet
+*/
+struct Meshlet
+{
+    std::uint32_t   vertexOffset    = 0;    //!< Index of the first entry in "MeshletSet::GetVertexIndices".
+    std::uint32_t   numVertices     = 0;    //!< Number of vertices of this meshlet.
+    std::uint32_t   triangleOffset  = 0;    //!< Index of the first triangle in "MeshletSet::GetLocalIndices", i.e. the first local index is at 3*triangleOffset.
+    std::uint32_t   numTriangles    = 0;    //!< Number of triangles of this meshlet.
+
+    //! Bounding sphere that encloses all vertices of this meshlet.
+    Sphere          boundingSphere;
+
+    /**
+    \brief Normal cone of all triangles of this meshlet.
+    \remarks The direction is the cone axis, and the angle (see "ConeT::GetAngle") is the maximal deviation of a triangle normal from the axis.
+    The cone has a slant height of one, i.e. 'height' is the cosine and 'radius' is the sine of that angle.
+    The tip is moved behind all triangles along the negative axis, so that every view point within the cone that is opened from the tip
+    into the opposite direction of the axis (with an angle of pi/2 minus the normal cone angle) is behind all triangles.
+    If the triangle normals spread over (almost) a hemisphere or more, the height is zero and the meshlet is never back-facing.
+    */
+    Cone            normalCone;
+};
+
+/**
+\brief Partitioning of a triangle mesh into meshlets with bounding spheres and normal cones.
+\remarks Meshlets are grown greedily across shared vertices, preferring triangles that add the fewest new vertices,
+are close to the meshlet center, and have a similar normal. This keeps the meshlets spatially compact,
+so that whole meshlets can be culled against a view frustum or as back-facing before any per-triangle work is done.
+\see Meshlet
+*/
+class MeshletSet
+{
+
+    public:
+
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using Triangle      = TriangleMesh::Triangle;
+
+        MeshletSet() = default;
+
+        //! Builds the meshlets for the specified mesh.
+        explicit MeshletSet(const TriangleMesh& mesh, const MeshletDescriptor& desc = MeshletDescriptor());
+
+        /**
+        \brief Partitions the specified mesh into meshlets. Previous content is replaced.
+        \remarks Each triangle of the mesh is assigned to exactly one meshlet. If the mesh has an adjacency index, it is used instead of building a temporary one.
+        The face normals are taken from the derived-data cache of the mesh if it is enabled.
+        \throws std::invalid_argument If 'desc.maxVertices' is out of the range [3, 256] or 'desc.maxTriangles' is zero.
+        \see TriangleMesh::BuildAdjacency
+        \see TriangleMesh::EnableCache
+        */
+        void Build(const TriangleMesh& mesh, const MeshletDescriptor& desc = MeshletDescriptor());
+
+        //! Releases all internal data.
+        void Clear();
+
+        //! Returns true if the bounding sphere of the specified meshlet is completely outside of the specified frustum.
+        bool IsOutside(std::size_t meshletIndex, const Frustum& frustum) const;
+
+        /**
+        \brief Returns true if all triangles of the specified meshlet are back-facing, as seen from the specified view point.
+        \remarks This is a conservative test with the normal cone of the meshlet, i.e. it may return false even if all triangles are back-facing.
+        \see Meshlet::normalCone
+        */
+        bool IsBackFacing(std::size_t meshletIndex, const Gs::Vector3& viewPoint) const;
+
+        /**
+        \brief Culls all meshlets against the specified frustum and view point.
+        \param[in] frustum Specifies the view frustum in the same coordinate space as the mesh vertices.
+        \param[in] viewPoint Specifies the view point in the same coordinate space as the mesh vertices.
+        \param[out] visibleMeshlets Specifies the output list of indices of all meshlets that are neither outside of the frustum nor back-facing (in ascending order).
+        \return Number of visible meshlets.
+        \remarks The meshlets are tested in parallel on the shared thread pool.
+        \see IsOutside
+        \see IsBackFacing
+        \see GetSharedThreadPool
+        */
+        std::size_t Cull(const Frustum& frustum, const Gs::Vector3& viewPoint, std::vector<std::size_t>& visibleMeshlets) const;
+
+        //! Returns the triangle with the specified local index of the specified meshlet, with the indices of the original mesh vertices.
+        Triangle GetTriangle(std::size_t meshletIndex, std::size_t triangleIndex) const;
+
+        //! Returns the list of all meshlets.
+        inline const std::vector<Meshlet>& GetMeshlets() const
+        {
+            return meshlets_;
+        }
+
+        //! Returns the indices of the original mesh vertices of all meshlets. Each meshlet refers to the range [vertexOffset, vertexOffset + numVertices).
+        inline const std::vector<VertexIndex>& GetVertexIndices() const
+        {
+            return vertexIndices_;
+        }
+
+        /**
+        \brief Returns the local vertex indices of all triangles (three per triangle) of all meshlets.
+        \remarks Each local index refers to the vertices of its meshlet, i.e. to the entry (vertexOffset + localIndex) in "GetVertexIndices".
+        */
+        inline const std::vector<std::uint8_t>& GetLocalIndices() const
+        {
+            return localIndices_;
+        }
+
+    private:
+
+        std::vector<Meshlet>        meshlets_;
+        std::vector<VertexIndex>    vertexIndices_;
+        std::vector<std::uint8_t>   localIndices_;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -117,7 +117,7 @@ class PlaneT
         */
         PlaneT(const T& x, const T& y, const T& z, const T& d) :
             normal   { x, y, z                  },
-            distance { PlaneEq::DistanceSign(d) }
+            distance { PlaneEq::DistanceSign(-d) }
         {
         }
 
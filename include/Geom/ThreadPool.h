@@ -0,0 +1,104 @@
+/*
+ * ThreadPool.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_THREAD_POOL_H
+#define GM_THREAD_POOL_H
+
+
+#include "Config.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Persistent worker thread pool for data-parallel loops.
+\remarks The worker threads are created once and wait for work, so a parallel loop only costs a few synchronizations instead of thread creations.
+The calling thread always takes part in its own loop, and parallel loops may be nested (e.g. inside recursive algorithms) without deadlocks.
+\see GetSharedThreadPool
+*/
+class ThreadPool
+{
+
+    public:
+
+        //! Chunk function interface. The function receives the half-open index range [begin, end) of the current chunk.
+        using ChunkFunction = std::function<void(std::size_t begin, std::size_t end)>;
+
+        /**
+        \brief Creates the thread pool with the specified number of worker threads.
+        \param[in] numThreads Specifies the number of worker threads, not counting the calling thread.
+        If this is zero, all loops are executed on the calling thread only.
+        */
+        explicit ThreadPool(std::size_t numThreads);
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator = (const ThreadPool&) = delete;
+
+        //! Waits for all worker threads to finish and joins them.
+        ~ThreadPool();
+
+        /**
+        \brief Calls the specified function for consecutive chunks of the index range [0, count) and returns when all chunks have been processed.
+        \param[in] count Specifies the number of elements.
+        \param[in] grainSize Specifies the minimal number of elements per chunk. Ranges below twice this size are processed at once on the calling thread.
+        \param[in] func Specifies the chunk function. It must be safe to call this function concurrently for disjoint chunks.
+        \remarks If the chunk function throws an exception, the remaining chunks are skipped and the first exception is re-thrown on the calling thread.
+        */
+        void ParallelFor(std::size_t count, std::size_t grainSize, const ChunkFunction& func);
+
+        //! Returns the number of worker threads, not counting the calling thread.
+        inline std::size_t NumThreads() const
+        {
+            return threads_.size();
+        }
+
+        //! Returns a recommended number of worker threads for this machine, i.e. the number of hardware threads minus one.
+        static std::size_t DefaultNumThreads();
+
+    private:
+
+        struct Job;
+
+        void WorkerThreadProc();
+        void RemoveJob(const std::shared_ptr<Job>& job);
+
+        std::vector<std::thread>            threads_;
+        std::deque<std::shared_ptr<Job>>    jobs_;
+        std::mutex                          mutex_;
+        std::condition_variable             jobAvailable_;
+        bool                                quit_           = false;
+
+};
+
+
+/**
+\brief Returns the thread pool which is shared by all parallel algorithms of this library.
+\remarks The pool is created on first use with "ThreadPool::DefaultNumThreads" worker threads.
+If 'GM_ENABLE_MULTI_THREADING' is not defined, the pool has no worker threads and all loops run on the calling thread.
+*/
+ThreadPool& GetSharedThreadPool();
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -13,6 +13,7 @@
 #include "Line.h"
 #include "Triangle.h"
 #include "AABB.h"
+#include "MemoryResource.h"
 
 #include <Gauss/Vector2.h>
 #include <Gauss/Vector3.h>
@@ -20,13 +21,18 @@
 #include <Gauss/Epsilon.h>
 #include <algorithm>
 #include <set>
+#include <memory>
 #include <cstdint>
+#include <type_traits>
+#include <limits>
 
 
 namespace Gm
 {
 
 
+class MeshAdjacency;
+
 /**
 \brief Triangle mesh base class.
 \remarks This class is used for generation and modification of all triangle meshes.
@@ -52,25 +58,59 @@ class TriangleMesh
             Gs::Vector2 texCoord;
         };
 
-        using VertexIndex   = std::vector<Vertex>::size_type;
+        /**
+        \brief Vertex index type for edges and triangles. This is std::uint32_t by default and can be configured with 'GM_MESH_INDEX_TYPE'.
+        \remarks The number of vertices is limited to "MaxNumVertices", i.e. the maximal value of this type is never a valid vertex index.
+        */
+        #ifdef GM_MESH_INDEX_TYPE
+        using VertexIndex   = GM_MESH_INDEX_TYPE;
+        #else
+        using VertexIndex   = std::uint32_t;
+        #endif
+
+        static_assert(std::is_integral<VertexIndex>::value && std::is_unsigned<VertexIndex>::value, "mesh index type must be an unsigned integral type");
 
         using Edge          = Gm::Line<VertexIndex>;
         using Triangle      = Gm::Triangle<VertexIndex>;
 
         using TriangleIndex = std::vector<Triangle>::size_type;
 
-        TriangleMesh() = default;
+        //! List type of the vertices, whose memory is allocated from the memory resource of the mesh.
+        using VertexArray   = std::vector<Vertex, PolymorphicAllocator<Vertex>>;
+
+        //! List type of the triangles, whose memory is allocated from the memory resource of the mesh.
+        using TriangleArray = std::vector<Triangle, PolymorphicAllocator<Triangle>>;
 
-        TriangleMesh(const TriangleMesh&) = default;
+        TriangleMesh();
+
+        /**
+        \brief Constructs an empty mesh whose vertices and triangles are allocated from the specified memory resource.
+        \param[in] resource Specifies the memory resource. If this is null, the default memory resource is used.
+        The resource must outlive the mesh, e.g. a "MonotonicArena" must only be reset after all of its scratch meshes have been destroyed.
+        \remarks The memory resource stays with the mesh: assigning another mesh copies or moves the elements into the memory of this mesh.
+        A copy of a mesh uses the default memory resource (see "PolymorphicAllocator"), and a moved mesh keeps the memory resource of its origin.
+        \see MonotonicArena
+        */
+        explicit TriangleMesh(MemoryResource* resource);
+
+        TriangleMesh(const TriangleMesh& rhs);
         TriangleMesh(TriangleMesh&& rhs);
 
-        TriangleMesh& operator = (const TriangleMesh& rhs) = default;
+        //! Copies the specified mesh into a new mesh, whose vertices and triangles are allocated from the specified memory resource.
+        TriangleMesh(const TriangleMesh& rhs, MemoryResource* resource);
+
+        ~TriangleMesh();
+
+        TriangleMesh& operator = (const TriangleMesh& rhs);
         TriangleMesh& operator = (TriangleMesh&& rhs);
 
         //! Clears all vertices and triangles.
         void Clear();
 
-        //! Adds a new vertex with the specified attributes and returns the index of the new vertex.
+        /**
+        \brief Adds a new vertex with the specified attributes and returns the index of the new vertex.
+        \throws std::overflow_error If the mesh already has "MaxNumVertices" vertices.
+        */
         VertexIndex AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord);
 
         //! Adds a new triangle with the specified three indices and returns the index of the new triangle.
@@ -79,13 +119,21 @@ class TriangleMesh
         //! Returns the vertex, interpolated from the triangle with the specified barycentric coordinates.
         Vertex Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const;
 
-        //! Computes the set of all triangle edges.
+        /**
+        \brief Computes the set of all triangle edges.
+        \remarks Each edge (a, b) satisfies a < b and the list is sorted, i.e. degenerated edges (with two equal vertices) are not included.
+        If the derived-data cache is enabled, the edges are only computed once.
+        \see EnableCache
+        */
         std::vector<Edge> Edges() const;
 
         /**
         \brief Computes the set of all triangle edges which are part of the silhouette.
         \param[in] toleranceAngle Specifies the tolerance angle (in radians) to reject edges. Must be in the range [0, pi].
+        \remarks This builds a temporary edge map in linear time. To extract the edges for several tolerance angles
+        or view points, use the "MeshSilhouette" class directly.
         \see Edges
+        \see MeshSilhouette
         */
         std::vector<Edge> SilhouetteEdges(Gs::Real toleranceAngle = Gs::Real(0)) const;
 
@@ -98,6 +146,12 @@ class TriangleMesh
         \param[in] searchViaPosition Specifies whether to search triangles via the position of
         their vertices (true), or only search via the index of their vertices (false). By default false.
         \return Set of triangle indices of the neighbor search result including the input triangle indices.
+        \remarks If the adjacency index is present and 'searchViaPosition' is false,
+        only the triangles adjacent to the respective search front are visited instead of all triangles.
+        If 'searchViaPosition' is true, vertices with equal positions are first mapped to a canonical vertex with a hashed grid
+        (see "MeshModifier::FindCanonicalVertices"), and a temporary adjacency index is built for the canonical indices,
+        so the search takes linear instead of quadratic time.
+        \see BuildAdjacency
         */
         std::set<TriangleIndex> TriangleNeighbors(
             std::set<TriangleIndex> triangleIndices,
@@ -106,40 +160,142 @@ class TriangleMesh
             bool                    searchViaPosition = false
         ) const;
 
-        //! Computes the list of all triangles that are connected to the specified vertex.
+        /**
+        \brief Computes the list of all triangles that are connected to the specified vertex.
+        \remarks This takes constant time per result if the adjacency index is present, otherwise all triangles are scanned.
+        \see BuildAdjacency
+        */
         std::vector<TriangleIndex> FindTriangles(VertexIndex vertexIndex) const;
 
-        //! Computes the list of all triangles that are connected to the specified edge.
+        /**
+        \brief Computes the list of all triangles that are connected to the specified edge.
+        \remarks This takes constant time per result if the adjacency index is present, otherwise all triangles are scanned.
+        \see BuildAdjacency
+        */
         std::vector<TriangleIndex> FindTriangles(const Edge& edge) const;
 
         //! Computes the list of all triangles with their own vertices, but without indices.
         std::vector<Gm::Triangle<Vertex>> TriangleList() const;
 
-        //! Returns the normal vector of the specified triangle (in unit length of 1.0).
+        //! Returns the maximal number of vertices a mesh can have with the configured index type.
+        static inline std::size_t MaxNumVertices()
+        {
+            return static_cast<std::size_t>(std::numeric_limits<VertexIndex>::max());
+        }
+
+        /**
+        \brief Returns the normal vector of the specified triangle (in unit length of 1.0).
+        \remarks If the derived-data cache is enabled, the normals of all triangles are computed once.
+        \see EnableCache
+        */
         Gs::Vector3 TriangleNormal(TriangleIndex triangleIndex) const;
 
-        //! Computes the axis-aligned bounding-box of this mesh.
+        /**
+        \brief Returns the area of the specified triangle.
+        \remarks If the derived-data cache is enabled, the areas of all triangles are computed once, together with the normals.
+        \see EnableCache
+        */
+        Gs::Real TriangleArea(TriangleIndex triangleIndex) const;
+
+        /**
+        \brief Computes the axis-aligned bounding-box of this mesh.
+        \remarks This is vectorized (if SSE2 is available) and split into chunks on the shared thread pool for large meshes.
+        If the derived-data cache is enabled, the box is only computed once.
+        \see GetSharedThreadPool
+        \see EnableCache
+        */
         AABB3 BoundingBox() const;
 
-        //! Computes the axis-aligned bounding-box of this mesh with the specified transformation matrix.
+        //! Computes the axis-aligned bounding-box of this mesh with the specified transformation matrix. This is vectorized and parallelized like "BoundingBox()".
         AABB3 BoundingBox(const Gs::AffineMatrix4& matrix) const;
 
-        #ifdef GM_ENABLE_MULTI_THREADING
-
         /**
-        \brief Computes the axis-aligned bounding-box of this mesh with the specified number of threads.
-        \param[in] threadCount Specifies the number of threads. This will be clamped to the range [1, vertices.size()].
-        \remarks This may only increase performance with very large triangle meshes, i.e. over 1 Mio. vertices and more.
+        \brief Computes the axis-aligned bounding-box of this mesh, split into the specified number of chunks on the shared thread pool.
+        \param[in] threadCount Specifies the number of chunks. If this is less than 2, or the mesh is too small, the box is computed on the calling thread.
+        \remarks "BoundingBox()" already selects the chunk size automatically, so this is only required to override that selection.
+        \see GetSharedThreadPool
         */
         AABB3 BoundingBoxMultiThreaded(std::size_t threadCount) const;
 
-        #endif
-
-        //! Appends the specified triangle mesh to this mesh.
+        /**
+        \brief Appends the specified triangle mesh to this mesh.
+        \throws std::overflow_error If the merged mesh would have more than "MaxNumVertices" vertices. In this case, this mesh remains unchanged.
+        */
         void Append(const TriangleMesh& other);
 
-        std::vector<Vertex>     vertices;   //!< Vertex array list.
-        std::vector<Triangle>   triangles;  //!< Triangle array list. Make sure that all triangle indices are less than the number of vertices of this mesh!
+        /**
+        \brief Builds the vertex/edge/triangle adjacency index for the current vertices and triangles.
+        \remarks The index is built in linear time and is then used by "FindTriangles" and "TriangleNeighbors".
+        It goes stale when the mesh is modified by "AddTriangle" or "Append", and it is released by "Clear".
+        After modifying the 'triangles' member directly, call "InvalidateAdjacency".
+        \see MeshAdjacency
+        \see GetAdjacency
+        */
+        void BuildAdjacency();
+
+        //! Releases the adjacency index (if it has been built).
+        void ReleaseAdjacency();
+
+        //! Marks the adjacency index as stale. Call this after the 'triangles' member has been modified directly.
+        void InvalidateAdjacency();
+
+        //! Returns true if an adjacency index has been built but the mesh has been modified since then.
+        bool IsAdjacencyStale() const;
+
+        /**
+        \brief Returns the adjacency index of this mesh, or null if it has not been built or has gone stale.
+        \see BuildAdjacency
+        */
+        const MeshAdjacency* GetAdjacency() const;
+
+        /**
+        \brief Enables or disables the cache for derived data, i.e. the triangle normals and areas, the bounding box, and the edges.
+        \remarks The cache is disabled by default. If enabled, each kind of data is computed on its first query,
+        and all further queries ("TriangleNormal", "TriangleArea", "BoundingBox()", and "Edges") return the stored data until the cache is invalidated.
+        The cache is invalidated by "AddVertex", "AddTriangle", "Append", and "Clear".
+        After modifying the 'vertices' or 'triangles' members directly, call "InvalidateCache".
+        Queries may run concurrently, e.g. from several threads of a parallel loop. A copy of this mesh starts with an empty cache.
+        */
+        void EnableCache(bool enable = true);
+
+        //! Returns true if the derived-data cache is enabled.
+        bool IsCacheEnabled() const;
+
+        //! Invalidates all derived data in the cache. Call this after the 'vertices' or 'triangles' members have been modified directly.
+        void InvalidateCache();
+
+        //! Returns the memory resource of the vertices and triangles. This is never null.
+        MemoryResource* GetMemoryResource() const;
+
+        VertexArray             vertices;   //!< Vertex array list.
+        TriangleArray           triangles;  //!< Triangle array list. Make sure that all triangle indices are less than the number of vertices of this mesh!
+
+    private:
+
+        struct DerivedCache;
+
+        // Returns the cache with valid triangle normals and areas, or null if the cache is disabled.
+        const DerivedCache* CacheWithFaceData() const;
+
+        // Returns the cache with a valid bounding box, or null if the cache is disabled.
+        const DerivedCache* CacheWithBoundingBox() const;
+
+        // Returns the cache with valid edges, or null if the cache is disabled.
+        const DerivedCache* CacheWithEdges() const;
+
+        // Searches the neighbors with the specified adjacency index, which was built from the specified triangles.
+        std::set<TriangleIndex> TriangleNeighborsWithAdjacency(
+            const MeshAdjacency&            adjacency,
+            const TriangleArray&            adjacencyTriangles,
+            std::set<TriangleIndex>         triangleIndices,
+            std::size_t                     searchDepth,
+            bool                            edgeBondOnly
+        ) const;
+
+        std::shared_ptr<const MeshAdjacency>    adjacency_;
+        bool                                    adjacencyStale_ = false;
+
+        std::unique_ptr<DerivedCache>           cache_;
 
 };
 
@@ -0,0 +1,132 @@
+/*
+ * TriangleMeshSoA.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_TRIANGLE_MESH_SOA_H
+#define GM_TRIANGLE_MESH_SOA_H
+
+
+#include "TriangleMesh.h"
+#include "AlignedAllocator.h"
+
+#include <vector>
+
+
+namespace Gm
+{
+
+
+/**
+\brief Triangle mesh with a structure-of-arrays (SoA) vertex layout.
+\remarks Each vertex component (i.e. position.x, position.y, ..., texCoord.y) is stored in its own aligned stream,
+so position-only passes (e.g. bounding box, plane classification, clipping) only read the position streams and can process several vertices per SIMD instruction.
+Use this class for the hot paths and "TriangleMesh" (array-of-structures) for everything else; the conversion between both is a single linear pass.
+\see TriangleMesh
+*/
+class TriangleMeshSoA
+{
+
+    public:
+
+        using Vertex        = TriangleMesh::Vertex;
+        using VertexIndex   = TriangleMesh::VertexIndex;
+        using Triangle      = TriangleMesh::Triangle;
+        using TriangleIndex = TriangleMesh::TriangleIndex;
+
+        //! Aligned stream of scalar vertex components.
+        using Stream        = AlignedVector<Gs::Real>;
+
+        //! Streams for a 3D vector attribute.
+        struct Vector3Streams
+        {
+            Stream x;
+            Stream y;
+            Stream z;
+        };
+
+        //! Streams for a 2D vector attribute.
+        struct Vector2Streams
+        {
+            Stream x;
+            Stream y;
+        };
+
+        TriangleMeshSoA() = default;
+
+        //! Converts the specified mesh from the array-of-structures layout.
+        explicit TriangleMeshSoA(const TriangleMesh& mesh);
+
+        //! Clears all vertices and triangles.
+        void Clear();
+
+        //! Resizes all vertex streams to the specified number of vertices.
+        void ResizeVertices(std::size_t numVertices);
+
+        //! Reserves memory in all vertex streams for the specified number of vertices.
+        void ReserveVertices(std::size_t numVertices);
+
+        /**
+        \brief Adds a new vertex with the specified attributes and returns the index of the new vertex.
+        \throws std::overflow_error If the mesh already has "TriangleMesh::MaxNumVertices" vertices.
+        */
+        VertexIndex AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord);
+
+        //! Adds a new vertex and returns the index of the new vertex. This has the same overflow check as the other overload.
+        VertexIndex AddVertex(const Vertex& vertex);
+
+        //! Adds a new triangle with the specified three indices and returns the index of the new triangle.
+        TriangleIndex AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2);
+
+        //! Gathers the specified vertex from all streams.
+        Vertex GetVertex(VertexIndex vertexIndex) const;
+
+        //! Scatters the specified vertex into all streams.
+        void SetVertex(VertexIndex vertexIndex, const Vertex& vertex);
+
+        //! Returns the position of the specified vertex.
+        Gs::Vector3 GetPosition(VertexIndex vertexIndex) const;
+
+        //! Returns the vertex, interpolated from the triangle with the specified barycentric coordinates.
+        Vertex Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const;
+
+        //! Replaces all vertices and triangles by those of the specified mesh in array-of-structures layout.
+        void FromMesh(const TriangleMesh& mesh);
+
+        //! Converts this mesh into the specified mesh in array-of-structures layout.
+        void ToMesh(TriangleMesh& mesh) const;
+
+        //! Returns this mesh in array-of-structures layout.
+        TriangleMesh ToMesh() const;
+
+        //! Computes the axis-aligned bounding-box of this mesh, vectorized over the position streams.
+        AABB3 BoundingBox() const;
+
+        //! Computes the axis-aligned bounding-box of this mesh with the specified transformation matrix, vectorized over the position streams.
+        AABB3 BoundingBox(const Gs::AffineMatrix4& matrix) const;
+
+        //! Returns the number of vertices.
+        inline std::size_t NumVertices() const
+        {
+            return positions.x.size();
+        }
+
+        Vector3Streams          positions;
+        Vector3Streams          normals;
+        Vector2Streams          texCoords;
+
+        std::vector<Triangle>   triangles;
+
+};
+
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
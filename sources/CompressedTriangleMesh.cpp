@@ -0,0 +1,601 @@
+/*
+ * CompressedTriangleMesh.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/CompressedTriangleMesh.h>
+#include <Geom/AABBCollision.h>
+#include <Geom/TriangleCollision.h>
+#include <Geom/ThreadPool.h>
+#include "SIMDDetails.h"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <cmath>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per chunk for the parallel encoding and decoding passes.
+static const std::size_t compressGrainSize = 16384;
+
+// Minimal number of triangles per chunk for the parallel intersection tests.
+static const std::size_t intersectionGrainSize = 4096;
+
+// Number of vertices that are decoded at once into temporary buffers on the stack.
+static const std::size_t decodeBlockSize = 256;
+
+static const Gs::Real unorm16Max = Gs::Real(65535);
+static const Gs::Real snorm16Max = Gs::Real(32767);
+
+using Packet = Details::SIMDPacket<Gs::Real>;
+
+static std::uint16_t QuantizeUnorm16(Gs::Real value, Gs::Real offset, Gs::Real invStep)
+{
+    auto q = (value - offset) * invStep + Gs::Real(0.5);
+    return static_cast<std::uint16_t>(std::max(Gs::Real(0), std::min(q, unorm16Max)));
+}
+
+// Decodes the specified number of quantized components: dst[i] = offset + src[i] * step.
+template <typename T>
+static void DecodeUnorm16(const std::uint16_t* src, std::size_t count, T offset, T step, T* dst)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        dst[i] = offset + static_cast<T>(src[i]) * step;
+}
+
+static Gs::Vector3 DecodeOctahedral(std::int16_t u, std::int16_t v)
+{
+    const auto scale = Gs::Real(1) / snorm16Max;
+
+    auto x = static_cast<Gs::Real>(u) * scale;
+    auto y = static_cast<Gs::Real>(v) * scale;
+    auto z = Gs::Real(1) - std::abs(x) - std::abs(y);
+
+    /* Unfold the lower hemisphere */
+    auto t = std::max(-z, Gs::Real(0));
+    x += (x >= Gs::Real(0) ? -t : t);
+    y += (y >= Gs::Real(0) ? -t : t);
+
+    return Gs::Vector3(x, y, z).Normalized();
+}
+
+// Decodes the specified number of octahedral encoded normals into three streams.
+template <typename T>
+static void DecodeOctahedral(const std::int16_t* u, const std::int16_t* v, std::size_t count, T* x, T* y, T* z)
+{
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto n = DecodeOctahedral(u[i], v[i]);
+        x[i] = n.x;
+        y[i] = n.y;
+        z[i] = n.z;
+    }
+}
+
+#ifdef GM_SIMD_SSE2
+
+// Single precision specialization, which decodes 8 components per iteration.
+template <>
+inline void DecodeUnorm16<float>(const std::uint16_t* src, std::size_t count, float offset, float step, float* dst)
+{
+    const auto zero     = _mm_setzero_si128();
+    const auto offsets  = _mm_set1_ps(offset);
+    const auto steps    = _mm_set1_ps(step);
+
+    std::size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        auto q  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        auto lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, zero));
+        auto hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q, zero));
+        _mm_storeu_ps(dst + i,     _mm_add_ps(offsets, _mm_mul_ps(lo, steps)));
+        _mm_storeu_ps(dst + i + 4, _mm_add_ps(offsets, _mm_mul_ps(hi, steps)));
+    }
+
+    for (; i < count; ++i)
+        dst[i] = offset + static_cast<float>(src[i]) * step;
+}
+
+// Decodes four octahedral encoded normals from 32 bit integers.
+static void DecodeOctahedral4(__m128i qu, __m128i qv, float* x, float* y, float* z)
+{
+    const auto scale    = _mm_set1_ps(1.0f / 32767.0f);
+    const auto one      = _mm_set1_ps(1.0f);
+    const auto zero     = _mm_setzero_ps();
+    const auto signMask = _mm_set1_ps(-0.0f);
+
+    auto nx = _mm_mul_ps(_mm_cvtepi32_ps(qu), scale);
+    auto ny = _mm_mul_ps(_mm_cvtepi32_ps(qv), scale);
+    auto nz = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, nx)), _mm_andnot_ps(signMask, ny));
+
+    /* Unfold the lower hemisphere: n.xy -= copysign(max(-n.z, 0), n.xy) */
+    auto t = _mm_max_ps(_mm_sub_ps(zero, nz), zero);
+    nx = _mm_sub_ps(nx, _mm_or_ps(t, _mm_and_ps(nx, signMask)));
+    ny = _mm_sub_ps(ny, _mm_or_ps(t, _mm_and_ps(ny, signMask)));
+
+    /* Normalize */
+    auto invLength = _mm_div_ps(one, _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)), _mm_mul_ps(nz, nz))));
+
+    _mm_storeu_ps(x, _mm_mul_ps(nx, invLength));
+    _mm_storeu_ps(y, _mm_mul_ps(ny, invLength));
+    _mm_storeu_ps(z, _mm_mul_ps(nz, invLength));
+}
+
+// Single precision specialization, which decodes 8 normals per iteration.
+template <>
+inline void DecodeOctahedral<float>(const std::int16_t* u, const std::int16_t* v, std::size_t count, float* x, float* y, float* z)
+{
+    std::size_t i = 0;
+
+    for (; i + 8 <= count; i += 8)
+    {
+        auto qu = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + i));
+        auto qv = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + i));
+
+        /* Sign-extend 16 bit to 32 bit integers */
+        DecodeOctahedral4(
+            _mm_srai_epi32(_mm_unpacklo_epi16(qu, qu), 16),
+            _mm_srai_epi32(_mm_unpacklo_epi16(qv, qv), 16),
+            x + i, y + i, z + i
+        );
+        DecodeOctahedral4(
+            _mm_srai_epi32(_mm_unpackhi_epi16(qu, qu), 16),
+            _mm_srai_epi32(_mm_unpackhi_epi16(qv, qv), 16),
+            x + i + 4, y + i + 4, z + i + 4
+        );
+    }
+
+    for (; i < count; ++i)
+    {
+        auto n = DecodeOctahedral(u[i], v[i]);
+        x[i] = static_cast<float>(n.x);
+        y[i] = static_cast<float>(n.y);
+        z[i] = static_cast<float>(n.z);
+    }
+}
+
+#endif
+
+/*
+Encodes the specified normal with the octahedral mapping and returns the cosine of the angle between the decoded and the original normal.
+Instead of rounding each component, the closest of the four neighboring grid points is selected.
+*/
+static Gs::Real EncodeOctahedral(const Gs::Vector3& normal, std::int16_t& u, std::int16_t& v)
+{
+    auto length1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+    if (length1 <= Gs::Real(0))
+    {
+        u = 0;
+        v = 0;
+        return Gs::Real(1);
+    }
+
+    /* Project onto the octahedron and fold the lower hemisphere */
+    auto x = normal.x / length1;
+    auto y = normal.y / length1;
+
+    if (normal.z < Gs::Real(0))
+    {
+        auto fx = (Gs::Real(1) - std::abs(y)) * (x >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        auto fy = (Gs::Real(1) - std::abs(x)) * (y >= Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+        x = fx;
+        y = fy;
+    }
+
+    /* Select the closest grid point */
+    const auto n     = normal.Normalized();
+    const auto baseU = std::floor(x * snorm16Max);
+    const auto baseV = std::floor(y * snorm16Max);
+
+    auto bestCosine = std::numeric_limits<Gs::Real>::lowest();
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto cu = static_cast<std::int16_t>(std::max(-snorm16Max, std::min(baseU + Gs::Real(i & 1), snorm16Max)));
+        auto cv = static_cast<std::int16_t>(std::max(-snorm16Max, std::min(baseV + Gs::Real(i >> 1), snorm16Max)));
+
+        auto cosine = Gs::Dot(DecodeOctahedral(cu, cv), n);
+        if (cosine > bestCosine)
+        {
+            bestCosine = cosine;
+            u = cu;
+            v = cv;
+        }
+    }
+
+    return bestCosine;
+}
+
+// Bounding box of the transformed points (x[i], y[i], z[i]) for i in [0, count), where the transformation is given by the 3x4 matrix 'm' (in row-major order).
+static AABB3 TransformedBoundingBox(const Gs::Real* x, const Gs::Real* y, const Gs::Real* z, std::size_t count, const Gs::Real* m)
+{
+    auto Transform = [m](const Packet& px, const Packet& py, const Packet& pz, std::size_t row) -> Packet
+    {
+        return
+        (
+            px * Packet::Splat(m[row*4    ]) +
+            py * Packet::Splat(m[row*4 + 1]) +
+            pz * Packet::Splat(m[row*4 + 2]) +
+            Packet::Splat(m[row*4 + 3])
+        );
+    };
+
+    auto minX = Packet::Splat(std::numeric_limits<Gs::Real>::max());
+    auto minY = minX;
+    auto minZ = minX;
+
+    auto maxX = Packet::Splat(std::numeric_limits<Gs::Real>::lowest());
+    auto maxY = maxX;
+    auto maxZ = maxX;
+
+    std::size_t i = 0;
+
+    for (; i + Packet::width <= count; i += Packet::width)
+    {
+        auto px = Packet::Load(x + i);
+        auto py = Packet::Load(y + i);
+        auto pz = Packet::Load(z + i);
+
+        auto tx = Transform(px, py, pz, 0);
+        auto ty = Transform(px, py, pz, 1);
+        auto tz = Transform(px, py, pz, 2);
+
+        minX = Packet::Min(tx, minX);
+        minY = Packet::Min(ty, minY);
+        minZ = Packet::Min(tz, minZ);
+
+        maxX = Packet::Max(tx, maxX);
+        maxY = Packet::Max(ty, maxY);
+        maxZ = Packet::Max(tz, maxZ);
+    }
+
+    AABB3 box;
+
+    box.min = Gs::Vector3(minX.ReduceMin(), minY.ReduceMin(), minZ.ReduceMin());
+    box.max = Gs::Vector3(maxX.ReduceMax(), maxY.ReduceMax(), maxZ.ReduceMax());
+
+    for (; i < count; ++i)
+    {
+        box.Insert(
+            Gs::Vector3(
+                x[i]*m[0] + y[i]*m[1] + z[i]*m[ 2] + m[ 3],
+                x[i]*m[4] + y[i]*m[5] + z[i]*m[ 6] + m[ 7],
+                x[i]*m[8] + y[i]*m[9] + z[i]*m[10] + m[11]
+            )
+        );
+    }
+
+    return box;
+}
+
+
+/* ----- CompressedTriangleMesh class ----- */
+
+CompressedTriangleMesh::CompressedTriangleMesh(const TriangleMesh& mesh)
+{
+    Compress(mesh);
+}
+
+void CompressedTriangleMesh::Compress(const TriangleMesh& mesh)
+{
+    const auto numVerts = mesh.vertices.size();
+
+    for (auto& s : positions_)
+        s.resize(numVerts);
+    for (auto& s : normals_)
+        s.resize(numVerts);
+    for (auto& s : texCoords_)
+        s.resize(numVerts);
+
+    triangles_.assign(mesh.triangles.begin(), mesh.triangles.end());
+
+    /* Setup quantization of positions (by the bounding box) and texture-coordinates (by their range) */
+    const auto box = (numVerts > 0 ? mesh.BoundingBox() : AABB3(Gs::Vector3(), Gs::Vector3()));
+
+    AABB2 texCoordBox { Gs::Vector2(), Gs::Vector2() };
+    if (numVerts > 0)
+    {
+        texCoordBox = AABB2(mesh.vertices[0].texCoord, mesh.vertices[0].texCoord);
+        for (const auto& vertex : mesh.vertices)
+            texCoordBox.Insert(vertex.texCoord);
+    }
+
+    Gs::Real invPositionSteps[3], invTexCoordSteps[2];
+
+    auto SetupQuantization = [](Quantization& quantization, Gs::Real minValue, Gs::Real maxValue) -> Gs::Real
+    {
+        quantization.offset = minValue;
+        quantization.step   = (maxValue - minValue) / unorm16Max;
+        return (quantization.step > Gs::Real(0) ? Gs::Real(1) / quantization.step : Gs::Real(0));
+    };
+
+    errorBounds_ = ErrorBounds();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        invPositionSteps[i] = SetupQuantization(positionQuantization_[i], box.min[i], box.max[i]);
+        errorBounds_.position += positionQuantization_[i].step * positionQuantization_[i].step;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        invTexCoordSteps[i] = SetupQuantization(texCoordQuantization_[i], texCoordBox.min[i], texCoordBox.max[i]);
+        errorBounds_.texCoord += texCoordQuantization_[i].step * texCoordQuantization_[i].step;
+    }
+
+    errorBounds_.position = std::sqrt(errorBounds_.position) * Gs::Real(0.5);
+    errorBounds_.texCoord = std::sqrt(errorBounds_.texCoord) * Gs::Real(0.5);
+
+    /* Encode all vertices and measure the normal error */
+    auto minNormalCosine = Gs::Real(1);
+    std::mutex errorMutex;
+
+    GetSharedThreadPool().ParallelFor(
+        numVerts, compressGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            auto minCosine = Gs::Real(1);
+
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& vertex = mesh.vertices[i];
+
+                for (int j = 0; j < 3; ++j)
+                    positions_[j][i] = QuantizeUnorm16(vertex.position[j], positionQuantization_[j].offset, invPositionSteps[j]);
+
+                for (int j = 0; j < 2; ++j)
+                    texCoords_[j][i] = QuantizeUnorm16(vertex.texCoord[j], texCoordQuantization_[j].offset, invTexCoordSteps[j]);
+
+                auto cosine = EncodeOctahedral(vertex.normal, normals_[0][i], normals_[1][i]);
+                minCosine = std::min(minCosine, cosine);
+            }
+
+            std::lock_guard<std::mutex> guard { errorMutex };
+            minNormalCosine = std::min(minNormalCosine, minCosine);
+        }
+    );
+
+    errorBounds_.normal = std::acos(std::max(Gs::Real(-1), std::min(minNormalCosine, Gs::Real(1))));
+}
+
+void CompressedTriangleMesh::Decompress(TriangleMesh& mesh) const
+{
+    const auto numVerts = NumVertices();
+
+    mesh.Clear();
+    mesh.vertices.resize(numVerts);
+    mesh.triangles.assign(triangles_.begin(), triangles_.end());
+
+    /* Decode blocks of vertices into temporary streams and scatter them into the vertices */
+    GetSharedThreadPool().ParallelFor(
+        numVerts, compressGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            Gs::Real p[3][decodeBlockSize], n[3][decodeBlockSize], t[2][decodeBlockSize];
+
+            for (auto block = begin; block < end; block += decodeBlockSize)
+            {
+                const auto count = std::min(decodeBlockSize, end - block);
+
+                for (int j = 0; j < 3; ++j)
+                    DecodeUnorm16(positions_[j].data() + block, count, positionQuantization_[j].offset, positionQuantization_[j].step, p[j]);
+
+                for (int j = 0; j < 2; ++j)
+                    DecodeUnorm16(texCoords_[j].data() + block, count, texCoordQuantization_[j].offset, texCoordQuantization_[j].step, t[j]);
+
+                DecodeOctahedral(normals_[0].data() + block, normals_[1].data() + block, count, n[0], n[1], n[2]);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    auto& vertex = mesh.vertices[block + i];
+                    vertex.position = Gs::Vector3(p[0][i], p[1][i], p[2][i]);
+                    vertex.normal   = Gs::Vector3(n[0][i], n[1][i], n[2][i]);
+                    vertex.texCoord = Gs::Vector2(t[0][i], t[1][i]);
+                }
+            }
+        }
+    );
+
+    mesh.InvalidateCache();
+}
+
+TriangleMesh CompressedTriangleMesh::Decompress() const
+{
+    TriangleMesh mesh;
+    Decompress(mesh);
+    return mesh;
+}
+
+void CompressedTriangleMesh::Clear()
+{
+    for (auto& s : positions_)
+        s.clear();
+    for (auto& s : normals_)
+        s.clear();
+    for (auto& s : texCoords_)
+        s.clear();
+
+    triangles_.clear();
+    errorBounds_ = ErrorBounds();
+}
+
+CompressedTriangleMesh::Vertex CompressedTriangleMesh::GetVertex(VertexIndex vertexIndex) const
+{
+    return Vertex(GetPosition(vertexIndex), GetNormal(vertexIndex), GetTexCoord(vertexIndex));
+}
+
+Gs::Vector3 CompressedTriangleMesh::GetPosition(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+
+    auto Decode = [this, vertexIndex](int axis)
+    {
+        const auto& q = positionQuantization_[axis];
+        return q.offset + static_cast<Gs::Real>(positions_[axis][vertexIndex]) * q.step;
+    };
+
+    return Gs::Vector3(Decode(0), Decode(1), Decode(2));
+}
+
+Gs::Vector3 CompressedTriangleMesh::GetNormal(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+    return DecodeOctahedral(normals_[0][vertexIndex], normals_[1][vertexIndex]);
+}
+
+Gs::Vector2 CompressedTriangleMesh::GetTexCoord(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+
+    auto Decode = [this, vertexIndex](int axis)
+    {
+        const auto& q = texCoordQuantization_[axis];
+        return q.offset + static_cast<Gs::Real>(texCoords_[axis][vertexIndex]) * q.step;
+    };
+
+    return Gs::Vector2(Decode(0), Decode(1));
+}
+
+AABB3 CompressedTriangleMesh::BoundingBox() const
+{
+    if (NumVertices() == 0)
+        return AABB3();
+
+    AABB3 box;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const auto& q = positionQuantization_[i];
+        box.min[i] = q.offset;
+        box.max[i] = q.offset + unorm16Max * q.step;
+    }
+
+    return box;
+}
+
+AABB3 CompressedTriangleMesh::BoundingBox(const Gs::AffineMatrix4& matrix) const
+{
+    const Gs::Real m[12] =
+    {
+        matrix(0, 0), matrix(0, 1), matrix(0, 2), matrix(0, 3),
+        matrix(1, 0), matrix(1, 1), matrix(1, 2), matrix(1, 3),
+        matrix(2, 0), matrix(2, 1), matrix(2, 2), matrix(2, 3),
+    };
+
+    AABB3 box;
+    std::mutex boxMutex;
+
+    GetSharedThreadPool().ParallelFor(
+        NumVertices(), compressGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            Gs::Real p[3][decodeBlockSize];
+
+            AABB3 subBox;
+
+            for (auto block = begin; block < end; block += decodeBlockSize)
+            {
+                const auto count = std::min(decodeBlockSize, end - block);
+
+                for (int j = 0; j < 3; ++j)
+                    DecodeUnorm16(positions_[j].data() + block, count, positionQuantization_[j].offset, positionQuantization_[j].step, p[j]);
+
+                subBox.Insert(TransformedBoundingBox(p[0], p[1], p[2], count, m));
+            }
+
+            std::lock_guard<std::mutex> guard { boxMutex };
+            box.Insert(subBox);
+        }
+    );
+
+    return box;
+}
+
+bool CompressedTriangleMesh::IntersectionWithRay(const Ray3& ray, TriangleIndex& triangleIndex, Gs::Vector3& barycentric) const
+{
+    if (triangles_.empty() || !IntersectionWithAABB(BoundingBox(), ray))
+        return false;
+
+    /* Find the closest intersection per chunk, then the closest of all chunks (the smaller triangle index wins ties, so the result is deterministic) */
+    bool        hit             = false;
+    Gs::Real    closestDistance = 0;
+    std::mutex  hitMutex;
+
+    GetSharedThreadPool().ParallelFor(
+        triangles_.size(), intersectionGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            bool            chunkHit        = false;
+            Gs::Real        chunkDistance   = 0;
+            TriangleIndex   chunkTriangle   = 0;
+            Gs::Vector3     chunkCoords;
+
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles_[i];
+
+                const Triangle3 coords
+                {
+                    GetPosition(tri.a),
+                    GetPosition(tri.b),
+                    GetPosition(tri.c)
+                };
+
+                Gs::Vector3 coordsBarycentric;
+                if (IntersectionWithTriangleBarycentric(coords, ray, coordsBarycentric))
+                {
+                    auto point      = coords.a * coordsBarycentric.x + coords.b * coordsBarycentric.y + coords.c * coordsBarycentric.z;
+                    auto distance   = Gs::Dot(point - ray.origin, ray.direction);
+
+                    if (!chunkHit || distance < chunkDistance)
+                    {
+                        chunkHit        = true;
+                        chunkDistance   = distance;
+                        chunkTriangle   = i;
+                        chunkCoords     = coordsBarycentric;
+                    }
+                }
+            }
+
+            if (chunkHit)
+            {
+                std::lock_guard<std::mutex> guard { hitMutex };
+                if (!hit || chunkDistance < closestDistance || (chunkDistance == closestDistance && chunkTriangle < triangleIndex))
+                {
+                    hit             = true;
+                    closestDistance = chunkDistance;
+                    triangleIndex   = chunkTriangle;
+                    barycentric     = chunkCoords;
+                }
+            }
+        }
+    );
+
+    return hit;
+}
+
+std::size_t CompressedTriangleMesh::MemoryUsage() const
+{
+    return
+    (
+        NumVertices() * (sizeof(std::uint16_t) * 5 + sizeof(std::int16_t) * 2) +
+        triangles_.size() * sizeof(Triangle)
+    );
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -8,6 +8,7 @@
 #include <Geom/KeyframeSequence.h>
 #include <Geom/Transform3.h>
 #include <Gauss/Algebra.h>
+#include "Except.h"
 #include <algorithm>
 #include <stdexcept>
 
@@ -123,6 +124,23 @@ void KeyframeSequence::BuildKeys(
     }
 }
 
+void KeyframeSequence::SetKeys(
+    std::vector<Gs::Vector3>    positionKeys,
+    std::vector<Gs::Quaternion> rotationKeys,
+    std::vector<Gs::Vector3>    scaleKeys,
+    std::size_t                 frameBegin)
+{
+    if (positionKeys.size() != rotationKeys.size() || positionKeys.size() != scaleKeys.size())
+        throw std::invalid_argument(GM_EXCEPT_INFO("number of position, rotation, and scale keys must be equal"));
+
+    frameBegin_ = frameBegin;
+    frameEnd_   = frameBegin + positionKeys.size();
+
+    positionKeys_   = std::move(positionKeys);
+    rotationKeys_   = std::move(rotationKeys);
+    scaleKeys_      = std::move(scaleKeys);
+}
+
 void KeyframeSequence::Interpolate(
     Gs::Vector3& position, Gs::Quaternion& rotation, Gs::Vector3& scale, std::size_t from, std::size_t to, Gs::Real interpolator)
 {
@@ -0,0 +1,182 @@
+/*
+ * MemoryResource.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MemoryResource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Memory resource for the global heap. Over-aligned blocks store the address returned by 'std::malloc' right before the aligned memory block.
+class DefaultMemoryResource : public MemoryResource
+{
+
+    public:
+
+        void* Allocate(std::size_t size, std::size_t alignment) override
+        {
+            if (alignment <= alignof(std::max_align_t))
+                return ::operator new(size);
+
+            if (size > static_cast<std::size_t>(-1) - alignment)
+                throw std::bad_alloc();
+
+            auto base = std::malloc(size + alignment);
+            if (!base)
+                throw std::bad_alloc();
+
+            auto addr = (reinterpret_cast<std::uintptr_t>(base) + alignment) & ~static_cast<std::uintptr_t>(alignment - 1);
+            auto ptr = reinterpret_cast<void**>(addr);
+
+            ptr[-1] = base;
+
+            return ptr;
+        }
+
+        void Deallocate(void* ptr, std::size_t /*size*/, std::size_t alignment) override
+        {
+            if (alignment <= alignof(std::max_align_t))
+                ::operator delete(ptr);
+            else if (ptr)
+                std::free(reinterpret_cast<void**>(ptr)[-1]);
+        }
+
+};
+
+// Returns the specified address rounded up to the specified alignment.
+static char* AlignUp(char* ptr, std::size_t alignment)
+{
+    auto addr = reinterpret_cast<std::uintptr_t>(ptr);
+    return reinterpret_cast<char*>((addr + alignment - 1) & ~static_cast<std::uintptr_t>(alignment - 1));
+}
+
+// Size of the block header, rounded up to the fundamental alignment.
+static const std::size_t blockHeaderSize = ((sizeof(void*) + sizeof(std::size_t) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t)) * alignof(std::max_align_t);
+
+
+/* ----- Global functions ----- */
+
+MemoryResource* GetDefaultMemoryResource()
+{
+    static DefaultMemoryResource resource;
+    return &resource;
+}
+
+
+/* ----- MonotonicArena class ----- */
+
+MonotonicArena::MonotonicArena(std::size_t initialBlockSize, MemoryResource* upstream) :
+    upstream_       { upstream != nullptr ? upstream : GetDefaultMemoryResource() },
+    nextBlockSize_  { std::max(initialBlockSize, blockHeaderSize * 2)              }
+{
+}
+
+MonotonicArena::~MonotonicArena()
+{
+    Release();
+}
+
+void* MonotonicArena::Allocate(std::size_t size, std::size_t alignment)
+{
+    auto ptr = AlignUp(cursor_, alignment);
+
+    if (cursor_ == nullptr || ptr > end_ || static_cast<std::size_t>(end_ - ptr) < size)
+    {
+        /* Allocate new block with enough space for the alignment padding */
+        if (size > static_cast<std::size_t>(-1) - alignment - blockHeaderSize)
+            throw std::bad_alloc();
+
+        AllocateBlock(size + alignment + blockHeaderSize);
+        ptr = AlignUp(cursor_, alignment);
+    }
+
+    allocatedSize_ += static_cast<std::size_t>(ptr - cursor_) + size;
+    cursor_ = ptr + size;
+
+    return ptr;
+}
+
+void MonotonicArena::Deallocate(void* /*ptr*/, std::size_t /*size*/, std::size_t /*alignment*/)
+{
+    /* Memory is only released by "Reset" or "Release" */
+}
+
+void MonotonicArena::Reset()
+{
+    if (blocks_ == nullptr)
+        return;
+
+    if (blocks_->next != nullptr)
+    {
+        /* Replace all blocks by a single block of their total size, so the next cycle of allocations fits into one block */
+        auto totalSize = capacity_;
+        Release();
+        AllocateBlock(totalSize);
+    }
+    else
+        SetCurrentBlock(blocks_);
+
+    allocatedSize_ = 0;
+}
+
+void MonotonicArena::Release()
+{
+    for (auto block = blocks_; block != nullptr;)
+    {
+        auto next = block->next;
+        upstream_->Deallocate(block, block->size, alignof(std::max_align_t));
+        block = next;
+    }
+
+    blocks_         = nullptr;
+    cursor_         = nullptr;
+    end_            = nullptr;
+    allocatedSize_  = 0;
+    capacity_       = 0;
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void MonotonicArena::AllocateBlock(std::size_t minSize)
+{
+    /* Grow block sizes geometrically, so the number of blocks is logarithmic in the total size */
+    auto size = std::max(nextBlockSize_, minSize);
+
+    auto block = static_cast<Block*>(upstream_->Allocate(size, alignof(std::max_align_t)));
+    block->next = blocks_;
+    block->size = size;
+
+    blocks_ = block;
+    capacity_ += size;
+    nextBlockSize_ = size * 2;
+
+    SetCurrentBlock(block);
+}
+
+void MonotonicArena::SetCurrentBlock(Block* block)
+{
+    blocks_ = block;
+    cursor_ = reinterpret_cast<char*>(block) + blockHeaderSize;
+    end_    = reinterpret_cast<char*>(block) + block->size;
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
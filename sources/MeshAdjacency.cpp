@@ -0,0 +1,233 @@
+/*
+ * MeshAdjacency.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshAdjacency.h>
+#include <algorithm>
+
+
+namespace Gm
+{
+
+
+const MeshAdjacency::EdgeIndex MeshAdjacency::invalidEdge;
+
+MeshAdjacency::MeshAdjacency(const TriangleMesh& mesh)
+{
+    Build(mesh);
+}
+
+// Converts the specified counters into offsets (exclusive prefix sum), where the last entry will be the total sum.
+template <typename T>
+static void CountersToOffsets(std::vector<T>& counters)
+{
+    T sum = 0;
+    for (auto& n : counters)
+    {
+        auto count = n;
+        n = sum;
+        sum += count;
+    }
+}
+
+void MeshAdjacency::Build(const TriangleMesh& mesh)
+{
+    Build(mesh.triangles, mesh.vertices.size());
+}
+
+void MeshAdjacency::Build(const TriangleArray& triangles, std::size_t numVertices)
+{
+    numVertices_    = numVertices;
+    numTriangles_   = triangles.size();
+
+    /* Count triangles per vertex (degenerated triangles are only counted once per vertex) */
+    vertexTriangleOffsets_.assign(numVertices_ + 1, 0);
+
+    for (const auto& tri : triangles)
+    {
+        GS_ASSERT(tri.a < numVertices_ && tri.b < numVertices_ && tri.c < numVertices_);
+        ++vertexTriangleOffsets_[tri.a];
+        if (tri.b != tri.a)
+            ++vertexTriangleOffsets_[tri.b];
+        if (tri.c != tri.a && tri.c != tri.b)
+            ++vertexTriangleOffsets_[tri.c];
+    }
+
+    CountersToOffsets(vertexTriangleOffsets_);
+
+    /* Fill vertex-to-triangle table (triangles are visited in ascending order, so each row is sorted) */
+    vertexTriangles_.resize(vertexTriangleOffsets_.back());
+
+    std::vector<TriangleIndex> cursor(vertexTriangleOffsets_.begin(), vertexTriangleOffsets_.end() - 1);
+
+    for (TriangleIndex i = 0; i < numTriangles_; ++i)
+    {
+        const auto& tri = triangles[i];
+        vertexTriangles_[cursor[tri.a]++] = i;
+        if (tri.b != tri.a)
+            vertexTriangles_[cursor[tri.b]++] = i;
+        if (tri.c != tri.a && tri.c != tri.b)
+            vertexTriangles_[cursor[tri.c]++] = i;
+    }
+
+    /* Enumerate unique edges (a, b) with a < b, grouped by 'a', by visiting the triangle fan of each vertex */
+    vertexEdgeOffsets_.resize(numVertices_ + 1);
+    edges_.clear();
+    edges_.reserve(numTriangles_ * 3 / 2 + 1);
+
+    std::vector<VertexIndex> fan;
+
+    for (VertexIndex v = 0; v < numVertices_; ++v)
+    {
+        vertexEdgeOffsets_[v] = edges_.size();
+
+        fan.clear();
+        for (auto j = vertexTriangleOffsets_[v]; j < vertexTriangleOffsets_[v + 1]; ++j)
+        {
+            const auto& tri = triangles[vertexTriangles_[j]];
+            for (std::size_t k = 0; k < 3; ++k)
+            {
+                if (tri[k] == v)
+                {
+                    /* Add both edge partners of this corner, if they are greater than the vertex */
+                    auto next = tri[(k + 1) % 3];
+                    auto prev = tri[(k + 2) % 3];
+                    if (next > v)
+                        fan.push_back(next);
+                    if (prev > v)
+                        fan.push_back(prev);
+                }
+            }
+        }
+
+        std::sort(fan.begin(), fan.end());
+        fan.erase(std::unique(fan.begin(), fan.end()), fan.end());
+
+        for (auto w : fan)
+            edges_.push_back({ v, w });
+    }
+
+    vertexEdgeOffsets_[numVertices_] = edges_.size();
+
+    /* Assign edges to triangles and count triangles per edge */
+    triangleEdges_.resize(numTriangles_ * 3);
+    edgeTriangleOffsets_.assign(edges_.size() + 1, 0);
+
+    auto IsFirstUse = [this](TriangleIndex triangleIndex, std::size_t k)
+    {
+        /* Degenerated triangles may use the same edge twice, but each triangle is only listed once per edge */
+        auto edgeIndex = triangleEdges_[triangleIndex*3 + k];
+        for (std::size_t l = 0; l < k; ++l)
+        {
+            if (triangleEdges_[triangleIndex*3 + l] == edgeIndex)
+                return false;
+        }
+        return (edgeIndex != invalidEdge);
+    };
+
+    for (TriangleIndex i = 0; i < numTriangles_; ++i)
+    {
+        const auto& tri = triangles[i];
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            auto v0 = tri[k];
+            auto v1 = tri[(k + 1) % 3];
+            triangleEdges_[i*3 + k] = (v0 != v1 ? FindEdge(v0, v1) : invalidEdge);
+            if (IsFirstUse(i, k))
+                ++edgeTriangleOffsets_[triangleEdges_[i*3 + k]];
+        }
+    }
+
+    CountersToOffsets(edgeTriangleOffsets_);
+
+    /* Fill edge-to-triangle table (again in ascending triangle order) */
+    edgeTriangles_.resize(edgeTriangleOffsets_.back());
+
+    cursor.assign(edgeTriangleOffsets_.begin(), edgeTriangleOffsets_.end() - 1);
+
+    for (TriangleIndex i = 0; i < numTriangles_; ++i)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            if (IsFirstUse(i, k))
+                edgeTriangles_[cursor[triangleEdges_[i*3 + k]]++] = i;
+        }
+    }
+}
+
+void MeshAdjacency::Clear()
+{
+    numVertices_    = 0;
+    numTriangles_   = 0;
+
+    vertexTriangleOffsets_.clear();
+    vertexTriangles_.clear();
+    vertexEdgeOffsets_.clear();
+    edges_.clear();
+    edgeTriangleOffsets_.clear();
+    edgeTriangles_.clear();
+    triangleEdges_.clear();
+}
+
+MeshAdjacency::Range<MeshAdjacency::TriangleIndex> MeshAdjacency::VertexTriangles(VertexIndex vertexIndex) const
+{
+    if (vertexIndex >= numVertices_)
+        return { nullptr, nullptr };
+
+    auto first = vertexTriangles_.data();
+    return { first + vertexTriangleOffsets_[vertexIndex], first + vertexTriangleOffsets_[vertexIndex + 1] };
+}
+
+MeshAdjacency::Range<MeshAdjacency::TriangleIndex> MeshAdjacency::EdgeTriangles(EdgeIndex edgeIndex) const
+{
+    GS_ASSERT(edgeIndex < edges_.size());
+    auto first = edgeTriangles_.data();
+    return { first + edgeTriangleOffsets_[edgeIndex], first + edgeTriangleOffsets_[edgeIndex + 1] };
+}
+
+MeshAdjacency::Range<MeshAdjacency::Edge> MeshAdjacency::VertexEdges(VertexIndex vertexIndex) const
+{
+    if (vertexIndex >= numVertices_)
+        return { nullptr, nullptr };
+
+    auto first = edges_.data();
+    return { first + vertexEdgeOffsets_[vertexIndex], first + vertexEdgeOffsets_[vertexIndex + 1] };
+}
+
+MeshAdjacency::Range<MeshAdjacency::EdgeIndex> MeshAdjacency::TriangleEdges(TriangleIndex triangleIndex) const
+{
+    GS_ASSERT(triangleIndex < numTriangles_);
+    auto first = triangleEdges_.data() + triangleIndex*3;
+    return { first, first + 3 };
+}
+
+MeshAdjacency::EdgeIndex MeshAdjacency::FindEdge(VertexIndex v0, VertexIndex v1) const
+{
+    if (v0 > v1)
+        std::swap(v0, v1);
+
+    auto edges = VertexEdges(v0);
+
+    auto it = std::lower_bound(
+        edges.begin(), edges.end(), v1,
+        [](const Edge& edge, VertexIndex v)
+        {
+            return (edge.b < v);
+        }
+    );
+
+    if (it != edges.end() && it->b == v1)
+        return static_cast<EdgeIndex>(it - edges_.data());
+
+    return invalidEdge;
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
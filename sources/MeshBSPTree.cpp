@@ -0,0 +1,755 @@
+/*
+ * MeshBSPTree.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshBSPTree.h>
+#include <Geom/PlaneCollision.h>
+#include <Geom/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of polygons of a node to build its two subtrees in parallel.
+static const std::size_t buildGrainSize = 2048;
+
+// Minimal number of nodes per chunk for the parallel clipping and inversion.
+static const std::size_t clipGrainSize = 16;
+
+using Vertex        = TriangleMesh::Vertex;
+using VertexIndex   = TriangleMesh::VertexIndex;
+
+// Convex polygon of a BSP tree. Polygons which are split keep the plane of their original triangle.
+struct BSPPolygon
+{
+    std::vector<Vertex> vertices;
+    Plane               plane;
+};
+
+// Relation of a polygon (or vertex) to a splitting plane. A spanning polygon has vertices on both sides.
+enum BSPRelation
+{
+    BSPCoplanar = 0,
+    BSPFront    = 1,
+    BSPBack     = 2,
+    BSPSpanning = (BSPFront | BSPBack),
+};
+
+static int ClassifyDistance(Gs::Real distance, Gs::Real epsilon)
+{
+    if (distance > epsilon)
+        return BSPFront;
+    if (distance < -epsilon)
+        return BSPBack;
+    return BSPCoplanar;
+}
+
+static int ClassifyPolygon(const BSPPolygon& poly, const Plane& plane, Gs::Real epsilon)
+{
+    int relation = BSPCoplanar;
+
+    for (const auto& v : poly.vertices)
+    {
+        relation |= ClassifyDistance(SgnDistanceToPlane(plane, v.position), epsilon);
+        if (relation == BSPSpanning)
+            break;
+    }
+
+    return relation;
+}
+
+static bool IsFacingSameDirection(const BSPPolygon& poly, const Plane& plane)
+{
+    return (Gs::Dot(poly.plane.normal, plane.normal) > Gs::Real(0));
+}
+
+static bool IsLexicographicallyLess(const Gs::Vector3& lhs, const Gs::Vector3& rhs)
+{
+    if (lhs.x != rhs.x)
+        return (lhs.x < rhs.x);
+    if (lhs.y != rhs.y)
+        return (lhs.y < rhs.y);
+    return (lhs.z < rhs.z);
+}
+
+// Returns the vertex where the plane crosses the edge (a, b). The interpolation always starts at the lexicographically smaller end point,
+// so the polygons on both sides of an edge get exactly the same vertex.
+static Vertex SplitEdge(const Vertex& a, Gs::Real distA, const Vertex& b, Gs::Real distB)
+{
+    if (IsLexicographicallyLess(b.position, a.position))
+        return SplitEdge(b, distB, a, distA);
+
+    const auto t = distA / (distA - distB);
+
+    Vertex v;
+    {
+        v.position  = a.position + (b.position - a.position) * t;
+        v.normal    = a.normal + (b.normal - a.normal) * t;
+        v.texCoord  = a.texCoord + (b.texCoord - a.texCoord) * t;
+
+        const auto lenSq = v.normal.LengthSq();
+        if (lenSq > Gs::Real(0))
+            v.normal *= Gs::Real(1) / std::sqrt(lenSq);
+    }
+    return v;
+}
+
+// Splits the spanning polygon into its parts in front of and behind the plane. Vertices onto the plane are added to both parts.
+static void SplitPolygon(const BSPPolygon& poly, const Plane& plane, Gs::Real epsilon, BSPPolygon& front, BSPPolygon& back)
+{
+    const auto count = poly.vertices.size();
+
+    front.plane = poly.plane;
+    back.plane  = poly.plane;
+
+    front.vertices.reserve(count + 1);
+    back.vertices.reserve(count + 1);
+
+    auto distI = SgnDistanceToPlane(plane, poly.vertices[0].position);
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto& vi = poly.vertices[i];
+        const auto& vj = poly.vertices[(i + 1) % count];
+
+        const auto distJ = SgnDistanceToPlane(plane, vj.position);
+        const auto relI = ClassifyDistance(distI, epsilon);
+        const auto relJ = ClassifyDistance(distJ, epsilon);
+
+        if (relI != BSPBack)
+            front.vertices.push_back(vi);
+        if (relI != BSPFront)
+            back.vertices.push_back(vi);
+
+        if ((relI | relJ) == BSPSpanning)
+        {
+            const auto v = SplitEdge(vi, distI, vj, distJ);
+            front.vertices.push_back(v);
+            back.vertices.push_back(v);
+        }
+
+        distI = distJ;
+    }
+}
+
+static void FlipPolygon(BSPPolygon& poly)
+{
+    std::reverse(poly.vertices.begin(), poly.vertices.end());
+
+    for (auto& v : poly.vertices)
+        v.normal = -v.normal;
+
+    poly.plane.Flip();
+}
+
+static AABB3 PolygonBoundingBox(const BSPPolygon& poly)
+{
+    AABB3 box;
+
+    for (const auto& v : poly.vertices)
+        box.Insert(v.position);
+
+    return box;
+}
+
+// Estimates the cost of the splitting plane with a sample of the polygons. Returns false if an axis-aligned plane does not separate the polygons.
+static bool EstimateSplitterCost(
+    const std::vector<BSPPolygon>&  polygons,
+    std::size_t                     numSamples,
+    const Plane&                    plane,
+    bool                            isPolygonPlane,
+    const BSPTreeDescriptor&        desc,
+    Gs::Real&                       cost)
+{
+    const auto n = polygons.size();
+
+    std::size_t numFront = 0, numBack = 0, numSpanning = 0;
+
+    for (std::size_t i = 0; i < numSamples; ++i)
+    {
+        const auto& poly = polygons[i * n / numSamples];
+
+        switch (ClassifyPolygon(poly, plane, desc.epsilon))
+        {
+            case BSPCoplanar:
+                /* Polygons onto a polygon plane are stored in the node, otherwise they are sorted by their direction */
+                if (!isPolygonPlane)
+                {
+                    if (IsFacingSameDirection(poly, plane))
+                        ++numFront;
+                    else
+                        ++numBack;
+                }
+                break;
+            case BSPFront:
+                ++numFront;
+                break;
+            case BSPBack:
+                ++numBack;
+                break;
+            default:
+                ++numSpanning;
+                break;
+        }
+    }
+
+    /* An axis-aligned plane must reduce the polygons on both sides, otherwise the recursion would not terminate */
+    if (!isPolygonPlane && (numFront == 0 || numBack == 0))
+        return false;
+
+    const auto sizeFront    = static_cast<Gs::Real>(numFront + numSpanning);
+    const auto sizeBack     = static_cast<Gs::Real>(numBack + numSpanning);
+
+    cost = (sizeFront*sizeFront + sizeBack*sizeBack) / static_cast<Gs::Real>(numSamples) + desc.splitCost * static_cast<Gs::Real>(numSpanning);
+
+    return true;
+}
+
+/*
+Selects the splitting plane with the lowest cost among the planes of evenly distributed polygons and the axis-aligned planes through the center of the polygons.
+The cost approximates the number of polygons a query visits, i.e. the polygon count of each side weighted by the probability to enter that side (which is proportional to its polygon count).
+Returns true if the plane is the plane of a polygon, or false if it is an axis-aligned plane.
+*/
+static bool SelectSplitter(const std::vector<BSPPolygon>& polygons, const BSPTreeDescriptor& desc, Plane& splitter)
+{
+    const auto n                = polygons.size();
+    const auto numSamples       = std::max<std::size_t>(1, std::min(n, desc.numSamples));
+    const auto numCandidates    = std::max<std::size_t>(1, std::min(n, desc.numCandidates));
+
+    bool        isPolygonPlane  = true;
+    Gs::Real    minCost         = std::numeric_limits<Gs::Real>::max();
+    Gs::Real    cost            = 0;
+
+    splitter = polygons.front().plane;
+
+    /* Evaluate the planes of evenly distributed polygons */
+    for (std::size_t i = 0; i < numCandidates; ++i)
+    {
+        const auto& plane = polygons[i * n / numCandidates].plane;
+        if (EstimateSplitterCost(polygons, numSamples, plane, true, desc, cost) && cost < minCost)
+        {
+            minCost     = cost;
+            splitter    = plane;
+        }
+    }
+
+    /* Evaluate the axis-aligned planes through the center of the sampled polygons */
+    AABB3 centerBox;
+
+    for (std::size_t i = 0; i < numSamples; ++i)
+    {
+        const auto& poly = polygons[i * n / numSamples];
+
+        Gs::Vector3 center;
+        for (const auto& v : poly.vertices)
+            center += v.position;
+
+        centerBox.Insert(center / static_cast<Gs::Real>(poly.vertices.size()));
+    }
+
+    const auto center = centerBox.Center();
+
+    auto EvaluateAxisPlane = [&](int axis, Gs::Real offset)
+    {
+        Gs::Vector3 normal, memberPoint;
+        normal[axis]        = Gs::Real(1);
+        memberPoint[axis]   = offset;
+
+        Plane plane;
+        plane.Build(normal, memberPoint);
+
+        if (EstimateSplitterCost(polygons, numSamples, plane, false, desc, cost) && cost < minCost)
+        {
+            minCost         = cost;
+            splitter        = plane;
+            isPolygonPlane  = false;
+        }
+    };
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (centerBox.max[axis] - centerBox.min[axis] <= desc.epsilon)
+            continue;
+
+        EvaluateAxisPlane(axis, center[axis]);
+
+        /* Also evaluate the plane through the nearest vertex, which splits far fewer polygons of grid-like meshes (e.g. the rings of a sphere) */
+        auto nearest = center[axis];
+        auto minDist = std::numeric_limits<Gs::Real>::max();
+
+        for (std::size_t i = 0; i < numSamples; ++i)
+        {
+            for (const auto& v : polygons[i * n / numSamples].vertices)
+            {
+                const auto dist = std::abs(v.position[axis] - center[axis]);
+                if (dist < minDist)
+                {
+                    minDist = dist;
+                    nearest = v.position[axis];
+                }
+            }
+        }
+
+        if (minDist > desc.epsilon)
+            EvaluateAxisPlane(axis, nearest);
+    }
+
+    return isPolygonPlane;
+}
+
+template <typename T>
+static void AppendMoved(std::vector<T>& dst, std::vector<T>& src)
+{
+    if (dst.empty())
+        dst = std::move(src);
+    else
+        dst.insert(dst.end(), std::make_move_iterator(src.begin()), std::make_move_iterator(src.end()));
+}
+
+
+/* ----- MeshBSPTree::Node structure ----- */
+
+struct MeshBSPTree::Node
+{
+    // Builds this node and its subtrees. The input polygons are moved into the tree.
+    void Build(std::vector<BSPPolygon>& input, const BSPTreeDescriptor& desc)
+    {
+        const bool isPolygonPlane = SelectSplitter(input, desc, plane);
+
+        /* Partition the polygons by the splitting plane */
+        std::vector<BSPPolygon> frontPolys, backPolys;
+
+        for (auto& poly : input)
+        {
+            switch (ClassifyPolygon(poly, plane, desc.epsilon))
+            {
+                case BSPCoplanar:
+                    if (isPolygonPlane)
+                        polygons.push_back(std::move(poly));
+                    else if (IsFacingSameDirection(poly, plane))
+                        frontPolys.push_back(std::move(poly));
+                    else
+                        backPolys.push_back(std::move(poly));
+                    break;
+
+                case BSPFront:
+                    frontPolys.push_back(std::move(poly));
+                    break;
+
+                case BSPBack:
+                    backPolys.push_back(std::move(poly));
+                    break;
+
+                default:
+                {
+                    BSPPolygon frontPart, backPart;
+                    SplitPolygon(poly, plane, desc.epsilon, frontPart, backPart);
+                    frontPolys.push_back(std::move(frontPart));
+                    backPolys.push_back(std::move(backPart));
+                }
+                break;
+            }
+        }
+
+        std::vector<BSPPolygon>().swap(input);
+
+        /* Build both subtrees (in parallel for large nodes, which is nested into the parallel builds of the parent nodes) */
+        auto BuildChild = [&desc](std::unique_ptr<Node>& child, std::vector<BSPPolygon>& childPolys)
+        {
+            if (!childPolys.empty())
+            {
+                child = std::unique_ptr<Node>(new Node());
+                child->Build(childPolys, desc);
+            }
+        };
+
+        if (frontPolys.size() + backPolys.size() >= buildGrainSize)
+        {
+            GetSharedThreadPool().ParallelFor(
+                2, 1,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        if (i == 0)
+                            BuildChild(front, frontPolys);
+                        else
+                            BuildChild(back, backPolys);
+                    }
+                }
+            );
+        }
+        else
+        {
+            BuildChild(front, frontPolys);
+            BuildChild(back, backPolys);
+        }
+    }
+
+    // Appends all parts of the specified polygon which are outside of the solid of this subtree to the output list.
+    void ClipPolygon(BSPPolygon& poly, std::vector<BSPPolygon>& output, Gs::Real epsilon) const
+    {
+        /* Follow the polygon down the tree until it is split, so only spanning polygons allocate new memory */
+        for (auto node = this;;)
+        {
+            const auto relation = ClassifyPolygon(poly, node->plane, epsilon);
+
+            if (relation == BSPSpanning)
+            {
+                BSPPolygon frontPart, backPart;
+                SplitPolygon(poly, node->plane, epsilon, frontPart, backPart);
+
+                if (node->front)
+                    node->front->ClipPolygon(frontPart, output, epsilon);
+                else
+                    output.push_back(std::move(frontPart));
+
+                if (node->back)
+                    node->back->ClipPolygon(backPart, output, epsilon);
+
+                return;
+            }
+
+            const bool isFront = (relation == BSPFront || (relation == BSPCoplanar && IsFacingSameDirection(poly, node->plane)));
+
+            /* A missing front child is outside (keep the polygon), and a missing back child is inside (remove the polygon) */
+            if (isFront)
+            {
+                if (!node->front)
+                {
+                    output.push_back(std::move(poly));
+                    return;
+                }
+                node = node->front.get();
+            }
+            else
+            {
+                if (!node->back)
+                    return;
+                node = node->back.get();
+            }
+        }
+    }
+
+    // Returns the depth of this subtree.
+    std::size_t Depth() const
+    {
+        return 1 + std::max(front ? front->Depth() : 0, back ? back->Depth() : 0);
+    }
+
+    // Appends the specified node and all nodes of its subtree in breadth-first order.
+    template <typename NodePtr>
+    static void CollectNodes(NodePtr root, std::vector<NodePtr>& nodes)
+    {
+        nodes.push_back(root);
+
+        for (auto i = nodes.size() - 1; i < nodes.size(); ++i)
+        {
+            auto node = nodes[i];
+            if (node->front)
+                nodes.push_back(node->front.get());
+            if (node->back)
+                nodes.push_back(node->back.get());
+        }
+    }
+
+    Plane                   plane;
+    std::vector<BSPPolygon> polygons;   // Polygons onto the splitting plane (empty for axis-aligned planes)
+    std::unique_ptr<Node>   front;      // Subtree in front of the plane, or null if that space is outside of the solid
+    std::unique_ptr<Node>   back;       // Subtree behind the plane, or null if that space is inside of the solid
+};
+
+// Hash functor for vertices. Negative zero is mapped to positive zero, so vertices which compare equal have the same hash.
+struct BSPVertexHash
+{
+    std::size_t operator () (const Vertex& v) const
+    {
+        const Gs::Real components[8] =
+        {
+            v.position.x, v.position.y, v.position.z,
+            v.normal.x, v.normal.y, v.normal.z,
+            v.texCoord.x, v.texCoord.y,
+        };
+
+        std::size_t seed = 0;
+        for (auto c : components)
+            seed ^= std::hash<Gs::Real>()(c + Gs::Real(0)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+        return seed;
+    }
+};
+
+struct BSPVertexEqual
+{
+    bool operator () (const Vertex& lhs, const Vertex& rhs) const
+    {
+        return
+        (
+            lhs.position.x == rhs.position.x && lhs.position.y == rhs.position.y && lhs.position.z == rhs.position.z &&
+            lhs.normal.x   == rhs.normal.x   && lhs.normal.y   == rhs.normal.y   && lhs.normal.z   == rhs.normal.z   &&
+            lhs.texCoord.x == rhs.texCoord.x && lhs.texCoord.y == rhs.texCoord.y
+        );
+    }
+};
+
+
+/* ----- MeshBSPTree class ----- */
+
+MeshBSPTree::MeshBSPTree()
+{
+}
+
+MeshBSPTree::MeshBSPTree(const TriangleMesh& mesh, const BSPTreeDescriptor& desc)
+{
+    Build(mesh, desc);
+}
+
+MeshBSPTree::MeshBSPTree(MeshBSPTree&& rhs) = default;
+
+MeshBSPTree& MeshBSPTree::operator = (MeshBSPTree&& rhs) = default;
+
+MeshBSPTree::~MeshBSPTree()
+{
+}
+
+void MeshBSPTree::Build(const TriangleMesh& mesh, const BSPTreeDescriptor& desc)
+{
+    Clear();
+
+    desc_ = desc;
+
+    /* Convert all non-degenerated triangles into polygons */
+    std::vector<BSPPolygon> polygons;
+    polygons.reserve(mesh.triangles.size());
+
+    for (const auto& tri : mesh.triangles)
+    {
+        const auto& a = mesh.vertices[tri.a];
+        const auto& b = mesh.vertices[tri.b];
+        const auto& c = mesh.vertices[tri.c];
+
+        if (Gs::Cross(b.position - a.position, c.position - a.position).LengthSq() <= Gs::Real(0))
+            continue;
+
+        BSPPolygon poly;
+        {
+            poly.vertices   = { a, b, c };
+            poly.plane      = Plane(a.position, b.position, c.position);
+        }
+        polygons.push_back(std::move(poly));
+
+        boundingBox_.Insert(a.position);
+        boundingBox_.Insert(b.position);
+        boundingBox_.Insert(c.position);
+    }
+
+    /* Build the tree recursively */
+    if (!polygons.empty())
+    {
+        root_ = std::unique_ptr<Node>(new Node());
+        root_->Build(polygons, desc_);
+    }
+}
+
+void MeshBSPTree::Clear()
+{
+    root_.reset();
+    boundingBox_.Reset();
+    inverted_ = false;
+}
+
+void MeshBSPTree::Invert()
+{
+    inverted_ = !inverted_;
+
+    if (!root_)
+        return;
+
+    /* Each node is inverted independently, so all nodes can be processed in parallel */
+    std::vector<Node*> nodes;
+    Node::CollectNodes(root_.get(), nodes);
+
+    GetSharedThreadPool().ParallelFor(
+        nodes.size(), clipGrainSize,
+        [&nodes](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto node = nodes[i];
+
+                for (auto& poly : node->polygons)
+                    FlipPolygon(poly);
+
+                node->plane.Flip();
+                std::swap(node->front, node->back);
+            }
+        }
+    );
+}
+
+void MeshBSPTree::ClipTo(const MeshBSPTree& other)
+{
+    if (!root_)
+        return;
+
+    std::vector<Node*> nodes;
+    Node::CollectNodes(root_.get(), nodes);
+
+    /* Everything outside the bounding box of the other tree is outside of its solid (or inside if it has been inverted) */
+    const auto epsilon = other.desc_.epsilon;
+
+    AABB3 otherBox = other.boundingBox_;
+    {
+        otherBox.min -= Gs::Vector3(epsilon);
+        otherBox.max += Gs::Vector3(epsilon);
+    }
+
+    const bool keepOutside = !other.inverted_;
+
+    GetSharedThreadPool().ParallelFor(
+        nodes.size(), clipGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            std::vector<BSPPolygon> outside, overlapping;
+
+            for (auto i = begin; i < end; ++i)
+            {
+                auto node = nodes[i];
+
+                /* Only traverse the other tree with the polygons which overlap its bounding box */
+                for (auto& poly : node->polygons)
+                {
+                    if (other.root_ && Overlap(PolygonBoundingBox(poly), otherBox))
+                        overlapping.push_back(std::move(poly));
+                    else
+                        outside.push_back(std::move(poly));
+                }
+
+                node->polygons.clear();
+
+                if (keepOutside)
+                    AppendMoved(node->polygons, outside);
+
+                for (auto& poly : overlapping)
+                    other.root_->ClipPolygon(poly, node->polygons, epsilon);
+
+                outside.clear();
+                overlapping.clear();
+            }
+        }
+    );
+}
+
+bool MeshBSPTree::IsInside(const Gs::Vector3& point) const
+{
+    for (auto node = root_.get(); node != nullptr;)
+    {
+        if (SgnDistanceToPlane(node->plane, point) >= -desc_.epsilon)
+        {
+            if (!node->front)
+                return false;
+            node = node->front.get();
+        }
+        else
+        {
+            if (!node->back)
+                return true;
+            node = node->back.get();
+        }
+    }
+    return inverted_;
+}
+
+void MeshBSPTree::GetMesh(TriangleMesh& mesh) const
+{
+    mesh.Clear();
+
+    if (!root_)
+        return;
+
+    std::vector<const Node*> nodes;
+    Node::CollectNodes<const Node*>(root_.get(), nodes);
+
+    /* Share all vertices with equal attributes, and triangulate each convex polygon as a fan */
+    std::unordered_map<Vertex, VertexIndex, BSPVertexHash, BSPVertexEqual> vertexIndices;
+    std::vector<VertexIndex> indices;
+
+    for (auto node : nodes)
+    {
+        for (const auto& poly : node->polygons)
+        {
+            indices.clear();
+
+            for (const auto& v : poly.vertices)
+            {
+                auto it = vertexIndices.find(v);
+                if (it == vertexIndices.end())
+                {
+                    auto index = mesh.AddVertex(v.position, v.normal, v.texCoord);
+                    vertexIndices.insert({ v, index });
+                    indices.push_back(index);
+                }
+                else
+                    indices.push_back(it->second);
+            }
+
+            for (std::size_t i = 1; i + 1 < indices.size(); ++i)
+            {
+                if (indices[0] != indices[i] && indices[i] != indices[i + 1] && indices[i + 1] != indices[0])
+                    mesh.AddTriangle(indices[0], indices[i], indices[i + 1]);
+            }
+        }
+    }
+}
+
+std::size_t MeshBSPTree::NumNodes() const
+{
+    if (!root_)
+        return 0;
+
+    std::vector<const Node*> nodes;
+    Node::CollectNodes<const Node*>(root_.get(), nodes);
+
+    return nodes.size();
+}
+
+std::size_t MeshBSPTree::NumPolygons() const
+{
+    if (!root_)
+        return 0;
+
+    std::vector<const Node*> nodes;
+    Node::CollectNodes<const Node*>(root_.get(), nodes);
+
+    std::size_t count = 0;
+    for (auto node : nodes)
+        count += node->polygons.size();
+
+    return count;
+}
+
+std::size_t MeshBSPTree::Depth() const
+{
+    return (root_ ? root_->Depth() : 0);
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,687 @@
+/*
+ * MeshFile.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshFile.h>
+#include <Geom/ThreadPool.h>
+#include "MeshFileFormat.h"
+#include "Except.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <cstring>
+
+#ifdef _WIN32
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+
+namespace Gm
+{
+
+
+using namespace Details;
+
+/* ----- Internal functions ----- */
+
+// Size of the blocks whose hashes are combined to the checksum, so the blocks can be hashed in parallel.
+static const std::size_t checksumBlockSize = (1u << 20);
+
+// Minimal number of triangles per chunk for the parallel index verification.
+static const std::size_t verifyIndicesGrainSize = 16384;
+
+static std::uint64_t RotateLeft(std::uint64_t x, int r)
+{
+    return ((x << r) | (x >> (64 - r)));
+}
+
+static std::uint64_t Read64(const unsigned char* p)
+{
+    std::uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+static std::uint32_t Read32(const unsigned char* p)
+{
+    std::uint32_t x;
+    std::memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// 64-bit hash of the specified bytes (XXH64 by Yann Collet).
+static std::uint64_t Hash64(const unsigned char* data, std::size_t size, std::uint64_t seed)
+{
+    static const std::uint64_t p1 = 11400714785074694791ull;
+    static const std::uint64_t p2 = 14029467366897019727ull;
+    static const std::uint64_t p3 =  1609587929392839161ull;
+    static const std::uint64_t p4 =  9650029242287828579ull;
+    static const std::uint64_t p5 =  2870177450012600261ull;
+
+    auto Round = [](std::uint64_t acc, std::uint64_t input)
+    {
+        return RotateLeft(acc + input * p2, 31) * p1;
+    };
+
+    auto MergeRound = [&Round](std::uint64_t acc, std::uint64_t val)
+    {
+        return (acc ^ Round(0, val)) * p1 + p4;
+    };
+
+    const auto end = data + size;
+    std::uint64_t h;
+
+    if (size >= 32)
+    {
+        /* Process 32-byte stripes in four lanes */
+        std::uint64_t v1 = seed + p1 + p2;
+        std::uint64_t v2 = seed + p2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - p1;
+
+        for (; data + 32 <= end; data += 32)
+        {
+            v1 = Round(v1, Read64(data     ));
+            v2 = Round(v2, Read64(data +  8));
+            v3 = Round(v3, Read64(data + 16));
+            v4 = Round(v4, Read64(data + 24));
+        }
+
+        h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        h = MergeRound(h, v1);
+        h = MergeRound(h, v2);
+        h = MergeRound(h, v3);
+        h = MergeRound(h, v4);
+    }
+    else
+        h = seed + p5;
+
+    h += static_cast<std::uint64_t>(size);
+
+    /* Process remaining bytes */
+    for (; data + 8 <= end; data += 8)
+        h = RotateLeft(h ^ Round(0, Read64(data)), 27) * p1 + p4;
+
+    if (data + 4 <= end)
+    {
+        h = RotateLeft(h ^ (static_cast<std::uint64_t>(Read32(data)) * p1), 23) * p2 + p3;
+        data += 4;
+    }
+
+    for (; data < end; ++data)
+        h = RotateLeft(h ^ (static_cast<std::uint64_t>(*data) * p5), 11) * p1;
+
+    /* Final avalanche */
+    h ^= (h >> 33);
+    h *= p2;
+    h ^= (h >> 29);
+    h *= p3;
+    h ^= (h >> 32);
+
+    return h;
+}
+
+// Combines the hashes of all blocks into the final checksum.
+static std::uint64_t CombineBlockHashes(const std::vector<std::uint64_t>& blockHashes, std::size_t size)
+{
+    return Hash64(
+        reinterpret_cast<const unsigned char*>(blockHashes.data()),
+        blockHashes.size() * sizeof(std::uint64_t),
+        static_cast<std::uint64_t>(size)
+    );
+}
+
+// Computes the checksum of the specified bytes, whose blocks are hashed in parallel.
+static std::uint64_t ComputeChecksum(const unsigned char* data, std::size_t size)
+{
+    std::vector<std::uint64_t> blockHashes((size + checksumBlockSize - 1) / checksumBlockSize);
+
+    GetSharedThreadPool().ParallelFor(
+        blockHashes.size(), 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto offset = i * checksumBlockSize;
+                blockHashes[i] = Hash64(data + offset, std::min(checksumBlockSize, size - offset), 0);
+            }
+        }
+    );
+
+    return CombineBlockHashes(blockHashes, size);
+}
+
+// Output file stream that computes the checksum of all bytes that are written after the header, in the same blocks as "ComputeChecksum".
+class MeshFileWriter
+{
+
+    public:
+
+        MeshFileWriter(const std::string& filename) :
+            stream_ { filename, std::ios::out | std::ios::binary | std::ios::trunc }
+        {
+            if (!stream_.good())
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to open mesh file for writing"));
+            block_.reserve(checksumBlockSize);
+        }
+
+        // Writes the specified bytes and feeds them into the checksum.
+        void Write(const void* data, std::size_t size)
+        {
+            stream_.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+
+            auto bytes = reinterpret_cast<const unsigned char*>(data);
+
+            while (size > 0)
+            {
+                auto n = std::min(size, checksumBlockSize - block_.size());
+                block_.insert(block_.end(), bytes, bytes + n);
+                bytes += n;
+                size -= n;
+                totalSize_ += n;
+
+                if (block_.size() == checksumBlockSize)
+                {
+                    blockHashes_.push_back(Hash64(block_.data(), block_.size(), 0));
+                    block_.clear();
+                }
+            }
+        }
+
+        // Writes zeros until the total size is a multiple of the specified alignment.
+        void Pad(std::uint64_t alignment)
+        {
+            static const unsigned char zeros[meshFileSectionAlignment] = {};
+            auto position = sizeof(MeshFileHeader) + totalSize_;
+            Write(zeros, static_cast<std::size_t>((alignment - position % alignment) % alignment));
+        }
+
+        // Writes the header at the beginning of the file with the final checksum and file size.
+        void Finish(MeshFileHeader& header)
+        {
+            if (!block_.empty())
+                blockHashes_.push_back(Hash64(block_.data(), block_.size(), 0));
+
+            header.fileSize = sizeof(MeshFileHeader) + totalSize_;
+            header.checksum = CombineBlockHashes(blockHashes_, totalSize_);
+
+            stream_.seekp(0);
+            stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            stream_.flush();
+
+            if (!stream_.good())
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to write mesh file"));
+        }
+
+        // Reserves the space for the header, which is written by "Finish".
+        void SkipHeader()
+        {
+            const MeshFileHeader header = {};
+            stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+
+    private:
+
+        std::ofstream               stream_;
+        std::vector<unsigned char>  block_;
+        std::vector<std::uint64_t>  blockHashes_;
+        std::size_t                 totalSize_  = 0;
+
+};
+
+// Section data to be written.
+struct MeshFileSectionSource
+{
+    MeshFileSectionType type;
+    std::size_t         elementSize;
+    const void*         data;
+    std::size_t         count;
+};
+
+static std::uint64_t AlignOffset(std::uint64_t offset)
+{
+    return ((offset + meshFileSectionAlignment - 1) / meshFileSectionAlignment) * meshFileSectionAlignment;
+}
+
+
+/* ----- TriangleMeshView structure ----- */
+
+TriangleMesh TriangleMeshView::ToMesh() const
+{
+    TriangleMesh mesh;
+    mesh.vertices.assign(vertices, vertices + numVertices);
+    mesh.triangles.assign(triangles, triangles + numTriangles);
+    return mesh;
+}
+
+
+/* ----- Global functions ----- */
+
+void WriteMeshFile(const std::string& filename, const TriangleMesh& mesh, const Skeleton* skeleton)
+{
+    /* Collect all sections */
+    std::vector<MeshFileSectionSource> sources;
+
+    sources.push_back({ MeshFileSectionType::Vertices, sizeof(TriangleMesh::Vertex), mesh.vertices.data(), mesh.vertices.size() });
+    sources.push_back({ MeshFileSectionType::Triangles, sizeof(TriangleMesh::Triangle), mesh.triangles.data(), mesh.triangles.size() });
+
+    MeshFileSkeleton flatSkeleton;
+
+    if (skeleton)
+    {
+        FlattenSkeleton(*skeleton, flatSkeleton);
+        sources.push_back({ MeshFileSectionType::SkeletonJoints, sizeof(MeshFileJoint), flatSkeleton.joints.data(), flatSkeleton.joints.size() });
+        sources.push_back({ MeshFileSectionType::VertexWeights, sizeof(SkeletonJoint::VertexWeight), flatSkeleton.weights.data(), flatSkeleton.weights.size() });
+        sources.push_back({ MeshFileSectionType::JointKeys, sizeof(MeshFileJointKey), flatSkeleton.keys.data(), flatSkeleton.keys.size() });
+    }
+
+    /* Determine section layout */
+    std::vector<MeshFileSection> sections(sources.size());
+    std::uint64_t offset = sizeof(MeshFileHeader) + sizeof(MeshFileSection) * sections.size();
+
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        offset = AlignOffset(offset);
+
+        auto& section       = sections[i];
+        section.type        = static_cast<std::uint32_t>(sources[i].type);
+        section.elementSize = static_cast<std::uint32_t>(sources[i].elementSize);
+        section.offset      = offset;
+        section.count       = sources[i].count;
+        section.reserved    = 0;
+
+        offset += section.elementSize * section.count;
+    }
+
+    /* Write section table and all sections */
+    MeshFileWriter writer(filename);
+
+    writer.SkipHeader();
+    writer.Write(sections.data(), sizeof(MeshFileSection) * sections.size());
+
+    for (const auto& source : sources)
+    {
+        writer.Pad(meshFileSectionAlignment);
+        writer.Write(source.data, source.elementSize * source.count);
+    }
+
+    /* Write header with the final checksum */
+    MeshFileHeader header = {};
+
+    std::copy(std::begin(meshFileMagic), std::end(meshFileMagic), header.magic);
+    header.version          = meshFileVersion;
+    header.byteOrderMark    = meshFileByteOrderMark;
+    header.realSize         = static_cast<std::uint16_t>(sizeof(Gs::Real));
+    header.indexSize        = static_cast<std::uint16_t>(sizeof(TriangleMesh::VertexIndex));
+    header.vertexStride     = static_cast<std::uint32_t>(sizeof(TriangleMesh::Vertex));
+    header.numSections      = static_cast<std::uint32_t>(sections.size());
+
+    writer.Finish(header);
+}
+
+void ReadMeshFile(const std::string& filename, TriangleMesh& mesh, Skeleton* skeleton, bool verifyChecksum)
+{
+    MappedMeshFile file(filename, verifyChecksum, true);
+
+    const auto& view = file.GetMesh();
+
+    mesh.Clear();
+    mesh.vertices.assign(view.vertices, view.vertices + view.numVertices);
+    mesh.triangles.assign(view.triangles, view.triangles + view.numTriangles);
+
+    if (skeleton)
+        file.ReadSkeleton(*skeleton);
+}
+
+
+/* ----- MappedMeshFile class ----- */
+
+// Read-only memory mapping of an entire file.
+class MappedMeshFile::FileMapping
+{
+
+    public:
+
+        FileMapping(const std::string& filename)
+        {
+            #ifdef _WIN32
+
+            file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to open mesh file"));
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0)
+            {
+                CloseHandle(file_);
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to determine size of mesh file"));
+            }
+
+            mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping_)
+            {
+                CloseHandle(file_);
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to map mesh file"));
+            }
+
+            data_ = reinterpret_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+            if (!data_)
+            {
+                CloseHandle(mapping_);
+                CloseHandle(file_);
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to map mesh file"));
+            }
+
+            size_ = static_cast<std::size_t>(fileSize.QuadPart);
+
+            #else
+
+            auto fd = open(filename.c_str(), O_RDONLY);
+            if (fd == -1)
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to open mesh file"));
+
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+            {
+                close(fd);
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to determine size of mesh file"));
+            }
+
+            size_ = static_cast<std::size_t>(fileStat.st_size);
+
+            /* The mapping remains valid after the file descriptor has been closed */
+            auto addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+
+            if (addr == MAP_FAILED)
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to map mesh file"));
+
+            data_ = reinterpret_cast<const unsigned char*>(addr);
+
+            #endif
+        }
+
+        ~FileMapping()
+        {
+            #ifdef _WIN32
+            UnmapViewOfFile(data_);
+            CloseHandle(mapping_);
+            CloseHandle(file_);
+            #else
+            munmap(const_cast<unsigned char*>(data_), size_);
+            #endif
+        }
+
+        inline const unsigned char* Data() const
+        {
+            return data_;
+        }
+
+        inline std::size_t Size() const
+        {
+            return size_;
+        }
+
+    private:
+
+        const unsigned char*    data_       = nullptr;
+        std::size_t             size_       = 0;
+
+        #ifdef _WIN32
+        HANDLE                  file_       = INVALID_HANDLE_VALUE;
+        HANDLE                  mapping_    = nullptr;
+        #endif
+
+};
+
+MappedMeshFile::MappedMeshFile()
+{
+}
+
+MappedMeshFile::MappedMeshFile(const std::string& filename, bool verifyChecksum, bool verifyIndices)
+{
+    Open(filename, verifyChecksum, verifyIndices);
+}
+
+MappedMeshFile::MappedMeshFile(MappedMeshFile&& rhs)
+{
+    *this = std::move(rhs);
+}
+
+MappedMeshFile& MappedMeshFile::operator = (MappedMeshFile&& rhs)
+{
+    if (this != &rhs)
+    {
+        mapping_    = std::move(rhs.mapping_);
+        meshView_   = rhs.meshView_;
+        joints_     = rhs.joints_;
+        numJoints_  = rhs.numJoints_;
+        weights_    = rhs.weights_;
+        numWeights_ = rhs.numWeights_;
+        keys_       = rhs.keys_;
+        numKeys_    = rhs.numKeys_;
+        rhs.Close();
+    }
+    return *this;
+}
+
+MappedMeshFile::~MappedMeshFile()
+{
+}
+
+void MappedMeshFile::Open(const std::string& filename, bool verifyChecksum, bool verifyIndices)
+{
+    Close();
+
+    mapping_ = std::unique_ptr<FileMapping>(new FileMapping(filename));
+
+    try
+    {
+        ReadSections();
+
+        if (verifyChecksum && !VerifyChecksum())
+            throw std::runtime_error(GM_EXCEPT_INFO("checksum verification of mesh file failed"));
+        if (verifyIndices && !VerifyIndices())
+            throw std::runtime_error(GM_EXCEPT_INFO("vertex index out of range in mesh file"));
+    }
+    catch (...)
+    {
+        Close();
+        throw;
+    }
+}
+
+void MappedMeshFile::Close()
+{
+    mapping_.reset();
+    meshView_   = TriangleMeshView();
+    joints_     = nullptr;
+    numJoints_  = 0;
+    weights_    = nullptr;
+    numWeights_ = 0;
+    keys_       = nullptr;
+    numKeys_    = 0;
+}
+
+bool MappedMeshFile::IsOpen() const
+{
+    return (mapping_ != nullptr);
+}
+
+bool MappedMeshFile::VerifyChecksum() const
+{
+    if (!mapping_)
+        return false;
+
+    auto data = mapping_->Data();
+    auto size = mapping_->Size();
+
+    const auto& header = *reinterpret_cast<const MeshFileHeader*>(data);
+
+    return (ComputeChecksum(data + sizeof(MeshFileHeader), size - sizeof(MeshFileHeader)) == header.checksum);
+}
+
+bool MappedMeshFile::VerifyIndices() const
+{
+    const auto triangles    = meshView_.triangles;
+    const auto numVerts     = meshView_.numVertices;
+
+    std::atomic<bool> valid { true };
+
+    GetSharedThreadPool().ParallelFor(
+        meshView_.numTriangles, verifyIndicesGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = triangles[i];
+                if (tri.a >= numVerts || tri.b >= numVerts || tri.c >= numVerts)
+                {
+                    valid = false;
+                    return;
+                }
+            }
+        }
+    );
+
+    return valid;
+}
+
+bool MappedMeshFile::HasSkeleton() const
+{
+    return (joints_ != nullptr);
+}
+
+void MappedMeshFile::ReadSkeleton(Skeleton& skeleton, const MakeSkeletonJointFunction& makeSkeletonJoint) const
+{
+    if (!HasSkeleton())
+        return;
+
+    auto joints     = reinterpret_cast<const MeshFileJoint*>(joints_);
+    auto weights    = reinterpret_cast<const SkeletonJoint::VertexWeight*>(weights_);
+    auto keys       = reinterpret_cast<const MeshFileJointKey*>(keys_);
+
+    /* Validate joint hierarchy and ranges before any joint is created */
+    for (std::size_t i = 0; i < numJoints_; ++i)
+    {
+        const auto& joint = joints[i];
+
+        if (joint.parent != ~std::uint64_t(0) && joint.parent >= i)
+            throw std::runtime_error(GM_EXCEPT_INFO("invalid parent index in skeleton of mesh file"));
+        if (joint.firstWeight > numWeights_ || joint.numWeights > numWeights_ - joint.firstWeight)
+            throw std::runtime_error(GM_EXCEPT_INFO("invalid vertex weight range in skeleton of mesh file"));
+        if (joint.firstKey > numKeys_ || joint.numKeys > numKeys_ - joint.firstKey)
+            throw std::runtime_error(GM_EXCEPT_INFO("invalid keyframe range in skeleton of mesh file"));
+    }
+
+    RebuildSkeleton(joints, numJoints_, weights, keys, skeleton, makeSkeletonJoint);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void MappedMeshFile::ReadSections()
+{
+    auto data = mapping_->Data();
+    auto size = mapping_->Size();
+
+    /* Validate header */
+    if (size < sizeof(MeshFileHeader))
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file is too small"));
+
+    const auto& header = *reinterpret_cast<const MeshFileHeader*>(data);
+
+    if (!std::equal(std::begin(meshFileMagic), std::end(meshFileMagic), header.magic))
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid magic number in mesh file"));
+    if (header.version != meshFileVersion)
+        throw std::runtime_error(GM_EXCEPT_INFO("unsupported mesh file version"));
+    if (header.byteOrderMark != meshFileByteOrderMark)
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file has been written with another byte order"));
+    if (header.realSize != sizeof(Gs::Real))
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file has been written with another floating-point precision"));
+    if (header.indexSize != sizeof(TriangleMesh::VertexIndex))
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file has been written with another mesh index type"));
+    if (header.vertexStride != sizeof(TriangleMesh::Vertex))
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file has been written with another vertex layout"));
+    if (header.fileSize != size)
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file is truncated"));
+    if (header.numSections > (size - sizeof(MeshFileHeader)) / sizeof(MeshFileSection))
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid number of sections in mesh file"));
+
+    /* Validate sections (unknown sections are ignored) */
+    auto sections = reinterpret_cast<const MeshFileSection*>(data + sizeof(MeshFileHeader));
+
+    auto GetSection = [&](const MeshFileSection& section, std::size_t elementSize, std::size_t& count) -> const void*
+    {
+        if (section.elementSize != elementSize)
+            throw std::runtime_error(GM_EXCEPT_INFO("invalid element size of section in mesh file"));
+        if (section.offset % meshFileSectionAlignment != 0 || section.offset > size || section.count > (size - section.offset) / elementSize)
+            throw std::runtime_error(GM_EXCEPT_INFO("invalid section range in mesh file"));
+        count = static_cast<std::size_t>(section.count);
+        return (data + section.offset);
+    };
+
+    for (std::uint32_t i = 0; i < header.numSections; ++i)
+    {
+        const auto& section = sections[i];
+
+        switch (static_cast<MeshFileSectionType>(section.type))
+        {
+            case MeshFileSectionType::Vertices:
+                meshView_.vertices = reinterpret_cast<const TriangleMesh::Vertex*>(
+                    GetSection(section, sizeof(TriangleMesh::Vertex), meshView_.numVertices)
+                );
+                break;
+
+            case MeshFileSectionType::Triangles:
+                meshView_.triangles = reinterpret_cast<const TriangleMesh::Triangle*>(
+                    GetSection(section, sizeof(TriangleMesh::Triangle), meshView_.numTriangles)
+                );
+                break;
+
+            case MeshFileSectionType::SkeletonJoints:
+                joints_ = GetSection(section, sizeof(MeshFileJoint), numJoints_);
+                break;
+
+            case MeshFileSectionType::VertexWeights:
+                weights_ = GetSection(section, sizeof(SkeletonJoint::VertexWeight), numWeights_);
+                break;
+
+            case MeshFileSectionType::JointKeys:
+                keys_ = GetSection(section, sizeof(MeshFileJointKey), numKeys_);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (meshView_.numTriangles > 0 && meshView_.numVertices == 0)
+        throw std::runtime_error(GM_EXCEPT_INFO("mesh file has triangles but no vertices"));
+    if (joints_ != nullptr && (weights_ == nullptr || keys_ == nullptr))
+        throw std::runtime_error(GM_EXCEPT_INFO("incomplete skeleton in mesh file"));
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,129 @@
+/*
+ * MeshFileFormat.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_FILE_FORMAT_H
+#define GM_MESH_FILE_FORMAT_H
+
+
+#include <Geom/TriangleMesh.h>
+#include <Geom/Skeleton.h>
+
+#include <cstdint>
+#include <vector>
+
+
+namespace Gm
+{
+
+namespace Details
+{
+
+
+/*
+Binary mesh file layout (all offsets in bytes from the beginning of the file):
+- MeshFileHeader
+- MeshFileSection[numSections]
+- Section data, each aligned to 'meshFileSectionAlignment' and padded with zeros.
+The checksum covers all bytes after the header. All numbers are stored in the native byte order,
+which is validated by 'byteOrderMark', and all vertex and index data is stored in the native layout of "TriangleMesh".
+*/
+
+static const char           meshFileMagic[4]            = { 'G', 'M', 'S', 'H' };
+static const std::uint32_t  meshFileVersion             = 1;
+static const std::uint32_t  meshFileByteOrderMark       = 0x01020304;
+static const std::uint64_t  meshFileSectionAlignment    = 64;
+
+enum class MeshFileSectionType : std::uint32_t
+{
+    Vertices        = 1, // TriangleMesh::Vertex[]
+    Triangles       = 2, // TriangleMesh::Triangle[]
+    SkeletonJoints  = 3, // MeshFileJoint[]
+    VertexWeights   = 4, // SkeletonJoint::VertexWeight[]
+    JointKeys       = 5, // MeshFileJointKey[]
+};
+
+struct MeshFileHeader
+{
+    char            magic[4];
+    std::uint32_t   version;
+    std::uint32_t   byteOrderMark;
+    std::uint16_t   realSize;       // sizeof(Gs::Real)
+    std::uint16_t   indexSize;      // sizeof(TriangleMesh::VertexIndex)
+    std::uint32_t   vertexStride;   // sizeof(TriangleMesh::Vertex)
+    std::uint32_t   numSections;
+    std::uint64_t   fileSize;
+    std::uint64_t   checksum;
+    std::uint8_t    reserved[24];
+};
+
+static_assert(sizeof(MeshFileHeader) == 64, "unexpected size of mesh file header");
+
+struct MeshFileSection
+{
+    std::uint32_t   type;           // MeshFileSectionType
+    std::uint32_t   elementSize;
+    std::uint64_t   offset;
+    std::uint64_t   count;
+    std::uint64_t   reserved;
+};
+
+static_assert(sizeof(MeshFileSection) == 32, "unexpected size of mesh file section");
+
+// Skeleton joint record, whose sub-joints follow in depth-first order (i.e. the order of "Skeleton::JointList").
+struct MeshFileJoint
+{
+    std::uint64_t   parent;         // Index of the parent joint, or ~0 for root joints
+    std::uint64_t   firstWeight;
+    std::uint64_t   numWeights;
+    std::uint64_t   firstKey;
+    std::uint64_t   numKeys;
+    std::uint64_t   frameBegin;
+    Gs::Real        transform[12];
+    Gs::Real        poseTransform[12];
+    Gs::Real        jointSpaceTransform[12];
+};
+
+// Pre-computed key of a keyframe sequence.
+struct MeshFileJointKey
+{
+    Gs::Real        position[3];
+    Gs::Real        rotation[4];
+    Gs::Real        scale[3];
+};
+
+// Flattened skeleton, which is stored in three sections.
+struct MeshFileSkeleton
+{
+    std::vector<MeshFileJoint>                  joints;
+    std::vector<SkeletonJoint::VertexWeight>    weights;
+    std::vector<MeshFileJointKey>               keys;
+};
+
+// Flattens the specified skeleton.
+void FlattenSkeleton(const Skeleton& skeleton, MeshFileSkeleton& output);
+
+// Rebuilds the skeleton from the specified flattened joints. All indices must have been validated.
+void RebuildSkeleton(
+    const MeshFileJoint*                joints,
+    std::size_t                         numJoints,
+    const SkeletonJoint::VertexWeight*  weights,
+    const MeshFileJointKey*             keys,
+    Skeleton&                           skeleton,
+    const MakeSkeletonJointFunction&    makeSkeletonJoint
+);
+
+
+} // /namespace Details
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
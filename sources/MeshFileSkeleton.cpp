@@ -0,0 +1,158 @@
+/*
+ * MeshFileSkeleton.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "MeshFileFormat.h"
+
+#include <algorithm>
+#include <map>
+
+
+namespace Gm
+{
+
+namespace Details
+{
+
+
+/* ----- Internal functions ----- */
+
+static void StoreMatrix(Gs::Real (&dst)[12], const Gs::AffineMatrix4& matrix)
+{
+    for (std::size_t row = 0; row < 3; ++row)
+    {
+        for (std::size_t col = 0; col < 4; ++col)
+            dst[row*4 + col] = matrix(row, col);
+    }
+}
+
+static void LoadMatrix(Gs::AffineMatrix4& matrix, const Gs::Real (&src)[12])
+{
+    for (std::size_t row = 0; row < 3; ++row)
+    {
+        for (std::size_t col = 0; col < 4; ++col)
+            matrix(row, col) = src[row*4 + col];
+    }
+}
+
+
+/* ----- Functions ----- */
+
+void FlattenSkeleton(const Skeleton& skeleton, MeshFileSkeleton& output)
+{
+    /* Joints are listed in depth-first order, so each parent precedes its sub-joints */
+    auto jointList = skeleton.JointList();
+
+    std::map<const SkeletonJoint*, std::uint64_t> jointIndices;
+
+    output.joints.resize(jointList.size());
+    output.weights.clear();
+    output.keys.clear();
+
+    for (std::size_t i = 0; i < jointList.size(); ++i)
+    {
+        const auto& joint = *jointList[i];
+        auto& record = output.joints[i];
+
+        jointIndices[&joint] = i;
+
+        auto parentIt = jointIndices.find(joint.GetParent());
+        record.parent = (parentIt != jointIndices.end() ? parentIt->second : ~std::uint64_t(0));
+
+        StoreMatrix(record.transform, joint.transform);
+        StoreMatrix(record.poseTransform, joint.poseTransform);
+        StoreMatrix(record.jointSpaceTransform, joint.jointSpaceTransform);
+
+        /* Store vertex weights */
+        record.firstWeight  = output.weights.size();
+        record.numWeights   = joint.vertexWeights.size();
+        output.weights.insert(output.weights.end(), joint.vertexWeights.begin(), joint.vertexWeights.end());
+
+        /* Store pre-computed keys (all key lists have the same size) */
+        const auto& keyframes = joint.keyframes;
+        const auto& positionKeys = keyframes.GetPositionKeys();
+        const auto& rotationKeys = keyframes.GetRotationKeys();
+        const auto& scaleKeys = keyframes.GetScaleKeys();
+
+        record.firstKey     = output.keys.size();
+        record.numKeys      = std::min(positionKeys.size(), std::min(rotationKeys.size(), scaleKeys.size()));
+        record.frameBegin   = (record.numKeys > 0 ? keyframes.GetFrameBegin() : 0);
+
+        for (std::size_t j = 0; j < record.numKeys; ++j)
+        {
+            MeshFileJointKey key;
+
+            key.position[0] = positionKeys[j].x;
+            key.position[1] = positionKeys[j].y;
+            key.position[2] = positionKeys[j].z;
+
+            key.rotation[0] = rotationKeys[j].x;
+            key.rotation[1] = rotationKeys[j].y;
+            key.rotation[2] = rotationKeys[j].z;
+            key.rotation[3] = rotationKeys[j].w;
+
+            key.scale[0]    = scaleKeys[j].x;
+            key.scale[1]    = scaleKeys[j].y;
+            key.scale[2]    = scaleKeys[j].z;
+
+            output.keys.push_back(key);
+        }
+    }
+}
+
+void RebuildSkeleton(
+    const MeshFileJoint*                joints,
+    std::size_t                         numJoints,
+    const SkeletonJoint::VertexWeight*  weights,
+    const MeshFileJointKey*             keys,
+    Skeleton&                           skeleton,
+    const MakeSkeletonJointFunction&    makeSkeletonJoint)
+{
+    std::vector<SkeletonJoint*> jointList(numJoints, nullptr);
+
+    for (std::size_t i = 0; i < numJoints; ++i)
+    {
+        const auto& record = joints[i];
+
+        /* Create joint and add it to its parent, which has already been created */
+        auto jointPtr = (makeSkeletonJoint ? makeSkeletonJoint() : SkeletonJointPtr(new SkeletonJoint()));
+
+        auto& joint = (record.parent == ~std::uint64_t(0)
+            ? skeleton.AddRootJoint(std::move(jointPtr))
+            : jointList[record.parent]->AddSubJoint(std::move(jointPtr)));
+
+        jointList[i] = &joint;
+
+        LoadMatrix(joint.transform, record.transform);
+        LoadMatrix(joint.poseTransform, record.poseTransform);
+        LoadMatrix(joint.jointSpaceTransform, record.jointSpaceTransform);
+
+        joint.vertexWeights.assign(weights + record.firstWeight, weights + record.firstWeight + record.numWeights);
+
+        /* Restore pre-computed keys */
+        std::vector<Gs::Vector3> positionKeys(record.numKeys), scaleKeys(record.numKeys);
+        std::vector<Gs::Quaternion> rotationKeys(record.numKeys);
+
+        for (std::size_t j = 0; j < record.numKeys; ++j)
+        {
+            const auto& key = keys[record.firstKey + j];
+            positionKeys[j] = Gs::Vector3(key.position[0], key.position[1], key.position[2]);
+            rotationKeys[j] = Gs::Quaternion(key.rotation[0], key.rotation[1], key.rotation[2], key.rotation[3]);
+            scaleKeys[j]    = Gs::Vector3(key.scale[0], key.scale[1], key.scale[2]);
+        }
+
+        joint.keyframes.SetKeys(std::move(positionKeys), std::move(rotationKeys), std::move(scaleKeys), record.frameBegin);
+    }
+}
+
+
+} // /namespace Details
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GenerateBezierPatch(const BezierPatchDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxOffset    = mesh.vertices.size();
+    const auto idxOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsHorz     = std::max(1u, desc.segments.x);
     const auto segsVert     = std::max(1u, desc.segments.y);
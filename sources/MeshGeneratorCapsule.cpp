@@ -18,7 +18,7 @@ namespace MeshGenerator
 
 void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -70,11 +70,11 @@ void GenerateCapsule(const CapsuleDescriptor& desc, TriangleMesh& mesh)
 
     /* Generate bottom and top cover vertices */
     const Gs::Real coverSide[2] = { 1, -1 };
-    std::size_t idxBaseOffsetEllipsoid[2] = { 0 };
+    VertexIndex idxBaseOffsetEllipsoid[2] = { 0 };
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        idxBaseOffsetEllipsoid[i] = mesh.vertices.size();
+        idxBaseOffsetEllipsoid[i] = static_cast<VertexIndex>(mesh.vertices.size());
 
         for (std::uint32_t v = 0; v <= segsV; ++v)
         {
@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GenerateCone(const ConeDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -28,7 +28,7 @@ static void BuildFace(
 {
     sizeOffsetZ /= 2;
 
-    const auto idxOffset    = mesh.vertices.size();
+    const auto idxOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto invHorz      = Gs::Real(1) / static_cast<Gs::Real>(segsHorz);
     const auto invVert      = Gs::Real(1) / static_cast<Gs::Real>(segsVert);
@@ -20,7 +20,7 @@ namespace MeshGenerator
 
 void GenerateCurve(const CurveDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsU            = std::max(3u, desc.segments.x);
     const auto segsV            = std::max(3u, desc.segments.y);
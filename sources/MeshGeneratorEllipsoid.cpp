@@ -18,7 +18,7 @@ namespace MeshGenerator
 
 void GenerateEllipsoid(const EllipsoidDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsU            = std::max(3u, desc.segments.x);
     const auto segsV            = std::max(2u, desc.segments.y);
@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -79,7 +79,7 @@ void GeneratePie(const PieDescriptor& desc, TriangleMesh& mesh)
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        mantleIndexOffset[i] = mesh.vertices.size();
+        mantleIndexOffset[i] = static_cast<VertexIndex>(mesh.vertices.size());
 
         /* Compute normal vector */
         const auto angleNormal = mantleSideAngles[i] + mantleSideNormalOffset[i];
@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsHorz         = std::max(3u, desc.mantleSegments.x);
     const auto segsVert         = std::max(1u, desc.mantleSegments.y);
@@ -42,7 +42,7 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
 
     for (std::size_t i = 0; i < 2; ++i)
     {
-        mantleIndexOffset[i] = mesh.vertices.size();
+        mantleIndexOffset[i] = static_cast<VertexIndex>(mesh.vertices.size());
         angle = Gs::Real(0);
 
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
@@ -92,7 +92,7 @@ void GeneratePipe(const PipeDescriptor& desc, TriangleMesh& mesh)
 
         coord.y = halfHeight * coverSide[i];
         coordAlt.y = halfHeight * coverSide[i];
-        coverIndexOffset[i] = mesh.vertices.size();
+        coverIndexOffset[i] = static_cast<VertexIndex>(mesh.vertices.size());
 
         for (std::uint32_t u = 0; u <= segsHorz; ++u)
         {
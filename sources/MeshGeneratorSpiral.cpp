@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GenerateSpiral(const SpiralDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto turns            = std::max(Gs::Real(0), desc.turns);
 
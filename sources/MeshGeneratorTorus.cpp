@@ -17,7 +17,7 @@ namespace MeshGenerator
 
 void GenerateTorus(const TorusDescriptor& desc, TriangleMesh& mesh)
 {
-    const auto idxBaseOffset    = mesh.vertices.size();
+    const auto idxBaseOffset    = static_cast<VertexIndex>(mesh.vertices.size());
 
     const auto segsU            = std::max(3u, desc.segments.x);
     const auto segsV            = std::max(3u, desc.segments.y);
@@ -0,0 +1,548 @@
+/*
+ * MeshIODetails.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "MeshIODetails.h"
+#include "Except.h"
+#include <Geom/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+
+namespace Gm
+{
+
+namespace MeshIO
+{
+
+
+/* ----- Internal functions ----- */
+
+// Powers of ten which are exactly representable in double precision.
+static const double exactPowersOfTen[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const int maxExactPowerOfTen = 22;
+
+static bool IsDigit(char c)
+{
+    return (c >= '0' && c <= '9');
+}
+
+static double ScaleByPowerOfTen(double x, int exponent)
+{
+    while (exponent > maxExactPowerOfTen)
+    {
+        x *= exactPowersOfTen[maxExactPowerOfTen];
+        exponent -= maxExactPowerOfTen;
+    }
+    while (exponent < -maxExactPowerOfTen)
+    {
+        x /= exactPowersOfTen[maxExactPowerOfTen];
+        exponent += maxExactPowerOfTen;
+    }
+    return (exponent < 0 ? x / exactPowersOfTen[-exponent] : x * exactPowersOfTen[exponent]);
+}
+
+// Parses infinity or NaN with the standard library, since their spelling (unlike the decimal point) does not depend on the locale.
+static const char* ParseSpecialReal(const char* s, const char* end, Gs::Real& value)
+{
+    auto tokenEnd = s;
+    while (tokenEnd != end && !IsBlank(*tokenEnd) && *tokenEnd != '\n' && *tokenEnd != '/')
+        ++tokenEnd;
+
+    const std::string token(s, tokenEnd);
+    char* tokenParsed = nullptr;
+
+    auto result = std::strtod(token.c_str(), &tokenParsed);
+
+    if (tokenParsed == token.c_str())
+        return nullptr;
+
+    value = static_cast<Gs::Real>(result);
+
+    return s + (tokenParsed - token.c_str());
+}
+
+/*
+Parses the number in [s, end), which has already been validated by "ParseReal", with the standard library for correct rounding
+(e.g. more than 19 digits or a large exponent). The number is rewritten without a decimal point (e.g. "-1.25e3" as "-125e1"),
+so 'strtod' reads it the same way in every locale.
+*/
+static void ParseLongReal(const char* s, const char* end, Gs::Real& value)
+{
+    std::string token;
+    token.reserve(static_cast<std::size_t>(end - s) + 16);
+
+    long exponent = 0;
+    bool fraction = false;
+
+    for (; s != end; ++s)
+    {
+        if (IsDigit(*s))
+        {
+            token.push_back(*s);
+            if (fraction)
+                --exponent;
+        }
+        else if (*s == '.')
+            fraction = true;
+        else if (*s == 'e' || *s == 'E')
+        {
+            /* Clamp the exponent, which is far beyond the range of double precision anyway */
+            auto e = std::strtol(std::string(s + 1, end).c_str(), nullptr, 10);
+            exponent += std::max(-100000L, std::min(e, 100000L));
+            break;
+        }
+        else
+            token.push_back(*s);
+    }
+
+    token.push_back('e');
+    token += std::to_string(exponent);
+
+    value = static_cast<Gs::Real>(std::strtod(token.c_str(), nullptr));
+}
+
+static char* CopyString(char* s, const char* str)
+{
+    while (*str)
+        *s++ = *str++;
+    return s;
+}
+
+// Writes the specified significant decimal digits with the decimal exponent of the first digit.
+static char* FormatDecimal(char* s, const char* digits, int numDigits, int exponent)
+{
+    if (exponent >= -5 && exponent < 9)
+    {
+        if (exponent >= 0)
+        {
+            /* Write fixed notation, e.g. "123.45" */
+            for (int i = 0; i <= exponent; ++i)
+                *s++ = (i < numDigits ? digits[i] : '0');
+
+            if (numDigits > exponent + 1)
+            {
+                *s++ = '.';
+                for (int i = exponent + 1; i < numDigits; ++i)
+                    *s++ = digits[i];
+            }
+        }
+        else
+        {
+            /* Write fixed notation with leading zeros, e.g. "0.00123" */
+            *s++ = '0';
+            *s++ = '.';
+            for (int i = 0; i < -exponent - 1; ++i)
+                *s++ = '0';
+            for (int i = 0; i < numDigits; ++i)
+                *s++ = digits[i];
+        }
+    }
+    else
+    {
+        /* Write scientific notation, e.g. "1.2345e-12" */
+        *s++ = digits[0];
+
+        if (numDigits > 1)
+        {
+            *s++ = '.';
+            for (int i = 1; i < numDigits; ++i)
+                *s++ = digits[i];
+        }
+
+        *s++ = 'e';
+
+        if (exponent < 0)
+        {
+            *s++ = '-';
+            exponent = -exponent;
+        }
+
+        s = FormatInteger(s, static_cast<std::uint64_t>(exponent));
+    }
+
+    return s;
+}
+
+
+/* ----- FileBlockReader class ----- */
+
+FileBlockReader::FileBlockReader(const std::string& filename) :
+    stream_ { filename, std::ios::in | std::ios::binary }
+{
+    if (!stream_.good())
+        throw std::runtime_error(GM_EXCEPT_INFO("failed to open file for reading"));
+
+    stream_.seekg(0, std::ios::end);
+    fileSize_ = static_cast<std::uint64_t>(stream_.tellg());
+    stream_.seekg(0, std::ios::beg);
+}
+
+bool FileBlockReader::ReadBlock(std::size_t blockSize)
+{
+    /* Move the unconsumed bytes to the front */
+    if (offset_ > 0)
+    {
+        buffer_.erase(buffer_.begin(), buffer_.begin() + offset_);
+        offset_ = 0;
+    }
+
+    if (!eof_)
+    {
+        /* Append next block */
+        const auto size = buffer_.size();
+        buffer_.resize(size + blockSize);
+
+        stream_.read(buffer_.data() + size, static_cast<std::streamsize>(blockSize));
+
+        const auto numBytesRead = static_cast<std::size_t>(stream_.gcount());
+        buffer_.resize(size + numBytesRead);
+
+        if (numBytesRead < blockSize)
+        {
+            if (stream_.bad())
+                throw std::runtime_error(GM_EXCEPT_INFO("failed to read from file"));
+            eof_ = true;
+        }
+    }
+
+    return !buffer_.empty();
+}
+
+void FileBlockReader::Consume(std::size_t size)
+{
+    size = std::min(size, Size());
+    offset_ += size;
+    bytesConsumed_ += size;
+}
+
+
+/* ----- Functions ----- */
+
+void WriteSegmentsInParallel(std::ostream& stream, std::size_t count, std::size_t segmentSize, const SegmentEncoder& encoder)
+{
+    auto& threadPool = GetSharedThreadPool();
+
+    segmentSize = std::max<std::size_t>(1, segmentSize);
+
+    /* Encode a limited batch of segments at a time, so the memory usage does not depend on the number of elements */
+    const auto numBatchSegments = std::max<std::size_t>(16, (threadPool.NumThreads() + 1) * 4);
+    std::vector<std::string> segments(numBatchSegments);
+
+    for (std::size_t first = 0; first < count; first += numBatchSegments * segmentSize)
+    {
+        const auto numSegments = std::min(numBatchSegments, (count - first + segmentSize - 1) / segmentSize);
+
+        threadPool.ParallelFor(
+            numSegments,
+            1,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                {
+                    const auto segmentBegin = first + i * segmentSize;
+                    segments[i].clear();
+                    encoder(segmentBegin, std::min(count, segmentBegin + segmentSize), segments[i]);
+                }
+            }
+        );
+
+        for (std::size_t i = 0; i < numSegments; ++i)
+            stream.write(segments[i].data(), static_cast<std::streamsize>(segments[i].size()));
+    }
+}
+
+std::vector<std::size_t> SplitAtLineBreaks(const char* data, std::size_t size, std::size_t segmentSize)
+{
+    std::vector<std::size_t> boundaries { 0 };
+
+    for (auto pos = segmentSize; pos < size;)
+    {
+        auto lineBreak = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+        if (!lineBreak)
+            break;
+
+        pos = static_cast<std::size_t>(lineBreak - data) + 1;
+        if (pos < size)
+            boundaries.push_back(pos);
+
+        pos += segmentSize;
+    }
+
+    boundaries.push_back(size);
+
+    return boundaries;
+}
+
+const char* ParseReal(const char* s, const char* end, Gs::Real& value)
+{
+    const auto begin = s;
+
+    /* Parse sign */
+    bool negative = false;
+
+    if (s != end && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    /* Parse up to 19 significant digits into the mantissa, which always fits into 64 bits */
+    std::uint64_t   mantissa    = 0;
+    int             numDigits   = 0;
+    int             exponent    = 0;
+    bool            anyDigits   = false;
+    bool            truncated   = false;
+
+    for (; s != end && IsDigit(*s); ++s)
+    {
+        anyDigits = true;
+        if (numDigits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<std::uint64_t>(*s - '0');
+            if (mantissa != 0)
+                ++numDigits;
+        }
+        else
+        {
+            ++exponent;
+            if (*s != '0')
+                truncated = true;
+        }
+    }
+
+    if (s != end && *s == '.')
+    {
+        for (++s; s != end && IsDigit(*s); ++s)
+        {
+            anyDigits = true;
+            if (numDigits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<std::uint64_t>(*s - '0');
+                if (mantissa != 0)
+                    ++numDigits;
+                --exponent;
+            }
+            else if (*s != '0')
+                truncated = true;
+        }
+    }
+
+    if (!anyDigits)
+    {
+        /* Let the standard library handle "inf" and "nan" */
+        if (s != end && (*s == 'i' || *s == 'I' || *s == 'n' || *s == 'N'))
+            return ParseSpecialReal(begin, end, value);
+        return nullptr;
+    }
+
+    /* Parse exponent (the character 'e' is not consumed if no digits follow) */
+    if (s != end && (*s == 'e' || *s == 'E'))
+    {
+        auto p = s + 1;
+        bool negativeExponent = false;
+
+        if (p != end && (*p == '-' || *p == '+'))
+        {
+            negativeExponent = (*p == '-');
+            ++p;
+        }
+
+        if (p != end && IsDigit(*p))
+        {
+            int exponentValue = 0;
+
+            for (; p != end && IsDigit(*p); ++p)
+            {
+                if (exponentValue < 100000)
+                    exponentValue = exponentValue * 10 + (*p - '0');
+            }
+
+            exponent += (negativeExponent ? -exponentValue : exponentValue);
+            s = p;
+        }
+    }
+
+    /*
+    Fast path: if the mantissa and the power of ten are both exactly representable in double precision,
+    a single multiplication or division is correctly rounded (see "How to Read Floating Point Numbers Accurately" by William D. Clinger)
+    */
+    double result = 0.0;
+
+    if (mantissa != 0)
+    {
+        if (truncated || mantissa > (std::uint64_t(1) << 53) || exponent < -maxExactPowerOfTen || exponent > maxExactPowerOfTen)
+        {
+            ParseLongReal(begin, s, value);
+            return s;
+        }
+
+        result = static_cast<double>(mantissa);
+        result = (exponent < 0 ? result / exactPowersOfTen[-exponent] : result * exactPowersOfTen[exponent]);
+    }
+
+    value = static_cast<Gs::Real>(negative ? -result : result);
+
+    return s;
+}
+
+const char* ParseInteger(const char* s, const char* end, std::int64_t& value)
+{
+    bool negative = false;
+
+    if (s != end && (*s == '-' || *s == '+'))
+    {
+        negative = (*s == '-');
+        ++s;
+    }
+
+    if (s == end || !IsDigit(*s))
+        return nullptr;
+
+    /* Saturate large values, so they are rejected as invalid indices rather than overflow */
+    std::int64_t result = 0;
+    const std::int64_t maxValue = (std::int64_t(1) << 62);
+
+    for (; s != end && IsDigit(*s); ++s)
+    {
+        const auto digit = static_cast<std::int64_t>(*s - '0');
+        if (result > (maxValue - digit) / 10)
+            result = maxValue;
+        else
+            result = result * 10 + digit;
+    }
+
+    value = (negative ? -result : result);
+
+    return s;
+}
+
+char* FormatReal(char* s, float value)
+{
+    if (std::isnan(value))
+        return CopyString(s, "nan");
+
+    if (std::signbit(value))
+    {
+        *s++ = '-';
+        value = -value;
+    }
+
+    if (std::isinf(value))
+        return CopyString(s, "inf");
+
+    if (value == 0.0f)
+    {
+        *s++ = '0';
+        return s;
+    }
+
+    /*
+    Round to 9 significant digits, which is enough to restore any single-precision number exactly.
+    The scaling in double precision is accurate enough that a misrounded last digit still restores the same number
+    */
+    const double x = value;
+
+    auto exponent = static_cast<int>(std::floor(std::log10(x)));
+    auto mantissa = static_cast<std::uint64_t>(std::llround(ScaleByPowerOfTen(x, 8 - exponent)));
+
+    if (mantissa >= 1000000000u)
+    {
+        ++exponent;
+        mantissa = static_cast<std::uint64_t>(std::llround(ScaleByPowerOfTen(x, 8 - exponent)));
+    }
+    else if (mantissa < 100000000u)
+    {
+        --exponent;
+        mantissa = static_cast<std::uint64_t>(std::llround(ScaleByPowerOfTen(x, 8 - exponent)));
+    }
+
+    /* Convert to digits and remove trailing zeros */
+    char digits[9];
+    for (int i = 8; i >= 0; --i)
+    {
+        digits[i] = static_cast<char>('0' + mantissa % 10);
+        mantissa /= 10;
+    }
+
+    int numDigits = 9;
+    while (numDigits > 1 && digits[numDigits - 1] == '0')
+        --numDigits;
+
+    return FormatDecimal(s, digits, numDigits, exponent);
+}
+
+char* FormatReal(char* s, double value)
+{
+    /* 17 significant digits are enough to restore any double-precision number exactly */
+    auto len = std::snprintf(s, maxRealLength, "%.17g", value);
+    auto end = s + std::max(0, std::min(len, static_cast<int>(maxRealLength) - 1));
+
+    /* Replace the decimal point of the current locale (which may have several characters, e.g. "," for "de_DE") by '.' */
+    auto p = s;
+    if (p != end && *p == '-')
+        ++p;
+
+    auto digits = p;
+    while (p != end && IsDigit(*p))
+        ++p;
+
+    if (p != digits && p != end && *p != 'e' && *p != 'E')
+    {
+        auto next = p;
+        while (next != end && !IsDigit(*next))
+            ++next;
+
+        *p++ = '.';
+        end = std::copy(next, end, p);
+    }
+
+    return end;
+}
+
+char* FormatInteger(char* s, std::uint64_t value)
+{
+    char digits[20];
+    int numDigits = 0;
+
+    do
+    {
+        digits[numDigits++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    while (value > 0);
+
+    while (numDigits > 0)
+        *s++ = digits[--numDigits];
+
+    return s;
+}
+
+bool IsLittleEndian()
+{
+    const std::uint16_t value = 1;
+    unsigned char firstByte = 0;
+    std::memcpy(&firstByte, &value, 1);
+    return (firstByte == 1);
+}
+
+
+} // /namespace MeshIO
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,163 @@
+/*
+ * MeshIODetails.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_MESH_IO_DETAILS_H
+#define GM_MESH_IO_DETAILS_H
+
+
+#include <Geom/MeshIO.h>
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <functional>
+#include <cstdint>
+#include <cstring>
+
+
+namespace Gm
+{
+
+namespace MeshIO
+{
+
+
+// Number of bytes that are read from a file at once.
+static const std::size_t ioBlockSize    = (64u << 20);
+
+// Minimal number of bytes of a block that are parsed by a single task.
+static const std::size_t ioSegmentSize  = (1u << 20);
+
+
+// Reads a file in large blocks. Bytes that have not been consumed are carried over into the next block.
+class FileBlockReader
+{
+
+    public:
+
+        explicit FileBlockReader(const std::string& filename);
+
+        /*
+        Appends up to 'blockSize' new bytes from the file to the bytes that have not been consumed yet.
+        Returns false if there are no bytes left at all.
+        */
+        bool ReadBlock(std::size_t blockSize = ioBlockSize);
+
+        // Marks the specified number of bytes at the front as consumed.
+        void Consume(std::size_t size);
+
+        // Returns a pointer to the first byte that has not been consumed yet.
+        inline const char* Data() const
+        {
+            return (buffer_.data() + offset_);
+        }
+
+        // Returns the number of bytes that have been read but not consumed yet.
+        inline std::size_t Size() const
+        {
+            return (buffer_.size() - offset_);
+        }
+
+        // Returns true if the end of the file has been reached, i.e. all bytes have been read.
+        inline bool IsEOF() const
+        {
+            return eof_;
+        }
+
+        inline std::uint64_t FileSize() const
+        {
+            return fileSize_;
+        }
+
+        inline std::uint64_t BytesConsumed() const
+        {
+            return bytesConsumed_;
+        }
+
+    private:
+
+        std::ifstream       stream_;
+        std::vector<char>   buffer_;
+        std::size_t         offset_         = 0;
+        std::uint64_t       fileSize_       = 0;
+        std::uint64_t       bytesConsumed_  = 0;
+        bool                eof_            = false;
+
+};
+
+
+// Function interface to encode the elements in the range [begin, end) into the specified output buffer.
+using SegmentEncoder = std::function<void(std::size_t begin, std::size_t end, std::string& output)>;
+
+/*
+Encodes 'count' elements in segments of 'segmentSize' elements in parallel and writes the segments in order into the specified stream.
+Only a limited number of segments is held in memory at a time.
+*/
+void WriteSegmentsInParallel(std::ostream& stream, std::size_t count, std::size_t segmentSize, const SegmentEncoder& encoder);
+
+/*
+Splits the specified text into segments of at least 'segmentSize' bytes which end at line breaks (except the last one).
+Returns the segment boundaries, starting with 0 and ending with 'size'.
+*/
+std::vector<std::size_t> SplitAtLineBreaks(const char* data, std::size_t size, std::size_t segmentSize = ioSegmentSize);
+
+/*
+Parses a floating-point number (e.g. "-1.25e+3") without a locale, with a fast path for up to 19 significant digits.
+Returns the pointer to the character after the number, or null if there is no number.
+*/
+const char* ParseReal(const char* s, const char* end, Gs::Real& value);
+
+// Parses a signed decimal integer, saturated to +/- 2^62. Returns the pointer to the character after the integer, or null if there is no integer.
+const char* ParseInteger(const char* s, const char* end, std::int64_t& value);
+
+// Maximal number of characters written by "FormatReal".
+static const std::size_t maxRealLength = 32;
+
+/*
+Writes the number in fixed or scientific notation with enough significant digits to read it back exactly, and returns the pointer to the character after the number.
+The decimal point is always '.', independent of the locale.
+*/
+char* FormatReal(char* s, float value);
+char* FormatReal(char* s, double value);
+
+// Writes the specified unsigned integer and returns the pointer to the character after the number.
+char* FormatInteger(char* s, std::uint64_t value);
+
+inline bool IsBlank(char c)
+{
+    return (c == ' ' || c == '\t' || c == '\r');
+}
+
+// Returns the pointer to the first character that is not a blank (but possibly a line break).
+inline const char* SkipBlanks(const char* s, const char* end)
+{
+    while (s != end && IsBlank(*s))
+        ++s;
+    return s;
+}
+
+// Returns the pointer to the character after the next line break, or 'end'.
+inline const char* SkipLine(const char* s, const char* end)
+{
+    auto lineBreak = static_cast<const char*>(std::memchr(s, '\n', static_cast<std::size_t>(end - s)));
+    return (lineBreak != nullptr ? lineBreak + 1 : end);
+}
+
+// Returns true if the native byte order is little-endian.
+bool IsLittleEndian();
+
+
+} // /namespace MeshIO
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
@@ -0,0 +1,677 @@
+/*
+ * MeshIOOBJ.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "MeshIODetails.h"
+#include "Except.h"
+#include <Geom/ThreadPool.h>
+
+#include <algorithm>
+
+
+namespace Gm
+{
+
+namespace MeshIO
+{
+
+
+/* ----- Internal structures ----- */
+
+// Number of vertices or triangles that are formatted by a single task.
+static const std::size_t objWriteSegmentSize = 16384;
+
+enum OBJAttribute
+{
+    OBJAttributePosition    = (1 << 0),
+    OBJAttributeTexCoord    = (1 << 1),
+    OBJAttributeNormal      = (1 << 2),
+};
+
+// Corner index which is relative to the beginning of its segment, because the number of preceding elements is unknown while the segment is parsed.
+struct OBJRelativeIndex
+{
+    std::size_t     corner;
+    OBJAttribute    attribute;
+};
+
+// Face corner with a bitmask of its relative indices (see OBJAttribute).
+struct OBJFaceCorner
+{
+    OBJCorner   corner;
+    int         relativeMask;
+};
+
+// Content of a segment of an OBJ file, which is parsed independently of the other segments.
+class OBJSegment
+{
+
+    public:
+
+        // Parses the specified lines.
+        void Parse(const char* s, const char* end);
+
+        // Resolves the relative indices with the specified element offsets and validates all indices against the specified element counts.
+        void ResolveIndices(
+            std::uint64_t numPositions,
+            std::uint64_t numTexCoords,
+            std::uint64_t numNormals
+        );
+
+        std::vector<Gs::Vector3>        positions;
+        std::vector<Gs::Vector2>        texCoords;
+        std::vector<Gs::Vector3>        normals;
+        std::vector<OBJCorner>          corners;
+
+        std::uint64_t                   positionOffset  = 0;
+        std::uint64_t                   texCoordOffset  = 0;
+        std::uint64_t                   normalOffset    = 0;
+
+    private:
+
+        const char* ParseIndex(const char* s, const char* end, std::size_t numElements, std::uint64_t& index, bool& relative);
+        const char* ParseFaceCorner(const char* s, const char* end, OBJFaceCorner& faceCorner);
+
+        void AddCorner(const OBJFaceCorner& faceCorner);
+
+        std::vector<OBJRelativeIndex>   relativeIndices_;
+        std::vector<OBJFaceCorner>      face_;
+
+};
+
+
+/* ----- Internal functions ----- */
+
+static const char* ParseRealArgument(const char* s, const char* end, Gs::Real& value)
+{
+    s = ParseReal(SkipBlanks(s, end), end, value);
+    if (!s)
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid number in OBJ file"));
+    return s;
+}
+
+static bool IsStatement(const char* s, const char* end, char c0, char c1 = '\0')
+{
+    if (c1 == '\0')
+        return (end - s >= 2 && s[0] == c0 && IsBlank(s[1]));
+    else
+        return (end - s >= 3 && s[0] == c0 && s[1] == c1 && IsBlank(s[2]));
+}
+
+static std::uint64_t ResolveRelativeIndex(std::uint64_t index, std::uint64_t offset)
+{
+    /* The relative index was stored as signed offset to the beginning of the segment */
+    auto absoluteIndex = static_cast<std::int64_t>(index) + static_cast<std::int64_t>(offset);
+    if (absoluteIndex < 0)
+        throw std::runtime_error(GM_EXCEPT_INFO("relative index out of range in OBJ face"));
+    return static_cast<std::uint64_t>(absoluteIndex);
+}
+
+// Parses the specified block of complete lines in parallel and passes the content to the callbacks.
+static void ParseOBJBlock(
+    const char*                 data,
+    std::size_t                 size,
+    std::vector<OBJSegment>&    segments,
+    std::uint64_t&              numPositions,
+    std::uint64_t&              numTexCoords,
+    std::uint64_t&              numNormals,
+    const OBJStreamCallbacks&   callbacks)
+{
+    auto& threadPool = GetSharedThreadPool();
+
+    /* Parse segments in parallel */
+    const auto boundaries = SplitAtLineBreaks(data, size);
+    const auto numSegments = boundaries.size() - 1;
+
+    segments.resize(numSegments);
+
+    threadPool.ParallelFor(
+        numSegments,
+        1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                segments[i].Parse(data + boundaries[i], data + boundaries[i + 1]);
+        }
+    );
+
+    /* Determine element offsets of the segments */
+    for (std::size_t i = 0; i < numSegments; ++i)
+    {
+        auto& segment = segments[i];
+
+        segment.positionOffset  = numPositions;
+        segment.texCoordOffset  = numTexCoords;
+        segment.normalOffset    = numNormals;
+
+        numPositions    += segment.positions.size();
+        numTexCoords    += segment.texCoords.size();
+        numNormals      += segment.normals.size();
+    }
+
+    /* Resolve and validate indices in parallel (forward references are only valid within the same block) */
+    threadPool.ParallelFor(
+        numSegments,
+        1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                segments[i].ResolveIndices(numPositions, numTexCoords, numNormals);
+        }
+    );
+
+    /* Pass all attributes of this block first, then the triangles */
+    for (const auto& segment : segments)
+    {
+        if (callbacks.positions && !segment.positions.empty())
+            callbacks.positions(segment.positions.data(), segment.positions.size());
+        if (callbacks.texCoords && !segment.texCoords.empty())
+            callbacks.texCoords(segment.texCoords.data(), segment.texCoords.size());
+        if (callbacks.normals && !segment.normals.empty())
+            callbacks.normals(segment.normals.data(), segment.normals.size());
+    }
+
+    if (callbacks.triangles)
+    {
+        for (const auto& segment : segments)
+        {
+            if (!segment.corners.empty())
+                callbacks.triangles(segment.corners.data(), segment.corners.size() / 3);
+        }
+    }
+}
+
+static char* FormatStatement(char* s, const char* keyword, const Gs::Real* values, std::size_t count)
+{
+    while (*keyword)
+        *s++ = *keyword++;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        *s++ = ' ';
+        s = FormatReal(s, values[i]);
+    }
+
+    *s++ = '\n';
+
+    return s;
+}
+
+
+/* ----- OBJSegment class ----- */
+
+void OBJSegment::Parse(const char* s, const char* end)
+{
+    positions.clear();
+    texCoords.clear();
+    normals.clear();
+    corners.clear();
+    relativeIndices_.clear();
+
+    while (s != end)
+    {
+        s = SkipBlanks(s, end);
+
+        if (IsStatement(s, end, 'v'))
+        {
+            /* Parse vertex position (an optional 'w' component or vertex color is ignored) */
+            Gs::Vector3 position;
+            s = ParseRealArgument(s + 1, end, position.x);
+            s = ParseRealArgument(s, end, position.y);
+            s = ParseRealArgument(s, end, position.z);
+            positions.push_back(position);
+        }
+        else if (IsStatement(s, end, 'v', 't'))
+        {
+            /* Parse texture-coordinate (the 'v' component is optional and an optional 'w' component is ignored) */
+            Gs::Vector2 texCoord;
+            s = ParseRealArgument(s + 2, end, texCoord.x);
+
+            s = SkipBlanks(s, end);
+            if (s != end && *s != '\n' && *s != '#')
+                s = ParseRealArgument(s, end, texCoord.y);
+            else
+                texCoord.y = Gs::Real(0);
+
+            texCoords.push_back(texCoord);
+        }
+        else if (IsStatement(s, end, 'v', 'n'))
+        {
+            /* Parse vertex normal */
+            Gs::Vector3 normal;
+            s = ParseRealArgument(s + 2, end, normal.x);
+            s = ParseRealArgument(s, end, normal.y);
+            s = ParseRealArgument(s, end, normal.z);
+            normals.push_back(normal);
+        }
+        else if (IsStatement(s, end, 'f'))
+        {
+            /* Parse face corners until the end of the line */
+            face_.clear();
+
+            for (++s;;)
+            {
+                s = SkipBlanks(s, end);
+                if (s == end || *s == '\n' || *s == '#')
+                    break;
+
+                OBJFaceCorner faceCorner;
+                s = ParseFaceCorner(s, end, faceCorner);
+
+                if (!s)
+                    throw std::runtime_error(GM_EXCEPT_INFO("invalid face corner in OBJ file"));
+
+                face_.push_back(faceCorner);
+            }
+
+            /* Triangulate polygon as triangle fan */
+            for (std::size_t i = 2; i < face_.size(); ++i)
+            {
+                AddCorner(face_[0]);
+                AddCorner(face_[i - 1]);
+                AddCorner(face_[i]);
+            }
+        }
+
+        s = SkipLine(s, end);
+    }
+}
+
+void OBJSegment::ResolveIndices(std::uint64_t numPositions, std::uint64_t numTexCoords, std::uint64_t numNormals)
+{
+    for (const auto& relativeIndex : relativeIndices_)
+    {
+        auto& corner = corners[relativeIndex.corner];
+
+        switch (relativeIndex.attribute)
+        {
+            case OBJAttributePosition:
+                corner.position = ResolveRelativeIndex(corner.position, positionOffset);
+                break;
+            case OBJAttributeTexCoord:
+                corner.texCoord = ResolveRelativeIndex(corner.texCoord, texCoordOffset);
+                break;
+            case OBJAttributeNormal:
+                corner.normal = ResolveRelativeIndex(corner.normal, normalOffset);
+                break;
+        }
+    }
+
+    for (const auto& corner : corners)
+    {
+        if ( corner.position >= numPositions ||
+             ( corner.texCoord != invalidIndex && corner.texCoord >= numTexCoords ) ||
+             ( corner.normal != invalidIndex && corner.normal >= numNormals ) )
+        {
+            throw std::runtime_error(GM_EXCEPT_INFO("index out of range in OBJ face"));
+        }
+    }
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+const char* OBJSegment::ParseIndex(const char* s, const char* end, std::size_t numElements, std::uint64_t& index, bool& relative)
+{
+    std::int64_t value = 0;
+
+    s = ParseInteger(s, end, value);
+    if (!s)
+        return nullptr;
+
+    if (value > 0)
+    {
+        /* Convert one-based index into zero-based index */
+        index = static_cast<std::uint64_t>(value - 1);
+        relative = false;
+    }
+    else if (value < 0)
+    {
+        /* Store relative index as signed offset to the beginning of this segment */
+        index = static_cast<std::uint64_t>(static_cast<std::int64_t>(numElements) + value);
+        relative = true;
+    }
+    else
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid index 0 in OBJ face"));
+
+    return s;
+}
+
+const char* OBJSegment::ParseFaceCorner(const char* s, const char* end, OBJFaceCorner& faceCorner)
+{
+    faceCorner.corner       = OBJCorner();
+    faceCorner.relativeMask = 0;
+
+    bool relative = false;
+
+    /* Parse "v", "v/vt", "v//vn", or "v/vt/vn" */
+    s = ParseIndex(s, end, positions.size(), faceCorner.corner.position, relative);
+    if (!s)
+        return nullptr;
+    if (relative)
+        faceCorner.relativeMask |= OBJAttributePosition;
+
+    if (s != end && *s == '/')
+    {
+        ++s;
+
+        if (s != end && *s != '/')
+        {
+            s = ParseIndex(s, end, texCoords.size(), faceCorner.corner.texCoord, relative);
+            if (!s)
+                return nullptr;
+            if (relative)
+                faceCorner.relativeMask |= OBJAttributeTexCoord;
+        }
+
+        if (s != end && *s == '/')
+        {
+            s = ParseIndex(s + 1, end, normals.size(), faceCorner.corner.normal, relative);
+            if (!s)
+                return nullptr;
+            if (relative)
+                faceCorner.relativeMask |= OBJAttributeNormal;
+        }
+    }
+
+    return s;
+}
+
+void OBJSegment::AddCorner(const OBJFaceCorner& faceCorner)
+{
+    corners.push_back(faceCorner.corner);
+
+    if (faceCorner.relativeMask != 0)
+    {
+        const auto cornerIndex = corners.size() - 1;
+
+        if ((faceCorner.relativeMask & OBJAttributePosition) != 0)
+            relativeIndices_.push_back({ cornerIndex, OBJAttributePosition });
+        if ((faceCorner.relativeMask & OBJAttributeTexCoord) != 0)
+            relativeIndices_.push_back({ cornerIndex, OBJAttributeTexCoord });
+        if ((faceCorner.relativeMask & OBJAttributeNormal) != 0)
+            relativeIndices_.push_back({ cornerIndex, OBJAttributeNormal });
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+void StreamOBJ(const std::string& filename, const OBJStreamCallbacks& callbacks)
+{
+    FileBlockReader reader(filename);
+
+    std::vector<OBJSegment> segments;
+    std::uint64_t numPositions = 0, numTexCoords = 0, numNormals = 0;
+
+    while (reader.ReadBlock())
+    {
+        const auto data = reader.Data();
+        auto size = reader.Size();
+
+        /* Parse only complete lines, unless the end of the file has been reached */
+        if (!reader.IsEOF())
+        {
+            while (size > 0 && data[size - 1] != '\n')
+                --size;
+            if (size == 0)
+                continue;
+        }
+
+        ParseOBJBlock(data, size, segments, numPositions, numTexCoords, numNormals, callbacks);
+
+        reader.Consume(size);
+
+        if (callbacks.progress)
+            callbacks.progress(reader.BytesConsumed(), reader.FileSize());
+    }
+}
+
+void ReadOBJ(const std::string& filename, TriangleMesh& mesh)
+{
+    using VertexIndex = TriangleMesh::VertexIndex;
+
+    const auto invalidVertex = static_cast<VertexIndex>(TriangleMesh::MaxNumVertices());
+
+    // Attribute indices of the face corners that use a vertex.
+    struct VertexKey
+    {
+        std::uint64_t texCoord;
+        std::uint64_t normal;
+    };
+
+    const VertexKey unassignedKey { invalidIndex - 1, invalidIndex - 1 };
+
+    mesh.Clear();
+
+    std::vector<Gs::Vector2>            texCoords;
+    std::vector<Gs::Vector3>            normals;
+    std::vector<VertexKey>              vertexKeys;
+
+    /* Additional vertices for positions that are used with different attributes, appended after all positions */
+    std::vector<TriangleMesh::Vertex>   variants;
+    std::vector<VertexKey>              variantKeys;
+    std::vector<VertexIndex>            firstVariants;
+    std::vector<VertexIndex>            nextVariants;
+    std::vector<std::pair<std::size_t, VertexIndex>> variantCorners;
+
+    auto AssignAttributes = [&](TriangleMesh::Vertex& vertex, const OBJCorner& corner)
+    {
+        if (corner.texCoord != invalidIndex)
+            vertex.texCoord = texCoords[static_cast<std::size_t>(corner.texCoord)];
+        if (corner.normal != invalidIndex)
+            vertex.normal = normals[static_cast<std::size_t>(corner.normal)];
+    };
+
+    auto FindVertex = [&](const OBJCorner& corner, std::size_t cornerIndex) -> VertexIndex
+    {
+        const auto position = static_cast<VertexIndex>(corner.position);
+
+        /* Use the vertex of the position itself, if it has no attributes yet or the same attributes */
+        auto& key = vertexKeys[position];
+
+        if (key.texCoord == unassignedKey.texCoord)
+        {
+            key.texCoord    = corner.texCoord;
+            key.normal      = corner.normal;
+            AssignAttributes(mesh.vertices[position], corner);
+            return position;
+        }
+
+        if (key.texCoord == corner.texCoord && key.normal == corner.normal)
+            return position;
+
+        /* Find or create additional vertex; the final index is assigned after all positions have been read */
+        auto variant = firstVariants[position];
+
+        while (variant != invalidVertex && (variantKeys[variant].texCoord != corner.texCoord || variantKeys[variant].normal != corner.normal))
+            variant = nextVariants[variant];
+
+        if (variant == invalidVertex)
+        {
+            if (variants.size() >= TriangleMesh::MaxNumVertices())
+                throw std::overflow_error(GM_EXCEPT_INFO("number of vertices in OBJ file exceeds the range of the mesh index type"));
+
+            variant = static_cast<VertexIndex>(variants.size());
+
+            TriangleMesh::Vertex vertex(mesh.vertices[position].position, Gs::Vector3(Gs::Real(0)), Gs::Vector2(Gs::Real(0)));
+            AssignAttributes(vertex, corner);
+
+            variants.push_back(vertex);
+            variantKeys.push_back({ corner.texCoord, corner.normal });
+            nextVariants.push_back(firstVariants[position]);
+            firstVariants[position] = variant;
+        }
+
+        variantCorners.push_back({ cornerIndex, variant });
+
+        return 0;
+    };
+
+    OBJStreamCallbacks callbacks;
+
+    callbacks.positions = [&](const Gs::Vector3* positions, std::size_t count)
+    {
+        if (mesh.vertices.size() + count > TriangleMesh::MaxNumVertices())
+            throw std::overflow_error(GM_EXCEPT_INFO("number of vertices in OBJ file exceeds the range of the mesh index type"));
+
+        for (std::size_t i = 0; i < count; ++i)
+            mesh.vertices.push_back(TriangleMesh::Vertex(positions[i], Gs::Vector3(Gs::Real(0)), Gs::Vector2(Gs::Real(0))));
+
+        vertexKeys.resize(mesh.vertices.size(), unassignedKey);
+        firstVariants.resize(mesh.vertices.size(), invalidVertex);
+    };
+
+    callbacks.texCoords = [&](const Gs::Vector2* data, std::size_t count)
+    {
+        texCoords.insert(texCoords.end(), data, data + count);
+    };
+
+    callbacks.normals = [&](const Gs::Vector3* data, std::size_t count)
+    {
+        normals.insert(normals.end(), data, data + count);
+    };
+
+    callbacks.triangles = [&](const OBJCorner* corners, std::size_t numTriangles)
+    {
+        for (std::size_t i = 0; i < numTriangles; ++i, corners += 3)
+        {
+            const auto cornerIndex = mesh.triangles.size() * 3;
+            mesh.triangles.push_back(
+                {
+                    FindVertex(corners[0], cornerIndex),
+                    FindVertex(corners[1], cornerIndex + 1),
+                    FindVertex(corners[2], cornerIndex + 2)
+                }
+            );
+        }
+    };
+
+    bool reserved = false;
+
+    callbacks.progress = [&](std::uint64_t bytesProcessed, std::uint64_t fileSize)
+    {
+        /* Reserve all containers once, extrapolated from the content of the first block */
+        if (!reserved && bytesProcessed > 0 && bytesProcessed < fileSize)
+        {
+            reserved = true;
+
+            const auto scale = static_cast<double>(fileSize) / static_cast<double>(bytesProcessed) * 1.05;
+
+            auto Extrapolate = [scale](std::size_t n)
+            {
+                return static_cast<std::size_t>(static_cast<double>(n) * scale);
+            };
+
+            mesh.vertices.reserve(Extrapolate(mesh.vertices.size()));
+            mesh.triangles.reserve(Extrapolate(mesh.triangles.size()));
+            vertexKeys.reserve(Extrapolate(vertexKeys.size()));
+            firstVariants.reserve(Extrapolate(firstVariants.size()));
+            texCoords.reserve(Extrapolate(texCoords.size()));
+            normals.reserve(Extrapolate(normals.size()));
+        }
+    };
+
+    StreamOBJ(filename, callbacks);
+
+    /* Append additional vertices and assign their final indices */
+    const auto numPositions = mesh.vertices.size();
+
+    if (numPositions + variants.size() > TriangleMesh::MaxNumVertices())
+        throw std::overflow_error(GM_EXCEPT_INFO("number of vertices in OBJ file exceeds the range of the mesh index type"));
+
+    mesh.vertices.insert(mesh.vertices.end(), variants.begin(), variants.end());
+
+    for (const auto& variantCorner : variantCorners)
+        mesh.triangles[variantCorner.first / 3][variantCorner.first % 3] = static_cast<VertexIndex>(numPositions + variantCorner.second);
+}
+
+void WriteOBJ(const std::string& filename, const TriangleMesh& mesh)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.good())
+        throw std::runtime_error(GM_EXCEPT_INFO("failed to open OBJ file for writing"));
+
+    file << "# Vertices: " << mesh.vertices.size() << '\n';
+    file << "# Triangles: " << mesh.triangles.size() << '\n';
+
+    /* Write vertices with one position, texture-coordinate, and normal statement each */
+    WriteSegmentsInParallel(
+        file,
+        mesh.vertices.size(),
+        objWriteSegmentSize,
+        [&mesh](std::size_t begin, std::size_t end, std::string& output)
+        {
+            char line[maxRealLength * 8 + 16];
+
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& vertex = mesh.vertices[i];
+
+                const Gs::Real position[3]  = { vertex.position.x, vertex.position.y, vertex.position.z };
+                const Gs::Real texCoord[2]  = { vertex.texCoord.x, vertex.texCoord.y };
+                const Gs::Real normal[3]    = { vertex.normal.x, vertex.normal.y, vertex.normal.z };
+
+                auto s = FormatStatement(line, "v", position, 3);
+                s = FormatStatement(s, "vt", texCoord, 2);
+                s = FormatStatement(s, "vn", normal, 3);
+
+                output.append(line, s);
+            }
+        }
+    );
+
+    /* Write triangles with one-based indices */
+    WriteSegmentsInParallel(
+        file,
+        mesh.triangles.size(),
+        objWriteSegmentSize,
+        [&mesh](std::size_t begin, std::size_t end, std::string& output)
+        {
+            char line[128];
+
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+
+                auto s = line;
+                *s++ = 'f';
+
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    const auto index = static_cast<std::uint64_t>(tri[k]) + 1;
+                    *s++ = ' ';
+                    s = FormatInteger(s, index);
+                    *s++ = '/';
+                    s = FormatInteger(s, index);
+                    *s++ = '/';
+                    s = FormatInteger(s, index);
+                }
+
+                *s++ = '\n';
+
+                output.append(line, s);
+            }
+        }
+    );
+
+    file.flush();
+
+    if (!file.good())
+        throw std::runtime_error(GM_EXCEPT_INFO("failed to write OBJ file"));
+}
+
+
+} // /namespace MeshIO
+
+} // /namespace Gm
+
+
+
+// ================================================================================
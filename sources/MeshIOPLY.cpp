@@ -0,0 +1,1025 @@
+/*
+ * MeshIOPLY.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include "MeshIODetails.h"
+#include "Except.h"
+#include <Geom/ThreadPool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <mutex>
+#include <limits>
+#include <stdexcept>
+
+
+namespace Gm
+{
+
+namespace MeshIO
+{
+
+
+/* ----- Internal structures ----- */
+
+// Number of vertices or triangles that are encoded by a single task.
+static const std::size_t plyWriteSegmentSize    = 16384;
+
+// Minimal number of binary records that are decoded by a single task.
+static const std::size_t plyRecordGrainSize     = 4096;
+
+// Number of vertex components, in the order 'x', 'y', 'z', 'nx', 'ny', 'nz', 's', 't'.
+static const std::size_t plyNumVertexComponents = 8;
+
+enum class PLYType
+{
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Float32,
+    Float64,
+};
+
+struct PLYProperty
+{
+    PLYType     type            = PLYType::Float32;
+    PLYType     countType       = PLYType::UInt8;   // Type of the list size (only for list properties)
+    bool        isList          = false;
+    int         component       = -1;               // Vertex component of this property (only for the vertex element), or -1
+    bool        isVertexIndices = false;            // Specifies whether this is the index list of the face element
+};
+
+struct PLYElement
+{
+    std::string                 name;
+    std::uint64_t               count       = 0;
+    std::vector<PLYProperty>    properties;
+    bool                        isVertex    = false;
+    bool                        isFace      = false;
+};
+
+struct PLYHeader
+{
+    PLYFormat                   format      = PLYFormat::ASCII;
+    std::vector<PLYElement>     elements;
+    std::uint64_t               numVertices = 0;
+    std::uint64_t               numFaces    = 0;
+};
+
+// Byte offsets of the properties of a binary record, whose lists have specific sizes.
+struct PLYRecordLayout
+{
+    std::vector<std::size_t>    offsets;    // Offset of each property (for lists, the offset of the first item)
+    std::vector<std::uint64_t>  listSizes;  // Number of items of each list property (0 for scalar properties)
+    std::size_t                 stride      = 0;
+};
+
+// Lines of a text block that are parsed by a single task.
+struct PLYTextSegment
+{
+    std::size_t                             begin   = 0;
+    std::size_t                             end     = 0;
+    std::vector<TriangleMesh::Vertex>       vertices;
+    std::vector<TriangleMesh::Triangle>     triangles;
+    std::vector<std::int64_t>               indices;
+};
+
+
+/* ----- Internal functions ----- */
+
+static PLYType ParsePLYType(const std::string& name)
+{
+    if (name == "char" || name == "int8")
+        return PLYType::Int8;
+    if (name == "uchar" || name == "uint8")
+        return PLYType::UInt8;
+    if (name == "short" || name == "int16")
+        return PLYType::Int16;
+    if (name == "ushort" || name == "uint16")
+        return PLYType::UInt16;
+    if (name == "int" || name == "int32")
+        return PLYType::Int32;
+    if (name == "uint" || name == "uint32")
+        return PLYType::UInt32;
+    if (name == "float" || name == "float32")
+        return PLYType::Float32;
+    if (name == "double" || name == "float64")
+        return PLYType::Float64;
+    throw std::runtime_error(GM_EXCEPT_INFO("invalid property type in PLY header"));
+}
+
+static std::size_t PLYTypeSize(const PLYType type)
+{
+    switch (type)
+    {
+        case PLYType::Int8:
+        case PLYType::UInt8:
+            return 1;
+        case PLYType::Int16:
+        case PLYType::UInt16:
+            return 2;
+        case PLYType::Int32:
+        case PLYType::UInt32:
+        case PLYType::Float32:
+            return 4;
+        case PLYType::Float64:
+            return 8;
+    }
+    return 0;
+}
+
+static int PLYVertexComponent(const std::string& name)
+{
+    static const char* const componentNames[][4] =
+    {
+        { "x",  nullptr,    nullptr,        nullptr         },
+        { "y",  nullptr,    nullptr,        nullptr         },
+        { "z",  nullptr,    nullptr,        nullptr         },
+        { "nx", nullptr,    nullptr,        nullptr         },
+        { "ny", nullptr,    nullptr,        nullptr         },
+        { "nz", nullptr,    nullptr,        nullptr         },
+        { "s",  "u",        "texture_u",    "texture_s"     },
+        { "t",  "v",        "texture_v",    "texture_t"     },
+    };
+
+    for (std::size_t i = 0; i < plyNumVertexComponents; ++i)
+    {
+        for (auto alias : componentNames[i])
+        {
+            if (alias != nullptr && name == alias)
+                return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+// Reads and parses the header and consumes it from the reader.
+static PLYHeader ReadPLYHeader(FileBlockReader& reader)
+{
+    /* Read blocks until the end of the header has been found */
+    static const std::string endHeader = "end_header";
+
+    std::size_t headerSize = 0;
+
+    while (headerSize == 0)
+    {
+        if (reader.IsEOF() || !reader.ReadBlock())
+            throw std::runtime_error(GM_EXCEPT_INFO("missing end of PLY header"));
+
+        const auto data = reader.Data();
+        const auto end = data + reader.Size();
+
+        auto it = std::search(data, end, endHeader.begin(), endHeader.end());
+        if (it != end)
+            headerSize = static_cast<std::size_t>(SkipLine(it, end) - data);
+    }
+
+    /* Parse header lines */
+    PLYHeader header;
+
+    std::istringstream stream(std::string(reader.Data(), headerSize));
+    std::string line, keyword;
+
+    std::getline(stream, line);
+    if (line.compare(0, 3, "ply") != 0)
+        throw std::runtime_error(GM_EXCEPT_INFO("missing magic number in PLY header"));
+
+    bool hasFormat = false;
+
+    while (std::getline(stream, line))
+    {
+        std::istringstream lineStream(line);
+
+        keyword.clear();
+        lineStream >> keyword;
+
+        if (keyword == "format")
+        {
+            std::string format;
+            lineStream >> format;
+
+            if (format == "ascii")
+                header.format = PLYFormat::ASCII;
+            else if (format == "binary_little_endian")
+                header.format = PLYFormat::BinaryLittleEndian;
+            else if (format == "binary_big_endian")
+                header.format = PLYFormat::BinaryBigEndian;
+            else
+                throw std::runtime_error(GM_EXCEPT_INFO("invalid format in PLY header"));
+
+            hasFormat = true;
+        }
+        else if (keyword == "element")
+        {
+            PLYElement element;
+            lineStream >> element.name >> element.count;
+
+            if (lineStream.fail())
+                throw std::runtime_error(GM_EXCEPT_INFO("invalid element in PLY header"));
+
+            if (element.name == "vertex")
+            {
+                element.isVertex = true;
+                header.numVertices = element.count;
+            }
+            else if (element.name == "face")
+            {
+                element.isFace = true;
+                header.numFaces = element.count;
+            }
+
+            header.elements.push_back(element);
+        }
+        else if (keyword == "property")
+        {
+            if (header.elements.empty())
+                throw std::runtime_error(GM_EXCEPT_INFO("property without element in PLY header"));
+
+            auto& element = header.elements.back();
+
+            PLYProperty property;
+            std::string type, name;
+
+            lineStream >> type;
+
+            if (type == "list")
+            {
+                std::string countType;
+                lineStream >> countType >> type;
+
+                property.isList     = true;
+                property.countType  = ParsePLYType(countType);
+            }
+
+            lineStream >> name;
+
+            if (lineStream.fail())
+                throw std::runtime_error(GM_EXCEPT_INFO("invalid property in PLY header"));
+
+            property.type = ParsePLYType(type);
+
+            if (element.isVertex && !property.isList)
+                property.component = PLYVertexComponent(name);
+            else if (element.isFace && property.isList && (name == "vertex_indices" || name == "vertex_index"))
+                property.isVertexIndices = true;
+
+            element.properties.push_back(property);
+        }
+        else if (keyword == "end_header")
+            break;
+    }
+
+    if (!hasFormat)
+        throw std::runtime_error(GM_EXCEPT_INFO("missing format in PLY header"));
+
+    reader.Consume(headerSize);
+
+    return header;
+}
+
+template <typename T>
+T LoadPLYValue(const unsigned char* data, bool swapBytes)
+{
+    T value;
+
+    if (swapBytes)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::reverse_copy(data, data + sizeof(T), bytes);
+        std::memcpy(&value, bytes, sizeof(T));
+    }
+    else
+        std::memcpy(&value, data, sizeof(T));
+
+    return value;
+}
+
+static double LoadPLYReal(const unsigned char* data, const PLYType type, bool swapBytes)
+{
+    switch (type)
+    {
+        case PLYType::Int8:     return static_cast<double>(LoadPLYValue<std::int8_t  >(data, swapBytes));
+        case PLYType::UInt8:    return static_cast<double>(LoadPLYValue<std::uint8_t >(data, swapBytes));
+        case PLYType::Int16:    return static_cast<double>(LoadPLYValue<std::int16_t >(data, swapBytes));
+        case PLYType::UInt16:   return static_cast<double>(LoadPLYValue<std::uint16_t>(data, swapBytes));
+        case PLYType::Int32:    return static_cast<double>(LoadPLYValue<std::int32_t >(data, swapBytes));
+        case PLYType::UInt32:   return static_cast<double>(LoadPLYValue<std::uint32_t>(data, swapBytes));
+        case PLYType::Float32:  return static_cast<double>(LoadPLYValue<float        >(data, swapBytes));
+        case PLYType::Float64:  return LoadPLYValue<double>(data, swapBytes);
+    }
+    return 0.0;
+}
+
+/*
+Converts a floating-point index or list size to an integer. Values that are not finite or beyond the exactly representable integers (2^53)
+are returned as -1, so they are rejected like any other invalid index or list size.
+*/
+template <typename T>
+std::int64_t PLYRealToInteger(T value)
+{
+    const auto maxValue = static_cast<T>(std::int64_t(1) << 53);
+    if (std::isfinite(value) && value >= -maxValue && value <= maxValue)
+        return static_cast<std::int64_t>(value);
+    return -1;
+}
+
+static std::int64_t LoadPLYInteger(const unsigned char* data, const PLYType type, bool swapBytes)
+{
+    switch (type)
+    {
+        case PLYType::Int8:     return static_cast<std::int64_t>(LoadPLYValue<std::int8_t  >(data, swapBytes));
+        case PLYType::UInt8:    return static_cast<std::int64_t>(LoadPLYValue<std::uint8_t >(data, swapBytes));
+        case PLYType::Int16:    return static_cast<std::int64_t>(LoadPLYValue<std::int16_t >(data, swapBytes));
+        case PLYType::UInt16:   return static_cast<std::int64_t>(LoadPLYValue<std::uint16_t>(data, swapBytes));
+        case PLYType::Int32:    return static_cast<std::int64_t>(LoadPLYValue<std::int32_t >(data, swapBytes));
+        case PLYType::UInt32:   return static_cast<std::int64_t>(LoadPLYValue<std::uint32_t>(data, swapBytes));
+        case PLYType::Float32:  return PLYRealToInteger(LoadPLYValue<float >(data, swapBytes));
+        case PLYType::Float64:  return PLYRealToInteger(LoadPLYValue<double>(data, swapBytes));
+    }
+    return 0;
+}
+
+template <typename T>
+void StorePLYValue(unsigned char* data, const T& value, bool swapBytes)
+{
+    std::memcpy(data, &value, sizeof(T));
+    if (swapBytes)
+        std::reverse(data, data + sizeof(T));
+}
+
+static TriangleMesh::Vertex MakePLYVertex(const Gs::Real (&components)[plyNumVertexComponents])
+{
+    return TriangleMesh::Vertex(
+        Gs::Vector3(components[0], components[1], components[2]),
+        Gs::Vector3(components[3], components[4], components[5]),
+        Gs::Vector2(components[6], components[7])
+    );
+}
+
+static TriangleMesh::VertexIndex ValidatePLYIndex(std::int64_t index, std::uint64_t numVertices)
+{
+    if (index < 0 || static_cast<std::uint64_t>(index) >= numVertices || static_cast<std::uint64_t>(index) >= TriangleMesh::MaxNumVertices())
+        throw std::runtime_error(GM_EXCEPT_INFO("vertex index out of range in PLY file"));
+    return static_cast<TriangleMesh::VertexIndex>(index);
+}
+
+static void CallPLYProgress(const FileBlockReader& reader, const PLYStreamCallbacks& callbacks)
+{
+    if (callbacks.progress)
+        callbacks.progress(reader.BytesConsumed(), reader.FileSize());
+}
+
+/* --- Binary format --- */
+
+// Determines the layout of the record at the beginning of the data. Returns false if the data does not contain the entire record.
+static bool DeterminePLYRecordLayout(
+    const PLYElement&       element,
+    const unsigned char*    data,
+    std::size_t             size,
+    bool                    swapBytes,
+    PLYRecordLayout&        layout)
+{
+    layout.offsets.clear();
+    layout.listSizes.clear();
+
+    std::uint64_t offset = 0;
+
+    for (const auto& property : element.properties)
+    {
+        if (property.isList)
+        {
+            const auto countSize = PLYTypeSize(property.countType);
+            if (offset + countSize > size)
+                return false;
+
+            const auto count = LoadPLYInteger(data + offset, property.countType, swapBytes);
+            if (count < 0)
+                throw std::runtime_error(GM_EXCEPT_INFO("invalid list size in PLY file"));
+
+            offset += countSize;
+
+            layout.offsets.push_back(static_cast<std::size_t>(offset));
+            layout.listSizes.push_back(static_cast<std::uint64_t>(count));
+
+            offset += static_cast<std::uint64_t>(count) * PLYTypeSize(property.type);
+        }
+        else
+        {
+            layout.offsets.push_back(static_cast<std::size_t>(offset));
+            layout.listSizes.push_back(0);
+
+            offset += PLYTypeSize(property.type);
+        }
+    }
+
+    if (offset > size)
+        return false;
+
+    layout.stride = static_cast<std::size_t>(offset);
+
+    return true;
+}
+
+// Returns true if the lists of the specified record have the same sizes as in the specified layout.
+static bool MatchesPLYRecordLayout(const PLYElement& element, const PLYRecordLayout& layout, const unsigned char* record, bool swapBytes)
+{
+    for (std::size_t i = 0; i < element.properties.size(); ++i)
+    {
+        const auto& property = element.properties[i];
+        if (property.isList)
+        {
+            const auto countSize = PLYTypeSize(property.countType);
+            const auto count = LoadPLYInteger(record + layout.offsets[i] - countSize, property.countType, swapBytes);
+            if (count < 0 || static_cast<std::uint64_t>(count) != layout.listSizes[i])
+                return false;
+        }
+    }
+    return true;
+}
+
+// Returns the number of records (up to 'maxCount') from the beginning of the data that have the same layout as the first record.
+static std::size_t FindUniformPLYRecords(
+    const PLYElement&       element,
+    const PLYRecordLayout&  layout,
+    const unsigned char*    data,
+    std::size_t             maxCount,
+    bool                    swapBytes)
+{
+    auto hasLists = std::any_of(
+        element.properties.begin(), element.properties.end(),
+        [](const PLYProperty& property) { return property.isList; }
+    );
+
+    if (!hasLists)
+        return maxCount;
+
+    /* Find the first record with another layout in parallel */
+    std::mutex mutex;
+    auto count = maxCount;
+
+    GetSharedThreadPool().ParallelFor(
+        maxCount,
+        plyRecordGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                if (!MatchesPLYRecordLayout(element, layout, data + i * layout.stride, swapBytes))
+                {
+                    std::lock_guard<std::mutex> guard { mutex };
+                    count = std::min(count, i);
+                    break;
+                }
+            }
+        }
+    );
+
+    return count;
+}
+
+static void StreamBinaryPLYElement(
+    FileBlockReader&            reader,
+    const PLYHeader&            header,
+    const PLYElement&           element,
+    const PLYStreamCallbacks&   callbacks)
+{
+    auto& threadPool = GetSharedThreadPool();
+
+    const bool swapBytes = ((header.format == PLYFormat::BinaryLittleEndian) != IsLittleEndian());
+
+    /* Find the list of vertex indices of faces */
+    std::size_t indicesProperty = element.properties.size();
+
+    for (std::size_t i = 0; i < element.properties.size(); ++i)
+    {
+        if (element.properties[i].isVertexIndices)
+            indicesProperty = i;
+    }
+
+    PLYRecordLayout layout;
+    std::vector<TriangleMesh::Vertex> vertices;
+    std::vector<TriangleMesh::Triangle> triangles;
+
+    for (auto remaining = element.count; remaining > 0;)
+    {
+        const auto data = reinterpret_cast<const unsigned char*>(reader.Data());
+        const auto size = reader.Size();
+
+        if (!DeterminePLYRecordLayout(element, data, size, swapBytes, layout))
+        {
+            /* Read more data for the next record */
+            if (reader.IsEOF())
+                throw std::runtime_error(GM_EXCEPT_INFO("PLY file is truncated"));
+            reader.ReadBlock();
+            continue;
+        }
+
+        if (layout.stride == 0)
+            break;
+
+        /* Decode the records with the same layout as the first one in parallel */
+        const auto maxCount = static_cast<std::size_t>(std::min<std::uint64_t>(remaining, size / layout.stride));
+        const auto count = FindUniformPLYRecords(element, layout, data, maxCount, swapBytes);
+
+        if (element.isVertex && callbacks.vertices)
+        {
+            vertices.resize(count);
+
+            threadPool.ParallelFor(
+                count,
+                plyRecordGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto record = data + i * layout.stride;
+
+                        Gs::Real components[plyNumVertexComponents] = {};
+
+                        for (std::size_t j = 0; j < element.properties.size(); ++j)
+                        {
+                            const auto& property = element.properties[j];
+                            if (property.component >= 0)
+                                components[property.component] = static_cast<Gs::Real>(LoadPLYReal(record + layout.offsets[j], property.type, swapBytes));
+                        }
+
+                        vertices[i] = MakePLYVertex(components);
+                    }
+                }
+            );
+
+            callbacks.vertices(vertices.data(), vertices.size());
+        }
+        else if (element.isFace && callbacks.triangles && indicesProperty < element.properties.size())
+        {
+            /* Triangulate polygons as triangle fans */
+            const auto& property = element.properties[indicesProperty];
+            const auto  offset = layout.offsets[indicesProperty];
+            const auto  numIndices = static_cast<std::size_t>(layout.listSizes[indicesProperty]);
+            const auto  indexSize = PLYTypeSize(property.type);
+            const auto  numFaceTriangles = (numIndices >= 3 ? numIndices - 2 : 0);
+
+            triangles.resize(count * numFaceTriangles);
+
+            threadPool.ParallelFor(
+                count,
+                plyRecordGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto indices = data + i * layout.stride + offset;
+
+                        auto LoadIndex = [&](std::size_t k)
+                        {
+                            return ValidatePLYIndex(LoadPLYInteger(indices + k * indexSize, property.type, swapBytes), header.numVertices);
+                        };
+
+                        auto tri = triangles.data() + i * numFaceTriangles;
+                        const auto v0 = (numFaceTriangles > 0 ? LoadIndex(0) : 0);
+
+                        for (std::size_t k = 0; k < numFaceTriangles; ++k)
+                            tri[k] = TriangleMesh::Triangle(v0, LoadIndex(k + 1), LoadIndex(k + 2));
+                    }
+                }
+            );
+
+            if (!triangles.empty())
+                callbacks.triangles(triangles.data(), triangles.size());
+        }
+
+        reader.Consume(count * layout.stride);
+        remaining -= count;
+
+        CallPLYProgress(reader, callbacks);
+    }
+}
+
+/* --- ASCII format --- */
+
+static const char* ParsePLYReal(const char* s, const char* end, Gs::Real& value)
+{
+    s = ParseReal(SkipBlanks(s, end), end, value);
+    if (!s)
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid number in PLY file"));
+    return s;
+}
+
+static const char* ParsePLYInteger(const char* s, const char* end, std::int64_t& value)
+{
+    s = ParseInteger(SkipBlanks(s, end), end, value);
+    if (!s)
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid integer in PLY file"));
+    return s;
+}
+
+// Parses the size of a list, which can not exceed the remaining characters of the segment (each element takes at least one character).
+static const char* ParsePLYListSize(const char* s, const char* end, std::int64_t& count)
+{
+    s = ParsePLYInteger(s, end, count);
+    if (count < 0 || count > end - s)
+        throw std::runtime_error(GM_EXCEPT_INFO("invalid list size in PLY file"));
+    return s;
+}
+
+// Parses the specified lines of the specified element into the segment.
+static void ParseASCIIPLYLines(const char* s, const char* end, const PLYHeader& header, const PLYElement& element, PLYTextSegment& segment)
+{
+    segment.vertices.clear();
+    segment.triangles.clear();
+
+    while (s != end)
+    {
+        if (element.isVertex)
+        {
+            Gs::Real components[plyNumVertexComponents] = {};
+            Gs::Real value = 0;
+            std::int64_t count = 0;
+
+            for (const auto& property : element.properties)
+            {
+                if (property.isList)
+                {
+                    s = ParsePLYListSize(s, end, count);
+                    for (std::int64_t i = 0; i < count; ++i)
+                        s = ParsePLYReal(s, end, value);
+                }
+                else
+                {
+                    s = ParsePLYReal(s, end, value);
+                    if (property.component >= 0)
+                        components[property.component] = value;
+                }
+            }
+
+            segment.vertices.push_back(MakePLYVertex(components));
+        }
+        else if (element.isFace)
+        {
+            Gs::Real value = 0;
+            std::int64_t count = 0;
+
+            for (const auto& property : element.properties)
+            {
+                if (property.isList)
+                {
+                    s = ParsePLYListSize(s, end, count);
+
+                    if (property.isVertexIndices)
+                    {
+                        /* Triangulate polygon as triangle fan */
+                        segment.indices.resize(static_cast<std::size_t>(count));
+
+                        for (auto& index : segment.indices)
+                            s = ParsePLYInteger(s, end, index);
+
+                        for (std::size_t i = 2; i < segment.indices.size(); ++i)
+                        {
+                            segment.triangles.push_back(
+                                TriangleMesh::Triangle(
+                                    ValidatePLYIndex(segment.indices[0], header.numVertices),
+                                    ValidatePLYIndex(segment.indices[i - 1], header.numVertices),
+                                    ValidatePLYIndex(segment.indices[i], header.numVertices)
+                                )
+                            );
+                        }
+                    }
+                    else
+                    {
+                        for (std::int64_t i = 0; i < count; ++i)
+                            s = ParsePLYReal(s, end, value);
+                    }
+                }
+                else
+                    s = ParsePLYReal(s, end, value);
+            }
+        }
+
+        s = SkipLine(s, end);
+    }
+}
+
+/*
+Finds the lines of up to 'maxCount' records at the beginning of the data and splits them into segments.
+Returns the number of records; 'size' receives the number of bytes of these records.
+*/
+static std::uint64_t FindASCIIPLYRecords(
+    const char*                     data,
+    std::size_t&                    size,
+    std::uint64_t                   maxCount,
+    bool                            isEOF,
+    std::vector<PLYTextSegment>&    segments)
+{
+    std::size_t numSegments = 0;
+    std::size_t pos = 0, segmentBegin = 0;
+    std::uint64_t count = 0;
+
+    auto AddSegment = [&]()
+    {
+        if (segments.size() <= numSegments)
+            segments.resize(numSegments + 1);
+        segments[numSegments].begin = segmentBegin;
+        segments[numSegments].end   = pos;
+        ++numSegments;
+        segmentBegin = pos;
+    };
+
+    while (count < maxCount && pos < size)
+    {
+        auto lineBreak = static_cast<const char*>(std::memchr(data + pos, '\n', size - pos));
+
+        if (lineBreak != nullptr)
+            pos = static_cast<std::size_t>(lineBreak - data) + 1;
+        else if (isEOF)
+            pos = size;
+        else
+            break;
+
+        ++count;
+
+        if (pos - segmentBegin >= ioSegmentSize)
+            AddSegment();
+    }
+
+    if (pos > segmentBegin)
+        AddSegment();
+
+    segments.resize(numSegments);
+    size = pos;
+
+    return count;
+}
+
+static void StreamASCIIPLYElement(
+    FileBlockReader&            reader,
+    const PLYHeader&            header,
+    const PLYElement&           element,
+    const PLYStreamCallbacks&   callbacks)
+{
+    std::vector<PLYTextSegment> segments;
+
+    for (auto remaining = element.count; remaining > 0;)
+    {
+        const auto data = reader.Data();
+        auto size = reader.Size();
+
+        const auto count = FindASCIIPLYRecords(data, size, remaining, reader.IsEOF(), segments);
+
+        if (count == 0)
+        {
+            /* Read more data for the next line */
+            if (reader.IsEOF())
+                throw std::runtime_error(GM_EXCEPT_INFO("PLY file is truncated"));
+            reader.ReadBlock();
+            continue;
+        }
+
+        /* Parse segments in parallel (lines of other elements are skipped) */
+        if (element.isVertex || element.isFace)
+        {
+            GetSharedThreadPool().ParallelFor(
+                segments.size(),
+                1,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        ParseASCIIPLYLines(data + segments[i].begin, data + segments[i].end, header, element, segments[i]);
+                }
+            );
+
+            for (const auto& segment : segments)
+            {
+                if (callbacks.vertices && !segment.vertices.empty())
+                    callbacks.vertices(segment.vertices.data(), segment.vertices.size());
+                if (callbacks.triangles && !segment.triangles.empty())
+                    callbacks.triangles(segment.triangles.data(), segment.triangles.size());
+            }
+        }
+
+        reader.Consume(size);
+        remaining -= count;
+
+        CallPLYProgress(reader, callbacks);
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+void StreamPLY(const std::string& filename, const PLYStreamCallbacks& callbacks)
+{
+    FileBlockReader reader(filename);
+
+    const auto header = ReadPLYHeader(reader);
+
+    if (callbacks.header)
+        callbacks.header(static_cast<std::size_t>(header.numVertices), static_cast<std::size_t>(header.numFaces));
+
+    for (const auto& element : header.elements)
+    {
+        if (header.format == PLYFormat::ASCII)
+            StreamASCIIPLYElement(reader, header, element, callbacks);
+        else
+            StreamBinaryPLYElement(reader, header, element, callbacks);
+    }
+}
+
+void ReadPLY(const std::string& filename, TriangleMesh& mesh)
+{
+    mesh.Clear();
+
+    PLYStreamCallbacks callbacks;
+
+    callbacks.header = [&mesh](std::size_t numVertices, std::size_t numFaces)
+    {
+        if (numVertices > TriangleMesh::MaxNumVertices())
+            throw std::overflow_error(GM_EXCEPT_INFO("number of vertices in PLY file exceeds the range of the mesh index type"));
+
+        mesh.vertices.reserve(numVertices);
+        mesh.triangles.reserve(numFaces);
+    };
+
+    callbacks.vertices = [&mesh](const TriangleMesh::Vertex* vertices, std::size_t count)
+    {
+        mesh.vertices.insert(mesh.vertices.end(), vertices, vertices + count);
+    };
+
+    callbacks.triangles = [&mesh](const TriangleMesh::Triangle* triangles, std::size_t count)
+    {
+        mesh.triangles.insert(mesh.triangles.end(), triangles, triangles + count);
+    };
+
+    StreamPLY(filename, callbacks);
+}
+
+void WritePLY(const std::string& filename, const TriangleMesh& mesh, const PLYFormat format)
+{
+    /* The PLY format has no 64-bit integer type, so all vertex indices must fit into 'uint' */
+    if (static_cast<std::uint64_t>(mesh.vertices.size()) > static_cast<std::uint64_t>(std::numeric_limits<std::uint32_t>::max()) + 1)
+        throw std::overflow_error(GM_EXCEPT_INFO("too many vertices for the 32-bit vertex indices of a PLY file"));
+
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+
+    if (!file.good())
+        throw std::runtime_error(GM_EXCEPT_INFO("failed to open PLY file for writing"));
+
+    /* Write header */
+    static const char* const formatNames[]  = { "ascii", "binary_little_endian", "binary_big_endian" };
+    static const char* const componentNames[] = { "x", "y", "z", "nx", "ny", "nz", "s", "t" };
+
+    const auto realType = (sizeof(Gs::Real) == sizeof(double) ? "double" : "float");
+
+    file << "ply\n";
+    file << "format " << formatNames[static_cast<int>(format)] << " 1.0\n";
+    file << "comment GeometronLib\n";
+    file << "element vertex " << mesh.vertices.size() << '\n';
+
+    for (auto name : componentNames)
+        file << "property " << realType << ' ' << name << '\n';
+
+    file << "element face " << mesh.triangles.size() << '\n';
+    file << "property list uchar uint vertex_indices\n";
+    file << "end_header\n";
+
+    /* Write vertices and faces */
+    auto VertexComponents = [&mesh](std::size_t i, Gs::Real (&components)[plyNumVertexComponents])
+    {
+        const auto& vertex = mesh.vertices[i];
+        components[0] = vertex.position.x;
+        components[1] = vertex.position.y;
+        components[2] = vertex.position.z;
+        components[3] = vertex.normal.x;
+        components[4] = vertex.normal.y;
+        components[5] = vertex.normal.z;
+        components[6] = vertex.texCoord.x;
+        components[7] = vertex.texCoord.y;
+    };
+
+    if (format == PLYFormat::ASCII)
+    {
+        WriteSegmentsInParallel(
+            file,
+            mesh.vertices.size(),
+            plyWriteSegmentSize,
+            [&](std::size_t begin, std::size_t end, std::string& output)
+            {
+                char line[(maxRealLength + 1) * plyNumVertexComponents + 1];
+                Gs::Real components[plyNumVertexComponents];
+
+                for (auto i = begin; i < end; ++i)
+                {
+                    VertexComponents(i, components);
+
+                    auto s = line;
+                    for (std::size_t j = 0; j < plyNumVertexComponents; ++j)
+                    {
+                        if (j > 0)
+                            *s++ = ' ';
+                        s = FormatReal(s, components[j]);
+                    }
+                    *s++ = '\n';
+
+                    output.append(line, s);
+                }
+            }
+        );
+
+        WriteSegmentsInParallel(
+            file,
+            mesh.triangles.size(),
+            plyWriteSegmentSize,
+            [&mesh](std::size_t begin, std::size_t end, std::string& output)
+            {
+                char line[128];
+
+                for (auto i = begin; i < end; ++i)
+                {
+                    const auto& tri = mesh.triangles[i];
+
+                    auto s = line;
+                    *s++ = '3';
+                    for (std::size_t k = 0; k < 3; ++k)
+                    {
+                        *s++ = ' ';
+                        s = FormatInteger(s, static_cast<std::uint64_t>(tri[k]));
+                    }
+                    *s++ = '\n';
+
+                    output.append(line, s);
+                }
+            }
+        );
+    }
+    else
+    {
+        const bool swapBytes = ((format == PLYFormat::BinaryLittleEndian) != IsLittleEndian());
+
+        WriteSegmentsInParallel(
+            file,
+            mesh.vertices.size(),
+            plyWriteSegmentSize,
+            [&](std::size_t begin, std::size_t end, std::string& output)
+            {
+                unsigned char record[sizeof(Gs::Real) * plyNumVertexComponents];
+                Gs::Real components[plyNumVertexComponents];
+
+                output.reserve((end - begin) * sizeof(record));
+
+                for (auto i = begin; i < end; ++i)
+                {
+                    VertexComponents(i, components);
+
+                    for (std::size_t j = 0; j < plyNumVertexComponents; ++j)
+                        StorePLYValue(record + j * sizeof(Gs::Real), components[j], swapBytes);
+
+                    output.append(reinterpret_cast<const char*>(record), sizeof(record));
+                }
+            }
+        );
+
+        WriteSegmentsInParallel(
+            file,
+            mesh.triangles.size(),
+            plyWriteSegmentSize,
+            [&](std::size_t begin, std::size_t end, std::string& output)
+            {
+                unsigned char record[1 + sizeof(std::uint32_t) * 3];
+
+                output.reserve((end - begin) * sizeof(record));
+
+                for (auto i = begin; i < end; ++i)
+                {
+                    const auto& tri = mesh.triangles[i];
+
+                    record[0] = 3;
+                    for (std::size_t k = 0; k < 3; ++k)
+                        StorePLYValue(record + 1 + k * sizeof(std::uint32_t), static_cast<std::uint32_t>(tri[k]), swapBytes);
+
+                    output.append(reinterpret_cast<const char*>(record), sizeof(record));
+                }
+            }
+        );
+    }
+
+    file.flush();
+
+    if (!file.good())
+        throw std::runtime_error(GM_EXCEPT_INFO("failed to write PLY file"));
+}
+
+
+} // /namespace MeshIO
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -7,6 +7,13 @@
 
 #include <Geom/MeshModifier.h>
 #include <Geom/TriangleCollision.h>
+#include <Geom/ThreadPool.h>
+#include "Except.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
 
 
 namespace Gm
@@ -16,22 +23,332 @@ namespace MeshModifier
 {
 
 
+using VertexIndex   = TriangleMesh::VertexIndex;
 using TriangleIndex = TriangleMesh::TriangleIndex;
 
 
 /* ----- Internal functions ----- */
 
+// Minimal number of samples per chunk for the parallel barycentric interpolation.
+static const std::size_t interpolateGrainSize = 4096;
+
+// Number of components of a vertex attribute with a packed format that are interpolated at once.
+static const std::size_t interpolateBlockSize = 16;
+
+// Number of samples whose packed attributes are gathered and converted at once by the batch interpolation.
+static const std::size_t interpolateBatchSize = 256;
+
 static std::size_t GetVertexStride(const VertexDescriptor& vertexDesc)
 {
     auto stride = vertexDesc.stride;
     if (stride == 0)
     {
         for (const auto& attrib : vertexDesc.attributes)
-            stride += attrib.components * sizeof(Gs::Real);
+            stride += attrib.components * GetComponentSize(attrib.format);
     }
     return stride;
 }
 
+// Adds the specified vertex to the mesh, with the overflow check of the mesh index type.
+static VertexIndex AddMeshVertex(TriangleMesh& mesh, const TriangleMesh::Vertex& vertex)
+{
+    return mesh.AddVertex(vertex.position, vertex.normal, vertex.texCoord);
+}
+
+// Number of triangles per chunk of the parallel "ClipMesh". The chunk ranges are fixed, so both passes over the triangles see the same chunks.
+static const std::size_t clipChunkSize = 4096;
+
+// Number of vertices and triangles, which a chunk of triangles adds to one output mesh of "ClipMesh".
+struct ClipCounts
+{
+    std::size_t numVertices     = 0;
+    std::size_t numTriangles    = 0;
+};
+
+// Front and back polygons of a clipped triangle, which the counting pass of "ClipMesh" stores for the writing pass.
+struct ClippedPolygonPair
+{
+    ClippedPolygon<Gs::Real> front;
+    ClippedPolygon<Gs::Real> back;
+};
+
+// Clips the specified triangle, and returns its polygons if the relation is PlaneRelation::Clipped.
+static PlaneRelation ClipMeshTriangle(
+    const TriangleMesh& mesh, const TriangleMesh::Triangle& indices, const Plane& clipPlane,
+    ClippedPolygon<Gs::Real>& frontPoly, ClippedPolygon<Gs::Real>& backPoly)
+{
+    Triangle3 tri(
+        mesh.vertices[indices.a].position,
+        mesh.vertices[indices.b].position,
+        mesh.vertices[indices.c].position
+    );
+    return ClipTriangle<Gs::Real>(tri, clipPlane, frontPoly, backPoly);
+}
+
+// Adds the number of vertices and triangles of the specified polygon (as triangle fan) to the counts.
+static void CountPolygon(ClipCounts& counts, std::size_t numPolyVertices)
+{
+    counts.numVertices += numPolyVertices;
+    if (numPolyVertices > 2)
+        counts.numTriangles += numPolyVertices - 2;
+}
+
+// Writes the output of one chunk of "ClipMesh" into a pre-sized mesh, beginning at the output offsets of that chunk.
+class ClipChunkWriter
+{
+
+    public:
+
+        ClipChunkWriter(TriangleMesh& output, const ClipCounts& offsets) :
+            output_     { output                },
+            vertex_     { offsets.numVertices   },
+            triangle_   { offsets.numTriangles  }
+        {
+        }
+
+        // Adds a copy of the specified triangle (with its own vertices).
+        void CopyTriangle(const TriangleMesh& mesh, const TriangleMesh::Triangle& indices)
+        {
+            auto v = static_cast<VertexIndex>(vertex_);
+            output_.vertices[vertex_++] = mesh.vertices[indices.a];
+            output_.vertices[vertex_++] = mesh.vertices[indices.b];
+            output_.vertices[vertex_++] = mesh.vertices[indices.c];
+            output_.triangles[triangle_++] = TriangleMesh::Triangle(v, v + 1, v + 2);
+        }
+
+        // Adds the specified clipped polygon of the triangle as triangle fan.
+        void AddPolygon(const TriangleMesh& mesh, TriangleIndex triIdx, const ClippedPolygon<Gs::Real>& poly)
+        {
+            auto first = static_cast<VertexIndex>(vertex_);
+            for (unsigned char i = 0; i < poly.count; ++i)
+            {
+                output_.vertices[vertex_++] = mesh.Barycentric(triIdx, poly.vertices[i]);
+                if (i >= 2)
+                    output_.triangles[triangle_++] = TriangleMesh::Triangle(first, first + i - 1, first + i);
+            }
+        }
+
+    private:
+
+        TriangleMesh&   output_;
+        std::size_t     vertex_;
+        std::size_t     triangle_;
+
+};
+
+// Converts the counts of each chunk into output offsets (exclusive prefix sum), resizes the output mesh, and returns false on overflow.
+static bool ResizeClipOutput(TriangleMesh& output, std::vector<ClipCounts>& counts)
+{
+    ClipCounts total;
+    for (auto& chunk : counts)
+    {
+        auto offsets = total;
+        total.numVertices += chunk.numVertices;
+        total.numTriangles += chunk.numTriangles;
+        chunk = offsets;
+    }
+
+    if (total.numVertices > TriangleMesh::MaxNumVertices())
+        return false;
+
+    output.vertices.resize(total.numVertices);
+    output.triangles.resize(total.numTriangles);
+
+    return true;
+}
+
+// Output mesh of "ClipMesh" with shared vertices, which copies each source vertex at most once.
+class SharedClipOutput
+{
+
+    public:
+
+        SharedClipOutput(TriangleMesh& output, std::size_t numSourceVerts) :
+            output_ { output                                            },
+            remap_  ( numSourceVerts, TriangleMesh::MaxNumVertices()    )
+        {
+        }
+
+        // Returns the output index of the specified source vertex, and copies it on first use.
+        VertexIndex CopyVertex(const TriangleMesh& mesh, VertexIndex v)
+        {
+            auto& index = remap_[v];
+            if (index == TriangleMesh::MaxNumVertices())
+                index = AddMeshVertex(output_, mesh.vertices[v]);
+            return index;
+        }
+
+        // Adds the specified source triangle with its copied vertices.
+        void CopyTriangle(const TriangleMesh& mesh, const TriangleMesh::Triangle& indices)
+        {
+            auto v0 = CopyVertex(mesh, indices.a);
+            auto v1 = CopyVertex(mesh, indices.b);
+            auto v2 = CopyVertex(mesh, indices.c);
+            output_.AddTriangle(v0, v1, v2);
+        }
+
+        VertexIndex AddVertex(const TriangleMesh::Vertex& vertex)
+        {
+            return AddMeshVertex(output_, vertex);
+        }
+
+        // Adds the specified polygon of output vertices as triangle fan.
+        void AddPolygon(const VertexIndex* indices, std::size_t count)
+        {
+            for (std::size_t i = 2; i < count; ++i)
+                output_.AddTriangle(indices[0], indices[i - 1], indices[i]);
+        }
+
+    private:
+
+        TriangleMesh&               output_;
+        std::vector<VertexIndex>    remap_;
+
+};
+
+// Invalid entry of the split cache, i.e. the end of a linked list of splits.
+static const std::size_t invalidSplitEntry = ~std::size_t(0);
+
+// Cache of the vertices which are inserted where an edge of the source mesh crosses the clipping plane.
+class EdgeSplitCache
+{
+
+    public:
+
+        // Vertex on a split edge, which is added to both output meshes.
+        struct Split
+        {
+            VertexIndex front;
+            VertexIndex back;
+        };
+
+        explicit EdgeSplitCache(std::size_t numSourceVerts) :
+            firstEntries_ ( numSourceVerts, invalidSplitEntry )
+        {
+        }
+
+        /*
+        Returns the split vertex of the edge (a, b), and adds it to both output meshes on first use.
+        The edge is always interpolated from its smaller to its greater vertex index,
+        so both triangles of an edge receive exactly the same vertex.
+        */
+        const Split& SplitEdge(
+            const TriangleMesh& mesh, VertexIndex a, VertexIndex b, const std::vector<Gs::Real>& distances,
+            SharedClipOutput& front, SharedClipOutput& back)
+        {
+            if (a > b)
+                std::swap(a, b);
+
+            /* Search the splits of the smaller vertex (only a few edges per vertex cross the plane) */
+            for (auto i = firstEntries_[a]; i != invalidSplitEntry; i = entries_[i].next)
+            {
+                if (entries_[i].other == b)
+                    return entries_[i].split;
+            }
+
+            /* Interpolate the vertex at the intersection with the plane */
+            const auto t = distances[a] / (distances[a] - distances[b]);
+
+            const auto& va = mesh.vertices[a];
+            const auto& vb = mesh.vertices[b];
+
+            TriangleMesh::Vertex v;
+            v.position  = va.position + (vb.position - va.position) * t;
+            v.normal    = va.normal   + (vb.normal   - va.normal  ) * t;
+            v.texCoord  = va.texCoord + (vb.texCoord - va.texCoord) * t;
+
+            entries_.push_back({ b, { front.AddVertex(v), back.AddVertex(v) }, firstEntries_[a] });
+            firstEntries_[a] = entries_.size() - 1;
+
+            return entries_.back().split;
+        }
+
+    private:
+
+        struct Entry
+        {
+            VertexIndex other;
+            Split       split;
+            std::size_t next;
+        };
+
+        std::vector<std::size_t>    firstEntries_;  // First entry of the linked list of splits for each vertex
+        std::vector<Entry>          entries_;
+
+};
+
+// Clips the mesh with shared output vertices (see "ClipMesh").
+static void ClipMeshWithSharedVertices(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back)
+{
+    const auto numVerts = mesh.vertices.size();
+
+    /* Classify all vertices once (with the same tolerance as "ClipTriangle") */
+    const auto epsilon = Gs::Epsilon<Gs::Real>();
+
+    std::vector<Gs::Real> distances(numVerts);
+    std::vector<PlaneRelation> relations(numVerts);
+
+    for (std::size_t i = 0; i < numVerts; ++i)
+    {
+        distances[i] = SgnDistanceToPlane(clipPlane, mesh.vertices[i].position);
+        if (distances[i] > epsilon)
+            relations[i] = PlaneRelation::InFrontOf;
+        else if (distances[i] < -epsilon)
+            relations[i] = PlaneRelation::Behind;
+        else
+            relations[i] = PlaneRelation::Onto;
+    }
+
+    SharedClipOutput frontOutput(front, numVerts), backOutput(back, numVerts);
+    EdgeSplitCache splits(numVerts);
+
+    for (const auto& indices : mesh.triangles)
+    {
+        const auto relA = relations[indices.a];
+        const auto relB = relations[indices.b];
+        const auto relC = relations[indices.c];
+
+        if (relA != PlaneRelation::Behind && relB != PlaneRelation::Behind && relC != PlaneRelation::Behind)
+        {
+            /* Add current triangle to front sided mesh */
+            frontOutput.CopyTriangle(mesh, indices);
+        }
+        else if (relA == PlaneRelation::Behind && relB == PlaneRelation::Behind && relC == PlaneRelation::Behind)
+        {
+            /* Add current triangle to back sided mesh */
+            backOutput.CopyTriangle(mesh, indices);
+        }
+        else
+        {
+            /* Walk along the triangle edges and insert a split vertex where an edge crosses the plane */
+            VertexIndex frontPoly[4], backPoly[4];
+            std::size_t numFront = 0, numBack = 0;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto v0 = indices[i];
+                const auto v1 = indices[(i + 1) % 3];
+
+                if (relations[v0] != PlaneRelation::Behind)
+                    frontPoly[numFront++] = frontOutput.CopyVertex(mesh, v0);
+                if (relations[v0] != PlaneRelation::InFrontOf)
+                    backPoly[numBack++] = backOutput.CopyVertex(mesh, v0);
+
+                if ( ( relations[v0] == PlaneRelation::InFrontOf && relations[v1] == PlaneRelation::Behind    ) ||
+                     ( relations[v0] == PlaneRelation::Behind    && relations[v1] == PlaneRelation::InFrontOf ) )
+                {
+                    const auto& split = splits.SplitEdge(mesh, v0, v1, distances, frontOutput, backOutput);
+                    frontPoly[numFront++] = split.front;
+                    backPoly[numBack++] = split.back;
+                }
+            }
+
+            frontOutput.AddPolygon(frontPoly, numFront);
+            backOutput.AddPolygon(backPoly, numBack);
+        }
+    }
+}
+
 template <typename T>
 struct ByteBufferDetails
 {
@@ -82,6 +399,155 @@ class BasicByteBuffer
 using ByteBuffer = BasicByteBuffer<void*>;
 using ConstByteBuffer = BasicByteBuffer<const void*>;
 
+// Interpolates the components of a vertex attribute with the format ComponentFormat::Real.
+static void InterpolateRealAttribute(
+    std::uint32_t       components,
+    Gs::Real*           out,
+    const Gs::Real*     in0,
+    const Gs::Real*     in1,
+    const Gs::Real*     in2,
+    const Gs::Vector3&  barycentricCoords)
+{
+    for (std::uint32_t i = 0; i < components; ++i)
+    {
+        out[i] = (
+            in0[i] * barycentricCoords.x +
+            in1[i] * barycentricCoords.y +
+            in2[i] * barycentricCoords.z
+        );
+    }
+}
+
+// Interpolates the vertex with the specified output index from the three specified input vertices.
+static void InterpolateVertex(
+    const VertexDescriptor& vertexDesc,
+    const ByteBuffer&       output,
+    std::size_t             outputIndex,
+    const ConstByteBuffer&  input,
+    std::size_t             v0,
+    std::size_t             v1,
+    std::size_t             v2,
+    const Gs::Vector3&      barycentricCoords)
+{
+    for (const auto& attribDesc : vertexDesc.attributes)
+    {
+        auto out = output.Attrib(attribDesc, outputIndex);
+
+        auto in0 = input.Attrib(attribDesc, v0);
+        auto in1 = input.Attrib(attribDesc, v1);
+        auto in2 = input.Attrib(attribDesc, v2);
+
+        if (attribDesc.format == ComponentFormat::Real)
+            InterpolateRealAttribute(attribDesc.components, out, in0, in1, in2, barycentricCoords);
+        else
+        {
+            /* Decode the components in blocks, interpolate them, and encode the result (in0-in2 and out are only byte addresses here) */
+            const auto componentSize = GetComponentSize(attribDesc.format);
+
+            Gs::Real a[interpolateBlockSize], b[interpolateBlockSize], c[interpolateBlockSize];
+
+            for (std::size_t first = 0; first < attribDesc.components; first += interpolateBlockSize)
+            {
+                const auto count = std::min<std::size_t>(attribDesc.components - first, interpolateBlockSize);
+                const auto offset = first * componentSize;
+
+                DecodeComponents(attribDesc.format, reinterpret_cast<const char*>(in0) + offset, count, a);
+                DecodeComponents(attribDesc.format, reinterpret_cast<const char*>(in1) + offset, count, b);
+                DecodeComponents(attribDesc.format, reinterpret_cast<const char*>(in2) + offset, count, c);
+
+                for (std::size_t i = 0; i < count; ++i)
+                    a[i] = a[i] * barycentricCoords.x + b[i] * barycentricCoords.y + c[i] * barycentricCoords.z;
+
+                EncodeComponents(attribDesc.format, a, count, reinterpret_cast<char*>(out) + offset);
+            }
+        }
+    }
+}
+
+/*
+Interpolates a chunk of samples of a packed vertex attribute. The attribute of each triangle corner is gathered over all samples into contiguous blocks,
+so the format is only selected once per chunk, and the conversion kernels process long runs of components (which their SIMD paths require).
+*/
+class PackedAttributeInterpolator
+{
+
+    public:
+
+        PackedAttributeInterpolator(const VertexDescriptor& vertexDesc)
+        {
+            std::size_t maxComponents = 0, maxAttribSize = 0;
+
+            for (const auto& attribDesc : vertexDesc.attributes)
+            {
+                if (attribDesc.format != ComponentFormat::Real)
+                {
+                    maxComponents = std::max<std::size_t>(maxComponents, attribDesc.components);
+                    maxAttribSize = std::max(maxAttribSize, attribDesc.components * GetComponentSize(attribDesc.format));
+                }
+            }
+
+            values_.resize(interpolateBatchSize * maxComponents * 3);
+            packed_.resize(interpolateBatchSize * maxAttribSize * 3);
+        }
+
+        void Interpolate(
+            const VertexAttributeDescriptor&    attribDesc,
+            const ByteBuffer&                   output,
+            const ConstByteBuffer&              input,
+            const TriangleMesh::Triangle*       triangles,
+            const BarycentricSample*            samples,
+            std::size_t                         first,
+            std::size_t                         count)
+        {
+            const std::size_t components    = attribDesc.components;
+            const auto attribSize           = components * GetComponentSize(attribDesc.format);
+            const auto numComponents        = count * components;
+
+            if (numComponents == 0)
+                return;
+
+            auto packed0 = packed_.data();
+            auto packed1 = packed0 + count * attribSize;
+            auto packed2 = packed1 + count * attribSize;
+
+            auto a = values_.data();
+            auto b = a + numComponents;
+            auto c = b + numComponents;
+
+            /* Gather the packed attribute of the triangle corners of all samples */
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto& tri = triangles[samples[first + i].triangleIndex];
+                std::memcpy(packed0 + i * attribSize, input.Attrib(attribDesc, tri.a), attribSize);
+                std::memcpy(packed1 + i * attribSize, input.Attrib(attribDesc, tri.b), attribSize);
+                std::memcpy(packed2 + i * attribSize, input.Attrib(attribDesc, tri.c), attribSize);
+            }
+
+            DecodeComponents(attribDesc.format, packed0, numComponents, a);
+            DecodeComponents(attribDesc.format, packed1, numComponents, b);
+            DecodeComponents(attribDesc.format, packed2, numComponents, c);
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto& coords = samples[first + i].barycentricCoords;
+                for (auto j = i * components; j < (i + 1) * components; ++j)
+                    a[j] = a[j] * coords.x + b[j] * coords.y + c[j] * coords.z;
+            }
+
+            /* Encode the results and scatter them to the output vertices */
+            EncodeComponents(attribDesc.format, a, numComponents, packed0);
+
+            for (std::size_t i = 0; i < count; ++i)
+                std::memcpy(output.Attrib(attribDesc, first + i), packed0 + i * attribSize, attribSize);
+        }
+
+    private:
+
+        std::vector<Gs::Real>   values_;
+        std::vector<char>       packed_;
+
+};
+
 
 /* ----- Global functions ----- */
 
@@ -109,101 +575,182 @@ void InterpolateBarycentric(
 {
     ByteBuffer output(outputVertexBuffer, vertexDesc);
     ConstByteBuffer input(inputVertexBuffer, vertexDesc);
+    InterpolateVertex(vertexDesc, output, 0, input, v0, v1, v2, barycentricCoords);
+}
 
-    for (const auto& attribDesc : vertexDesc.attributes)
-    {
-        auto out = output.Attrib(attribDesc, 0);
+void InterpolateBarycentric(
+    const VertexDescriptor&         vertexDesc,
+    void*                           outputVertexBuffer,
+    const void*                     inputVertexBuffer,
+    const TriangleMesh::Triangle*   triangles,
+    const BarycentricSample*        samples,
+    std::size_t                     numSamples)
+{
+    ByteBuffer output(outputVertexBuffer, vertexDesc);
+    ConstByteBuffer input(inputVertexBuffer, vertexDesc);
+    PackedAttributeInterpolator packedInterpolator(vertexDesc);
 
-        auto in0 = input.Attrib(attribDesc, v0);
-        auto in1 = input.Attrib(attribDesc, v1);
-        auto in2 = input.Attrib(attribDesc, v2);
+    for (std::size_t first = 0; first < numSamples; first += interpolateBatchSize)
+    {
+        const auto count = std::min(numSamples - first, interpolateBatchSize);
 
-        for (std::uint32_t i = 0; i < attribDesc.components; ++i)
+        for (const auto& attribDesc : vertexDesc.attributes)
         {
-            out[i] = (
-                in0[i] * barycentricCoords.x +
-                in1[i] * barycentricCoords.y +
-                in2[i] * barycentricCoords.z
-            );
+            if (attribDesc.format == ComponentFormat::Real)
+            {
+                for (auto i = first; i < first + count; ++i)
+                {
+                    const auto& tri = triangles[samples[i].triangleIndex];
+                    InterpolateRealAttribute(
+                        attribDesc.components,
+                        output.Attrib(attribDesc, i),
+                        input.Attrib(attribDesc, tri.a),
+                        input.Attrib(attribDesc, tri.b),
+                        input.Attrib(attribDesc, tri.c),
+                        samples[i].barycentricCoords
+                    );
+                }
+            }
+            else
+                packedInterpolator.Interpolate(attribDesc, output, input, triangles, samples, first, count);
         }
     }
 }
 
-void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back)
+void InterpolateBarycentric(const TriangleMesh& mesh, const BarycentricSample* samples, std::size_t numSamples, TriangleMesh::Vertex* output)
+{
+    const auto vertices = mesh.vertices.data();
+    const auto triangles = mesh.triangles.data();
+
+    GetSharedThreadPool().ParallelFor(
+        numSamples, interpolateGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            InterpolateBarycentric(vertices, triangles, samples + begin, end - begin, output + begin);
+        }
+    );
+}
+
+void ClipMesh(const TriangleMesh& mesh, const Plane& clipPlane, TriangleMesh& front, TriangleMesh& back, bool sharedVertices)
 {
     /* Clear previous output meshes */
     front.Clear();
     back.Clear();
 
-    /* Clip each triangle against the clipping plane */
-    TriangleIndex triIdx = 0;
+    if (sharedVertices)
+    {
+        ClipMeshWithSharedVertices(mesh, clipPlane, front, back);
+        return;
+    }
 
-    const auto& vertices = mesh.vertices;
+    const auto numTriangles = mesh.triangles.size();
+    const auto numChunks    = (numTriangles + clipChunkSize - 1) / clipChunkSize;
 
-    for (const auto& indices : mesh.triangles)
-    {
-        /* Setup triangle coordinates */
-        Triangle3 tri(
-            vertices[indices.a].position,
-            vertices[indices.b].position,
-            vertices[indices.c].position
-        );
+    auto& pool = GetSharedThreadPool();
 
-        /* Clip triangle against plane */
-        ClippedPolygon<Gs::Real> frontPoly, backPoly;
-        auto rel = ClipTriangle<Gs::Real>(tri, clipPlane, frontPoly, backPoly);
+    /* Classify and clip each chunk of triangles, count its output vertices and triangles, and keep the polygons of the clipped triangles */
+    std::vector<PlaneRelation> relations(numTriangles);
+    std::vector<ClipCounts> frontCounts(numChunks), backCounts(numChunks);
+    std::vector<std::vector<ClippedPolygonPair>> clippedPolygons(numChunks);
 
-        switch (rel)
+    pool.ParallelFor(
+        numChunks, 1,
+        [&](std::size_t beginChunk, std::size_t endChunk)
         {
-            case PlaneRelation::InFrontOf:
+            for (auto chunk = beginChunk; chunk < endChunk; ++chunk)
             {
-                /* Add current triangle to front sided mesh */
-                auto count = front.vertices.size();
-                front.vertices.push_back(vertices[indices.a]);
-                front.vertices.push_back(vertices[indices.b]);
-                front.vertices.push_back(vertices[indices.c]);
-                front.AddTriangle(count, count + 1, count + 2);
-            }
-            break;
+                auto& frontCount = frontCounts[chunk];
+                auto& backCount = backCounts[chunk];
+                auto& polygons = clippedPolygons[chunk];
 
-            case PlaneRelation::Behind:
-            {
-                /* Add current triangle to back sided mesh */
-                auto count = back.vertices.size();
-                back.vertices.push_back(vertices[indices.a]);
-                back.vertices.push_back(vertices[indices.b]);
-                back.vertices.push_back(vertices[indices.c]);
-                back.AddTriangle(count, count + 1, count + 2);
-            }
-            break;
+                const auto begin = chunk * clipChunkSize;
+                const auto end = std::min(begin + clipChunkSize, numTriangles);
 
-            case PlaneRelation::Clipped:
-            {
-                auto count = front.vertices.size();
-                for (unsigned char i = 0; i < frontPoly.count; ++i)
+                for (auto i = begin; i < end; ++i)
                 {
-                    front.vertices.push_back(mesh.Barycentric(triIdx, frontPoly.vertices[i]));
-                    if (i >= 2)
-                        front.AddTriangle(count, count + i - 1, count + i);
+                    ClippedPolygonPair polygonPair;
+                    relations[i] = ClipMeshTriangle(mesh, mesh.triangles[i], clipPlane, polygonPair.front, polygonPair.back);
+
+                    switch (relations[i])
+                    {
+                        case PlaneRelation::InFrontOf:
+                            CountPolygon(frontCount, 3);
+                            break;
+                        case PlaneRelation::Behind:
+                            CountPolygon(backCount, 3);
+                            break;
+                        case PlaneRelation::Clipped:
+                            CountPolygon(frontCount, polygonPair.front.count);
+                            CountPolygon(backCount, polygonPair.back.count);
+                            polygons.push_back(polygonPair);
+                            break;
+                        default:
+                            break;
+                    }
                 }
+            }
+        }
+    );
+
+    /* Compute the output offsets of each chunk, so the output has the same order as a serial loop over all triangles */
+    if (!ResizeClipOutput(front, frontCounts) || !ResizeClipOutput(back, backCounts))
+    {
+        front.Clear();
+        back.Clear();
+        throw std::overflow_error(GM_EXCEPT_INFO("number of vertices exceeds the range of the mesh index type"));
+    }
+
+    /* Write the output of each chunk (the clipped triangles take their stored polygons in the same order) */
+    pool.ParallelFor(
+        numChunks, 1,
+        [&](std::size_t beginChunk, std::size_t endChunk)
+        {
+            for (auto chunk = beginChunk; chunk < endChunk; ++chunk)
+            {
+                ClipChunkWriter frontWriter(front, frontCounts[chunk]), backWriter(back, backCounts[chunk]);
+                auto polygonPair = clippedPolygons[chunk].cbegin();
 
-                count = back.vertices.size();
-                for (unsigned char i = 0; i < backPoly.count; ++i)
+                const auto begin = chunk * clipChunkSize;
+                const auto end = std::min(begin + clipChunkSize, numTriangles);
+
+                for (auto i = begin; i < end; ++i)
                 {
-                    back.vertices.push_back(mesh.Barycentric(triIdx, backPoly.vertices[i]));
-                    if (i >= 2)
-                        back.AddTriangle(count, count + i - 1, count + i);
+                    const auto& indices = mesh.triangles[i];
+
+                    switch (relations[i])
+                    {
+                        case PlaneRelation::InFrontOf:
+                        {
+                            /* Add current triangle to front sided mesh */
+                            frontWriter.CopyTriangle(mesh, indices);
+                        }
+                        break;
+
+                        case PlaneRelation::Behind:
+                        {
+                            /* Add current triangle to back sided mesh */
+                            backWriter.CopyTriangle(mesh, indices);
+                        }
+                        break;
+
+                        case PlaneRelation::Clipped:
+                        {
+                            frontWriter.AddPolygon(mesh, i, polygonPair->front);
+                            backWriter.AddPolygon(mesh, i, polygonPair->back);
+                            ++polygonPair;
+                        }
+                        break;
+
+                        default:
+                        break;
+                    }
                 }
             }
-            break;
-
-            default:
-            break;
         }
+    );
 
-        /* Track triangle index */
-        ++triIdx;
-    }
+    front.InvalidateCache();
+    back.InvalidateCache();
 }
 
 
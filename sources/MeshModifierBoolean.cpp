@@ -0,0 +1,130 @@
+/*
+ * MeshModifierBoolean.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
+#include "Except.h"
+
+#include <stdexcept>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+
+/* ----- Internal functions ----- */
+
+// Appends all vertices and triangles of the source mesh to the destination mesh.
+static void AppendMesh(TriangleMesh& dst, const TriangleMesh& src)
+{
+    const auto offset = dst.vertices.size();
+
+    if (offset + src.vertices.size() > TriangleMesh::MaxNumVertices())
+        throw std::overflow_error(GM_EXCEPT_INFO("too many vertices for boolean mesh operation"));
+
+    dst.vertices.insert(dst.vertices.end(), src.vertices.begin(), src.vertices.end());
+
+    dst.triangles.reserve(dst.triangles.size() + src.triangles.size());
+
+    for (const auto& tri : src.triangles)
+    {
+        dst.triangles.push_back(
+            TriangleMesh::Triangle(
+                static_cast<VertexIndex>(offset + tri.a),
+                static_cast<VertexIndex>(offset + tri.b),
+                static_cast<VertexIndex>(offset + tri.c)
+            )
+        );
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+void BooleanMesh(
+    const TriangleMesh&         lhs,
+    const TriangleMesh&         rhs,
+    const BooleanOperation      operation,
+    TriangleMesh&               result,
+    const BSPTreeDescriptor&    desc)
+{
+    /* Build both trees in parallel */
+    MeshBSPTree a, b;
+
+    GetSharedThreadPool().ParallelFor(
+        2, 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                if (i == 0)
+                    a.Build(lhs, desc);
+                else
+                    b.Build(rhs, desc);
+            }
+        }
+    );
+
+    /*
+    Clip the trees against each other. The inversions turn intersection and difference into a union of complements,
+    and clipping the inverted tree 'b' again removes the polygons which are coplanar in both trees from one of them.
+    */
+    switch (operation)
+    {
+        case BooleanOperation::Union:
+            a.ClipTo(b);
+            b.ClipTo(a);
+            b.Invert();
+            b.ClipTo(a);
+            b.Invert();
+            break;
+
+        case BooleanOperation::Intersection:
+            a.Invert();
+            b.ClipTo(a);
+            b.Invert();
+            a.ClipTo(b);
+            b.ClipTo(a);
+            a.Invert();
+            b.Invert();
+            break;
+
+        case BooleanOperation::Difference:
+            a.Invert();
+            a.ClipTo(b);
+            b.ClipTo(a);
+            b.Invert();
+            b.ClipTo(a);
+            b.Invert();
+            a.Invert();
+            b.Invert();
+            break;
+    }
+
+    /* Merge the remaining polygons of both trees */
+    TriangleMesh rhsResult;
+
+    a.GetMesh(result);
+    b.GetMesh(rhsResult);
+
+    AppendMesh(result, rhsResult);
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,265 @@
+/*
+ * MeshModifierComponents.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
+
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <utility>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t componentGrainSize = 8192;
+
+/*
+Lock-free disjoint-set forest over the vertex indices.
+Roots are always linked to the smaller root, so every parent index is less than or equal to its child index,
+which excludes cycles and makes the final root of each set its smallest vertex, independent of the order of the unions.
+*/
+class ConcurrentUnionFind
+{
+
+    public:
+
+        explicit ConcurrentUnionFind(std::size_t size) :
+            parents_ { new std::atomic<VertexIndex>[size] }
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                parents_[i].store(static_cast<VertexIndex>(i), std::memory_order_relaxed);
+        }
+
+        // Returns the root of the specified element, and halves the path to it.
+        VertexIndex Find(VertexIndex x)
+        {
+            while (true)
+            {
+                auto parent = parents_[x].load(std::memory_order_relaxed);
+                if (parent == x)
+                    return x;
+
+                auto grandParent = parents_[parent].load(std::memory_order_relaxed);
+                if (parent != grandParent)
+                {
+                    /* Path halving; a failed exchange only means another thread has already shortened the path */
+                    parents_[x].compare_exchange_weak(parent, grandParent, std::memory_order_relaxed);
+                }
+
+                x = grandParent;
+            }
+        }
+
+        // Merges the sets of the two specified elements.
+        void Unite(VertexIndex a, VertexIndex b)
+        {
+            while (true)
+            {
+                a = Find(a);
+                b = Find(b);
+
+                if (a == b)
+                    return;
+
+                /* Link the greater root to the smaller one; retry if the greater root has been linked concurrently */
+                if (a < b)
+                    std::swap(a, b);
+
+                auto expected = a;
+                if (parents_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed))
+                    return;
+            }
+        }
+
+    private:
+
+        std::unique_ptr<std::atomic<VertexIndex>[]> parents_;
+
+};
+
+
+/* ----- Global functions ----- */
+
+std::size_t FindConnectedComponents(const TriangleMesh& mesh, std::vector<std::size_t>& componentIDs, Gs::Real weldEpsilon)
+{
+    const auto numVerts     = mesh.vertices.size();
+    const auto numTriangles = mesh.triangles.size();
+
+    componentIDs.resize(numTriangles);
+
+    ConcurrentUnionFind sets(numVerts);
+
+    auto& pool = GetSharedThreadPool();
+
+    /* Join vertices at equal positions */
+    if (weldEpsilon >= Gs::Real(0))
+    {
+        std::vector<VertexIndex> canonicalIndices;
+        FindCanonicalVertices(mesh, weldEpsilon, canonicalIndices);
+
+        pool.ParallelFor(
+            numVerts, componentGrainSize,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                {
+                    if (canonicalIndices[i] != i)
+                        sets.Unite(static_cast<VertexIndex>(i), canonicalIndices[i]);
+                }
+            }
+        );
+    }
+
+    /* Join the vertices of each triangle */
+    pool.ParallelFor(
+        numTriangles, componentGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+                sets.Unite(tri.a, tri.b);
+                sets.Unite(tri.a, tri.c);
+            }
+        }
+    );
+
+    /* Store the root vertex of each triangle (all unions are complete, so the roots are final) */
+    pool.ParallelFor(
+        numTriangles, componentGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                componentIDs[i] = sets.Find(mesh.triangles[i].a);
+        }
+    );
+
+    /* Number the roots in the order of their first triangle */
+    const auto invalidID = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t> rootIDs(numVerts, invalidID);
+    std::size_t numComponents = 0;
+
+    for (auto& id : componentIDs)
+    {
+        auto& rootID = rootIDs[id];
+        if (rootID == invalidID)
+            rootID = numComponents++;
+        id = rootID;
+    }
+
+    return numComponents;
+}
+
+std::vector<TriangleMesh> SplitConnectedComponents(const TriangleMesh& mesh, Gs::Real weldEpsilon)
+{
+    const auto numVerts     = mesh.vertices.size();
+    const auto numTriangles = mesh.triangles.size();
+
+    std::vector<std::size_t> componentIDs;
+    const auto numComponents = FindConnectedComponents(mesh, componentIDs, weldEpsilon);
+
+    /*
+    Sort triangles and referenced vertices by their component (counting sort, which preserves their order).
+    Each vertex belongs to exactly one component, since all triangles that share a vertex are connected.
+    */
+    const auto invalidID = std::numeric_limits<std::size_t>::max();
+
+    std::vector<std::size_t> vertexIDs(numVerts, invalidID);
+    std::vector<std::size_t> triangleOffsets(numComponents + 1, 0), vertexOffsets(numComponents + 1, 0);
+
+    for (std::size_t i = 0; i < numTriangles; ++i)
+    {
+        const auto& tri = mesh.triangles[i];
+        const auto id = componentIDs[i];
+
+        ++triangleOffsets[id + 1];
+
+        for (int j = 0; j < 3; ++j)
+        {
+            if (vertexIDs[tri[j]] == invalidID)
+            {
+                vertexIDs[tri[j]] = id;
+                ++vertexOffsets[id + 1];
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < numComponents; ++i)
+    {
+        triangleOffsets[i + 1] += triangleOffsets[i];
+        vertexOffsets[i + 1] += vertexOffsets[i];
+    }
+
+    std::vector<std::size_t> sortedTriangles(numTriangles), sortedVertices(vertexOffsets.back());
+    std::vector<VertexIndex> localIndices(numVerts);
+
+    {
+        std::vector<std::size_t> triangleCursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+        std::vector<std::size_t> vertexCursors(vertexOffsets.begin(), vertexOffsets.end() - 1);
+
+        for (std::size_t i = 0; i < numTriangles; ++i)
+            sortedTriangles[triangleCursors[componentIDs[i]]++] = i;
+
+        for (std::size_t i = 0; i < numVerts; ++i)
+        {
+            const auto id = vertexIDs[i];
+            if (id != invalidID)
+            {
+                localIndices[i] = static_cast<VertexIndex>(vertexCursors[id] - vertexOffsets[id]);
+                sortedVertices[vertexCursors[id]++] = i;
+            }
+        }
+    }
+
+    /* Fill the component meshes in parallel (one component per chunk, since their sizes may differ greatly) */
+    std::vector<TriangleMesh> components(numComponents);
+
+    GetSharedThreadPool().ParallelFor(
+        numComponents, 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto& component = components[i];
+
+                component.vertices.reserve(vertexOffsets[i + 1] - vertexOffsets[i]);
+                for (auto j = vertexOffsets[i]; j < vertexOffsets[i + 1]; ++j)
+                    component.vertices.push_back(mesh.vertices[sortedVertices[j]]);
+
+                component.triangles.reserve(triangleOffsets[i + 1] - triangleOffsets[i]);
+                for (auto j = triangleOffsets[i]; j < triangleOffsets[i + 1]; ++j)
+                {
+                    const auto& tri = mesh.triangles[sortedTriangles[j]];
+                    component.triangles.push_back({ localIndices[tri.a], localIndices[tri.b], localIndices[tri.c] });
+                }
+            }
+        }
+    );
+
+    return components;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
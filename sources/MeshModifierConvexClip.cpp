@@ -0,0 +1,234 @@
+/*
+ * MeshModifierConvexClip.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/PlaneCollision.h>
+
+#include <algorithm>
+#include <vector>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const VertexIndex invalidIndex = static_cast<VertexIndex>(TriangleMesh::MaxNumVertices());
+
+// Vertex of a clipped polygon, with its barycentric coordinates in the source triangle.
+struct ClipVertex
+{
+    Gs::Vector3 position;
+    Gs::Vector3 barycentric;
+    VertexIndex source;         // Source vertex index, or "invalidIndex" for a vertex on a clipping plane
+};
+
+// Clips the polygon by the plane (Sutherland-Hodgman), and keeps the part behind the plane (including the tolerance).
+static void ClipPolygon(
+    const std::vector<ClipVertex>&  poly,
+    const Plane&                    plane,
+    std::vector<ClipVertex>&        output,
+    std::vector<Gs::Real>&          distances)
+{
+    const auto epsilon = Gs::Epsilon<Gs::Real>();
+    const auto count = poly.size();
+
+    distances.resize(count);
+    for (std::size_t i = 0; i < count; ++i)
+        distances[i] = SgnDistanceToPlane(plane, poly[i].position);
+
+    output.clear();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto j = (i + 1) % count;
+        const auto d0 = distances[i];
+        const auto d1 = distances[j];
+
+        if (d0 <= epsilon)
+            output.push_back(poly[i]);
+
+        /* Insert a vertex where the edge crosses the plane (vertices within the tolerance do not split an edge) */
+        if ((d0 > epsilon && d1 < -epsilon) || (d0 < -epsilon && d1 > epsilon))
+        {
+            const auto t = d0 / (d0 - d1);
+            const auto& a = poly[i];
+            const auto& b = poly[j];
+            output.push_back(
+                {
+                    a.position    + (b.position    - a.position   ) * t,
+                    a.barycentric + (b.barycentric - a.barycentric) * t,
+                    invalidIndex
+                }
+            );
+        }
+    }
+}
+
+// Clips the mesh against the specified planes, whose normals point out of the clipping volume.
+static void ClipMeshWithPlanes(const TriangleMesh& mesh, const Plane* planes, std::size_t numPlanes, TriangleMesh& inside)
+{
+    inside.Clear();
+
+    if (mesh.triangles.empty())
+        return;
+
+    /* Select the planes which intersect the bounding box of the mesh */
+    const auto meshBox = mesh.BoundingBox();
+
+    std::vector<const Plane*> activePlanes;
+    activePlanes.reserve(numPlanes);
+
+    for (std::size_t i = 0; i < numPlanes; ++i)
+    {
+        switch (RelationToPlane(planes[i], meshBox))
+        {
+            case PlaneRelation::InFrontOf:
+                return;
+            case PlaneRelation::Clipped:
+                activePlanes.push_back(&planes[i]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    /* Clip each triangle against all planes which intersect its bounding box */
+    std::vector<VertexIndex> remap(mesh.vertices.size(), invalidIndex);
+
+    auto CopyVertex = [&](VertexIndex v)
+    {
+        auto& index = remap[v];
+        if (index == invalidIndex)
+        {
+            const auto& vert = mesh.vertices[v];
+            index = inside.AddVertex(vert.position, vert.normal, vert.texCoord);
+        }
+        return index;
+    };
+
+    std::vector<ClipVertex> poly, clippedPoly;
+    std::vector<Gs::Real> distances;
+    std::vector<VertexIndex> polyIndices;
+
+    for (TriangleIndex triIdx = 0; triIdx < mesh.triangles.size(); ++triIdx)
+    {
+        const auto& indices = mesh.triangles[triIdx];
+
+        const auto& a = mesh.vertices[indices.a].position;
+        const auto& b = mesh.vertices[indices.b].position;
+        const auto& c = mesh.vertices[indices.c].position;
+
+        AABB3 triBox(a, a);
+        triBox.Insert(b);
+        triBox.Insert(c);
+
+        bool outside = false;
+        poly.clear();
+
+        for (auto plane : activePlanes)
+        {
+            auto rel = RelationToPlane(*plane, triBox);
+
+            if (rel == PlaneRelation::InFrontOf)
+            {
+                /* Triangle is outside of the clipping volume */
+                outside = true;
+                break;
+            }
+
+            if (rel == PlaneRelation::Clipped)
+            {
+                if (poly.empty())
+                {
+                    poly.push_back({ a, Gs::Vector3(1, 0, 0), indices.a });
+                    poly.push_back({ b, Gs::Vector3(0, 1, 0), indices.b });
+                    poly.push_back({ c, Gs::Vector3(0, 0, 1), indices.c });
+                }
+
+                ClipPolygon(poly, *plane, clippedPoly, distances);
+                poly.swap(clippedPoly);
+
+                if (poly.size() < 3)
+                {
+                    outside = true;
+                    break;
+                }
+            }
+        }
+
+        if (outside)
+            continue;
+
+        if (poly.empty())
+        {
+            /* Add unclipped triangle */
+            auto v0 = CopyVertex(indices.a);
+            auto v1 = CopyVertex(indices.b);
+            auto v2 = CopyVertex(indices.c);
+            inside.AddTriangle(v0, v1, v2);
+        }
+        else
+        {
+            /* Add clipped polygon as triangle fan */
+            polyIndices.clear();
+
+            for (const auto& v : poly)
+            {
+                if (v.source != invalidIndex)
+                    polyIndices.push_back(CopyVertex(v.source));
+                else
+                {
+                    auto vert = mesh.Barycentric(triIdx, v.barycentric);
+                    polyIndices.push_back(inside.AddVertex(vert.position, vert.normal, vert.texCoord));
+                }
+            }
+
+            for (std::size_t i = 2; i < polyIndices.size(); ++i)
+                inside.AddTriangle(polyIndices[0], polyIndices[i - 1], polyIndices[i]);
+        }
+    }
+}
+
+
+/* ----- Global functions ----- */
+
+void ClipMesh(const TriangleMesh& mesh, const ConvexHull& convexHull, TriangleMesh& inside)
+{
+    ClipMeshWithPlanes(mesh, convexHull.planes.data(), convexHull.planes.size(), inside);
+}
+
+void ClipMesh(const TriangleMesh& mesh, const Frustum& frustum, TriangleMesh& inside)
+{
+    const Plane planes[6] =
+    {
+        frustum.GetPlane(FrustumPlane::Near),
+        frustum.GetPlane(FrustumPlane::Left),
+        frustum.GetPlane(FrustumPlane::Right),
+        frustum.GetPlane(FrustumPlane::Top),
+        frustum.GetPlane(FrustumPlane::Bottom),
+        frustum.GetPlane(FrustumPlane::Far),
+    };
+    ClipMeshWithPlanes(mesh, planes, 6, inside);
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
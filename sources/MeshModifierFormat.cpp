@@ -0,0 +1,480 @@
+/*
+ * MeshModifierFormat.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include "SIMDDetails.h"
+#include "Except.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+/* ----- Internal functions ----- */
+
+static std::uint32_t FloatToBits(float f)
+{
+    std::uint32_t bits;
+    std::memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static float BitsToFloat(std::uint32_t bits)
+{
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static float HalfToFloat(std::uint16_t h)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+    const std::uint32_t exp  = (h >> 10) & 0x1Fu;
+    const std::uint32_t mant = h & 0x3FFu;
+
+    if (exp == 0)
+    {
+        /* Zero or subnormal: mant * 2^-24 is exact in single precision */
+        return BitsToFloat(sign | FloatToBits(static_cast<float>(mant) * (1.0f / 16777216.0f)));
+    }
+    if (exp == 31)
+    {
+        /* Infinity or NaN */
+        return BitsToFloat(sign | 0x7F800000u | (mant << 13));
+    }
+    return BitsToFloat(sign | ((exp + (127 - 15)) << 23) | (mant << 13));
+}
+
+// Converts the float to half precision with rounding to the nearest even value.
+static std::uint16_t FloatToHalf(float f)
+{
+    auto bits = FloatToBits(f);
+
+    const auto sign = static_cast<std::uint16_t>((bits >> 16) & 0x8000u);
+    bits &= 0x7FFFFFFFu;
+
+    if (bits > 0x7F800000u)
+        return static_cast<std::uint16_t>(sign | 0x7E00u);
+    if (bits >= 0x47800000u)
+    {
+        /* Values from 65536 on are beyond the range (smaller values round to infinity below) */
+        return static_cast<std::uint16_t>(sign | 0x7C00u);
+    }
+    if (bits < 0x38800000u)
+    {
+        /* Subnormal result: the scaling by 2^24 is exact, and the conversion rounds to the nearest even integer */
+        auto value = BitsToFloat(bits) * 16777216.0f;
+        return static_cast<std::uint16_t>(sign | static_cast<std::uint16_t>(std::nearbyint(value)));
+    }
+
+    /* Rebias the exponent and round the mantissa (ties to the even mantissa) */
+    const auto mantOdd = (bits >> 13) & 1u;
+    bits += (static_cast<std::uint32_t>(15 - 127) << 23) + 0xFFFu + mantOdd;
+    return static_cast<std::uint16_t>(sign | (bits >> 13));
+}
+
+template <typename TInt>
+static Gs::Real DecodeUNorm(TInt value)
+{
+    return static_cast<Gs::Real>(value) * (Gs::Real(1) / static_cast<Gs::Real>(std::numeric_limits<TInt>::max()));
+}
+
+template <typename TInt>
+static Gs::Real DecodeSNorm(TInt value)
+{
+    return std::max(Gs::Real(-1), static_cast<Gs::Real>(value) * (Gs::Real(1) / static_cast<Gs::Real>(std::numeric_limits<TInt>::max())));
+}
+
+template <typename TInt>
+static TInt EncodeUNorm(Gs::Real value)
+{
+    const auto maxValue = static_cast<Gs::Real>(std::numeric_limits<TInt>::max());
+    return static_cast<TInt>(std::max(Gs::Real(0), std::min(value, Gs::Real(1))) * maxValue + Gs::Real(0.5));
+}
+
+template <typename TInt>
+static TInt EncodeSNorm(Gs::Real value)
+{
+    const auto maxValue = static_cast<Gs::Real>(std::numeric_limits<TInt>::max());
+    const auto scaled = std::max(Gs::Real(-1), std::min(value, Gs::Real(1))) * maxValue;
+    return static_cast<TInt>(scaled >= Gs::Real(0) ? scaled + Gs::Real(0.5) : scaled - Gs::Real(0.5));
+}
+
+/*
+Generic conversion kernels for contiguous components. The single precision specializations below use SSE2 and process the remainder with the generic kernels.
+*/
+
+template <typename T>
+static void DecodeHalfs(const std::uint16_t* input, std::size_t count, T* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = static_cast<T>(HalfToFloat(input[i]));
+}
+
+template <typename T>
+static void EncodeHalfs(const T* input, std::size_t count, std::uint16_t* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = FloatToHalf(static_cast<float>(input[i]));
+}
+
+template <typename T, typename TInt>
+static void DecodeUNorms(const TInt* input, std::size_t count, T* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = DecodeUNorm(input[i]);
+}
+
+template <typename T, typename TInt>
+static void EncodeUNorms(const T* input, std::size_t count, TInt* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = EncodeUNorm<TInt>(input[i]);
+}
+
+#ifdef GM_SIMD_SSE2
+
+// Converts 4 halfs (in the lower 16 bits of each lane) to floats, including subnormals, infinity, and NaN.
+static inline __m128 HalfToFloatSSE2(__m128i h)
+{
+    const auto maskNoSign   = _mm_set1_epi32(0x7FFF);
+    const auto magic        = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+    const auto wasInfNaN    = _mm_set1_epi32(0x7BFF);
+    const auto expInfNaN    = _mm_set1_epi32(255 << 23);
+
+    auto expMant    = _mm_and_si128(h, maskNoSign);
+    auto shifted    = _mm_slli_epi32(expMant, 13);
+    auto scaled     = _mm_mul_ps(_mm_castsi128_ps(shifted), magic);
+    auto isInfNaN   = _mm_cmpgt_epi32(expMant, wasInfNaN);
+    auto sign       = _mm_slli_epi32(_mm_xor_si128(h, expMant), 16);
+    auto infNaNExp  = _mm_and_si128(isInfNaN, expInfNaN);
+
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNaNExp)));
+}
+
+// Converts 4 floats to halfs (in the lower 16 bits of each lane) with rounding to the nearest even value, like "FloatToHalf".
+static inline __m128i FloatToHalfSSE2(__m128 f)
+{
+    const auto maskSign         = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    const auto f16Max           = _mm_set1_epi32((127 + 16) << 23);
+    const auto nanBit           = _mm_set1_epi32(0x200);
+    const auto infinityAsF16    = _mm_set1_epi32(0x7C00);
+    const auto minNormal        = _mm_set1_epi32((127 - 14) << 23);
+    const auto subnormMagic     = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const auto normalBias       = _mm_set1_epi32(0xFFF - ((127 - 15) << 23));
+
+    auto justSign   = _mm_and_si128(_mm_castps_si128(f), maskSign);
+    auto absBits    = _mm_xor_si128(_mm_castps_si128(f), justSign);
+    auto absFloat   = _mm_castsi128_ps(absBits);
+
+    auto isNaN      = _mm_castps_si128(_mm_cmpunord_ps(absFloat, absFloat));
+    auto isRegular  = _mm_cmpgt_epi32(f16Max, absBits);
+    auto infOrNaN   = _mm_or_si128(_mm_and_si128(isNaN, nanBit), infinityAsF16);
+
+    /* Subnormal results: the float addition rounds the mantissa into the lower bits */
+    auto isSubnorm  = _mm_cmpgt_epi32(minNormal, absBits);
+    auto subnorm    = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absFloat, _mm_castsi128_ps(subnormMagic))), subnormMagic);
+
+    /* Normal results: rebias the exponent and round the mantissa (ties to the even mantissa) */
+    auto mantOdd    = _mm_srai_epi32(_mm_slli_epi32(absBits, 31 - 13), 31);
+    auto normal     = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absBits, normalBias), mantOdd), 13);
+
+    auto nonNaN     = _mm_or_si128(_mm_and_si128(isSubnorm, subnorm), _mm_andnot_si128(isSubnorm, normal));
+    auto joined     = _mm_or_si128(_mm_and_si128(isRegular, nonNaN), _mm_andnot_si128(isRegular, infOrNaN));
+
+    return _mm_or_si128(joined, _mm_srli_epi32(justSign, 16));
+}
+
+// Packs the lower 16 bits of each 32-bit lane of both vectors (SSE2 only has a signed saturating pack, so the values are sign-extended first).
+static inline __m128i PackLow16SSE2(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+
+template <>
+inline void DecodeHalfs<float>(const std::uint16_t* input, std::size_t count, float* output)
+{
+    const auto zero = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm_storeu_ps(output + i,     HalfToFloatSSE2(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(output + i + 4, HalfToFloatSSE2(_mm_unpackhi_epi16(h, zero)));
+    }
+
+    for (; i < count; ++i)
+        output[i] = HalfToFloat(input[i]);
+}
+
+template <>
+inline void EncodeHalfs<float>(const float* input, std::size_t count, std::uint16_t* output)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto lo = FloatToHalfSSE2(_mm_loadu_ps(input + i));
+        auto hi = FloatToHalfSSE2(_mm_loadu_ps(input + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), PackLow16SSE2(lo, hi));
+    }
+
+    for (; i < count; ++i)
+        output[i] = FloatToHalf(input[i]);
+}
+
+template <>
+inline void DecodeUNorms<float, std::uint8_t>(const std::uint8_t* input, std::size_t count, float* output)
+{
+    const auto zero     = _mm_setzero_si128();
+    const auto scale    = _mm_set1_ps(1.0f / 255.0f);
+
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        auto q   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        auto lo  = _mm_unpacklo_epi8(q, zero);
+        auto hi  = _mm_unpackhi_epi8(q, zero);
+        _mm_storeu_ps(output + i,      _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(output + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(output + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(output + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+
+    for (; i < count; ++i)
+        output[i] = DecodeUNorm(input[i]);
+}
+
+template <>
+inline void DecodeUNorms<float, std::uint16_t>(const std::uint16_t* input, std::size_t count, float* output)
+{
+    const auto zero     = _mm_setzero_si128();
+    const auto scale    = _mm_set1_ps(1.0f / 65535.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm_storeu_ps(output + i,     _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(q, zero)), scale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(q, zero)), scale));
+    }
+
+    for (; i < count; ++i)
+        output[i] = DecodeUNorm(input[i]);
+}
+
+// Clamps 4 floats to [0, 1], and scales and rounds them like "EncodeUNorm".
+static inline __m128i EncodeUNormSSE2(__m128 f, __m128 maxValue)
+{
+    const auto zero = _mm_setzero_ps();
+    const auto one  = _mm_set1_ps(1.0f);
+    const auto half = _mm_set1_ps(0.5f);
+
+    /* "max" returns its second operand for NaN, which maps NaN to zero like the scalar kernel */
+    auto clamped = _mm_min_ps(_mm_max_ps(f, zero), one);
+    return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(clamped, maxValue), half));
+}
+
+template <>
+inline void EncodeUNorms<float, std::uint8_t>(const float* input, std::size_t count, std::uint8_t* output)
+{
+    const auto maxValue = _mm_set1_ps(255.0f);
+
+    std::size_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        auto q0 = EncodeUNormSSE2(_mm_loadu_ps(input + i     ), maxValue);
+        auto q1 = EncodeUNormSSE2(_mm_loadu_ps(input + i +  4), maxValue);
+        auto q2 = EncodeUNormSSE2(_mm_loadu_ps(input + i +  8), maxValue);
+        auto q3 = EncodeUNormSSE2(_mm_loadu_ps(input + i + 12), maxValue);
+        auto lo = _mm_packs_epi32(q0, q1);
+        auto hi = _mm_packs_epi32(q2, q3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_packus_epi16(lo, hi));
+    }
+
+    for (; i < count; ++i)
+        output[i] = EncodeUNorm<std::uint8_t>(input[i]);
+}
+
+template <>
+inline void EncodeUNorms<float, std::uint16_t>(const float* input, std::size_t count, std::uint16_t* output)
+{
+    const auto maxValue = _mm_set1_ps(65535.0f);
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        auto lo = EncodeUNormSSE2(_mm_loadu_ps(input + i    ), maxValue);
+        auto hi = EncodeUNormSSE2(_mm_loadu_ps(input + i + 4), maxValue);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), PackLow16SSE2(lo, hi));
+    }
+
+    for (; i < count; ++i)
+        output[i] = EncodeUNorm<std::uint16_t>(input[i]);
+}
+
+#endif // /GM_SIMD_SSE2
+
+
+/* ----- Global functions ----- */
+
+std::size_t GetComponentSize(ComponentFormat format)
+{
+    switch (format)
+    {
+        case ComponentFormat::Real:     return sizeof(Gs::Real);
+        case ComponentFormat::Float32:  return sizeof(float);
+        case ComponentFormat::Float16:  return sizeof(std::uint16_t);
+        case ComponentFormat::UNorm8:   return sizeof(std::uint8_t);
+        case ComponentFormat::SNorm8:   return sizeof(std::int8_t);
+        case ComponentFormat::UNorm16:  return sizeof(std::uint16_t);
+        case ComponentFormat::SNorm16:  return sizeof(std::int16_t);
+    }
+    throw std::invalid_argument(GM_EXCEPT_INFO("invalid component format"));
+}
+
+/*
+The input and output buffers of packed vertices are not necessarily aligned to their component size,
+so the components are copied into aligned blocks on the stack before they are converted.
+*/
+
+// Number of components that are converted at once.
+static const std::size_t convertBlockSize = 256;
+
+template <typename T>
+static void DecodeBlocks(const void* input, std::size_t count, Gs::Real* output, void (*decode)(const T*, std::size_t, Gs::Real*))
+{
+    T block[convertBlockSize];
+    auto src = reinterpret_cast<const char*>(input);
+
+    for (std::size_t first = 0; first < count; first += convertBlockSize)
+    {
+        const auto n = std::min(count - first, convertBlockSize);
+        std::memcpy(block, src + first * sizeof(T), n * sizeof(T));
+        decode(block, n, output + first);
+    }
+}
+
+template <typename T>
+static void EncodeBlocks(const Gs::Real* input, std::size_t count, void* output, void (*encode)(const Gs::Real*, std::size_t, T*))
+{
+    T block[convertBlockSize];
+    auto dst = reinterpret_cast<char*>(output);
+
+    for (std::size_t first = 0; first < count; first += convertBlockSize)
+    {
+        const auto n = std::min(count - first, convertBlockSize);
+        encode(input + first, n, block);
+        std::memcpy(dst + first * sizeof(T), block, n * sizeof(T));
+    }
+}
+
+static void DecodeFloats(const float* input, std::size_t count, Gs::Real* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = static_cast<Gs::Real>(input[i]);
+}
+
+static void EncodeFloats(const Gs::Real* input, std::size_t count, float* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = static_cast<float>(input[i]);
+}
+
+template <typename TInt>
+static void DecodeSNorms(const TInt* input, std::size_t count, Gs::Real* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = DecodeSNorm(input[i]);
+}
+
+template <typename TInt>
+static void EncodeSNorms(const Gs::Real* input, std::size_t count, TInt* output)
+{
+    for (std::size_t i = 0; i < count; ++i)
+        output[i] = EncodeSNorm<TInt>(input[i]);
+}
+
+void DecodeComponents(ComponentFormat format, const void* input, std::size_t count, Gs::Real* output)
+{
+    switch (format)
+    {
+        case ComponentFormat::Real:
+            std::memcpy(output, input, count * sizeof(Gs::Real));
+            break;
+        case ComponentFormat::Float32:
+            DecodeBlocks<float>(input, count, output, DecodeFloats);
+            break;
+        case ComponentFormat::Float16:
+            DecodeBlocks<std::uint16_t>(input, count, output, DecodeHalfs<Gs::Real>);
+            break;
+        case ComponentFormat::UNorm8:
+            DecodeBlocks<std::uint8_t>(input, count, output, DecodeUNorms<Gs::Real, std::uint8_t>);
+            break;
+        case ComponentFormat::SNorm8:
+            DecodeBlocks<std::int8_t>(input, count, output, DecodeSNorms<std::int8_t>);
+            break;
+        case ComponentFormat::UNorm16:
+            DecodeBlocks<std::uint16_t>(input, count, output, DecodeUNorms<Gs::Real, std::uint16_t>);
+            break;
+        case ComponentFormat::SNorm16:
+            DecodeBlocks<std::int16_t>(input, count, output, DecodeSNorms<std::int16_t>);
+            break;
+        default:
+            throw std::invalid_argument(GM_EXCEPT_INFO("invalid component format"));
+    }
+}
+
+void EncodeComponents(ComponentFormat format, const Gs::Real* input, std::size_t count, void* output)
+{
+    switch (format)
+    {
+        case ComponentFormat::Real:
+            std::memcpy(output, input, count * sizeof(Gs::Real));
+            break;
+        case ComponentFormat::Float32:
+            EncodeBlocks<float>(input, count, output, EncodeFloats);
+            break;
+        case ComponentFormat::Float16:
+            EncodeBlocks<std::uint16_t>(input, count, output, EncodeHalfs<Gs::Real>);
+            break;
+        case ComponentFormat::UNorm8:
+            EncodeBlocks<std::uint8_t>(input, count, output, EncodeUNorms<Gs::Real, std::uint8_t>);
+            break;
+        case ComponentFormat::SNorm8:
+            EncodeBlocks<std::int8_t>(input, count, output, EncodeSNorms<std::int8_t>);
+            break;
+        case ComponentFormat::UNorm16:
+            EncodeBlocks<std::uint16_t>(input, count, output, EncodeUNorms<Gs::Real, std::uint16_t>);
+            break;
+        case ComponentFormat::SNorm16:
+            EncodeBlocks<std::int16_t>(input, count, output, EncodeSNorms<std::int16_t>);
+            break;
+        default:
+            throw std::invalid_argument(GM_EXCEPT_INFO("invalid component format"));
+    }
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
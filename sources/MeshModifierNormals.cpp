@@ -0,0 +1,376 @@
+/*
+ * MeshModifierNormals.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
+#include "Except.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+using Triangle      = TriangleMesh::Triangle;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t normalGrainSize = 4096;
+
+// Minimal cosine between two corner normals to be assigned to the same vertex (approx. 0.5 degrees).
+static const Gs::Real normalEqualityCosine = Gs::Real(0.99996);
+
+/*
+Vertex-to-triangle table as compressed sparse rows (CSR). Each row is sorted in ascending order,
+and degenerated triangles are only listed once per vertex. If 'remap' is not null, the triangle indices are remapped first.
+*/
+struct VertexTriangleTable
+{
+    VertexTriangleTable(const TriangleMesh::TriangleArray& triangles, std::size_t numVertices, const VertexIndex* remap = nullptr)
+    {
+        offsets.assign(numVertices + 1, 0);
+
+        auto Map = [remap](VertexIndex v) -> VertexIndex
+        {
+            return (remap != nullptr ? remap[v] : v);
+        };
+
+        /* Count triangles per vertex */
+        for (const auto& tri : triangles)
+        {
+            const auto a = Map(tri.a), b = Map(tri.b), c = Map(tri.c);
+            ++offsets[a + 1];
+            if (b != a)
+                ++offsets[b + 1];
+            if (c != a && c != b)
+                ++offsets[c + 1];
+        }
+
+        for (std::size_t i = 0; i < numVertices; ++i)
+            offsets[i + 1] += offsets[i];
+
+        /* Fill rows (triangles are visited in ascending order, so each row is sorted) */
+        entries.resize(offsets.back());
+
+        std::vector<TriangleIndex> cursor(offsets.begin(), offsets.end() - 1);
+
+        for (TriangleIndex i = 0; i < triangles.size(); ++i)
+        {
+            const auto a = Map(triangles[i].a), b = Map(triangles[i].b), c = Map(triangles[i].c);
+            entries[cursor[a]++] = i;
+            if (b != a)
+                entries[cursor[b]++] = i;
+            if (c != a && c != b)
+                entries[cursor[c]++] = i;
+        }
+    }
+
+    std::vector<TriangleIndex> offsets; // Size: numVertices + 1
+    std::vector<TriangleIndex> entries;
+};
+
+/*
+Computes the normal (in unit length) and the angle of each corner of the specified triangle.
+Degenerated triangles (whose sine of the largest angle is below epsilon) get a zero normal and zero angles,
+otherwise their arbitrary normal could dominate a vertex (e.g. at the poles of a sphere).
+*/
+static void ComputeNormalAndAngles(const Gs::Vector3& a, const Gs::Vector3& b, const Gs::Vector3& c, Gs::Vector3& normal, Gs::Real* angles)
+{
+    const auto e0 = b - a, e1 = c - b, e2 = a - c;
+
+    normal = Gs::Cross(e0, -e2);
+
+    const auto area2        = normal.Length();
+    const auto maxEdgeSq    = std::max({ e0.LengthSq(), e1.LengthSq(), e2.LengthSq() });
+
+    if (area2 <= maxEdgeSq * Gs::Epsilon<Gs::Real>())
+    {
+        normal = Gs::Vector3();
+        angles[0] = angles[1] = angles[2] = Gs::Real(0);
+    }
+    else
+    {
+        normal *= (Gs::Real(1) / area2);
+        angles[0] = std::atan2(area2, -Gs::Dot(e0, e2));
+        angles[1] = std::atan2(area2, -Gs::Dot(e1, e0));
+        angles[2] = std::atan2(area2, -Gs::Dot(e2, e1));
+    }
+}
+
+// Computes the normals and the corner angles of all triangles in parallel.
+static void ComputeFaceNormalsAndAngles(const TriangleMesh& mesh, std::vector<Gs::Vector3>& faceNormals, std::vector<Gs::Real>& cornerAngles)
+{
+    const auto numTriangles = mesh.triangles.size();
+
+    faceNormals.resize(numTriangles);
+    cornerAngles.resize(numTriangles * 3);
+
+    GetSharedThreadPool().ParallelFor(
+        numTriangles, normalGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+                const auto& a = mesh.vertices[tri.a].position;
+                const auto& b = mesh.vertices[tri.b].position;
+                const auto& c = mesh.vertices[tri.c].position;
+                ComputeNormalAndAngles(a, b, c, faceNormals[i], &cornerAngles[i*3]);
+            }
+        }
+    );
+}
+
+// Returns the corner (0, 1, or 2) of the specified triangle whose (optionally remapped) index equals the specified vertex.
+static int FindCorner(const Triangle& tri, VertexIndex vertex, const VertexIndex* remap = nullptr)
+{
+    if (remap != nullptr)
+        return (remap[tri.a] == vertex ? 0 : remap[tri.b] == vertex ? 1 : 2);
+    else
+        return (tri.a == vertex ? 0 : tri.b == vertex ? 1 : 2);
+}
+
+// Returns a unit vector that is orthogonal to the specified unit vector.
+static Gs::Vector3 AnyOrthogonalVector(const Gs::Vector3& v)
+{
+    if (std::abs(v.x) < std::abs(v.y))
+        return Gs::Cross(v, Gs::Vector3(1, 0, 0)).Normalized();
+    else
+        return Gs::Cross(v, Gs::Vector3(0, 1, 0)).Normalized();
+}
+
+
+/* ----- Global functions ----- */
+
+void ComputeCornerNormals(const TriangleMesh& mesh, Gs::Real creaseAngle, std::vector<Gs::Vector3>& cornerNormals)
+{
+    const auto numTriangles = mesh.triangles.size();
+
+    cornerNormals.resize(numTriangles * 3);
+
+    /* Compute face normals and corner angles */
+    std::vector<Gs::Vector3> faceNormals;
+    std::vector<Gs::Real> cornerAngles;
+    ComputeFaceNormalsAndAngles(mesh, faceNormals, cornerAngles);
+
+    /* Build vertex-to-triangle table over the positions */
+    std::vector<VertexIndex> positions;
+    FindCanonicalVertices(mesh, Gs::Epsilon<Gs::Real>(), positions);
+
+    VertexTriangleTable table(mesh.triangles, mesh.vertices.size(), positions.data());
+
+    /* Gather the normal of each corner from the triangles around its position */
+    const auto minCosine = (creaseAngle < Gs::Real(Gs::pi) ? std::cos(creaseAngle) : Gs::Real(-2));
+
+    GetSharedThreadPool().ParallelFor(
+        numTriangles, normalGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+                const auto& faceNormal = faceNormals[i];
+
+                /* Corners of degenerated triangles take all triangles around their position */
+                const auto cornerMinCosine = (faceNormal.LengthSq() == Gs::Real(0) ? Gs::Real(-2) : minCosine);
+
+                for (int j = 0; j < 3; ++j)
+                {
+                    const auto position = positions[tri[j]];
+
+                    Gs::Vector3 normal;
+                    for (auto k = table.offsets[position]; k < table.offsets[position + 1]; ++k)
+                    {
+                        const auto neighbor = table.entries[k];
+                        if (Gs::Dot(faceNormal, faceNormals[neighbor]) >= cornerMinCosine)
+                        {
+                            const auto corner = FindCorner(mesh.triangles[neighbor], position, positions.data());
+                            normal += faceNormals[neighbor] * cornerAngles[neighbor*3 + corner];
+                        }
+                    }
+
+                    auto length = normal.Length();
+                    cornerNormals[i*3 + j] = (length > Gs::Real(0) ? normal * (Gs::Real(1) / length) : faceNormal);
+                }
+            }
+        }
+    );
+}
+
+std::size_t ComputeNormals(TriangleMesh& mesh, Gs::Real creaseAngle)
+{
+    std::vector<Gs::Vector3> cornerNormals;
+    ComputeCornerNormals(mesh, creaseAngle, cornerNormals);
+
+    /* Assign the corner normals to their vertices, and split a vertex for each further normal */
+    const auto numVerts         = mesh.vertices.size();
+    const auto invalidIndex     = static_cast<VertexIndex>(TriangleMesh::MaxNumVertices());
+
+    std::vector<Gs::Vector3>            normals(numVerts);
+    std::vector<char>                   assigned(numVerts, 0);
+    std::vector<VertexIndex>            nextSplits(numVerts, invalidIndex);    // Linked list of the copies of each vertex
+    std::vector<TriangleMesh::Vertex>   splitVertices;
+    TriangleMesh::TriangleArray         triangles(mesh.triangles, mesh.triangles.get_allocator());
+
+    for (std::size_t i = 0; i < triangles.size(); ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            auto& index = triangles[i][j];
+            const auto& normal = cornerNormals[i*3 + j];
+
+            if (!assigned[index])
+            {
+                assigned[index] = 1;
+                normals[index] = normal;
+                continue;
+            }
+
+            /* Find the vertex or copy with the same normal, or append a new copy */
+            for (auto v = index;; v = nextSplits[v])
+            {
+                const auto& vertexNormal = (v < numVerts ? normals[v] : splitVertices[v - numVerts].normal);
+
+                if (Gs::Dot(vertexNormal, normal) >= normalEqualityCosine)
+                {
+                    index = v;
+                    break;
+                }
+
+                if (nextSplits[v] == invalidIndex)
+                {
+                    if (numVerts + splitVertices.size() >= TriangleMesh::MaxNumVertices())
+                        throw std::overflow_error(GM_EXCEPT_INFO("too many vertices to split mesh vertices along crease edges"));
+
+                    const auto split = static_cast<VertexIndex>(numVerts + splitVertices.size());
+
+                    splitVertices.push_back(mesh.vertices[index]);
+                    splitVertices.back().normal = normal;
+                    nextSplits.push_back(invalidIndex);
+
+                    nextSplits[v] = split;
+                    index = split;
+                    break;
+                }
+            }
+        }
+    }
+
+    /* Write normals and split vertices into the mesh */
+    for (std::size_t i = 0; i < numVerts; ++i)
+    {
+        if (assigned[i])
+            mesh.vertices[i].normal = normals[i];
+    }
+
+    mesh.vertices.insert(mesh.vertices.end(), splitVertices.begin(), splitVertices.end());
+    mesh.triangles = std::move(triangles);
+
+    mesh.InvalidateAdjacency();
+    mesh.InvalidateCache();
+
+    return splitVertices.size();
+}
+
+void ComputeTangents(const TriangleMesh& mesh, std::vector<Gs::Vector4>& tangents)
+{
+    const auto numVerts     = mesh.vertices.size();
+    const auto numTriangles = mesh.triangles.size();
+
+    /* Compute tangent and bitangent directions and corner angles of all triangles */
+    std::vector<Gs::Vector3> faceTangents(numTriangles), faceBitangents(numTriangles);
+    std::vector<Gs::Real> cornerAngles(numTriangles * 3);
+
+    GetSharedThreadPool().ParallelFor(
+        numTriangles, normalGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto& tri = mesh.triangles[i];
+                const auto& a = mesh.vertices[tri.a];
+                const auto& b = mesh.vertices[tri.b];
+                const auto& c = mesh.vertices[tri.c];
+
+                Gs::Vector3 normal;
+                ComputeNormalAndAngles(a.position, b.position, c.position, normal, &cornerAngles[i*3]);
+
+                const auto v1   = b.position - a.position;
+                const auto v2   = c.position - a.position;
+                const auto st1  = b.texCoord - a.texCoord;
+                const auto st2  = c.texCoord - a.texCoord;
+                const auto det  = st1.x*st2.y - st2.x*st1.y;
+
+                /* Triangles with degenerated texture-coordinates do not contribute */
+                if (det != Gs::Real(0))
+                {
+                    const auto sign = (det > Gs::Real(0) ? Gs::Real(1) : Gs::Real(-1));
+                    faceTangents[i]     = ((v1 * st2.y) - (v2 * st1.y)).Normalized() * sign;
+                    faceBitangents[i]   = ((v2 * st1.x) - (v1 * st2.x)).Normalized() * sign;
+                }
+            }
+        }
+    );
+
+    /* Gather the tangent frame of each vertex from its triangles */
+    VertexTriangleTable table(mesh.triangles, numVerts);
+
+    tangents.resize(numVerts);
+
+    GetSharedThreadPool().ParallelFor(
+        numVerts, normalGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto vertex = static_cast<VertexIndex>(i);
+
+                Gs::Vector3 tangent, bitangent;
+                for (auto k = table.offsets[i]; k < table.offsets[i + 1]; ++k)
+                {
+                    const auto neighbor = table.entries[k];
+                    const auto weight = cornerAngles[neighbor*3 + FindCorner(mesh.triangles[neighbor], vertex)];
+                    tangent     += faceTangents[neighbor] * weight;
+                    bitangent   += faceBitangents[neighbor] * weight;
+                }
+
+                /* Orthogonalize tangent to the normal (Gram-Schmidt) and determine the handedness by the bitangent */
+                const auto normal = mesh.vertices[i].normal.Normalized();
+
+                tangent -= normal * Gs::Dot(normal, tangent);
+
+                auto length = tangent.Length();
+                if (length > Gs::Epsilon<Gs::Real>())
+                    tangent *= (Gs::Real(1) / length);
+                else
+                    tangent = AnyOrthogonalVector(normal);
+
+                const auto handedness = (Gs::Dot(Gs::Cross(normal, tangent), bitangent) < Gs::Real(0) ? Gs::Real(-1) : Gs::Real(1));
+
+                tangents[i] = Gs::Vector4(tangent.x, tangent.y, tangent.z, handedness);
+            }
+        }
+    );
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
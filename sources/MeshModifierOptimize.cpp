@@ -0,0 +1,341 @@
+/*
+ * MeshModifierOptimize.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+
+/* ----- Internal functions ----- */
+
+// Size of the LRU cache which is modeled by the vertex scores (as proposed by Tom Forsyth, independent of the actual cache size).
+static const std::size_t forsythCacheSize   = 32;
+
+// Maximal valence that is distinguished by the vertex scores.
+static const std::size_t forsythMaxValence  = 32;
+
+// Precomputed vertex scores, as proposed in "Linear-Speed Vertex Cache Optimisation" by Tom Forsyth.
+class ForsythScoreTable
+{
+
+    public:
+
+        ForsythScoreTable()
+        {
+            const float cacheDecayPower     = 1.5f;
+            const float lastTriScore        = 0.75f;
+            const float valenceBoostScale   = 2.0f;
+            const float valenceBoostPower   = 0.5f;
+
+            /* Vertices of the last triangle get a fixed score, so the next triangle does not reuse all of them (which would be a strip order) */
+            for (std::size_t i = 0; i < forsythCacheSize; ++i)
+            {
+                if (i < 3)
+                    cacheScores_[i] = lastTriScore;
+                else
+                {
+                    auto scale = 1.0f / static_cast<float>(forsythCacheSize - 3);
+                    cacheScores_[i] = std::pow(1.0f - static_cast<float>(i - 3) * scale, cacheDecayPower);
+                }
+            }
+
+            /* Vertices with only a few remaining triangles get a boost, so they are finished quickly and do not remain as lone triangles */
+            valenceScores_[0] = 0.0f;
+            for (std::size_t i = 1; i <= forsythMaxValence; ++i)
+                valenceScores_[i] = valenceBoostScale * std::pow(static_cast<float>(i), -valenceBoostPower);
+        }
+
+        // Returns the score of a vertex with the specified position in the cache (or -1 if it is not in the cache) and the number of remaining triangles.
+        float Score(int cachePosition, std::size_t numActiveTriangles) const
+        {
+            if (numActiveTriangles == 0)
+                return -1.0f;
+
+            auto score = valenceScores_[std::min(numActiveTriangles, forsythMaxValence)];
+
+            if (cachePosition >= 0)
+                score += cacheScores_[cachePosition];
+
+            return score;
+        }
+
+    private:
+
+        float cacheScores_[forsythCacheSize];
+        float valenceScores_[forsythMaxValence + 1];
+
+};
+
+// Reorders the triangles with the algorithm of Tom Forsyth, which greedily emits the triangle with the highest score of its vertices.
+static TriangleMesh::TriangleArray ForsythTriangleOrder(const TriangleMesh::TriangleArray& triangles, std::size_t numVertices)
+{
+    static const ForsythScoreTable scoreTable;
+
+    const auto numTriangles = triangles.size();
+
+    /* Build vertex-to-triangle table in CSR layout */
+    std::vector<std::size_t> vertexTriangleOffsets(numVertices + 1, 0);
+
+    for (const auto& tri : triangles)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+            ++vertexTriangleOffsets[tri[k] + 1];
+    }
+
+    for (std::size_t i = 0; i < numVertices; ++i)
+        vertexTriangleOffsets[i + 1] += vertexTriangleOffsets[i];
+
+    std::vector<TriangleIndex> vertexTriangles(vertexTriangleOffsets[numVertices]);
+    std::vector<std::size_t> numActiveTriangles(numVertices, 0);
+
+    for (TriangleIndex i = 0; i < numTriangles; ++i)
+    {
+        const auto& tri = triangles[i];
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            auto v = tri[k];
+            vertexTriangles[vertexTriangleOffsets[v] + numActiveTriangles[v]++] = i;
+        }
+    }
+
+    /* Initialize vertex and triangle scores */
+    std::vector<int> cachePositions(numVertices, -1);
+    std::vector<float> vertexScores(numVertices);
+
+    for (std::size_t i = 0; i < numVertices; ++i)
+        vertexScores[i] = scoreTable.Score(-1, numActiveTriangles[i]);
+
+    std::vector<float> triangleScores(numTriangles);
+    std::vector<bool> emitted(numTriangles, false);
+
+    for (TriangleIndex i = 0; i < numTriangles; ++i)
+    {
+        const auto& tri = triangles[i];
+        triangleScores[i] = vertexScores[tri.a] + vertexScores[tri.b] + vertexScores[tri.c];
+    }
+
+    /* Emit triangles with the highest score, considering only the triangles of the cached vertices */
+    TriangleMesh::TriangleArray result(triangles.get_allocator());
+    result.reserve(numTriangles);
+
+    std::vector<VertexIndex> cache, nextCache;
+    cache.reserve(forsythCacheSize + 3);
+    nextCache.reserve(forsythCacheSize + 3);
+
+    TriangleIndex nextUnemitted = 0;
+
+    auto FindBestCachedTriangle = [&]() -> TriangleIndex
+    {
+        auto best = numTriangles;
+        auto bestScore = -1.0f;
+
+        for (auto v : cache)
+        {
+            for (auto j = vertexTriangleOffsets[v]; j < vertexTriangleOffsets[v] + numActiveTriangles[v]; ++j)
+            {
+                auto t = vertexTriangles[j];
+                if (triangleScores[t] > bestScore)
+                {
+                    best = t;
+                    bestScore = triangleScores[t];
+                }
+            }
+        }
+
+        return best;
+    };
+
+    for (auto best = numTriangles; result.size() < numTriangles;)
+    {
+        /* Continue with the next triangle in the input order if the cache has run dry */
+        if (best == numTriangles)
+        {
+            while (emitted[nextUnemitted])
+                ++nextUnemitted;
+            best = nextUnemitted;
+        }
+
+        /* Emit triangle and remove it from the active triangles of its vertices */
+        const auto& tri = triangles[best];
+        result.push_back(tri);
+        emitted[best] = true;
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            auto v = tri[k];
+            auto begin = vertexTriangles.begin() + vertexTriangleOffsets[v];
+            auto end = begin + numActiveTriangles[v];
+            auto it = std::find(begin, end, best);
+            if (it != end)
+            {
+                std::iter_swap(it, end - 1);
+                --numActiveTriangles[v];
+            }
+        }
+
+        /* Move the vertices of the emitted triangle to the front of the LRU cache */
+        nextCache.clear();
+
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            if (std::find(nextCache.begin(), nextCache.end(), tri[k]) == nextCache.end())
+                nextCache.push_back(tri[k]);
+        }
+
+        const auto numNewEntries = nextCache.size();
+
+        for (auto v : cache)
+        {
+            if (std::find(nextCache.begin(), nextCache.begin() + numNewEntries, v) == nextCache.begin() + numNewEntries)
+                nextCache.push_back(v);
+        }
+
+        /* Update the scores of all vertices that were in the cache before or are in the cache now */
+        for (std::size_t i = 0; i < nextCache.size(); ++i)
+        {
+            auto v = nextCache[i];
+            cachePositions[v] = (i < forsythCacheSize ? static_cast<int>(i) : -1);
+            vertexScores[v] = scoreTable.Score(cachePositions[v], numActiveTriangles[v]);
+        }
+
+        if (nextCache.size() > forsythCacheSize)
+            nextCache.resize(forsythCacheSize);
+
+        cache.swap(nextCache);
+
+        /* Update the scores of all triangles of the cached vertices */
+        for (auto v : cache)
+        {
+            for (auto j = vertexTriangleOffsets[v]; j < vertexTriangleOffsets[v] + numActiveTriangles[v]; ++j)
+            {
+                auto t = vertexTriangles[j];
+                const auto& adjTri = triangles[t];
+                triangleScores[t] = vertexScores[adjTri.a] + vertexScores[adjTri.b] + vertexScores[adjTri.c];
+            }
+        }
+
+        best = FindBestCachedTriangle();
+    }
+
+    return result;
+}
+
+
+/* ----- Global functions ----- */
+
+VertexCacheStatistics AnalyzeVertexCache(const TriangleMesh& mesh, std::size_t cacheSize)
+{
+    VertexCacheStatistics stats;
+
+    if (mesh.triangles.empty() || mesh.vertices.empty())
+        return stats;
+
+    cacheSize = std::max<std::size_t>(1, cacheSize);
+
+    /*
+    Simulate a FIFO cache: each vertex stores the time stamp (i.e. the number of cache misses) when it was last inserted,
+    so it is still in the cache if less than 'cacheSize' other vertices have been inserted since then
+    */
+    std::vector<std::size_t> timeStamps(mesh.vertices.size(), 0);
+    std::size_t numMisses = 0;
+
+    for (const auto& tri : mesh.triangles)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            auto& stamp = timeStamps[tri[k]];
+            if (stamp == 0 || numMisses + 1 - stamp > cacheSize)
+                stamp = ++numMisses;
+        }
+    }
+
+    stats.acmr = static_cast<Gs::Real>(numMisses) / static_cast<Gs::Real>(mesh.triangles.size());
+    stats.atvr = static_cast<Gs::Real>(numMisses) / static_cast<Gs::Real>(mesh.vertices.size());
+
+    return stats;
+}
+
+VertexCacheReport OptimizeVertexCache(TriangleMesh& mesh, std::size_t cacheSize)
+{
+    VertexCacheReport report;
+
+    report.before = AnalyzeVertexCache(mesh, cacheSize);
+
+    mesh.triangles = ForsythTriangleOrder(mesh.triangles, mesh.vertices.size());
+    mesh.InvalidateAdjacency();
+    mesh.InvalidateCache();
+
+    report.after = AnalyzeVertexCache(mesh, cacheSize);
+
+    return report;
+}
+
+VertexCacheReport OptimizeVertexFetch(TriangleMesh& mesh, std::size_t cacheSize, std::vector<VertexIndex>* remapTable)
+{
+    VertexCacheReport report;
+
+    report.before = AnalyzeVertexCache(mesh, cacheSize);
+
+    /* Assign new vertex indices in the order of their first use (unused vertices keep the invalid index) */
+    const auto numVerts = mesh.vertices.size();
+    const auto invalidIndex = static_cast<VertexIndex>(TriangleMesh::MaxNumVertices());
+
+    std::vector<VertexIndex> remap(numVerts, invalidIndex);
+    VertexIndex numUsedVerts = 0;
+
+    for (auto& tri : mesh.triangles)
+    {
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            auto& v = remap[tri[k]];
+            if (v == invalidIndex)
+                v = numUsedVerts++;
+            tri[k] = v;
+        }
+    }
+
+    /* Reorder vertices */
+    TriangleMesh::VertexArray reorderedVertices(numUsedVerts, TriangleMesh::Vertex(), mesh.vertices.get_allocator());
+
+    for (std::size_t i = 0; i < numVerts; ++i)
+    {
+        if (remap[i] != invalidIndex)
+            reorderedVertices[remap[i]] = mesh.vertices[i];
+    }
+
+    mesh.vertices = std::move(reorderedVertices);
+    mesh.InvalidateAdjacency();
+    mesh.InvalidateCache();
+
+    if (remapTable)
+        *remapTable = std::move(remap);
+
+    report.after = AnalyzeVertexCache(mesh, cacheSize);
+
+    return report;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
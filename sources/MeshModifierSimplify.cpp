@@ -0,0 +1,695 @@
+/*
+ * MeshModifierSimplify.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include "Except.h"
+
+#include <algorithm>
+#include <queue>
+#include <stdexcept>
+#include <cmath>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using TriangleIndex = TriangleMesh::TriangleIndex;
+using Triangle      = TriangleMesh::Triangle;
+
+
+/* ----- Internal functions ----- */
+
+// Minimal cosine between the normal of a triangle before and after a collapse. Collapses which rotate a triangle any further are rejected.
+static const double minFlipCosine = 0.25;
+
+/*
+Symmetric 4x4 error quadric of a set of planes (as proposed by Garland and Heckbert), stored as the upper triangle
+with the accumulated weight of all planes. Computed with double precision, since the coefficients cancel out.
+*/
+struct Quadric
+{
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    // Adds the plane n*x + d = 0 (with unit normal n) with the specified weight.
+    void AddPlane(const Gs::Vector3& normal, double d, double w)
+    {
+        const double x = normal.x, y = normal.y, z = normal.z;
+        a00 += w*x*x; a01 += w*x*y; a02 += w*x*z;
+        a11 += w*y*y; a12 += w*y*z;
+        a22 += w*z*z;
+        b0  += w*x*d; b1  += w*y*d; b2  += w*z*d;
+        c   += w*d*d;
+        weight += w;
+    }
+
+    Quadric& operator += (const Quadric& rhs)
+    {
+        a00 += rhs.a00; a01 += rhs.a01; a02 += rhs.a02;
+        a11 += rhs.a11; a12 += rhs.a12;
+        a22 += rhs.a22;
+        b0  += rhs.b0;  b1  += rhs.b1;  b2  += rhs.b2;
+        c   += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    // Returns the weighted sum of squared distances between the specified point and all planes.
+    double Evaluate(const Gs::Vector3& p) const
+    {
+        const double x = p.x, y = p.y, z = p.z;
+        return (
+            a00*x*x + a11*y*y + a22*z*z + 2.0*(a01*x*y + a02*x*z + a12*y*z) +
+            2.0*(b0*x + b1*y + b2*z) + c
+        );
+    }
+};
+
+// Returns true if the attributes of the specified vertex descriptor are equal for both vertices.
+static bool CompareSeamAttributes(const VertexDescriptor& seamDesc, const TriangleMesh::Vertex& lhs, const TriangleMesh::Vertex& rhs)
+{
+    auto lhsBytes = reinterpret_cast<const char*>(&lhs);
+    auto rhsBytes = reinterpret_cast<const char*>(&rhs);
+
+    for (const auto& attrib : seamDesc.attributes)
+    {
+        auto a = reinterpret_cast<const Gs::Real*>(lhsBytes + attrib.offset);
+        auto b = reinterpret_cast<const Gs::Real*>(rhsBytes + attrib.offset);
+        for (std::uint32_t i = 0; i < attrib.components; ++i)
+        {
+            if (a[i] != b[i])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+Simplifier with half-edge collapses. The connectivity is tracked on positions (i.e. canonical vertices), while the triangles refer to wedges,
+i.e. the first vertex at a position with equal seam attributes. When a position is collapsed, each of its wedges is replaced by the wedge
+of the target position it shares an edge with, so seams are only collapsed along themselves.
+*/
+class QuadricSimplifier
+{
+
+    public:
+
+        QuadricSimplifier(const TriangleMesh& mesh, const VertexDescriptor& seamDesc) :
+            mesh_ { mesh }
+        {
+            InitWedges(seamDesc);
+            InitTriangles();
+            InitQuadricsAndCollapses();
+        }
+
+        // Collapses edges until at most 'targetTriangleCount' triangles remain, or the next collapse would exceed the specified error.
+        void Run(std::size_t targetTriangleCount, Gs::Real maxError)
+        {
+            const double maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+
+            while (numTriangles_ > targetTriangleCount && !collapses_.empty())
+            {
+                auto collapse = collapses_.top();
+
+                if (collapse.cost > maxCost)
+                    break;
+
+                collapses_.pop();
+
+                /* Skip collapses whose positions have been removed or changed since the collapse was queued */
+                if (removed_[collapse.from] || removed_[collapse.to] || stamps_[collapse.from] != collapse.fromStamp || stamps_[collapse.to] != collapse.toStamp)
+                    continue;
+
+                if (IsCollapseValid(collapse.from, collapse.to))
+                {
+                    ApplyCollapse(collapse.from, collapse.to);
+                    error_ = std::max(error_, std::sqrt(std::max(0.0, static_cast<double>(collapse.cost))));
+                }
+                else if (collapse.reversible && IsCollapseAllowed(collapse.to, collapse.from))
+                    collapses_.push(MakeCollapse(collapse.to, collapse.from, false));
+            }
+        }
+
+        // Returns the remaining triangles in their original order.
+        void GetTriangles(std::vector<Triangle>& triangles) const
+        {
+            triangles.clear();
+            triangles.reserve(numTriangles_);
+
+            for (std::size_t i = 0; i < triangles_.size(); ++i)
+            {
+                if (!deleted_[i])
+                    triangles.push_back(triangles_[i]);
+            }
+        }
+
+        std::size_t NumTriangles() const
+        {
+            return numTriangles_;
+        }
+
+        Gs::Real Error() const
+        {
+            return static_cast<Gs::Real>(error_);
+        }
+
+    private:
+
+        enum class PositionKind : char
+        {
+            Interior,   // Position can be collapsed onto any neighbor
+            Border,     // Position can only be collapsed along a border edge
+            Locked,     // Position on a non-manifold edge, which is never collapsed
+        };
+
+        struct Collapse
+        {
+            float           cost;
+            VertexIndex     from;
+            VertexIndex     to;
+            std::uint32_t   fromStamp;
+            std::uint32_t   toStamp;
+            bool            reversible;     // Specifies whether the opposite direction is to be tried if this collapse is rejected
+
+            inline bool operator > (const Collapse& rhs) const
+            {
+                return (cost > rhs.cost);
+            }
+        };
+
+        // Returns the position (i.e. canonical vertex) of the specified wedge.
+        inline VertexIndex Pos(VertexIndex wedge) const
+        {
+            return canonicals_[wedge];
+        }
+
+        inline const Gs::Vector3& Coord(VertexIndex position) const
+        {
+            return mesh_.vertices[position].position;
+        }
+
+        // Returns the triangle's corner (0, 1, or 2) at the specified position, or 3 if the triangle does not touch that position.
+        inline int FindCorner(const Triangle& tri, VertexIndex position) const
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                if (Pos(tri[i]) == position)
+                    return i;
+            }
+            return 3;
+        }
+
+        void InitWedges(const VertexDescriptor& seamDesc)
+        {
+            const auto numVerts = mesh_.vertices.size();
+
+            FindCanonicalVertices(mesh_, Gs::Epsilon<Gs::Real>(), canonicals_);
+
+            /* Group vertices by position */
+            std::vector<std::size_t> groupOffsets(numVerts + 1, 0);
+            for (auto v : canonicals_)
+                ++groupOffsets[v + 1];
+            for (std::size_t i = 0; i < numVerts; ++i)
+                groupOffsets[i + 1] += groupOffsets[i];
+
+            std::vector<VertexIndex> groupVertices(numVerts);
+            {
+                std::vector<std::size_t> cursor(groupOffsets.begin(), groupOffsets.end() - 1);
+                for (std::size_t i = 0; i < numVerts; ++i)
+                    groupVertices[cursor[canonicals_[i]]++] = static_cast<VertexIndex>(i);
+            }
+
+            /* Each vertex refers to the first vertex of its position with equal seam attributes */
+            wedges_.resize(numVerts);
+
+            for (std::size_t p = 0; p < numVerts; ++p)
+            {
+                const auto first = groupOffsets[p], last = groupOffsets[p + 1];
+                for (auto i = first; i < last; ++i)
+                {
+                    const auto v = groupVertices[i];
+                    wedges_[v] = v;
+                    for (auto j = first; j < i; ++j)
+                    {
+                        const auto w = groupVertices[j];
+                        if (wedges_[w] == w && CompareSeamAttributes(seamDesc, mesh_.vertices[v], mesh_.vertices[w]))
+                        {
+                            wedges_[v] = w;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        void InitTriangles()
+        {
+            const auto numVerts = mesh_.vertices.size();
+
+            /* Take over all triangles with three distinct positions, with the indices replaced by their wedges */
+            triangles_.reserve(mesh_.triangles.size());
+
+            for (const auto& tri : mesh_.triangles)
+            {
+                Triangle wedgeTri(wedges_[tri.a], wedges_[tri.b], wedges_[tri.c]);
+                const auto a = Pos(wedgeTri.a), b = Pos(wedgeTri.b), c = Pos(wedgeTri.c);
+                if (a != b && b != c && c != a)
+                    triangles_.push_back(wedgeTri);
+            }
+
+            numTriangles_ = triangles_.size();
+            deleted_.assign(triangles_.size(), 0);
+
+            /* Build position-to-triangle lists */
+            positionTriangles_.resize(numVerts);
+            for (TriangleIndex i = 0; i < triangles_.size(); ++i)
+            {
+                for (int j = 0; j < 3; ++j)
+                    positionTriangles_[Pos(triangles_[i][j])].push_back(i);
+            }
+
+            removed_.assign(numVerts, 0);
+            stamps_.assign(numVerts, 0);
+            marks_.assign(numVerts, 0);
+        }
+
+        void InitQuadricsAndCollapses()
+        {
+            const auto numVerts = mesh_.vertices.size();
+
+            quadrics_.resize(numVerts);
+            kinds_.assign(numVerts, PositionKind::Interior);
+
+            /* Accumulate the plane of each triangle, weighted by its area */
+            TriangleMesh::TriangleArray positionTris(triangles_.size());
+
+            for (std::size_t i = 0; i < triangles_.size(); ++i)
+            {
+                const auto& tri = triangles_[i];
+                positionTris[i] = Triangle(Pos(tri.a), Pos(tri.b), Pos(tri.c));
+
+                const auto& p0 = Coord(positionTris[i].a);
+                auto normal = Gs::Cross(Coord(positionTris[i].b) - p0, Coord(positionTris[i].c) - p0);
+                auto area2 = normal.Length();
+                if (area2 > Gs::Real(0))
+                {
+                    normal *= (Gs::Real(1) / area2);
+                    Quadric q;
+                    q.AddPlane(normal, -static_cast<double>(Gs::Dot(normal, p0)), static_cast<double>(area2) * 0.5);
+                    for (int j = 0; j < 3; ++j)
+                        quadrics_[positionTris[i][j]] += q;
+                }
+            }
+
+            /* Classify positions by the edges of the position triangles, and constrain border edges with perpendicular planes */
+            MeshAdjacency adjacency;
+            adjacency.Build(positionTris, numVerts);
+
+            const auto& edges = adjacency.GetEdges();
+
+            for (std::size_t i = 0; i < edges.size(); ++i)
+            {
+                const auto& edge = edges[i];
+                auto edgeTris = adjacency.EdgeTriangles(i);
+
+                if (edgeTris.size() > 2)
+                {
+                    kinds_[edge.a] = PositionKind::Locked;
+                    kinds_[edge.b] = PositionKind::Locked;
+                }
+                else if (edgeTris.size() == 1)
+                {
+                    if (kinds_[edge.a] == PositionKind::Interior)
+                        kinds_[edge.a] = PositionKind::Border;
+                    if (kinds_[edge.b] == PositionKind::Interior)
+                        kinds_[edge.b] = PositionKind::Border;
+
+                    const auto& tri = positionTris[edgeTris[0]];
+                    const auto& p0 = Coord(tri.a);
+                    const auto faceNormal = Gs::Cross(Coord(tri.b) - p0, Coord(tri.c) - p0);
+                    const auto edgeVec = Coord(edge.b) - Coord(edge.a);
+
+                    auto normal = Gs::Cross(edgeVec, faceNormal);
+                    auto length = normal.Length();
+                    if (length > Gs::Real(0))
+                    {
+                        normal *= (Gs::Real(1) / length);
+                        Quadric q;
+                        q.AddPlane(normal, -static_cast<double>(Gs::Dot(normal, Coord(edge.a))), static_cast<double>(edgeVec.LengthSq()));
+                        quadrics_[edge.a] += q;
+                        quadrics_[edge.b] += q;
+                    }
+                }
+            }
+
+            /* Queue the collapses of all edges */
+            for (const auto& edge : edges)
+                QueueEdge(edge.a, edge.b);
+        }
+
+        // Returns true if the position kinds allow to collapse the first position onto the second one.
+        bool IsCollapseAllowed(VertexIndex from, VertexIndex to) const
+        {
+            return !(kinds_[from] == PositionKind::Locked || (kinds_[from] == PositionKind::Border && kinds_[to] == PositionKind::Interior));
+        }
+
+        Collapse MakeCollapse(VertexIndex from, VertexIndex to, bool reversible) const
+        {
+            /* Cost is the mean squared distance of the target to all planes of both positions */
+            auto q = quadrics_[from];
+            q += quadrics_[to];
+
+            Collapse collapse;
+            collapse.cost       = static_cast<float>(q.weight > 0.0 ? q.Evaluate(Coord(to)) / q.weight : 0.0);
+            collapse.from       = from;
+            collapse.to         = to;
+            collapse.fromStamp  = stamps_[from];
+            collapse.toStamp    = stamps_[to];
+            collapse.reversible = reversible;
+
+            return collapse;
+        }
+
+        // Queues the cheaper allowed collapse direction of the specified edge. The other direction is only tried if the first one is rejected.
+        void QueueEdge(VertexIndex a, VertexIndex b)
+        {
+            const bool allowedAB = IsCollapseAllowed(a, b);
+            const bool allowedBA = IsCollapseAllowed(b, a);
+
+            if (allowedAB && allowedBA)
+            {
+                auto ab = MakeCollapse(a, b, true);
+                auto ba = MakeCollapse(b, a, true);
+                collapses_.push(ab.cost <= ba.cost ? ab : ba);
+            }
+            else if (allowedAB)
+                collapses_.push(MakeCollapse(a, b, false));
+            else if (allowedBA)
+                collapses_.push(MakeCollapse(b, a, false));
+        }
+
+        bool IsCollapseValid(VertexIndex from, VertexIndex to)
+        {
+            /* Mark all neighbor positions of the target */
+            ++currentMark_;
+            for (auto t : positionTriangles_[to])
+            {
+                if (!deleted_[t])
+                {
+                    for (int i = 0; i < 3; ++i)
+                        marks_[Pos(triangles_[t][i])] = currentMark_;
+                }
+            }
+
+            /* Map the wedges of the triangles that are removed by this collapse, and unmark their opposite positions */
+            wedgeMap_.clear();
+
+            std::size_t numEdgeTris = 0;
+
+            for (auto t : positionTriangles_[from])
+            {
+                if (deleted_[t])
+                    continue;
+
+                const auto& tri = triangles_[t];
+                const auto toCorner = FindCorner(tri, to);
+
+                if (toCorner < 3)
+                {
+                    const auto corner = FindCorner(tri, from);
+                    if (!MapWedge(tri[corner], tri[toCorner]))
+                        return false;
+                    marks_[Pos(tri[3 - corner - toCorner])] = 0;
+                    ++numEdgeTris;
+                }
+            }
+
+            /* The edge must still exist, and border positions only move along the border */
+            if (numEdgeTris == 0 || (kinds_[from] == PositionKind::Border && numEdgeTris != 1))
+                return false;
+
+            /* Check all remaining triangles of the source */
+            const auto& source = Coord(from);
+            const auto& target = Coord(to);
+
+            for (auto t : positionTriangles_[from])
+            {
+                if (deleted_[t])
+                    continue;
+
+                const auto& tri = triangles_[t];
+                const auto corner = FindCorner(tri, from);
+
+                if (FindCorner(tri, to) < 3)
+                    continue;
+
+                /* Each wedge of the source must have a target wedge, otherwise a seam would be collapsed across */
+                if (!FindWedge(tri[corner]))
+                    return false;
+
+                /* Link condition: the only shared neighbors are the opposite positions of the removed triangles */
+                const auto v1 = Pos(tri[(corner + 1) % 3]);
+                const auto v2 = Pos(tri[(corner + 2) % 3]);
+
+                if (marks_[v1] == currentMark_ || marks_[v2] == currentMark_)
+                    return false;
+
+                /* Reject collapses that flip the triangle */
+                const auto& p1 = Coord(v1);
+                const auto& p2 = Coord(v2);
+                const auto oldNormal = Gs::Cross(p1 - source, p2 - source);
+                const auto newNormal = Gs::Cross(p1 - target, p2 - target);
+                const double dot = Gs::Dot(oldNormal, newNormal);
+                if (dot <= minFlipCosine * std::sqrt(static_cast<double>(oldNormal.LengthSq()) * static_cast<double>(newNormal.LengthSq())))
+                    return false;
+            }
+
+            return true;
+        }
+
+        // Adds the specified wedge mapping. Returns false if the wedge or the target is already mapped differently.
+        bool MapWedge(VertexIndex wedge, VertexIndex target)
+        {
+            for (const auto& entry : wedgeMap_)
+            {
+                if (entry.first == wedge || entry.second == target)
+                    return (entry.first == wedge && entry.second == target);
+            }
+            wedgeMap_.push_back({ wedge, target });
+            return true;
+        }
+
+        const VertexIndex* FindWedge(VertexIndex wedge) const
+        {
+            for (const auto& entry : wedgeMap_)
+            {
+                if (entry.first == wedge)
+                    return &(entry.second);
+            }
+            return nullptr;
+        }
+
+        void ApplyCollapse(VertexIndex from, VertexIndex to)
+        {
+            auto& toTris = positionTriangles_[to];
+
+            /* Remove triangles of the collapsed edge and move all other triangles to the target */
+            for (auto t : positionTriangles_[from])
+            {
+                if (deleted_[t])
+                    continue;
+
+                auto& tri = triangles_[t];
+                if (FindCorner(tri, to) < 3)
+                {
+                    deleted_[t] = 1;
+                    --numTriangles_;
+                }
+                else
+                {
+                    auto& wedge = tri[FindCorner(tri, from)];
+                    wedge = *FindWedge(wedge);
+                    toTris.push_back(t);
+                }
+            }
+
+            toTris.erase(
+                std::remove_if(toTris.begin(), toTris.end(), [&](TriangleIndex t) { return (deleted_[t] != 0); }),
+                toTris.end()
+            );
+
+            std::vector<TriangleIndex>().swap(positionTriangles_[from]);
+
+            quadrics_[to] += quadrics_[from];
+            removed_[from] = 1;
+
+            /* Queue the collapses of all edges of the target again with the new quadric */
+            ++stamps_[to];
+            ++currentMark_;
+            marks_[to] = currentMark_;
+
+            for (auto t : toTris)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    const auto neighbor = Pos(triangles_[t][i]);
+                    if (marks_[neighbor] != currentMark_)
+                    {
+                        marks_[neighbor] = currentMark_;
+                        QueueEdge(to, neighbor);
+                    }
+                }
+            }
+        }
+
+    private:
+
+        const TriangleMesh&                         mesh_;
+
+        std::vector<VertexIndex>                    canonicals_;            // Position of each vertex
+        std::vector<VertexIndex>                    wedges_;                // Wedge of each vertex
+
+        std::vector<Triangle>                       triangles_;             // Triangles with wedge indices
+        std::vector<char>                           deleted_;
+        std::size_t                                 numTriangles_   = 0;    // Number of triangles that are not deleted
+
+        std::vector<std::vector<TriangleIndex>>     positionTriangles_;     // Triangles of each position (may contain deleted triangles)
+        std::vector<Quadric>                        quadrics_;
+        std::vector<PositionKind>                   kinds_;
+        std::vector<char>                           removed_;
+        std::vector<std::uint32_t>                  stamps_;                // Incremented whenever the quadric of a position changes
+
+        std::vector<std::uint32_t>                  marks_;
+        std::uint32_t                               currentMark_    = 0;
+
+        std::vector<std::pair<VertexIndex, VertexIndex>> wedgeMap_;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> collapses_;
+
+        double                                      error_          = 0.0;
+
+};
+
+
+/* ----- Global functions ----- */
+
+Gs::Real Simplify(TriangleMesh& mesh, std::size_t targetTriangleCount, Gs::Real maxError, const VertexDescriptor& seamDesc)
+{
+    if (mesh.triangles.size() <= targetTriangleCount)
+        return Gs::Real(0);
+
+    /* Collapse edges and take over the remaining triangles */
+    std::vector<Triangle> triangles;
+    Gs::Real error = 0;
+    {
+        QuadricSimplifier simplifier(mesh, seamDesc);
+        simplifier.Run(targetTriangleCount, maxError);
+        simplifier.GetTriangles(triangles);
+        error = simplifier.Error();
+    }
+
+    /* Remove unreferenced vertices (in their original order) */
+    const auto numVerts = mesh.vertices.size();
+    const auto invalidIndex = static_cast<VertexIndex>(TriangleMesh::MaxNumVertices());
+
+    std::vector<VertexIndex> remap(numVerts, invalidIndex);
+    for (const auto& tri : triangles)
+    {
+        for (int i = 0; i < 3; ++i)
+            remap[tri[i]] = 0;
+    }
+
+    VertexIndex numUsedVerts = 0;
+    for (std::size_t i = 0; i < numVerts; ++i)
+    {
+        if (remap[i] != invalidIndex)
+        {
+            remap[i] = numUsedVerts;
+            mesh.vertices[numUsedVerts++] = mesh.vertices[i];
+        }
+    }
+
+    mesh.vertices.resize(numUsedVerts);
+
+    for (auto& tri : triangles)
+    {
+        for (int i = 0; i < 3; ++i)
+            tri[i] = remap[tri[i]];
+    }
+
+    mesh.triangles.assign(triangles.begin(), triangles.end());
+    mesh.InvalidateAdjacency();
+    mesh.InvalidateCache();
+
+    return error;
+}
+
+std::vector<LODLevel> GenerateLODChain(
+    const TriangleMesh&     mesh,
+    std::size_t             numLevels,
+    Gs::Real                reductionRatio,
+    Gs::Real                maxError,
+    const VertexDescriptor& seamDesc)
+{
+    if (!(reductionRatio > Gs::Real(0) && reductionRatio < Gs::Real(1)))
+        throw std::invalid_argument(GM_EXCEPT_INFO("'reductionRatio' must be in the range (0, 1)"));
+
+    std::vector<LODLevel> levels;
+
+    if (numLevels == 0)
+        return levels;
+
+    /* First level is the input mesh */
+    levels.resize(1);
+    levels[0].triangles.assign(mesh.triangles.begin(), mesh.triangles.end());
+
+    if (numLevels == 1)
+        return levels;
+
+    /* Continue the collapses of each level for the next one */
+    QuadricSimplifier simplifier(mesh, seamDesc);
+
+    auto numTriangles = mesh.triangles.size();
+
+    while (levels.size() < numLevels)
+    {
+        const auto targetTriangleCount = static_cast<std::size_t>(static_cast<Gs::Real>(numTriangles) * reductionRatio);
+
+        simplifier.Run(targetTriangleCount, maxError);
+
+        /* Stop if no further triangles could be removed */
+        if (simplifier.NumTriangles() >= numTriangles)
+            break;
+
+        numTriangles = simplifier.NumTriangles();
+
+        LODLevel level;
+        simplifier.GetTriangles(level.triangles);
+        level.error = simplifier.Error();
+        levels.push_back(std::move(level));
+    }
+
+    return levels;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
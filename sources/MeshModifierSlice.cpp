@@ -0,0 +1,371 @@
+/*
+ * MeshModifierSlice.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/PlaneCollision.h>
+#include <Geom/ThreadPool.h>
+#include <Geom/Line.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+
+/* ----- Internal functions ----- */
+
+// Number of layers per chunk of the parallel sweep.
+static const std::size_t sliceGrainSize = 4;
+
+// Minimal number of vertices per chunk for the parallel projection.
+static const std::size_t projectGrainSize = 16384;
+
+// Edge between two canonical vertices (the smaller index first), which is crossed by a slicing plane.
+using SliceEdge = std::pair<VertexIndex, VertexIndex>;
+
+struct SliceEdgeHash
+{
+    std::size_t operator () (const SliceEdge& edge) const
+    {
+        return std::hash<std::uint64_t>()((static_cast<std::uint64_t>(edge.first) << 32) ^ static_cast<std::uint64_t>(edge.second));
+    }
+};
+
+// Segment of a triangle on a slicing plane, from the edge where the triangle crosses to the upper side to the edge where it crosses back.
+struct SliceSegment
+{
+    SliceEdge from;
+    SliceEdge to;
+};
+
+static SliceEdge MakeSliceEdge(VertexIndex a, VertexIndex b)
+{
+    return (a < b ? SliceEdge(a, b) : SliceEdge(b, a));
+}
+
+// Sweeps chunks of slicing planes across the triangles, which are sorted by the lower end of their projected extent.
+class MeshSlicer
+{
+
+    public:
+
+        MeshSlicer(const TriangleMesh& mesh, const Gs::Vector3& normal, Gs::Real weldEpsilon) :
+            mesh_   { mesh   },
+            normal_ { normal }
+        {
+            const auto numVerts = mesh.vertices.size();
+
+            /* Map vertices at equal positions to the same canonical vertex, so the edges of adjacent triangles match across seams */
+            if (weldEpsilon >= Gs::Real(0))
+                FindCanonicalVertices(mesh, weldEpsilon, canonical_);
+            else
+            {
+                canonical_.resize(numVerts);
+                for (std::size_t i = 0; i < numVerts; ++i)
+                    canonical_[i] = static_cast<VertexIndex>(i);
+            }
+
+            /* Project all vertices onto the normal */
+            heights_.resize(numVerts);
+
+            GetSharedThreadPool().ParallelFor(
+                numVerts, projectGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        heights_[i] = Gs::Dot(normal_, mesh_.vertices[i].position);
+                }
+            );
+
+            /* Store the canonical corners and the projected extent of each triangle (degenerated triangles never contribute a segment) */
+            for (const auto& tri : mesh.triangles)
+            {
+                SlicedTriangle t;
+
+                t.corners[0] = canonical_[tri.a];
+                t.corners[1] = canonical_[tri.b];
+                t.corners[2] = canonical_[tri.c];
+
+                if (t.corners[0] == t.corners[1] || t.corners[1] == t.corners[2] || t.corners[2] == t.corners[0])
+                    continue;
+
+                t.minHeight = std::min({ heights_[t.corners[0]], heights_[t.corners[1]], heights_[t.corners[2]] });
+                t.maxHeight = std::max({ heights_[t.corners[0]], heights_[t.corners[1]], heights_[t.corners[2]] });
+
+                triangles_.push_back(t);
+            }
+
+            /* Sort triangles by the lower end of their extent (the stable sort keeps the output independent of the sort implementation) */
+            std::stable_sort(
+                triangles_.begin(), triangles_.end(),
+                [](const SlicedTriangle& lhs, const SlicedTriangle& rhs)
+                {
+                    return (lhs.minHeight < rhs.minHeight);
+                }
+            );
+        }
+
+        // Sweep position: the next triangle to be added, and the triangles which span the current plane (in ascending order).
+        struct SweepState
+        {
+            std::size_t                 next    = 0;
+            std::vector<std::size_t>    active;
+        };
+
+        // Advances the sweep to the specified plane: adds the triangles that begin below this plane, and removes the triangles that end below it.
+        void Advance(SweepState& state, Gs::Real height) const
+        {
+            while (state.next < triangles_.size() && triangles_[state.next].minHeight <= height)
+                state.active.push_back(state.next++);
+
+            state.active.erase(
+                std::remove_if(
+                    state.active.begin(), state.active.end(),
+                    [&](std::size_t t)
+                    {
+                        return (triangles_[t].maxHeight < height);
+                    }
+                ),
+                state.active.end()
+            );
+        }
+
+        // Slices the specified layers, whose offsets must be sorted in ascending order, starting with the specified sweep state.
+        void SliceLayers(SliceLayer* const* layers, std::size_t numLayers, SweepState state) const
+        {
+            std::vector<SliceSegment>                                       segments;
+            std::unordered_map<SliceEdge, std::size_t, SliceEdgeHash>       segmentsFrom;
+
+            for (std::size_t i = 0; i < numLayers; ++i)
+            {
+                auto& layer = *layers[i];
+                const auto height = layer.offset;
+
+                Advance(state, height);
+
+                /* Generate one segment for each triangle that is crossed by this plane */
+                segments.clear();
+
+                for (auto t : state.active)
+                {
+                    SliceSegment segment;
+                    if (FindSegment(triangles_[t], height, segment))
+                        segments.push_back(segment);
+                }
+
+                ChainSegments(segments, segmentsFrom, Plane(normal_, height), layer.contours);
+            }
+        }
+
+    private:
+
+        struct SlicedTriangle
+        {
+            VertexIndex corners[3];
+            Gs::Real    minHeight;
+            Gs::Real    maxHeight;
+        };
+
+        // Vertices exactly on the plane are treated as above the plane, so a crossed triangle always has exactly one edge up and one edge down.
+        bool IsAbove(VertexIndex v, Gs::Real height) const
+        {
+            return (heights_[v] >= height);
+        }
+
+        bool FindSegment(const SlicedTriangle& t, Gs::Real height, SliceSegment& segment) const
+        {
+            bool above[3];
+            for (int i = 0; i < 3; ++i)
+                above[i] = IsAbove(t.corners[i], height);
+
+            if (above[0] == above[1] && above[1] == above[2])
+                return false;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto j = (i + 1) % 3;
+                if (!above[i] && above[j])
+                    segment.from = MakeSliceEdge(t.corners[i], t.corners[j]);
+                else if (above[i] && !above[j])
+                    segment.to = MakeSliceEdge(t.corners[i], t.corners[j]);
+            }
+
+            return true;
+        }
+
+        // Returns the point where the plane crosses the specified edge. The edge is always in the same order, so adjacent triangles share exactly the same point.
+        Gs::Vector3 CrossingPoint(const Plane& plane, const SliceEdge& edge) const
+        {
+            Line3 line(mesh_.vertices[edge.first].position, mesh_.vertices[edge.second].position);
+
+            Gs::Vector3 point;
+            if (!IntersectionWithPlane(plane, line, point))
+            {
+                /* Rounding may move the interpolation factor slightly out of range, then take the nearer end point */
+                point = (std::abs(SgnDistanceToPlane(plane, line.a)) <= std::abs(SgnDistanceToPlane(plane, line.b)) ? line.a : line.b);
+            }
+
+            return point;
+        }
+
+        // Chains the segments of one plane into polylines, following the crossed edges.
+        void ChainSegments(
+            const std::vector<SliceSegment>&                                segments,
+            std::unordered_map<SliceEdge, std::size_t, SliceEdgeHash>&      segmentsFrom,
+            const Plane&                                                    plane,
+            std::vector<SliceContour>&                                      contours) const
+        {
+            const auto numSegments = segments.size();
+
+            segmentsFrom.clear();
+            segmentsFrom.reserve(numSegments);
+
+            for (std::size_t i = 0; i < numSegments; ++i)
+                segmentsFrom.insert({ segments[i].from, i });
+
+            /* Open contours begin with a segment that has no predecessor (at a border of the mesh) */
+            std::vector<bool> hasPredecessor(numSegments, false), visited(numSegments, false);
+
+            for (const auto& segment : segments)
+            {
+                auto it = segmentsFrom.find(segment.to);
+                if (it != segmentsFrom.end())
+                    hasPredecessor[it->second] = true;
+            }
+
+            auto TraceContour = [&](std::size_t first)
+            {
+                SliceContour contour;
+                contour.points.push_back(CrossingPoint(plane, segments[first].from));
+
+                for (auto i = first;;)
+                {
+                    visited[i] = true;
+
+                    auto it = segmentsFrom.find(segments[i].to);
+                    if (it != segmentsFrom.end() && it->second == first)
+                    {
+                        contour.closed = true;
+                        break;
+                    }
+
+                    contour.points.push_back(CrossingPoint(plane, segments[i].to));
+
+                    if (it == segmentsFrom.end() || visited[it->second])
+                        break;
+
+                    i = it->second;
+                }
+
+                contours.push_back(std::move(contour));
+            };
+
+            for (std::size_t i = 0; i < numSegments; ++i)
+            {
+                if (!hasPredecessor[i] && !visited[i])
+                    TraceContour(i);
+            }
+
+            /* All remaining segments belong to closed contours */
+            for (std::size_t i = 0; i < numSegments; ++i)
+            {
+                if (!visited[i])
+                    TraceContour(i);
+            }
+        }
+
+        const TriangleMesh&         mesh_;
+        Gs::Vector3                 normal_;
+        std::vector<VertexIndex>    canonical_;
+        std::vector<Gs::Real>       heights_;
+        std::vector<SlicedTriangle> triangles_;
+
+};
+
+
+/* ----- Global functions ----- */
+
+std::vector<SliceLayer> SliceMesh(
+    const TriangleMesh&             mesh,
+    const Gs::Vector3&              normal,
+    const std::vector<Gs::Real>&    offsets,
+    Gs::Real                        weldEpsilon)
+{
+    const auto numLayers = offsets.size();
+
+    std::vector<SliceLayer> layers(numLayers);
+    for (std::size_t i = 0; i < numLayers; ++i)
+        layers[i].offset = offsets[i];
+
+    if (mesh.triangles.empty() || numLayers == 0)
+        return layers;
+
+    MeshSlicer slicer(mesh, normal.Normalized(), weldEpsilon);
+
+    /* Sweep the layers in ascending order of their offsets */
+    std::vector<SliceLayer*> sortedLayers(numLayers);
+    for (std::size_t i = 0; i < numLayers; ++i)
+        sortedLayers[i] = &layers[i];
+
+    std::stable_sort(
+        sortedLayers.begin(), sortedLayers.end(),
+        [](const SliceLayer* lhs, const SliceLayer* rhs)
+        {
+            return (lhs->offset < rhs->offset);
+        }
+    );
+
+    /*
+    Sweep once over the first layer of each chunk to store its sweep state, so each chunk continues from its first plane
+    and the triangles below that plane are not visited again (the sweep state only depends on the plane, so the output is independent of the chunks)
+    */
+    const auto numChunks = (numLayers + sliceGrainSize - 1) / sliceGrainSize;
+
+    std::vector<MeshSlicer::SweepState> chunkStates(numChunks);
+    MeshSlicer::SweepState state;
+
+    for (std::size_t i = 0; i < numChunks; ++i)
+    {
+        slicer.Advance(state, sortedLayers[i * sliceGrainSize]->offset);
+        chunkStates[i] = state;
+    }
+
+    /* Each chunk sweeps its own range of layers */
+    GetSharedThreadPool().ParallelFor(
+        numChunks, 1,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                const auto first = i * sliceGrainSize;
+                slicer.SliceLayers(sortedLayers.data() + first, std::min(sliceGrainSize, numLayers - first), std::move(chunkStates[i]));
+            }
+        }
+    );
+
+    return layers;
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,218 @@
+/*
+ * MeshModifierSoA.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/TriangleCollision.h>
+#include <Geom/ThreadPool.h>
+#include "SIMDDetails.h"
+#include "Except.h"
+
+#include <utility>
+#include <vector>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per chunk for the parallel plane distance computation.
+static const std::size_t planeDistanceGrainSize = 16384;
+
+// Source index for output vertices which are interpolated from a clipped triangle.
+static const TriangleMeshSoA::VertexIndex interpolated = ~TriangleMeshSoA::VertexIndex(0);
+
+// Output mesh under construction: the source vertex index of each output vertex is gathered first, and the streams are filled afterwards.
+struct ClipOutput
+{
+    // Takes over the triangle container of the output mesh to reuse its capacity when a mesh is clipped repeatedly.
+    ClipOutput(TriangleMeshSoA& mesh)
+    {
+        triangles.swap(mesh.triangles);
+        triangles.clear();
+        sources.reserve(triangles.capacity() * 3);
+    }
+
+    void CopyTriangle(const TriangleMeshSoA::Triangle& indices)
+    {
+        auto v = NextVertex(3);
+        sources.push_back(indices.a);
+        sources.push_back(indices.b);
+        sources.push_back(indices.c);
+        triangles.push_back({ v, static_cast<TriangleMeshSoA::VertexIndex>(v + 1), static_cast<TriangleMeshSoA::VertexIndex>(v + 2) });
+    }
+
+    void AddPolygon(const TriangleMeshSoA& src, TriangleMeshSoA::TriangleIndex triIdx, const ClippedPolygon<Gs::Real>& poly)
+    {
+        auto v = NextVertex(poly.count);
+        for (unsigned char i = 0; i < poly.count; ++i)
+        {
+            interpolatedVertices.push_back({ v + i, src.Barycentric(triIdx, poly.vertices[i]) });
+            sources.push_back(interpolated);
+            if (i >= 2)
+                triangles.push_back({ v, static_cast<TriangleMeshSoA::VertexIndex>(v + i - 1), static_cast<TriangleMeshSoA::VertexIndex>(v + i) });
+        }
+    }
+
+    // Returns the index of the next output vertex and checks if the specified number of vertices can still be addressed.
+    TriangleMeshSoA::VertexIndex NextVertex(std::size_t count) const
+    {
+        if (count > TriangleMesh::MaxNumVertices() - sources.size())
+            throw std::overflow_error(GM_EXCEPT_INFO("number of clipped vertices exceeds the range of the mesh index type"));
+        return static_cast<TriangleMeshSoA::VertexIndex>(sources.size());
+    }
+
+    // Gathers all vertex streams from the source mesh and moves the triangles into the specified mesh.
+    void Flush(const TriangleMeshSoA& src, TriangleMeshSoA& mesh)
+    {
+        mesh.triangles = std::move(triangles);
+
+        /* Gather all streams in one pass (the interpolated vertices are written afterwards) */
+        const auto numVerts = sources.size();
+        mesh.ResizeVertices(numVerts);
+
+        Gs::Real* out[8] =
+        {
+            mesh.positions.x.data(), mesh.positions.y.data(), mesh.positions.z.data(),
+            mesh.normals.x.data(), mesh.normals.y.data(), mesh.normals.z.data(),
+            mesh.texCoords.x.data(), mesh.texCoords.y.data(),
+        };
+
+        const Gs::Real* in[8] =
+        {
+            src.positions.x.data(), src.positions.y.data(), src.positions.z.data(),
+            src.normals.x.data(), src.normals.y.data(), src.normals.z.data(),
+            src.texCoords.x.data(), src.texCoords.y.data(),
+        };
+
+        for (std::size_t i = 0; i < numVerts; ++i)
+        {
+            auto v = sources[i];
+            if (v != interpolated)
+            {
+                for (int j = 0; j < 8; ++j)
+                    out[j][i] = in[j][v];
+            }
+        }
+
+        for (const auto& v : interpolatedVertices)
+            mesh.SetVertex(v.first, v.second);
+    }
+
+    std::vector<TriangleMeshSoA::VertexIndex>                               sources;
+    std::vector<TriangleMeshSoA::Triangle>                                  triangles;
+    std::vector<std::pair<TriangleMeshSoA::VertexIndex, TriangleMesh::Vertex>> interpolatedVertices;
+};
+
+
+/* ----- Global functions ----- */
+
+void PlaneDistances(const TriangleMeshSoA& mesh, const Plane& plane, AlignedVector<Gs::Real>& distances)
+{
+    using Packet = Details::SIMDPacket<Gs::Real>;
+
+    const auto numVerts = mesh.NumVertices();
+    distances.resize(numVerts);
+
+    const auto x = mesh.positions.x.data();
+    const auto y = mesh.positions.y.data();
+    const auto z = mesh.positions.z.data();
+    const auto d = distances.data();
+
+    /* Same evaluation order as "SgnDistanceToPlane", so the classification matches "ClipTriangle" exactly */
+    const auto& n = plane.normal;
+    const auto dist = DefaultPlaneEquation<Gs::Real>::DistanceSign(plane.distance);
+
+    GetSharedThreadPool().ParallelFor(
+        numVerts, planeDistanceGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            const auto nx = Packet::Splat(n.x);
+            const auto ny = Packet::Splat(n.y);
+            const auto nz = Packet::Splat(n.z);
+            const auto nd = Packet::Splat(dist);
+
+            auto i = begin;
+
+            for (; i + Packet::width <= end; i += Packet::width)
+                (nx * Packet::Load(x + i) + ny * Packet::Load(y + i) + nz * Packet::Load(z + i) - nd).Store(d + i);
+
+            for (; i < end; ++i)
+                d[i] = n.x*x[i] + n.y*y[i] + n.z*z[i] - dist;
+        }
+    );
+}
+
+void ClipMesh(const TriangleMeshSoA& mesh, const Plane& clipPlane, TriangleMeshSoA& front, TriangleMeshSoA& back)
+{
+    /* Classify all vertices against the clipping plane */
+    AlignedVector<Gs::Real> distances;
+    PlaneDistances(mesh, clipPlane, distances);
+
+    const auto epsilon = Gs::Epsilon<Gs::Real>();
+
+    auto IsBehind = [&distances, epsilon](TriangleMeshSoA::VertexIndex v)
+    {
+        return (distances[v] < -epsilon);
+    };
+
+    /* Collect source vertices and triangles of both output meshes */
+    ClipOutput frontOutput(front), backOutput(back);
+
+    for (TriangleMeshSoA::TriangleIndex triIdx = 0; triIdx < mesh.triangles.size(); ++triIdx)
+    {
+        const auto& indices = mesh.triangles[triIdx];
+
+        auto behindA = IsBehind(indices.a);
+        auto behindB = IsBehind(indices.b);
+        auto behindC = IsBehind(indices.c);
+
+        if (!behindA && !behindB && !behindC)
+        {
+            /* Add current triangle to front sided mesh */
+            frontOutput.CopyTriangle(indices);
+        }
+        else if (behindA && behindB && behindC)
+        {
+            /* Add current triangle to back sided mesh */
+            backOutput.CopyTriangle(indices);
+        }
+        else
+        {
+            /* Clip triangle against plane (only required for triangles that intersect the plane) */
+            Triangle3 tri(
+                mesh.GetPosition(indices.a),
+                mesh.GetPosition(indices.b),
+                mesh.GetPosition(indices.c)
+            );
+
+            ClippedPolygon<Gs::Real> frontPoly, backPoly;
+            if (ClipTriangle<Gs::Real>(tri, clipPlane, frontPoly, backPoly) == PlaneRelation::Clipped)
+            {
+                frontOutput.AddPolygon(mesh, triIdx, frontPoly);
+                backOutput.AddPolygon(mesh, triIdx, backPoly);
+            }
+        }
+    }
+
+    /* Gather output streams, one stream at a time */
+    frontOutput.Flush(mesh, front);
+    backOutput.Flush(mesh, back);
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,579 @@
+/*
+ * MeshModifierSubdivide.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/ThreadPool.h>
+#include "Except.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex   = TriangleMesh::VertexIndex;
+using Triangle      = TriangleMesh::Triangle;
+using Edge          = TriangleMesh::Edge;
+using EdgeIndex     = MeshAdjacency::EdgeIndex;
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t subdivideGrainSize = 4096;
+
+// Invalid side of an edge, i.e. no triangle traverses the edge in that direction.
+static const std::size_t invalidSide = std::numeric_limits<std::size_t>::max();
+
+// Returns the weight of each neighbor of a smooth vertex with the specified valence (Loop's original weights).
+static Gs::Real LoopBeta(std::size_t valence)
+{
+    const auto n = static_cast<Gs::Real>(valence);
+    const auto c = Gs::Real(0.375) + Gs::Real(0.25) * std::cos(Gs::Real(2) * Gs::Real(Gs::pi) / n);
+    return (Gs::Real(0.625) - c*c) / n;
+}
+
+/*
+Loop subdivision surface. The topology refers to the canonical vertices (so texture-coordinate seams do not tear the surface apart),
+and the triangles refer to the attribute vertices, each of which is mapped to a canonical vertex. The edge table is only built once for the input mesh,
+the edges and triangles of each further level are derived from their parents: edge e is split into the edges 2e and 2e+1,
+and triangle t is split into the triangles 4t to 4t+3 with the three new inner edges 2E+3t to 2E+3t+2 (where E is the previous number of edges).
+*/
+class LoopSubdivider
+{
+
+    public:
+
+        LoopSubdivider(const TriangleMesh& mesh, const SubdivisionDescriptor& desc)
+        {
+            const auto numVerts = mesh.vertices.size();
+
+            /* Map vertices at equal positions to the same canonical vertex */
+            if (desc.weldEpsilon >= Gs::Real(0))
+                FindCanonicalVertices(mesh, desc.weldEpsilon, canonical_);
+            else
+            {
+                canonical_.resize(numVerts);
+                for (std::size_t i = 0; i < numVerts; ++i)
+                    canonical_[i] = static_cast<VertexIndex>(i);
+            }
+
+            vertices_.assign(mesh.vertices.begin(), mesh.vertices.end());
+
+            positions_.resize(numVerts);
+            for (std::size_t i = 0; i < numVerts; ++i)
+                positions_[i] = mesh.vertices[i].position;
+
+            /* Take all triangles with three distinct canonical corners */
+            TriangleMesh::TriangleArray canonicalTriangles;
+
+            for (const auto& tri : mesh.triangles)
+            {
+                Triangle t(canonical_[tri.a], canonical_[tri.b], canonical_[tri.c]);
+                if (t.a != t.b && t.b != t.c && t.c != t.a)
+                {
+                    triangles_.push_back(tri);
+                    canonicalTriangles.push_back(t);
+                }
+            }
+
+            corners_.assign(canonicalTriangles.begin(), canonicalTriangles.end());
+
+            /* Build the edge table of the canonical triangles */
+            MeshAdjacency adjacency;
+            adjacency.Build(canonicalTriangles, numVerts);
+
+            edges_ = adjacency.GetEdges();
+
+            const auto numTriangles = triangles_.size();
+            const auto numEdges     = edges_.size();
+
+            triangleEdges_.resize(numTriangles * 3);
+            for (std::size_t i = 0; i < numTriangles; ++i)
+            {
+                auto edges = adjacency.TriangleEdges(i);
+                for (int k = 0; k < 3; ++k)
+                    triangleEdges_[i*3 + k] = edges[k];
+            }
+
+            /*
+            Store the triangle (and its corner) that traverses each edge from 'a' to 'b' on side 0, and from 'b' to 'a' on side 1.
+            Non-manifold edges (with several triangles on the same side) are creases, and only the first of these triangles is kept.
+            */
+            sides_.assign(numEdges * 2, invalidSide);
+            creases_.assign(numEdges, 0);
+
+            for (EdgeIndex e = 0; e < numEdges; ++e)
+            {
+                for (auto t : adjacency.EdgeTriangles(e))
+                {
+                    for (int k = 0; k < 3; ++k)
+                    {
+                        if (triangleEdges_[t*3 + k] == e)
+                        {
+                            auto& side = sides_[e*2 + SideOfCorner(e, CornerOf(t, k))];
+                            if (side == invalidSide)
+                                side = t*3 + k;
+                            else
+                                creases_[e] = 1;
+                        }
+                    }
+                }
+            }
+
+            /* Mark sharp edges between triangles whose normals deviate by more than the crease angle */
+            if (desc.creaseAngle < Gs::Real(Gs::pi))
+                MarkCreaseAngle(desc.creaseAngle);
+
+            /* Mark the specified crease edges */
+            for (const auto& edge : desc.creaseEdges)
+            {
+                if (edge.a >= numVerts || edge.b >= numVerts)
+                    throw std::invalid_argument(GM_EXCEPT_INFO("crease edge refers to a vertex index out of range"));
+
+                auto e = adjacency.FindEdge(canonical_[edge.a], canonical_[edge.b]);
+                if (e != MeshAdjacency::invalidEdge)
+                    creases_[e] = 1;
+            }
+        }
+
+        // Subdivides each triangle into four triangles and moves all vertices according to the Loop masks.
+        void Refine()
+        {
+            const auto numPositions = positions_.size();
+            const auto numVerts     = vertices_.size();
+            const auto numEdges     = edges_.size();
+            const auto numTriangles = triangles_.size();
+
+            /* Count the attribute vertices of each edge: edges on a seam get a separate vertex for each side */
+            std::vector<std::size_t> edgeVertexOffsets(numEdges + 1, 0);
+
+            for (EdgeIndex e = 0; e < numEdges; ++e)
+                edgeVertexOffsets[e + 1] = edgeVertexOffsets[e] + (IsSeam(e) ? 2 : 1);
+
+            const auto newNumVerts = numVerts + edgeVertexOffsets.back();
+            if (newNumVerts > TriangleMesh::MaxNumVertices())
+                throw std::overflow_error(GM_EXCEPT_INFO("too many vertices for mesh subdivision"));
+
+            /* Compute the new positions of all vertices and edges */
+            std::vector<Gs::Vector3> positions(numPositions + numEdges);
+
+            ComputeVertexPoints(positions);
+            ComputeEdgePoints(positions);
+
+            /* Interpolate the attribute vertices of all edges */
+            vertices_.resize(newNumVerts);
+            canonical_.resize(newNumVerts);
+
+            GetSharedThreadPool().ParallelFor(
+                numEdges, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto e = begin; e < end; ++e)
+                    {
+                        const bool seam = IsSeam(e);
+
+                        for (std::size_t s = 0; s < 2; ++s)
+                        {
+                            const auto side = sides_[e*2 + s];
+                            if (side == invalidSide || !(seam || s == 0 || sides_[e*2] == invalidSide))
+                                continue;
+
+                            const auto& tri = triangles_[side / 3];
+                            const auto  k   = static_cast<int>(side % 3);
+                            const auto  v   = numVerts + edgeVertexOffsets[e] + (seam ? s : 0);
+
+                            vertices_[v] = vertices_[tri[k]];
+                            vertices_[v] += vertices_[tri[(k + 1) % 3]];
+                            vertices_[v] *= Gs::Real(0.5);
+
+                            canonical_[v] = static_cast<VertexIndex>(numPositions + e);
+                        }
+                    }
+                }
+            );
+
+            /* Split each edge into two child edges */
+            const auto newNumEdges = numEdges*2 + numTriangles*3;
+
+            std::vector<Edge>           edges(newNumEdges);
+            std::vector<std::size_t>    sides(newNumEdges * 2);
+            std::vector<std::uint8_t>   creases(newNumEdges, 0);
+
+            GetSharedThreadPool().ParallelFor(
+                numEdges, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto e = begin; e < end; ++e)
+                    {
+                        const auto midpoint = static_cast<VertexIndex>(numPositions + e);
+
+                        edges[e*2    ] = Edge(edges_[e].a, midpoint);
+                        edges[e*2 + 1] = Edge(edges_[e].b, midpoint);
+
+                        std::fill(&sides[e*4], &sides[e*4 + 4], invalidSide);
+
+                        creases[e*2    ] = creases_[e];
+                        creases[e*2 + 1] = creases_[e];
+                    }
+                }
+            );
+
+            /* Split each triangle into four triangles */
+            TriangleMesh::TriangleArray     triangles(numTriangles * 4);
+            std::vector<Triangle>           corners(numTriangles * 4);
+            std::vector<EdgeIndex>          triangleEdges(numTriangles * 12);
+
+            GetSharedThreadPool().ParallelFor(
+                numTriangles, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto t = begin; t < end; ++t)
+                    {
+                        const auto& tri = triangles_[t];
+                        const auto& c   = corners_[t];
+
+                        VertexIndex m[3], am[3];
+                        EdgeIndex   e[3], inner[3];
+                        bool        registered[3];
+
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            e[k] = triangleEdges_[t*3 + k];
+
+                            const auto s = SideOfCorner(e[k], c[k]);
+
+                            m[k]            = static_cast<VertexIndex>(numPositions + e[k]);
+                            am[k]           = static_cast<VertexIndex>(numVerts + edgeVertexOffsets[e[k]] + (IsSeam(e[k]) ? s : 0));
+                            inner[k]        = numEdges*2 + t*3 + k;
+                            registered[k]   = (sides_[e[k]*2 + s] == t*3 + k);
+                        }
+
+                        /* Inner edges between the midpoints: (m0, m1), (m1, m2), (m2, m0) */
+                        for (int k = 0; k < 3; ++k)
+                        {
+                            const auto a = m[k], b = m[(k + 1) % 3];
+                            edges[inner[k]] = (a < b ? Edge(a, b) : Edge(b, a));
+                        }
+
+                        auto ChildEdge = [&](int k, VertexIndex v) -> EdgeIndex
+                        {
+                            return (e[k]*2 + (v == edges_[e[k]].a ? 0 : 1));
+                        };
+
+                        const auto t0 = t*4;
+
+                        /* Corner triangles, and center triangle */
+                        triangles[t0    ] = Triangle(tri.a, am[0], am[2]);
+                        triangles[t0 + 1] = Triangle(tri.b, am[1], am[0]);
+                        triangles[t0 + 2] = Triangle(tri.c, am[2], am[1]);
+                        triangles[t0 + 3] = Triangle(am[0], am[1], am[2]);
+
+                        corners[t0    ] = Triangle(c.a, m[0], m[2]);
+                        corners[t0 + 1] = Triangle(c.b, m[1], m[0]);
+                        corners[t0 + 2] = Triangle(c.c, m[2], m[1]);
+                        corners[t0 + 3] = Triangle(m[0], m[1], m[2]);
+
+                        const EdgeIndex childEdges[12] =
+                        {
+                            ChildEdge(0, c.a), inner[2], ChildEdge(2, c.a),
+                            ChildEdge(1, c.b), inner[0], ChildEdge(0, c.b),
+                            ChildEdge(2, c.c), inner[1], ChildEdge(1, c.c),
+                            inner[0],          inner[1], inner[2],
+                        };
+
+                        // Parent edge of each child edge, or -1 for inner edges
+                        static const int parentEdges[12] =
+                        {
+                             0, -1,  2,
+                             1, -1,  0,
+                             2, -1,  1,
+                            -1, -1, -1,
+                        };
+
+                        /* Register the sides of the child edges (only once per side, i.e. only if the parent triangle was registered) */
+                        for (int i = 0; i < 12; ++i)
+                        {
+                            const auto ce = childEdges[i];
+                            const auto ct = t0 + static_cast<std::size_t>(i / 3);
+
+                            triangleEdges[t0*3 + i] = ce;
+
+                            if (parentEdges[i] < 0 || registered[parentEdges[i]])
+                            {
+                                const auto from = corners[ct][i % 3];
+                                sides[ce*2 + (from == edges[ce].a ? 0 : 1)] = t0*3 + i;
+                            }
+                        }
+                    }
+                }
+            );
+
+            /* Replace the previous level */
+            positions_      = std::move(positions);
+            edges_          = std::move(edges);
+            sides_          = std::move(sides);
+            creases_        = std::move(creases);
+            triangles_      = std::move(triangles);
+            corners_        = std::move(corners);
+            triangleEdges_  = std::move(triangleEdges);
+        }
+
+        // Writes the current level into the specified mesh.
+        void GetMesh(TriangleMesh& mesh) const
+        {
+            const auto numVerts = vertices_.size();
+
+            mesh.vertices.assign(vertices_.begin(), vertices_.end());
+
+            GetSharedThreadPool().ParallelFor(
+                numVerts, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        mesh.vertices[i].position = positions_[canonical_[i]];
+                }
+            );
+
+            mesh.triangles.assign(triangles_.begin(), triangles_.end());
+        }
+
+    private:
+
+        // Returns the canonical vertex of the specified triangle corner.
+        VertexIndex CornerOf(std::size_t triangle, int corner) const
+        {
+            return corners_[triangle][corner];
+        }
+
+        // Returns the side of the specified edge which is traversed by a triangle edge that starts at the specified canonical vertex.
+        std::size_t SideOfCorner(EdgeIndex e, VertexIndex from) const
+        {
+            return (from == edges_[e].a ? 0 : 1);
+        }
+
+        // Returns true if the specified edge is sharp, i.e. a crease or a border edge.
+        bool IsSharp(EdgeIndex e) const
+        {
+            return (creases_[e] != 0 || sides_[e*2] == invalidSide || sides_[e*2 + 1] == invalidSide);
+        }
+
+        // Returns true if the triangles on both sides of the specified edge refer to different attribute vertices.
+        bool IsSeam(EdgeIndex e) const
+        {
+            const auto s0 = sides_[e*2], s1 = sides_[e*2 + 1];
+
+            if (s0 == invalidSide || s1 == invalidSide)
+                return false;
+
+            const auto& t0 = triangles_[s0 / 3];
+            const auto& t1 = triangles_[s1 / 3];
+            const auto  k0 = static_cast<int>(s0 % 3);
+            const auto  k1 = static_cast<int>(s1 % 3);
+
+            /* Side 0 traverses the edge from 'a' to 'b', and side 1 from 'b' to 'a' */
+            return (t0[k0] != t1[(k1 + 1) % 3] || t0[(k0 + 1) % 3] != t1[k1]);
+        }
+
+        // Returns the canonical vertex opposite to the specified side of an edge.
+        VertexIndex OppositeCorner(std::size_t side) const
+        {
+            return CornerOf(side / 3, static_cast<int>(side % 3 + 2) % 3);
+        }
+
+        void MarkCreaseAngle(Gs::Real creaseAngle)
+        {
+            const auto numTriangles = corners_.size();
+            const auto numEdges     = edges_.size();
+
+            std::vector<Gs::Vector3> faceNormals(numTriangles);
+
+            GetSharedThreadPool().ParallelFor(
+                numTriangles, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto& c = corners_[i];
+                        const auto  n = Gs::Cross(positions_[c.b] - positions_[c.a], positions_[c.c] - positions_[c.a]);
+                        const auto  len = n.Length();
+                        faceNormals[i] = (len > Gs::Real(0) ? n * (Gs::Real(1) / len) : Gs::Vector3());
+                    }
+                }
+            );
+
+            const auto minCosine = std::cos(creaseAngle);
+
+            GetSharedThreadPool().ParallelFor(
+                numEdges, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto e = begin; e < end; ++e)
+                    {
+                        const auto s0 = sides_[e*2], s1 = sides_[e*2 + 1];
+                        if (s0 == invalidSide || s1 == invalidSide)
+                            continue;
+
+                        const auto& n0 = faceNormals[s0 / 3];
+                        const auto& n1 = faceNormals[s1 / 3];
+
+                        /* Degenerated triangles (with a zero normal) never make a crease */
+                        if (n0.LengthSq() > Gs::Real(0) && n1.LengthSq() > Gs::Real(0) && Gs::Dot(n0, n1) < minCosine)
+                            creases_[e] = 1;
+                    }
+                }
+            );
+        }
+
+        /*
+        Smooth vertices are weighted with Loop's mask, vertices with two sharp edges with the crease mask (3/4, 1/8, 1/8),
+        and vertices with one or more than two sharp edges (corners) keep their position.
+        */
+        void ComputeVertexPoints(std::vector<Gs::Vector3>& positions) const
+        {
+            const auto numPositions = positions_.size();
+            const auto numEdges     = edges_.size();
+
+            /* Build vertex-to-edge table (CSR) */
+            std::vector<EdgeIndex> offsets(numPositions + 1, 0), entries(numEdges * 2);
+
+            for (const auto& edge : edges_)
+            {
+                ++offsets[edge.a + 1];
+                ++offsets[edge.b + 1];
+            }
+
+            for (std::size_t i = 0; i < numPositions; ++i)
+                offsets[i + 1] += offsets[i];
+
+            std::vector<EdgeIndex> cursor(offsets.begin(), offsets.end() - 1);
+
+            for (EdgeIndex e = 0; e < numEdges; ++e)
+            {
+                entries[cursor[edges_[e].a]++] = e;
+                entries[cursor[edges_[e].b]++] = e;
+            }
+
+            /* Apply the vertex masks */
+            GetSharedThreadPool().ParallelFor(
+                numPositions, subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto v = begin; v < end; ++v)
+                    {
+                        Gs::Vector3 sum, sharpSum;
+                        std::size_t valence = 0, numSharp = 0;
+
+                        for (auto i = offsets[v]; i < offsets[v + 1]; ++i)
+                        {
+                            const auto  e       = entries[i];
+                            const auto& edge    = edges_[e];
+                            const auto& p       = positions_[edge.a == v ? edge.b : edge.a];
+
+                            sum += p;
+                            ++valence;
+
+                            if (IsSharp(e))
+                            {
+                                sharpSum += p;
+                                ++numSharp;
+                            }
+                        }
+
+                        const auto& p = positions_[v];
+
+                        if (numSharp == 2)
+                            positions[v] = p * Gs::Real(0.75) + sharpSum * Gs::Real(0.125);
+                        else if (numSharp == 0 && valence > 0)
+                        {
+                            const auto beta = LoopBeta(valence);
+                            positions[v] = p * (Gs::Real(1) - static_cast<Gs::Real>(valence) * beta) + sum * beta;
+                        }
+                        else
+                            positions[v] = p;
+                    }
+                }
+            );
+        }
+
+        // Smooth edges are weighted with (3/8, 3/8, 1/8, 1/8) including the opposite vertices, and sharp edges are split at their midpoint.
+        void ComputeEdgePoints(std::vector<Gs::Vector3>& positions) const
+        {
+            const auto numPositions = positions_.size();
+
+            GetSharedThreadPool().ParallelFor(
+                edges_.size(), subdivideGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto e = begin; e < end; ++e)
+                    {
+                        const auto& a = positions_[edges_[e].a];
+                        const auto& b = positions_[edges_[e].b];
+
+                        if (IsSharp(e))
+                            positions[numPositions + e] = (a + b) * Gs::Real(0.5);
+                        else
+                        {
+                            const auto& c = positions_[OppositeCorner(sides_[e*2    ])];
+                            const auto& d = positions_[OppositeCorner(sides_[e*2 + 1])];
+                            positions[numPositions + e] = (a + b) * Gs::Real(0.375) + (c + d) * Gs::Real(0.125);
+                        }
+                    }
+                }
+            );
+        }
+
+        std::vector<Gs::Vector3>            positions_;     // Per canonical vertex
+        std::vector<TriangleMesh::Vertex>   vertices_;      // Per attribute vertex (the positions are taken from the canonical vertices)
+        std::vector<VertexIndex>            canonical_;     // Canonical vertex of each attribute vertex
+        TriangleMesh::TriangleArray         triangles_;     // Triangles with attribute vertices
+        std::vector<Triangle>               corners_;       // Triangles with canonical vertices
+        std::vector<EdgeIndex>              triangleEdges_; // Three edges per triangle, in the order (a, b), (b, c), (c, a)
+        std::vector<Edge>                   edges_;         // Canonical edges (a, b) with a < b
+        std::vector<std::size_t>            sides_;         // Two sides per edge: triangle index * 3 + corner index
+        std::vector<std::uint8_t>           creases_;       // Non-zero for crease edges
+
+};
+
+
+/* ----- Global functions ----- */
+
+void Subdivide(TriangleMesh& mesh, std::size_t levels, const SubdivisionDescriptor& desc)
+{
+    if (levels == 0 || mesh.triangles.empty())
+        return;
+
+    LoopSubdivider subdivider(mesh, desc);
+
+    for (std::size_t i = 0; i < levels; ++i)
+        subdivider.Refine();
+
+    /* Recompute the normals of the smooth surface, then replace the input mesh */
+    TriangleMesh result;
+    subdivider.GetMesh(result);
+
+    ComputeNormals(result, desc.creaseAngle);
+
+    mesh = std::move(result);
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
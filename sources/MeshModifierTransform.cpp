@@ -0,0 +1,199 @@
+/*
+ * MeshModifierTransform.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
+#include "SIMDDetails.h"
+
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using Vertex = TriangleMesh::Vertex;
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per chunk for the parallel transformation.
+static const std::size_t transformGrainSize = 8192;
+
+// Columns of the position and normal transformations.
+struct TransformColumns
+{
+    Gs::Vector3 position[4];
+    Gs::Vector3 normal[3];
+};
+
+/*
+Returns the columns of the specified matrix, and the columns of its cofactor matrix for the normals.
+With the columns a, b, c of the upper-left 3x3 matrix M, the cofactor matrix [b x c, c x a, a x b] equals det(M) * M^-T,
+so its sign-corrected version is the inverse-transpose up to a positive factor (which the normalization removes), and it also exists for singular matrices.
+*/
+static TransformColumns GetTransformColumns(const Gs::AffineMatrix4& matrix)
+{
+    TransformColumns columns;
+
+    for (int i = 0; i < 4; ++i)
+        columns.position[i] = Gs::Vector3(matrix(0, i), matrix(1, i), matrix(2, i));
+
+    const auto& a = columns.position[0];
+    const auto& b = columns.position[1];
+    const auto& c = columns.position[2];
+
+    columns.normal[0] = Gs::Cross(b, c);
+    columns.normal[1] = Gs::Cross(c, a);
+    columns.normal[2] = Gs::Cross(a, b);
+
+    if (Gs::Dot(a, columns.normal[0]) < Gs::Real(0))
+    {
+        for (auto& col : columns.normal)
+            col = -col;
+    }
+
+    return columns;
+}
+
+static void NormalizeOrZero(Gs::Vector3& normal)
+{
+    const auto lengthSq = normal.LengthSq();
+    if (lengthSq > Gs::Real(0))
+        normal *= (Gs::Real(1) / std::sqrt(lengthSq));
+}
+
+// Transforms a range of vertices from 'src' to 'dst' (which may be equal) and returns the bounding box of the transformed positions.
+static AABB3 TransformVertexRange(const Vertex* src, Vertex* dst, std::size_t count, const TransformColumns& columns)
+{
+    AABB3 box;
+
+    #ifdef GM_SIMD_SSE2
+
+    using SIMDVector3 = Details::SIMDVector3<Gs::Real>;
+
+    const SIMDVector3 positionColumns[4] =
+    {
+        SIMDVector3::Set(columns.position[0].x, columns.position[0].y, columns.position[0].z),
+        SIMDVector3::Set(columns.position[1].x, columns.position[1].y, columns.position[1].z),
+        SIMDVector3::Set(columns.position[2].x, columns.position[2].y, columns.position[2].z),
+        SIMDVector3::Set(columns.position[3].x, columns.position[3].y, columns.position[3].z),
+    };
+
+    const SIMDVector3 normalColumns[3] =
+    {
+        SIMDVector3::Set(columns.normal[0].x, columns.normal[0].y, columns.normal[0].z),
+        SIMDVector3::Set(columns.normal[1].x, columns.normal[1].y, columns.normal[1].z),
+        SIMDVector3::Set(columns.normal[2].x, columns.normal[2].y, columns.normal[2].z),
+    };
+
+    auto boxMin = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::max());
+    auto boxMax = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::lowest());
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto point  = SIMDVector3::MulAdd(src[i].position, positionColumns);
+        auto normal = SIMDVector3::Mul(src[i].normal, normalColumns);
+
+        boxMin.Min(point);
+        boxMax.Max(point);
+
+        point.Store(dst[i].position);
+        normal.Store(dst[i].normal);
+        NormalizeOrZero(dst[i].normal);
+
+        dst[i].texCoord = src[i].texCoord;
+    }
+
+    boxMin.Store(box.min);
+    boxMax.Store(box.max);
+
+    #else
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto& p = src[i].position;
+        const auto& n = src[i].normal;
+
+        const auto position = columns.position[0]*p.x + columns.position[1]*p.y + columns.position[2]*p.z + columns.position[3];
+        const auto normal   = columns.normal[0]*n.x + columns.normal[1]*n.y + columns.normal[2]*n.z;
+
+        box.Insert(position);
+
+        dst[i].position = position;
+        dst[i].normal   = normal;
+        NormalizeOrZero(dst[i].normal);
+
+        dst[i].texCoord = src[i].texCoord;
+    }
+
+    #endif
+
+    return box;
+}
+
+// Transforms all vertices in chunks on the shared thread pool, and merges the bounding boxes of all chunks.
+static void ParallelTransform(const Vertex* src, Vertex* dst, std::size_t numVerts, const Gs::AffineMatrix4& matrix, AABB3* boundingBox)
+{
+    const auto columns = GetTransformColumns(matrix);
+
+    AABB3 box;
+    std::mutex boxMutex;
+
+    GetSharedThreadPool().ParallelFor(
+        numVerts, transformGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            auto subBox = TransformVertexRange(src + begin, dst + begin, end - begin, columns);
+            std::lock_guard<std::mutex> guard { boxMutex };
+            box.Insert(subBox);
+        }
+    );
+
+    if (boundingBox)
+        *boundingBox = box;
+}
+
+
+/* ----- Global functions ----- */
+
+void Transform(TriangleMesh& mesh, const Gs::AffineMatrix4& matrix, AABB3* boundingBox)
+{
+    ParallelTransform(mesh.vertices.data(), mesh.vertices.data(), mesh.vertices.size(), matrix, boundingBox);
+    mesh.InvalidateCache();
+}
+
+void Transform(const TriangleMesh& mesh, const Gs::AffineMatrix4& matrix, TriangleMesh& result, AABB3* boundingBox)
+{
+    if (&mesh == &result)
+    {
+        Transform(result, matrix, boundingBox);
+        return;
+    }
+
+    result.vertices.resize(mesh.vertices.size());
+    result.triangles.assign(mesh.triangles.begin(), mesh.triangles.end());
+
+    ParallelTransform(mesh.vertices.data(), result.vertices.data(), mesh.vertices.size(), matrix, boundingBox);
+
+    result.InvalidateCache();
+    result.InvalidateAdjacency();
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -0,0 +1,355 @@
+/*
+ * MeshModifierWeld.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
+
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+
+
+namespace Gm
+{
+
+namespace MeshModifier
+{
+
+
+using VertexIndex = TriangleMesh::VertexIndex;
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per chunk for the parallel grid passes.
+static const std::size_t weldGrainSize = 8192;
+
+// Uniform grid over the vertex positions, whose cells are hashed into a bucket table in CSR layout.
+class VertexHashGrid
+{
+
+    public:
+
+        VertexHashGrid(const TriangleMesh& mesh, Gs::Real epsilon) :
+            vertices_ { mesh.vertices },
+            epsilon_  { std::max(Gs::Real(0), epsilon) }
+        {
+            const auto numVerts = vertices_.size();
+
+            SetupCellSize(mesh.BoundingBox(), numVerts);
+
+            /* Allocate bucket table with a power-of-two size (at least the number of vertices) */
+            std::size_t numBuckets = 1;
+            while (numBuckets < numVerts)
+                numBuckets <<= 1;
+
+            bucketMask_ = numBuckets - 1;
+
+            std::unique_ptr<std::atomic<std::size_t>[]> counters { new std::atomic<std::size_t>[numBuckets] };
+            for (std::size_t i = 0; i < numBuckets; ++i)
+                counters[i] = 0;
+
+            /* Count vertices per bucket */
+            auto& pool = GetSharedThreadPool();
+
+            pool.ParallelFor(
+                numVerts, weldGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                        counters[BucketOf(CellOf(vertices_[i].position))].fetch_add(1, std::memory_order_relaxed);
+                }
+            );
+
+            /* Convert counters to start offsets */
+            std::size_t sum = 0;
+            for (std::size_t i = 0; i < numBuckets; ++i)
+            {
+                auto count = counters[i].load(std::memory_order_relaxed);
+                counters[i].store(sum, std::memory_order_relaxed);
+                sum += count;
+            }
+
+            /* Scatter vertices into buckets (the order within a bucket is irrelevant for the queries) */
+            bucketVertices_.resize(numVerts);
+
+            pool.ParallelFor(
+                numVerts, weldGrainSize,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        auto slot = counters[BucketOf(CellOf(vertices_[i].position))].fetch_add(1, std::memory_order_relaxed);
+                        bucketVertices_[slot] = static_cast<VertexIndex>(i);
+                    }
+                }
+            );
+
+            /* Each counter is now the end offset of its bucket */
+            bucketEnds_.resize(numBuckets);
+            for (std::size_t i = 0; i < numBuckets; ++i)
+                bucketEnds_[i] = counters[i].load(std::memory_order_relaxed);
+        }
+
+        // Returns the smallest vertex index whose position equals the position of the specified vertex within the tolerance.
+        VertexIndex FindFirstEqual(VertexIndex vertexIndex) const
+        {
+            const auto& p = vertices_[vertexIndex].position;
+
+            /* Determine the neighbor cells which are closer than the tolerance (at most one per axis, since cells are at least 2*epsilon wide) */
+            Cell cell;
+            int neighbor[3];
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                auto t = (p[axis] - origin_[axis]) * invCellSize_;
+                auto c = std::floor(t);
+
+                cell.c[axis] = ToCellCoord(c);
+
+                if (t - c <= relEpsilon_)
+                    neighbor[axis] = -1;
+                else if (c + Gs::Real(1) - t <= relEpsilon_)
+                    neighbor[axis] = 1;
+                else
+                    neighbor[axis] = 0;
+            }
+
+            /* Search all vertices in the cell and its neighbors */
+            auto first = vertexIndex;
+
+            for (int i = 0; i < 8; ++i)
+            {
+                if ( ( (i & 1) != 0 && neighbor[0] == 0 ) ||
+                     ( (i & 2) != 0 && neighbor[1] == 0 ) ||
+                     ( (i & 4) != 0 && neighbor[2] == 0 ) )
+                {
+                    continue;
+                }
+
+                Cell n = cell;
+                if ((i & 1) != 0) n.c[0] += neighbor[0];
+                if ((i & 2) != 0) n.c[1] += neighbor[1];
+                if ((i & 4) != 0) n.c[2] += neighbor[2];
+
+                /* Buckets may contain vertices of other cells, but those fail the distance test anyway */
+                auto bucket = BucketOf(n);
+                auto begin  = (bucket > 0 ? bucketEnds_[bucket - 1] : 0);
+                auto end    = bucketEnds_[bucket];
+
+                for (auto j = begin; j < end; ++j)
+                {
+                    auto v = bucketVertices_[j];
+                    if (v < first && IsEqual(vertices_[v].position, p))
+                        first = v;
+                }
+            }
+
+            return first;
+        }
+
+    private:
+
+        struct Cell
+        {
+            std::int64_t c[3];
+        };
+
+        void SetupCellSize(const AABB3& box, std::size_t numVerts)
+        {
+            origin_ = box.min;
+
+            /* Choose the cell size for about one vertex per cell, over all axes the mesh actually extends in */
+            auto extent = box.max - box.min;
+
+            Gs::Real volume = 1, maxExtent = 0;
+            int dimensions = 0;
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                if (extent[axis] > Gs::Real(0))
+                {
+                    volume *= extent[axis];
+                    maxExtent = std::max(maxExtent, extent[axis]);
+                    ++dimensions;
+                }
+            }
+
+            Gs::Real cellSize = 1;
+
+            if (dimensions > 0 && numVerts > 0)
+                cellSize = std::pow(volume / static_cast<Gs::Real>(numVerts), Gs::Real(1) / static_cast<Gs::Real>(dimensions));
+
+            /* Cells must be wider than twice the tolerance, and there must not be too many cells along an axis */
+            cellSize = std::max(cellSize, epsilon_ * Gs::Real(2.001));
+            cellSize = std::max(cellSize, maxExtent * Gs::Real(1.0e-9));
+
+            if (!(cellSize > Gs::Real(0)) || !std::isfinite(cellSize))
+                cellSize = 1;
+
+            invCellSize_    = Gs::Real(1) / cellSize;
+            relEpsilon_     = epsilon_ * invCellSize_;
+        }
+
+        // Converts the floored cell coordinate to an integer (non-finite coordinates are clamped).
+        static std::int64_t ToCellCoord(Gs::Real c)
+        {
+            static const Gs::Real limit = Gs::Real(1ll << 62);
+            if (!(c >= -limit))
+                return -(1ll << 62);
+            if (!(c <= limit))
+                return (1ll << 62);
+            return static_cast<std::int64_t>(c);
+        }
+
+        Cell CellOf(const Gs::Vector3& p) const
+        {
+            Cell cell;
+            for (int axis = 0; axis < 3; ++axis)
+                cell.c[axis] = ToCellCoord(std::floor((p[axis] - origin_[axis]) * invCellSize_));
+            return cell;
+        }
+
+        std::size_t BucketOf(const Cell& cell) const
+        {
+            auto h = static_cast<std::uint64_t>(cell.c[0]) * 0x9E3779B97F4A7C15ull;
+            h ^= static_cast<std::uint64_t>(cell.c[1]) * 0xC2B2AE3D27D4EB4Full;
+            h ^= static_cast<std::uint64_t>(cell.c[2]) * 0x165667B19E3779F9ull;
+            h ^= (h >> 29);
+            return static_cast<std::size_t>(h) & bucketMask_;
+        }
+
+        bool IsEqual(const Gs::Vector3& a, const Gs::Vector3& b) const
+        {
+            return
+            (
+                std::abs(a.x - b.x) <= epsilon_ &&
+                std::abs(a.y - b.y) <= epsilon_ &&
+                std::abs(a.z - b.z) <= epsilon_
+            );
+        }
+
+        const TriangleMesh::VertexArray&            vertices_;
+
+        Gs::Real                                    epsilon_        = 0;
+        Gs::Real                                    relEpsilon_     = 0;    // Tolerance relative to the cell size
+        Gs::Vector3                                 origin_;
+        Gs::Real                                    invCellSize_    = 1;
+
+        std::size_t                                 bucketMask_     = 0;
+        std::vector<std::size_t>                    bucketEnds_;
+        std::vector<VertexIndex>                    bucketVertices_;
+
+};
+
+
+/* ----- Global functions ----- */
+
+void FindCanonicalVertices(const TriangleMesh& mesh, Gs::Real epsilon, std::vector<VertexIndex>& canonicalIndices)
+{
+    const auto numVerts = mesh.vertices.size();
+
+    canonicalIndices.resize(numVerts);
+
+    if (numVerts == 0)
+        return;
+
+    /* Find the first equal vertex for each vertex */
+    VertexHashGrid grid(mesh, epsilon);
+
+    GetSharedThreadPool().ParallelFor(
+        numVerts, weldGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                canonicalIndices[i] = grid.FindFirstEqual(static_cast<VertexIndex>(i));
+        }
+    );
+
+    /*
+    Resolve chains of equal vertices (only possible with a tolerance), so every index refers to a canonical vertex.
+    Since canonicalIndices[i] <= i, the referenced entry has already been resolved.
+    */
+    for (std::size_t i = 0; i < numVerts; ++i)
+        canonicalIndices[i] = canonicalIndices[canonicalIndices[i]];
+}
+
+std::size_t WeldVertices(TriangleMesh& mesh, Gs::Real epsilon, std::vector<VertexIndex>* remapTable)
+{
+    const auto numVerts = mesh.vertices.size();
+
+    /* Find canonical vertices and assign new indices to them in ascending order */
+    std::vector<VertexIndex> remap;
+    FindCanonicalVertices(mesh, epsilon, remap);
+
+    std::vector<VertexIndex> canonicalVerts;
+
+    for (std::size_t i = 0; i < numVerts; ++i)
+    {
+        if (remap[i] == i)
+        {
+            remap[i] = static_cast<VertexIndex>(canonicalVerts.size());
+            canonicalVerts.push_back(static_cast<VertexIndex>(i));
+        }
+        else
+            remap[i] = remap[remap[i]];
+    }
+
+    const auto numWeldedVerts = canonicalVerts.size();
+
+    if (numWeldedVerts < numVerts)
+    {
+        auto& pool = GetSharedThreadPool();
+
+        /* Compact vertices */
+        TriangleMesh::VertexArray weldedVertices(numWeldedVerts, TriangleMesh::Vertex(), mesh.vertices.get_allocator());
+
+        pool.ParallelFor(
+            numWeldedVerts, weldGrainSize,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                    weldedVertices[i] = mesh.vertices[canonicalVerts[i]];
+            }
+        );
+
+        mesh.vertices = std::move(weldedVertices);
+
+        /* Remap triangle indices */
+        pool.ParallelFor(
+            mesh.triangles.size(), weldGrainSize,
+            [&](std::size_t begin, std::size_t end)
+            {
+                for (auto i = begin; i < end; ++i)
+                {
+                    auto& tri = mesh.triangles[i];
+                    tri.a = remap[tri.a];
+                    tri.b = remap[tri.b];
+                    tri.c = remap[tri.c];
+                }
+            }
+        );
+
+        mesh.InvalidateAdjacency();
+        mesh.InvalidateCache();
+    }
+
+    if (remapTable)
+        *remapTable = std::move(remap);
+
+    return (numVerts - numWeldedVerts);
+}
+
+
+} // /namespace MeshModifier
+
+} // /namespace Gm
+
+
+
+// ================================================================================
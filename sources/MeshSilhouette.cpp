@@ -0,0 +1,177 @@
+/*
+ * MeshSilhouette.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshSilhouette.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/ThreadPool.h>
+#include <Gauss/Epsilon.h>
+
+#include <cmath>
+#include <limits>
+
+
+namespace Gm
+{
+
+
+static const std::size_t parallelGrainSize = 4096;
+
+MeshSilhouette::MeshSilhouette(const TriangleMesh& mesh)
+{
+    Build(mesh);
+}
+
+void MeshSilhouette::Build(const TriangleMesh& mesh)
+{
+    /* Get adjacency index from the mesh or build a temporary one */
+    MeshAdjacency tempAdjacency;
+
+    auto adjacency = mesh.GetAdjacency();
+    if (!adjacency)
+    {
+        tempAdjacency.Build(mesh);
+        adjacency = &tempAdjacency;
+    }
+
+    /* Take over edges and edge-to-triangle map */
+    edges_ = adjacency->GetEdges();
+
+    const auto numEdges = edges_.size();
+
+    edgeTriangleOffsets_.resize(numEdges + 1);
+    edgeTriangles_.clear();
+    edgeTriangles_.reserve(mesh.triangles.size() * 3);
+
+    for (std::size_t i = 0; i < numEdges; ++i)
+    {
+        edgeTriangleOffsets_[i] = edgeTriangles_.size();
+        auto tris = adjacency->EdgeTriangles(i);
+        edgeTriangles_.insert(edgeTriangles_.end(), tris.begin(), tris.end());
+    }
+
+    edgeTriangleOffsets_[numEdges] = edgeTriangles_.size();
+
+    /* Compute face normals and plane distances */
+    const auto numTriangles = mesh.triangles.size();
+
+    faceNormals_.resize(numTriangles);
+    faceDistances_.resize(numTriangles);
+
+    GetSharedThreadPool().ParallelFor(
+        numTriangles, parallelGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                /* Normals are taken from the mesh, which only computes them once if its derived-data cache is enabled */
+                faceNormals_[i]     = mesh.TriangleNormal(i);
+                faceDistances_[i]   = Gs::Dot(faceNormals_[i], mesh.vertices[mesh.triangles[i].a].position);
+            }
+        }
+    );
+
+    /* Compute dihedral deviation for each edge (border edges get the maximal deviation) */
+    edgeDeviations_.resize(numEdges);
+
+    GetSharedThreadPool().ParallelFor(
+        numEdges, parallelGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+            {
+                auto first  = edgeTriangleOffsets_[i];
+                auto last   = edgeTriangleOffsets_[i + 1];
+
+                if (last - first >= 2)
+                {
+                    const auto& normalPattern = faceNormals_[edgeTriangles_[first]];
+
+                    Gs::Real deviation = 0;
+                    for (auto j = first + 1; j < last; ++j)
+                        deviation = std::max(deviation, std::abs(Gs::Dot(faceNormals_[edgeTriangles_[j]], normalPattern) - Gs::Real(1)));
+
+                    edgeDeviations_[i] = deviation;
+                }
+                else
+                    edgeDeviations_[i] = std::numeric_limits<Gs::Real>::max();
+            }
+        }
+    );
+}
+
+void MeshSilhouette::Clear()
+{
+    edges_.clear();
+    edgeDeviations_.clear();
+    edgeTriangleOffsets_.clear();
+    edgeTriangles_.clear();
+    faceNormals_.clear();
+    faceDistances_.clear();
+}
+
+std::vector<MeshSilhouette::Edge> MeshSilhouette::CreaseEdges(Gs::Real toleranceAngle) const
+{
+    /* Adjust tolerance angle to sine-curve and absolute value */
+    const auto threshold = Gs::Epsilon<Gs::Real>() + std::sin(std::abs(toleranceAngle));
+
+    /* Select all edges whose triangle normals deviate too much */
+    std::vector<Edge> edges;
+
+    for (std::size_t i = 0; i < edges_.size(); ++i)
+    {
+        if (edgeDeviations_[i] >= threshold)
+            edges.push_back(edges_[i]);
+    }
+
+    return edges;
+}
+
+std::vector<MeshSilhouette::Edge> MeshSilhouette::SilhouetteEdges(const Gs::Vector3& viewPoint) const
+{
+    /* Classify all triangles as front- or back-facing */
+    const auto numTriangles = faceNormals_.size();
+
+    std::vector<char> frontFacing(numTriangles);
+
+    GetSharedThreadPool().ParallelFor(
+        numTriangles, parallelGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                frontFacing[i] = (Gs::Dot(faceNormals_[i], viewPoint) > faceDistances_[i] ? 1 : 0);
+        }
+    );
+
+    /* Select all border edges and all edges between front- and back-facing triangles */
+    std::vector<Edge> edges;
+
+    for (std::size_t i = 0; i < edges_.size(); ++i)
+    {
+        auto first  = edgeTriangleOffsets_[i];
+        auto last   = edgeTriangleOffsets_[i + 1];
+
+        bool silhouette = (last - first < 2);
+
+        for (auto j = first + 1; j < last && !silhouette; ++j)
+        {
+            if (frontFacing[edgeTriangles_[j]] != frontFacing[edgeTriangles_[first]])
+                silhouette = true;
+        }
+
+        if (silhouette)
+            edges.push_back(edges_[i]);
+    }
+
+    return edges;
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
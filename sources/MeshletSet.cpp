@@ -0,0 +1,491 @@
+/*
+ * MeshletSet.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/MeshletSet.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/PlaneCollision.h>
+#include <Geom/ThreadPool.h>
+#include "Except.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+static const std::size_t parallelGrainSize = 1024;
+
+// Minimal cosine between the normal cone axis and any triangle normal for the cone to be usable for back-face culling.
+static const Gs::Real minConeCosine = Gs::Real(0.1);
+
+using TriangleIndex = TriangleMesh::TriangleIndex;
+
+static const TriangleIndex invalidTriangle = std::numeric_limits<TriangleIndex>::max();
+
+// Computes the bounding sphere of the specified vertices around the center of their bounding box.
+static Sphere ComputeBoundingSphere(const TriangleMesh& mesh, const TriangleMesh::VertexIndex* indices, std::size_t count)
+{
+    Gs::Vector3 minPoint = mesh.vertices[indices[0]].position;
+    Gs::Vector3 maxPoint = minPoint;
+
+    for (std::size_t i = 1; i < count; ++i)
+    {
+        const auto& p = mesh.vertices[indices[i]].position;
+        minPoint.x = std::min(minPoint.x, p.x);
+        minPoint.y = std::min(minPoint.y, p.y);
+        minPoint.z = std::min(minPoint.z, p.z);
+        maxPoint.x = std::max(maxPoint.x, p.x);
+        maxPoint.y = std::max(maxPoint.y, p.y);
+        maxPoint.z = std::max(maxPoint.z, p.z);
+    }
+
+    const auto center = (minPoint + maxPoint) * Gs::Real(0.5);
+
+    Gs::Real radiusSq = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        radiusSq = std::max(radiusSq, Gs::DistanceSq(center, mesh.vertices[indices[i]].position));
+
+    return Sphere(center, std::sqrt(radiusSq));
+}
+
+// Computes the normal cone of the specified triangles. See 'Meshlet::normalCone' for the layout of the cone.
+static Cone ComputeNormalCone(
+    const TriangleMesh&                 mesh,
+    const std::vector<Gs::Vector3>&     faceNormals,
+    const TriangleIndex*                triangles,
+    std::size_t                         count,
+    const Sphere&                       boundingSphere)
+{
+    /* Compute cone axis as the average normal */
+    Gs::Vector3 axis;
+    for (std::size_t i = 0; i < count; ++i)
+        axis += faceNormals[triangles[i]];
+
+    const auto axisLength = axis.Length();
+    if (axisLength <= Gs::Epsilon<Gs::Real>())
+        return Cone(boundingSphere.origin, Gs::Vector3(0, 0, 1), Gs::Real(0), Gs::Real(1));
+
+    axis *= (Gs::Real(1) / axisLength);
+
+    /* Find the maximal deviation of any normal from the axis */
+    Gs::Real minCosine = Gs::Real(1);
+    for (std::size_t i = 0; i < count; ++i)
+        minCosine = std::min(minCosine, Gs::Dot(faceNormals[triangles[i]], axis));
+
+    if (minCosine <= minConeCosine)
+        return Cone(boundingSphere.origin, axis, Gs::Real(0), Gs::Real(1));
+
+    /* Move tip along the negative axis until it is behind all triangle planes */
+    Gs::Real offset = 0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto& normal  = faceNormals[triangles[i]];
+        const auto& point   = mesh.vertices[mesh.triangles[triangles[i]].a].position;
+        offset = std::max(offset, Gs::Dot(boundingSphere.origin - point, normal) / Gs::Dot(axis, normal));
+    }
+
+    return Cone(
+        boundingSphere.origin - axis * offset,
+        axis,
+        minCosine,
+        std::sqrt(std::max(Gs::Real(0), Gs::Real(1) - minCosine*minCosine))
+    );
+}
+
+/*
+Greedy meshlet builder: each meshlet is grown from a seed triangle across shared vertices.
+The candidates are all unassigned triangles that share a vertex with the current meshlet.
+*/
+class MeshletBuilder
+{
+
+    public:
+
+        MeshletBuilder(const TriangleMesh& mesh, const MeshAdjacency& adjacency, const MeshletDescriptor& desc) :
+            mesh_               { mesh                                         },
+            adjacency_          { adjacency                                    },
+            desc_               { desc                                         },
+            vertexStamps_       ( mesh.vertices.size(), 0                      ),
+            vertexLocals_       ( mesh.vertices.size(), 0                      ),
+            liveTriangles_      ( mesh.vertices.size(), 0                      ),
+            candidateStamps_    ( mesh.triangles.size(), 0                     ),
+            assigned_           ( mesh.triangles.size(), false                 )
+        {
+            for (std::size_t i = 0; i < mesh.vertices.size(); ++i)
+                liveTriangles_[i] = static_cast<std::uint32_t>(adjacency.VertexTriangles(static_cast<TriangleMesh::VertexIndex>(i)).size());
+        }
+
+        // Computes the normals and centroids of all triangles in parallel.
+        void ComputeFaceData()
+        {
+            const auto numTriangles = mesh_.triangles.size();
+
+            faceNormals_.resize(numTriangles);
+            centroids_.resize(numTriangles);
+
+            GetSharedThreadPool().ParallelFor(
+                numTriangles, parallelGrainSize * 4,
+                [&](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        const auto& tri = mesh_.triangles[i];
+                        faceNormals_[i] = mesh_.TriangleNormal(i);
+                        centroids_[i]   = (
+                            mesh_.vertices[tri.a].position +
+                            mesh_.vertices[tri.b].position +
+                            mesh_.vertices[tri.c].position
+                        ) * (Gs::Real(1) / Gs::Real(3));
+                    }
+                }
+            );
+        }
+
+        void Build(std::vector<Meshlet>& meshlets, std::vector<TriangleMesh::VertexIndex>& vertexIndices, std::vector<std::uint8_t>& localIndices)
+        {
+            const auto numTriangles = mesh_.triangles.size();
+
+            std::vector<TriangleIndex> meshletTriangles;
+            meshletTriangles.reserve(desc_.maxTriangles);
+
+            std::size_t numAssigned = 0;
+
+            while (numAssigned < numTriangles)
+            {
+                /* Start new meshlet */
+                Meshlet meshlet;
+                meshlet.vertexOffset    = static_cast<std::uint32_t>(vertexIndices.size());
+                meshlet.triangleOffset  = static_cast<std::uint32_t>(localIndices.size() / 3);
+
+                ++stamp_;
+                centroidSum_    = Gs::Vector3();
+                normalSum_      = Gs::Vector3();
+                meshletTriangles.clear();
+
+                auto seed = SelectSeed();
+
+                while (seed != invalidTriangle)
+                {
+                    AddTriangle(seed, meshlet, vertexIndices, localIndices);
+                    meshletTriangles.push_back(seed);
+                    ++numAssigned;
+
+                    if (meshlet.numTriangles >= desc_.maxTriangles)
+                        break;
+
+                    seed = SelectCandidate(meshlet);
+                }
+
+                /* Compute bounds of the meshlet */
+                meshlet.boundingSphere  = ComputeBoundingSphere(mesh_, &vertexIndices[meshlet.vertexOffset], meshlet.numVertices);
+                meshlet.normalCone      = ComputeNormalCone(mesh_, faceNormals_, meshletTriangles.data(), meshletTriangles.size(), meshlet.boundingSphere);
+
+                meshlets.push_back(meshlet);
+            }
+        }
+
+    private:
+
+        // Returns the number of vertices of the specified triangle that are not yet part of the current meshlet.
+        std::size_t NumNewVertices(TriangleIndex triangleIndex) const
+        {
+            const auto& tri = mesh_.triangles[triangleIndex];
+
+            std::size_t count = 0;
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto v = tri[i];
+                if (vertexStamps_[v] != stamp_ && (i < 1 || v != tri[0]) && (i < 2 || v != tri[1]))
+                    ++count;
+            }
+
+            return count;
+        }
+
+        void AddTriangle(TriangleIndex triangleIndex, Meshlet& meshlet, std::vector<TriangleMesh::VertexIndex>& vertexIndices, std::vector<std::uint8_t>& localIndices)
+        {
+            const auto& tri = mesh_.triangles[triangleIndex];
+
+            assigned_[triangleIndex] = true;
+
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto v = tri[i];
+
+                /* Add vertex to the meshlet if it is not yet part of it */
+                if (vertexStamps_[v] != stamp_)
+                {
+                    vertexStamps_[v] = stamp_;
+                    vertexLocals_[v] = static_cast<std::uint8_t>(meshlet.numVertices++);
+                    vertexIndices.push_back(v);
+
+                    /* Append all unassigned triangles of this vertex to the candidates */
+                    for (auto neighbor : adjacency_.VertexTriangles(v))
+                    {
+                        if (!assigned_[neighbor] && candidateStamps_[neighbor] != stamp_)
+                        {
+                            candidateStamps_[neighbor] = stamp_;
+                            candidates_.push_back(neighbor);
+                        }
+                    }
+                }
+
+                localIndices.push_back(vertexLocals_[v]);
+            }
+
+            /* Each vertex of a degenerated triangle is only counted once in the adjacency index */
+            for (int i = 0; i < 3; ++i)
+            {
+                const auto v = tri[i];
+                if ((i < 1 || v != tri[0]) && (i < 2 || v != tri[1]))
+                    --liveTriangles_[v];
+            }
+
+            centroidSum_    += centroids_[triangleIndex];
+            normalSum_      += faceNormals_[triangleIndex];
+
+            ++meshlet.numTriangles;
+        }
+
+        // Selects the best candidate that still fits into the current meshlet, or returns 'invalidTriangle' if there is no such triangle.
+        TriangleIndex SelectCandidate(const Meshlet& meshlet)
+        {
+            const auto center   = centroidSum_ * (Gs::Real(1) / static_cast<Gs::Real>(meshlet.numTriangles));
+            const auto normal   = normalSum_.Normalized();
+
+            auto        best            = invalidTriangle;
+            std::size_t bestNewVertices = 4;
+            Gs::Real    bestScore       = 0;
+
+            for (std::size_t i = 0; i < candidates_.size();)
+            {
+                const auto triangleIndex = candidates_[i];
+
+                /* Remove candidates that have already been assigned */
+                if (assigned_[triangleIndex])
+                {
+                    candidates_[i] = candidates_.back();
+                    candidates_.pop_back();
+                    continue;
+                }
+
+                const auto numNewVertices = NumNewVertices(triangleIndex);
+
+                if (meshlet.numVertices + numNewVertices <= desc_.maxVertices && numNewVertices <= bestNewVertices)
+                {
+                    /* Prefer triangles with fewer new vertices first, then close triangles with a similar normal (score is compared squared) */
+                    const auto weight   = Gs::Real(1) + desc_.coneWeight * (Gs::Real(1) - Gs::Dot(normal, faceNormals_[triangleIndex]));
+                    const auto score    = Gs::DistanceSq(center, centroids_[triangleIndex]) * weight * weight;
+
+                    if (numNewVertices < bestNewVertices || score < bestScore)
+                    {
+                        best            = triangleIndex;
+                        bestNewVertices = numNewVertices;
+                        bestScore       = score;
+                    }
+                }
+
+                ++i;
+            }
+
+            if (best != invalidTriangle)
+                return best;
+
+            /* Continue with the next unassigned triangle in mesh order if the meshlet has no more connected candidates (e.g. for disconnected triangles) */
+            if (meshlet.numVertices + 3 <= desc_.maxVertices && candidates_.empty())
+                return NextUnassignedTriangle();
+
+            return invalidTriangle;
+        }
+
+        /*
+        Selects the seed triangle of a new meshlet: the remaining candidate of the previous meshlet with the fewest unassigned neighbors,
+        so the meshlets continue along the border of the unassigned region and leave fewer isolated triangles behind.
+        */
+        TriangleIndex SelectSeed()
+        {
+            auto            best        = invalidTriangle;
+            std::uint32_t   bestLive    = std::numeric_limits<std::uint32_t>::max();
+
+            for (auto triangleIndex : candidates_)
+            {
+                if (!assigned_[triangleIndex])
+                {
+                    const auto& tri = mesh_.triangles[triangleIndex];
+                    const auto live = liveTriangles_[tri.a] + liveTriangles_[tri.b] + liveTriangles_[tri.c];
+                    if (live < bestLive)
+                    {
+                        best        = triangleIndex;
+                        bestLive    = live;
+                    }
+                }
+            }
+
+            candidates_.clear();
+
+            return (best != invalidTriangle ? best : NextUnassignedTriangle());
+        }
+
+        TriangleIndex NextUnassignedTriangle()
+        {
+            while (nextTriangle_ < assigned_.size())
+            {
+                if (!assigned_[nextTriangle_])
+                    return nextTriangle_;
+                ++nextTriangle_;
+            }
+            return invalidTriangle;
+        }
+
+    private:
+
+        const TriangleMesh&         mesh_;
+        const MeshAdjacency&        adjacency_;
+        MeshletDescriptor           desc_;
+
+        std::vector<Gs::Vector3>    faceNormals_;
+        std::vector<Gs::Vector3>    centroids_;
+
+        std::uint32_t               stamp_          = 0;    // Current meshlet number (starting with 1) to avoid clearing the per-vertex and per-triangle flags
+        std::vector<std::uint32_t>  vertexStamps_;          // Stamp of the meshlet the vertex was last added to
+        std::vector<std::uint8_t>   vertexLocals_;          // Local index of the vertex within the meshlet of its stamp
+        std::vector<std::uint32_t>  liveTriangles_;         // Number of unassigned triangles per vertex
+        std::vector<std::uint32_t>  candidateStamps_;       // Stamp of the meshlet the triangle was last added to the candidates of
+        std::vector<bool>           assigned_;
+
+        std::vector<TriangleIndex>  candidates_;
+        TriangleIndex               nextTriangle_   = 0;
+
+        Gs::Vector3                 centroidSum_;
+        Gs::Vector3                 normalSum_;
+
+};
+
+
+/* ----- MeshletSet class ----- */
+
+MeshletSet::MeshletSet(const TriangleMesh& mesh, const MeshletDescriptor& desc)
+{
+    Build(mesh, desc);
+}
+
+void MeshletSet::Build(const TriangleMesh& mesh, const MeshletDescriptor& desc)
+{
+    /* Validate arguments */
+    if (desc.maxVertices < 3 || desc.maxVertices > 256)
+        throw std::invalid_argument(GM_EXCEPT_INFO("'maxVertices' must be in the range [3, 256]"));
+    if (desc.maxTriangles == 0)
+        throw std::invalid_argument(GM_EXCEPT_INFO("'maxTriangles' must be greater than zero"));
+    if (mesh.triangles.size() > std::numeric_limits<std::uint32_t>::max() / 3)
+        throw std::overflow_error(GM_EXCEPT_INFO("too many triangles for meshlet offsets"));
+
+    Clear();
+
+    /* Get adjacency index from the mesh or build a temporary one */
+    MeshAdjacency tempAdjacency;
+
+    auto adjacency = mesh.GetAdjacency();
+    if (!adjacency)
+    {
+        tempAdjacency.Build(mesh);
+        adjacency = &tempAdjacency;
+    }
+
+    /* Grow meshlets over the whole mesh */
+    localIndices_.reserve(mesh.triangles.size() * 3);
+
+    MeshletBuilder builder(mesh, *adjacency, desc);
+    builder.ComputeFaceData();
+    builder.Build(meshlets_, vertexIndices_, localIndices_);
+}
+
+void MeshletSet::Clear()
+{
+    meshlets_.clear();
+    vertexIndices_.clear();
+    localIndices_.clear();
+}
+
+bool MeshletSet::IsOutside(std::size_t meshletIndex, const Frustum& frustum) const
+{
+    const auto& sphere = meshlets_[meshletIndex].boundingSphere;
+
+    /* All frustum planes point out of the frustum */
+    for (int i = 0; i < 6; ++i)
+    {
+        if (SgnDistanceToPlane(frustum.GetPlane(static_cast<FrustumPlane>(i)), sphere.origin) > sphere.radius)
+            return true;
+    }
+
+    return false;
+}
+
+bool MeshletSet::IsBackFacing(std::size_t meshletIndex, const Gs::Vector3& viewPoint) const
+{
+    const auto& cone = meshlets_[meshletIndex].normalCone;
+
+    if (cone.height <= Gs::Real(0))
+        return false;
+
+    /*
+    The view point is behind all triangles if the angle between the direction from the view point to the cone tip and the cone axis
+    is at most pi/2 minus the normal cone angle, i.e. dot(normalize(tip - viewPoint), axis) >= sin(angle)
+    */
+    const auto dir = cone.point - viewPoint;
+    const auto dot = Gs::Dot(dir, cone.direction);
+
+    return (dot > Gs::Real(0) && dot*dot >= cone.radius*cone.radius * dir.LengthSq());
+}
+
+std::size_t MeshletSet::Cull(const Frustum& frustum, const Gs::Vector3& viewPoint, std::vector<std::size_t>& visibleMeshlets) const
+{
+    /* Test all meshlets in parallel */
+    const auto numMeshlets = meshlets_.size();
+
+    std::vector<char> visible(numMeshlets);
+
+    GetSharedThreadPool().ParallelFor(
+        numMeshlets, parallelGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                visible[i] = (IsOutside(i, frustum) || IsBackFacing(i, viewPoint) ? 0 : 1);
+        }
+    );
+
+    /* Gather indices of visible meshlets */
+    visibleMeshlets.clear();
+
+    for (std::size_t i = 0; i < numMeshlets; ++i)
+    {
+        if (visible[i])
+            visibleMeshlets.push_back(i);
+    }
+
+    return visibleMeshlets.size();
+}
+
+MeshletSet::Triangle MeshletSet::GetTriangle(std::size_t meshletIndex, std::size_t triangleIndex) const
+{
+    const auto& meshlet = meshlets_[meshletIndex];
+    const auto  indices = &localIndices_[(meshlet.triangleOffset + triangleIndex) * 3];
+    const auto  vertices = &vertexIndices_[meshlet.vertexOffset];
+    return Triangle(vertices[indices[0]], vertices[indices[1]], vertices[indices[2]]);
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
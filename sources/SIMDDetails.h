@@ -0,0 +1,375 @@
+/*
+ * SIMDDetails.h
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#ifndef GM_SIMD_DETAILS_H
+#define GM_SIMD_DETAILS_H
+
+
+#include <Gauss/Vector3.h>
+#include <algorithm>
+#include <limits>
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define GM_SIMD_SSE2
+#   include <emmintrin.h>
+#endif
+
+
+namespace Gm
+{
+
+namespace Details
+{
+
+
+/*
+Packet of 'width' scalars for loops over structure-of-arrays streams.
+The generic version is the scalar fallback with a width of 1. The loads and stores are unaligned,
+so chunks of a stream may start at any index. 'Min' and 'Max' return 'b' where 'a' is NaN, like the SSE instructions.
+*/
+template <typename T>
+struct SIMDPacket
+{
+    static const std::size_t width = 1;
+
+    T v;
+
+    static inline SIMDPacket Splat(T s)
+    {
+        return { s };
+    }
+
+    static inline SIMDPacket Load(const T* p)
+    {
+        return { *p };
+    }
+
+    inline void Store(T* p) const
+    {
+        *p = v;
+    }
+
+    static inline SIMDPacket Min(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { (a.v < b.v ? a.v : b.v) };
+    }
+
+    static inline SIMDPacket Max(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { (a.v > b.v ? a.v : b.v) };
+    }
+
+    inline T ReduceMin() const
+    {
+        return v;
+    }
+
+    inline T ReduceMax() const
+    {
+        return v;
+    }
+
+    friend inline SIMDPacket operator + (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { a.v + b.v };
+    }
+
+    friend inline SIMDPacket operator - (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { a.v - b.v };
+    }
+
+    friend inline SIMDPacket operator * (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { a.v * b.v };
+    }
+};
+
+#ifdef GM_SIMD_SSE2
+
+template <>
+struct SIMDPacket<float>
+{
+    static const std::size_t width = 4;
+
+    __m128 v;
+
+    static inline SIMDPacket Splat(float s)
+    {
+        return { _mm_set1_ps(s) };
+    }
+
+    static inline SIMDPacket Load(const float* p)
+    {
+        return { _mm_loadu_ps(p) };
+    }
+
+    inline void Store(float* p) const
+    {
+        _mm_storeu_ps(p, v);
+    }
+
+    static inline SIMDPacket Min(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_min_ps(a.v, b.v) };
+    }
+
+    static inline SIMDPacket Max(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_max_ps(a.v, b.v) };
+    }
+
+    inline float ReduceMin() const
+    {
+        float s[4];
+        _mm_storeu_ps(s, v);
+        return std::min(std::min(s[0], s[1]), std::min(s[2], s[3]));
+    }
+
+    inline float ReduceMax() const
+    {
+        float s[4];
+        _mm_storeu_ps(s, v);
+        return std::max(std::max(s[0], s[1]), std::max(s[2], s[3]));
+    }
+
+    friend inline SIMDPacket operator + (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_add_ps(a.v, b.v) };
+    }
+
+    friend inline SIMDPacket operator - (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_sub_ps(a.v, b.v) };
+    }
+
+    friend inline SIMDPacket operator * (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_mul_ps(a.v, b.v) };
+    }
+};
+
+template <>
+struct SIMDPacket<double>
+{
+    static const std::size_t width = 2;
+
+    __m128d v;
+
+    static inline SIMDPacket Splat(double s)
+    {
+        return { _mm_set1_pd(s) };
+    }
+
+    static inline SIMDPacket Load(const double* p)
+    {
+        return { _mm_loadu_pd(p) };
+    }
+
+    inline void Store(double* p) const
+    {
+        _mm_storeu_pd(p, v);
+    }
+
+    static inline SIMDPacket Min(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_min_pd(a.v, b.v) };
+    }
+
+    static inline SIMDPacket Max(const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_max_pd(a.v, b.v) };
+    }
+
+    inline double ReduceMin() const
+    {
+        double s[2];
+        _mm_storeu_pd(s, v);
+        return std::min(s[0], s[1]);
+    }
+
+    inline double ReduceMax() const
+    {
+        double s[2];
+        _mm_storeu_pd(s, v);
+        return std::max(s[0], s[1]);
+    }
+
+    friend inline SIMDPacket operator + (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_add_pd(a.v, b.v) };
+    }
+
+    friend inline SIMDPacket operator - (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_sub_pd(a.v, b.v) };
+    }
+
+    friend inline SIMDPacket operator * (const SIMDPacket& a, const SIMDPacket& b)
+    {
+        return { _mm_mul_pd(a.v, b.v) };
+    }
+};
+
+/*
+3D vector held in SSE registers, specialized for single and double precision.
+The 'LoadPadded' functions read one more component than 'x', 'y', and 'z',
+so they must only be used where the vector is followed by at least one more scalar in memory (e.g. inside a vertex structure).
+*/
+template <typename T>
+struct SIMDVector3;
+
+template <>
+struct SIMDVector3<float>
+{
+    __m128 xyz;
+
+    static inline SIMDVector3 Splat(float s)
+    {
+        return { _mm_set1_ps(s) };
+    }
+
+    static inline SIMDVector3 Set(float x, float y, float z)
+    {
+        return { _mm_set_ps(0.0f, z, y, x) };
+    }
+
+    static inline SIMDVector3 LoadPadded(const Gs::Vector3f& v)
+    {
+        return { _mm_loadu_ps(&v.x) };
+    }
+
+    // Returns x*col0 + y*col1 + z*col2 + col3.
+    static inline SIMDVector3 MulAdd(const Gs::Vector3f& v, const SIMDVector3* cols)
+    {
+        auto r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(v.x), cols[0].xyz), cols[3].xyz);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.y), cols[1].xyz));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.z), cols[2].xyz));
+        return { r };
+    }
+
+    // Returns x*col0 + y*col1 + z*col2.
+    static inline SIMDVector3 Mul(const Gs::Vector3f& v, const SIMDVector3* cols)
+    {
+        auto r = _mm_mul_ps(_mm_set1_ps(v.x), cols[0].xyz);
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.y), cols[1].xyz));
+        r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(v.z), cols[2].xyz));
+        return { r };
+    }
+
+    // Component-wise minimum and maximum (NaN components of 'v' are ignored).
+    inline void Min(const SIMDVector3& v)
+    {
+        xyz = _mm_min_ps(v.xyz, xyz);
+    }
+
+    inline void Max(const SIMDVector3& v)
+    {
+        xyz = _mm_max_ps(v.xyz, xyz);
+    }
+
+    inline void Store(Gs::Vector3f& v) const
+    {
+        float s[4];
+        _mm_storeu_ps(s, xyz);
+        v.x = s[0];
+        v.y = s[1];
+        v.z = s[2];
+    }
+};
+
+template <>
+struct SIMDVector3<double>
+{
+    __m128d xy;
+    __m128d z;
+
+    static inline SIMDVector3 Splat(double s)
+    {
+        return { _mm_set1_pd(s), _mm_set1_pd(s) };
+    }
+
+    static inline SIMDVector3 Set(double x, double y, double z)
+    {
+        return { _mm_set_pd(y, x), _mm_set_sd(z) };
+    }
+
+    static inline SIMDVector3 LoadPadded(const Gs::Vector3d& v)
+    {
+        return { _mm_loadu_pd(&v.x), _mm_load_sd(&v.z) };
+    }
+
+    // Returns x*col0 + y*col1 + z*col2 + col3.
+    static inline SIMDVector3 MulAdd(const Gs::Vector3d& v, const SIMDVector3* cols)
+    {
+        auto x = _mm_set1_pd(v.x);
+        auto y = _mm_set1_pd(v.y);
+        auto z = _mm_set1_pd(v.z);
+
+        auto rxy = _mm_add_pd(_mm_mul_pd(x, cols[0].xy), cols[3].xy);
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(y, cols[1].xy));
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(z, cols[2].xy));
+
+        auto rz = _mm_add_sd(_mm_mul_sd(x, cols[0].z), cols[3].z);
+        rz = _mm_add_sd(rz, _mm_mul_sd(y, cols[1].z));
+        rz = _mm_add_sd(rz, _mm_mul_sd(z, cols[2].z));
+
+        return { rxy, rz };
+    }
+
+    // Returns x*col0 + y*col1 + z*col2.
+    static inline SIMDVector3 Mul(const Gs::Vector3d& v, const SIMDVector3* cols)
+    {
+        auto x = _mm_set1_pd(v.x);
+        auto y = _mm_set1_pd(v.y);
+        auto z = _mm_set1_pd(v.z);
+
+        auto rxy = _mm_mul_pd(x, cols[0].xy);
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(y, cols[1].xy));
+        rxy = _mm_add_pd(rxy, _mm_mul_pd(z, cols[2].xy));
+
+        auto rz = _mm_mul_sd(x, cols[0].z);
+        rz = _mm_add_sd(rz, _mm_mul_sd(y, cols[1].z));
+        rz = _mm_add_sd(rz, _mm_mul_sd(z, cols[2].z));
+
+        return { rxy, rz };
+    }
+
+    // Component-wise minimum and maximum (NaN components of 'v' are ignored).
+    inline void Min(const SIMDVector3& v)
+    {
+        xy  = _mm_min_pd(v.xy, xy);
+        z   = _mm_min_sd(v.z, z);
+    }
+
+    inline void Max(const SIMDVector3& v)
+    {
+        xy  = _mm_max_pd(v.xy, xy);
+        z   = _mm_max_sd(v.z, z);
+    }
+
+    inline void Store(Gs::Vector3d& v) const
+    {
+        _mm_storeu_pd(&v.x, xy);
+        _mm_store_sd(&v.z, z);
+    }
+};
+
+#endif
+
+
+} // /namespace Details
+
+} // /namespace Gm
+
+
+#endif
+
+
+
+// ================================================================================
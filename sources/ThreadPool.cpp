@@ -0,0 +1,198 @@
+/*
+ * ThreadPool.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/ThreadPool.h>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+
+namespace Gm
+{
+
+
+// Number of chunks per thread, to balance the work load when chunks take different amounts of time.
+static const std::size_t chunksPerThread = 4;
+
+struct ThreadPool::Job
+{
+    Job(std::size_t count, std::size_t chunkSize, const ChunkFunction& func) :
+        count       { count                                 },
+        chunkSize   { chunkSize                             },
+        numChunks   { (count + chunkSize - 1) / chunkSize   },
+        func        { func                                  }
+    {
+    }
+
+    // Processes chunks until all of them have been claimed.
+    void Run()
+    {
+        while (true)
+        {
+            auto chunk = nextChunk.fetch_add(1);
+            if (chunk >= numChunks)
+                break;
+
+            if (!failed.load())
+            {
+                try
+                {
+                    auto begin = chunk * chunkSize;
+                    func(begin, std::min(count, begin + chunkSize));
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> guard { mutex };
+                    if (!exception)
+                        exception = std::current_exception();
+                    failed = true;
+                }
+            }
+
+            /* Notify waiting thread when the last chunk is done */
+            if (doneChunks.fetch_add(1) + 1 == numChunks)
+            {
+                std::lock_guard<std::mutex> guard { mutex };
+                finished.notify_all();
+            }
+        }
+    }
+
+    // Waits until all chunks are done.
+    void Wait()
+    {
+        std::unique_lock<std::mutex> lock { mutex };
+        finished.wait(lock, [this]() { return (doneChunks.load() == numChunks); });
+    }
+
+    const std::size_t           count;
+    const std::size_t           chunkSize;
+    const std::size_t           numChunks;
+    const ChunkFunction&        func;
+
+    std::atomic<std::size_t>    nextChunk   { 0 };
+    std::atomic<std::size_t>    doneChunks  { 0 };
+    std::atomic<bool>           failed      { false };
+
+    std::mutex                  mutex;
+    std::condition_variable     finished;
+    std::exception_ptr          exception;
+};
+
+ThreadPool::ThreadPool(std::size_t numThreads)
+{
+    threads_.reserve(numThreads);
+    for (std::size_t i = 0; i < numThreads; ++i)
+        threads_.emplace_back(&ThreadPool::WorkerThreadProc, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard { mutex_ };
+        quit_ = true;
+    }
+    jobAvailable_.notify_all();
+
+    for (auto& t : threads_)
+        t.join();
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grainSize, const ChunkFunction& func)
+{
+    grainSize = std::max<std::size_t>(1, grainSize);
+
+    /* Determine number of chunks and chunk size */
+    const auto numChunks = std::min(count / grainSize, (threads_.size() + 1) * chunksPerThread);
+
+    if (numChunks < 2)
+    {
+        /* Process entire range on the calling thread */
+        if (count > 0)
+            func(0, count);
+        return;
+    }
+
+    /* Enqueue job for the worker threads */
+    auto job = std::make_shared<Job>(count, (count + numChunks - 1) / numChunks, func);
+
+    {
+        std::lock_guard<std::mutex> guard { mutex_ };
+        jobs_.push_back(job);
+    }
+    jobAvailable_.notify_all();
+
+    /* Take part in the job, then wait for the chunks that are still processed by the worker threads */
+    job->Run();
+    RemoveJob(job);
+    job->Wait();
+
+    if (job->exception)
+        std::rethrow_exception(job->exception);
+}
+
+std::size_t ThreadPool::DefaultNumThreads()
+{
+    auto n = static_cast<std::size_t>(std::thread::hardware_concurrency());
+    return (n > 1 ? n - 1 : 0);
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+void ThreadPool::WorkerThreadProc()
+{
+    while (true)
+    {
+        /* Wait for next job */
+        std::shared_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock { mutex_ };
+            jobAvailable_.wait(lock, [this]() { return (quit_ || !jobs_.empty()); });
+
+            if (quit_)
+                return;
+
+            /* Take the latest job first, which is the innermost one for nested loops */
+            job = jobs_.back();
+        }
+
+        /* Process chunks of this job until all of them are claimed, then remove it from the queue */
+        job->Run();
+        RemoveJob(job);
+    }
+}
+
+void ThreadPool::RemoveJob(const std::shared_ptr<Job>& job)
+{
+    std::lock_guard<std::mutex> guard { mutex_ };
+    auto it = std::find(jobs_.begin(), jobs_.end(), job);
+    if (it != jobs_.end())
+        jobs_.erase(it);
+}
+
+
+/* ----- Global functions ----- */
+
+ThreadPool& GetSharedThreadPool()
+{
+    #ifdef GM_ENABLE_MULTI_THREADING
+    static ThreadPool pool { ThreadPool::DefaultNumThreads() };
+    #else
+    static ThreadPool pool { 0 };
+    #endif
+    return pool;
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
@@ -6,124 +6,159 @@
  */
 
 #include <Geom/TriangleMesh.h>
+#include <Geom/MeshAdjacency.h>
+#include <Geom/MeshSilhouette.h>
 #include <Geom/TriangleCollision.h>
 #include <Geom/MeshModifier.h>
+#include <Geom/ThreadPool.h>
 #include <Gauss/TransformVector.h>
-#include <Gauss/Equals.h>
-#include <algorithm>
+#include "SIMDDetails.h"
+#include "Except.h"
 
-#ifdef GM_ENABLE_MULTI_THREADING
-#   include <thread>
-#   include <memory>
-#endif
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <limits>
+#include <cstddef>
 
 
 namespace Gm
 {
 
 
-TriangleMesh::Vertex::Vertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord) :
-    position { position },
-    normal   { normal   },
-    texCoord { texCoord }
-{
-}
+/* ----- Internal functions ----- */
 
-TriangleMesh::Vertex& TriangleMesh::Vertex::operator += (const Vertex& rhs)
+/*
+Minimal number of vertices per chunk for the parallel bounding box computations.
+With SIMD a chunk of this size takes a few microseconds, which amortizes the pool's wake-up latency,
+so meshes of about 100k vertices are already split into several chunks.
+*/
+static const std::size_t boundingBoxGrainSize               = 16384;
+static const std::size_t boundingBoxTransformedGrainSize    = 8192;
+
+// The SIMD loads read one scalar beyond the vertex position, which must still be inside the vertex.
+static_assert(
+    offsetof(TriangleMesh::Vertex, position) + sizeof(Gs::Vector3) < sizeof(TriangleMesh::Vertex),
+    "vertex position must be followed by another member for padded SIMD loads"
+);
+
+static AABB3 VertexRangeBoundingBox(const TriangleMesh::Vertex* vertices, std::size_t count)
 {
-    position    += rhs.position;
-    normal      += rhs.normal;
-    texCoord    += rhs.texCoord;
-    return *this;
-}
+    AABB3 box;
 
-TriangleMesh::Vertex& TriangleMesh::Vertex::operator *= (Gs::Real rhs)
-{
-    position    *= rhs;
-    normal      *= rhs;
-    texCoord    *= rhs;
-    return *this;
-}
+    #ifdef GM_SIMD_SSE2
 
-TriangleMesh::TriangleMesh(TriangleMesh&& rhs) :
-    vertices  { std::move(rhs.vertices)  },
-    triangles { std::move(rhs.triangles) }
-{
-}
+    using SIMDVector3 = Details::SIMDVector3<Gs::Real>;
 
-TriangleMesh& TriangleMesh::operator = (TriangleMesh&& rhs)
-{
-    vertices = std::move(rhs.vertices);
-    triangles = std::move(rhs.triangles);
-    return *this;
-}
+    auto boxMin = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::max());
+    auto boxMax = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::lowest());
 
-void TriangleMesh::Clear()
-{
-    vertices.clear();
-    triangles.clear();
-}
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto point = SIMDVector3::LoadPadded(vertices[i].position);
+        boxMin.Min(point);
+        boxMax.Max(point);
+    }
 
-TriangleMesh::VertexIndex TriangleMesh::AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
-{
-    auto idx = vertices.size();
-    vertices.push_back({ position, normal, texCoord });
-    return idx;
-}
+    boxMin.Store(box.min);
+    boxMax.Store(box.max);
 
-TriangleMesh::TriangleIndex TriangleMesh::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
-{
-    GS_ASSERT(v0 < vertices.size() && v1 < vertices.size() && v2 < vertices.size());
-    auto idx = triangles.size();
-    triangles.push_back({ v0, v1, v2 });
-    return idx;
+    #else
+
+    for (std::size_t i = 0; i < count; ++i)
+        box.Insert(vertices[i].position);
+
+    #endif
+
+    return box;
 }
 
-TriangleMesh::Vertex TriangleMesh::Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const
+static AABB3 VertexRangeBoundingBox(const TriangleMesh::Vertex* vertices, std::size_t count, const Gs::AffineMatrix4& matrix)
 {
-    GS_ASSERT(triangleIndex < triangles.size());
+    AABB3 box;
 
-    const auto& tri = triangles[triangleIndex];
+    #ifdef GM_SIMD_SSE2
 
-    #if 0
+    using SIMDVector3 = Details::SIMDVector3<Gs::Real>;
+
+    const SIMDVector3 columns[4] =
+    {
+        SIMDVector3::Set(matrix(0, 0), matrix(1, 0), matrix(2, 0)),
+        SIMDVector3::Set(matrix(0, 1), matrix(1, 1), matrix(2, 1)),
+        SIMDVector3::Set(matrix(0, 2), matrix(1, 2), matrix(2, 2)),
+        SIMDVector3::Set(matrix(0, 3), matrix(1, 3), matrix(2, 3)),
+    };
 
-    const auto& a = vertices[tri.a];
-    const auto& b = vertices[tri.b];
-    const auto& c = vertices[tri.c];
+    auto boxMin = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::max());
+    auto boxMax = SIMDVector3::Splat(std::numeric_limits<Gs::Real>::lowest());
 
-    Vertex v;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto point = SIMDVector3::MulAdd(vertices[i].position, columns);
+        boxMin.Min(point);
+        boxMax.Max(point);
+    }
 
-    v.position  = a.position * barycentricCoords.x + b.position * barycentricCoords.y + c.position * barycentricCoords.z;
-    v.normal    = a.normal   * barycentricCoords.x + b.normal   * barycentricCoords.y + c.normal   * barycentricCoords.z;
-    v.texCoord  = a.texCoord * barycentricCoords.x + b.texCoord * barycentricCoords.y + c.texCoord * barycentricCoords.z;
+    boxMin.Store(box.min);
+    boxMax.Store(box.max);
 
     #else
 
-    Vertex v;
+    for (std::size_t i = 0; i < count; ++i)
+        box.Insert(Gs::TransformVector(matrix, vertices[i].position));
+
+    #endif
+
+    return box;
+}
+
+// Merges the bounding boxes of all vertex chunks, which are computed by 'rangeBox(begin, end)' on the shared thread pool.
+template <typename RangeBoxFunc>
+static AABB3 ParallelBoundingBox(std::size_t numVerts, std::size_t grainSize, const RangeBoxFunc& rangeBox)
+{
+    AABB3 box;
+    std::mutex boxMutex;
 
-    MeshModifier::InterpolateBarycentric(
-        MeshModifier::GetDefaultVertexDesc(),
-        &v, vertices.data(),
-        tri.a,
-        tri.b,
-        tri.c,
-        barycentricCoords
+    GetSharedThreadPool().ParallelFor(
+        numVerts, grainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            auto subBox = rangeBox(begin, end);
+            std::lock_guard<std::mutex> guard { boxMutex };
+            box.Insert(subBox);
+        }
     );
 
-    #endif
+    return box;
+}
+
+
+// Minimal number of triangles per chunk for the parallel computation of the triangle normals and areas.
+static const std::size_t faceDataGrainSize = 8192;
+
+static Gs::Vector3 TriangleCrossProduct(const TriangleMesh& mesh, TriangleMesh::TriangleIndex triangleIndex)
+{
+    const auto& tri = mesh.triangles[triangleIndex];
+
+    const auto& a = mesh.vertices[tri.a];
+    const auto& b = mesh.vertices[tri.b];
+    const auto& c = mesh.vertices[tri.c];
 
-    return v;
+    return Gs::Cross(b.position - a.position, c.position - a.position);
 }
 
-std::vector<TriangleMesh::Edge> TriangleMesh::Edges() const
+// Returns the sorted unique edges of the specified triangles. Degenerated edges (with two equal vertices) are skipped, like in "MeshAdjacency".
+static std::vector<TriangleMesh::Edge> SortedUniqueEdges(const TriangleMesh::TriangleArray& triangles)
 {
+    using Edge = TriangleMesh::Edge;
+
     std::vector<Edge> edges;
 
-    auto AddEdge = [&edges](VertexIndex a, VertexIndex b)
+    auto AddEdge = [&edges](TriangleMesh::VertexIndex a, TriangleMesh::VertexIndex b)
     {
         if (a < b)
             edges.push_back({ a, b });
-        else
+        else if (a > b)
             edges.push_back({ b, a });
     };
 
@@ -161,42 +196,186 @@ std::vector<TriangleMesh::Edge> TriangleMesh::Edges() const
     return edges;
 }
 
-std::vector<TriangleMesh::Edge> TriangleMesh::SilhouetteEdges(Gs::Real toleranceAngle) const
+/*
+Derived data of a mesh. Each kind of data has its own flag, which is set (with release semantics) after the data has been stored,
+so queries only take the mutex when the data is missing. The mesh sizes are stored as well, to detect vertices
+or triangles that have been added directly to the array lists.
+*/
+struct TriangleMesh::DerivedCache
 {
-    auto edges = Edges();
-
-    /* Adjust tolerance angle to sine-curve and absolute value */
-    toleranceAngle = std::sin(std::abs(toleranceAngle));
-
-    /* Search all edges that are not part of the silhouette */
-    auto PartOfSilh = [&](const Edge& edge)
+    void Invalidate()
     {
-        /* Find all triangles that are connected to this edge and compare their normal of equality */
-        auto tris = FindTriangles(edge);
+        hasFaceData     = false;
+        hasBoundingBox  = false;
+        hasEdges        = false;
+    }
 
-        if (tris.size() >= 2)
+    // Calls 'fill' once if the specified flag is not set, then sets the flag.
+    template <typename FillFunc>
+    void FillOnce(std::atomic<bool>& flag, const FillFunc& fill)
+    {
+        if (!flag.load(std::memory_order_acquire))
         {
-            auto normalPattern = TriangleNormal(tris[0]);
-            for (std::size_t i = 1; i < tris.size(); ++i)
+            std::lock_guard<std::mutex> guard { mutex };
+            if (!flag.load(std::memory_order_relaxed))
             {
-                /* If the normals deviate too much, this edge must be a part of the silhouette */
-                if (std::abs(Gs::Dot(TriangleNormal(tris[i]), normalPattern) - Gs::Real(1)) >= Gs::Epsilon<Gs::Real>() + toleranceAngle)
-                    return false;
+                fill();
+                flag.store(true, std::memory_order_release);
             }
-
-            return true;
         }
+    }
 
-        return false;
-    };
+    std::mutex                  mutex;
 
-    /* Remove respective edges from the result */
-    edges.erase(
-        std::remove_if(std::begin(edges), std::end(edges), PartOfSilh),
-        edges.end()
-    );
+    std::atomic<bool>           hasFaceData         { false };
+    std::vector<Gs::Vector3>    faceNormals;
+    std::vector<Gs::Real>       faceAreas;
 
-    return edges;
+    std::atomic<bool>           hasBoundingBox      { false };
+    AABB3                       boundingBox;
+    std::size_t                 boundingBoxVertices = 0;
+
+    std::atomic<bool>           hasEdges            { false };
+    std::vector<Edge>           edges;
+    std::size_t                 edgesTriangles      = 0;
+};
+
+
+/* ----- TriangleMesh class ----- */
+
+TriangleMesh::Vertex::Vertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord) :
+    position { position },
+    normal   { normal   },
+    texCoord { texCoord }
+{
+}
+
+TriangleMesh::Vertex& TriangleMesh::Vertex::operator += (const Vertex& rhs)
+{
+    position    += rhs.position;
+    normal      += rhs.normal;
+    texCoord    += rhs.texCoord;
+    return *this;
+}
+
+TriangleMesh::Vertex& TriangleMesh::Vertex::operator *= (Gs::Real rhs)
+{
+    position    *= rhs;
+    normal      *= rhs;
+    texCoord    *= rhs;
+    return *this;
+}
+
+TriangleMesh::TriangleMesh()
+{
+}
+
+TriangleMesh::TriangleMesh(MemoryResource* resource) :
+    vertices    ( VertexArray::allocator_type(resource)   ),
+    triangles   ( TriangleArray::allocator_type(resource) )
+{
+}
+
+TriangleMesh::TriangleMesh(const TriangleMesh& rhs) :
+    vertices        { rhs.vertices          },
+    triangles       { rhs.triangles         },
+    adjacency_      { rhs.adjacency_        },
+    adjacencyStale_ { rhs.adjacencyStale_   }
+{
+    EnableCache(rhs.IsCacheEnabled());
+}
+
+TriangleMesh::TriangleMesh(TriangleMesh&& rhs) :
+    vertices        { std::move(rhs.vertices)  },
+    triangles       { std::move(rhs.triangles) },
+    adjacency_      { std::move(rhs.adjacency_) },
+    adjacencyStale_ { rhs.adjacencyStale_       },
+    cache_          { std::move(rhs.cache_)     }
+{
+}
+
+TriangleMesh::TriangleMesh(const TriangleMesh& rhs, MemoryResource* resource) :
+    vertices        ( rhs.vertices, VertexArray::allocator_type(resource)    ),
+    triangles       ( rhs.triangles, TriangleArray::allocator_type(resource) ),
+    adjacency_      ( rhs.adjacency_                                        ),
+    adjacencyStale_ ( rhs.adjacencyStale_                                   )
+{
+    EnableCache(rhs.IsCacheEnabled());
+}
+
+TriangleMesh::~TriangleMesh()
+{
+}
+
+TriangleMesh& TriangleMesh::operator = (const TriangleMesh& rhs)
+{
+    vertices = rhs.vertices;
+    triangles = rhs.triangles;
+    adjacency_ = rhs.adjacency_;
+    adjacencyStale_ = rhs.adjacencyStale_;
+    EnableCache(rhs.IsCacheEnabled());
+    InvalidateCache();
+    return *this;
+}
+
+TriangleMesh& TriangleMesh::operator = (TriangleMesh&& rhs)
+{
+    vertices = std::move(rhs.vertices);
+    triangles = std::move(rhs.triangles);
+    adjacency_ = std::move(rhs.adjacency_);
+    adjacencyStale_ = rhs.adjacencyStale_;
+    cache_ = std::move(rhs.cache_);
+    return *this;
+}
+
+void TriangleMesh::Clear()
+{
+    vertices.clear();
+    triangles.clear();
+    ReleaseAdjacency();
+    InvalidateCache();
+}
+
+TriangleMesh::VertexIndex TriangleMesh::AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+{
+    if (vertices.size() >= TriangleMesh::MaxNumVertices())
+        throw std::overflow_error(GM_EXCEPT_INFO("number of vertices exceeds the range of the mesh index type"));
+
+    auto idx = static_cast<VertexIndex>(vertices.size());
+    vertices.push_back({ position, normal, texCoord });
+    InvalidateCache();
+    return idx;
+}
+
+TriangleMesh::TriangleIndex TriangleMesh::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+{
+    GS_ASSERT(v0 < vertices.size() && v1 < vertices.size() && v2 < vertices.size());
+    auto idx = triangles.size();
+    triangles.push_back({ v0, v1, v2 });
+    InvalidateAdjacency();
+    InvalidateCache();
+    return idx;
+}
+
+TriangleMesh::Vertex TriangleMesh::Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const
+{
+    GS_ASSERT(triangleIndex < triangles.size());
+
+    const auto& tri = triangles[triangleIndex];
+
+    return MeshModifier::InterpolateBarycentric(vertices[tri.a], vertices[tri.b], vertices[tri.c], barycentricCoords);
+}
+
+std::vector<TriangleMesh::Edge> TriangleMesh::Edges() const
+{
+    if (auto cache = CacheWithEdges())
+        return cache->edges;
+    return SortedUniqueEdges(triangles);
+}
+
+std::vector<TriangleMesh::Edge> TriangleMesh::SilhouetteEdges(Gs::Real toleranceAngle) const
+{
+    return MeshSilhouette(*this).CreaseEdges(toleranceAngle);
 }
 
 std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighbors(
@@ -207,15 +386,30 @@ std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighbors(
         GS_ASSERT(i < triangles.size());
     #endif
 
-    auto MatchVertex = [&](VertexIndex a, VertexIndex b)
+    if (searchViaPosition)
     {
-        return Gs::Equals(vertices[a].position, vertices[b].position);
-    };
+        /* Search via the canonical vertex of each position, i.e. vertices with equal positions share their adjacency */
+        std::vector<VertexIndex> canonicalIndices;
+        MeshModifier::FindCanonicalVertices(*this, Gs::Epsilon<Gs::Real>(), canonicalIndices);
+
+        TriangleArray canonicalTriangles(triangles.size());
+        for (std::size_t i = 0; i < triangles.size(); ++i)
+        {
+            const auto& tri = triangles[i];
+            canonicalTriangles[i] = { canonicalIndices[tri.a], canonicalIndices[tri.b], canonicalIndices[tri.c] };
+        }
+
+        MeshAdjacency adjacency;
+        adjacency.Build(canonicalTriangles, vertices.size());
 
-    auto HasVertex = [&](const Triangle& tri, VertexIndex v)
+        return TriangleNeighborsWithAdjacency(adjacency, canonicalTriangles, std::move(triangleIndices), searchDepth, edgeBondOnly);
+    }
+
+    if (auto adjacency = GetAdjacency())
+        return TriangleNeighborsWithAdjacency(*adjacency, triangles, std::move(triangleIndices), searchDepth, edgeBondOnly);
+
+    auto HasVertex = [](const Triangle& tri, VertexIndex v)
     {
-        if (searchViaPosition)
-            return (MatchVertex(v, tri.a) || MatchVertex(v, tri.b) || MatchVertex(v, tri.c));
         return (v == tri.a || v == tri.b || v == tri.c);
     };
 
@@ -272,12 +466,18 @@ std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighbors(
 
 std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(VertexIndex vertexIndex) const
 {
+    if (auto adjacency = GetAdjacency())
+    {
+        auto tris = adjacency->VertexTriangles(vertexIndex);
+        return std::vector<TriangleIndex>(tris.begin(), tris.end());
+    }
+
     std::vector<TriangleIndex> result;
 
     for (TriangleIndex i = 0; i < triangles.size(); ++i)
     {
         const auto& tri = triangles[i];
-        if (tri.a == vertexIndex || tri.b == vertexIndex || tri.b == vertexIndex)
+        if (tri.a == vertexIndex || tri.b == vertexIndex || tri.c == vertexIndex)
             result.push_back(i);
     }
 
@@ -286,6 +486,15 @@ std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(VertexIndex
 
 std::vector<TriangleMesh::TriangleIndex> TriangleMesh::FindTriangles(const Edge& edge) const
 {
+    if (auto adjacency = GetAdjacency())
+    {
+        auto edgeIndex = adjacency->FindEdge(edge.a, edge.b);
+        if (edgeIndex == MeshAdjacency::invalidEdge)
+            return {};
+        auto tris = adjacency->EdgeTriangles(edgeIndex);
+        return std::vector<TriangleIndex>(tris.begin(), tris.end());
+    }
+
     std::vector<TriangleIndex> result;
 
     auto HasEdge = [](const Triangle& tri, VertexIndex v0, VertexIndex v1)
@@ -328,41 +537,45 @@ Gs::Vector3 TriangleMesh::TriangleNormal(TriangleIndex triangleIndex) const
 {
     GS_ASSERT(triangleIndex < triangles.size());
 
-    const auto& tri = triangles[triangleIndex];
-
-    const auto& a = vertices[tri.a];
-    const auto& b = vertices[tri.b];
-    const auto& c = vertices[tri.c];
+    if (auto cache = CacheWithFaceData())
+        return cache->faceNormals[triangleIndex];
 
-    return Gs::Cross(b.position - a.position, c.position - a.position).Normalized();
+    return TriangleCrossProduct(*this, triangleIndex).Normalized();
 }
 
-AABB3 TriangleMesh::BoundingBox() const
+Gs::Real TriangleMesh::TriangleArea(TriangleIndex triangleIndex) const
 {
-    AABB3 box;
+    GS_ASSERT(triangleIndex < triangles.size());
 
-    for (const auto& vert : vertices)
-        box.Insert(vert.position);
+    if (auto cache = CacheWithFaceData())
+        return cache->faceAreas[triangleIndex];
 
-    return box;
+    return TriangleCrossProduct(*this, triangleIndex).Length() * Gs::Real(0.5);
 }
 
-AABB3 TriangleMesh::BoundingBox(const Gs::AffineMatrix4& matrix) const
+AABB3 TriangleMesh::BoundingBox() const
 {
-    AABB3 box;
+    if (auto cache = CacheWithBoundingBox())
+        return cache->boundingBox;
 
-    for (const auto& vert : vertices)
-        box.Insert(Gs::TransformVector(matrix, vert.position));
-
-    return box;
+    return ParallelBoundingBox(
+        vertices.size(), boundingBoxGrainSize,
+        [this](std::size_t begin, std::size_t end)
+        {
+            return VertexRangeBoundingBox(vertices.data() + begin, end - begin);
+        }
+    );
 }
 
-#ifdef GM_ENABLE_MULTI_THREADING
-
-static void BoundingBoxThreadProc(AABB3& box, const TriangleMesh::Vertex* vertices, std::size_t vertexCount)
+AABB3 TriangleMesh::BoundingBox(const Gs::AffineMatrix4& matrix) const
 {
-    for (std::size_t i = 0; i < vertexCount; ++i)
-        box.Insert(vertices[i].position);
+    return ParallelBoundingBox(
+        vertices.size(), boundingBoxTransformedGrainSize,
+        [this, &matrix](std::size_t begin, std::size_t end)
+        {
+            return VertexRangeBoundingBox(vertices.data() + begin, end - begin, matrix);
+        }
+    );
 }
 
 AABB3 TriangleMesh::BoundingBoxMultiThreaded(std::size_t threadCount) const
@@ -371,53 +584,26 @@ AABB3 TriangleMesh::BoundingBoxMultiThreaded(std::size_t threadCount) const
     auto numVerts = vertices.size();
 
     if (threadCount < 2 || numVerts / threadCount < 64)
-        return BoundingBox();
-
-    if (threadCount < 1)
-        threadCount = 1;
-    if (threadCount > numVerts)
-        threadCount = numVerts;
-
-    auto verticesPerThread = numVerts / threadCount;
-
-    /* Allocate threads */
-    std::vector< std::unique_ptr<std::thread> > threads(threadCount);
-    std::vector<AABB3> subBoxes(threadCount);
-
-    for (std::size_t i = 0; i < threadCount; ++i)
-    {
-        threads[i] = std::unique_ptr<std::thread>(
-            new std::thread(
-                BoundingBoxThreadProc,
-                std::ref(subBoxes[i]),
-                &(vertices[verticesPerThread*i]),
-                verticesPerThread
-            )
-        );
-    }
+        return VertexRangeBoundingBox(vertices.data(), numVerts);
 
-    /* Insert remaining vertices */
-    AABB3 box;
-
-    for (std::size_t i = verticesPerThread * threadCount; i < numVerts; ++i)
-        box.Insert(vertices[i].position);
-
-    /* Join all threads */
-    for (std::size_t i = 0; i < threadCount; ++i)
-    {
-        threads[i]->join();
-        box.Insert(subBoxes[i]);
-    }
-
-    return box;
+    /* Split vertices into one chunk per thread */
+    return ParallelBoundingBox(
+        numVerts, (numVerts + threadCount - 1) / threadCount,
+        [this](std::size_t begin, std::size_t end)
+        {
+            return VertexRangeBoundingBox(vertices.data() + begin, end - begin);
+        }
+    );
 }
 
-#endif
-
 void TriangleMesh::Append(const TriangleMesh& other)
 {
+    /* Check if the merged vertices are still addressable with the mesh index type */
+    if (vertices.size() > TriangleMesh::MaxNumVertices() || other.vertices.size() > TriangleMesh::MaxNumVertices() - vertices.size())
+        throw std::overflow_error(GM_EXCEPT_INFO("number of merged vertices exceeds the range of the mesh index type"));
+
     /* Append all vertices */
-    auto vertexOffset = vertices.size();
+    auto vertexOffset = static_cast<VertexIndex>(vertices.size());
     vertices.resize(vertexOffset + other.vertices.size());
     std::copy(other.vertices.begin(), other.vertices.end(), vertices.begin() + vertexOffset);
 
@@ -433,6 +619,208 @@ void TriangleMesh::Append(const TriangleMesh& other)
         tri.b += vertexOffset;
         tri.c += vertexOffset;
     }
+
+    if (!other.triangles.empty())
+        InvalidateAdjacency();
+
+    InvalidateCache();
+}
+
+void TriangleMesh::BuildAdjacency()
+{
+    adjacency_ = std::make_shared<MeshAdjacency>(*this);
+    adjacencyStale_ = false;
+}
+
+void TriangleMesh::ReleaseAdjacency()
+{
+    adjacency_.reset();
+    adjacencyStale_ = false;
+}
+
+void TriangleMesh::InvalidateAdjacency()
+{
+    if (adjacency_)
+        adjacencyStale_ = true;
+}
+
+bool TriangleMesh::IsAdjacencyStale() const
+{
+    /* Also detect triangles or vertices that have been added directly to the array lists */
+    return
+    (
+        adjacency_ != nullptr &&
+        (
+            adjacencyStale_ ||
+            adjacency_->NumTriangles() != triangles.size() ||
+            adjacency_->NumVertices() > vertices.size()
+        )
+    );
+}
+
+const MeshAdjacency* TriangleMesh::GetAdjacency() const
+{
+    return (IsAdjacencyStale() ? nullptr : adjacency_.get());
+}
+
+void TriangleMesh::EnableCache(bool enable)
+{
+    if (!enable)
+        cache_.reset();
+    else if (!cache_)
+        cache_ = std::unique_ptr<DerivedCache>(new DerivedCache());
+}
+
+bool TriangleMesh::IsCacheEnabled() const
+{
+    return (cache_ != nullptr);
+}
+
+void TriangleMesh::InvalidateCache()
+{
+    if (cache_)
+        cache_->Invalidate();
+}
+
+MemoryResource* TriangleMesh::GetMemoryResource() const
+{
+    return vertices.get_allocator().GetResource();
+}
+
+
+/*
+ * ======= Private: =======
+ */
+
+const TriangleMesh::DerivedCache* TriangleMesh::CacheWithFaceData() const
+{
+    if (!cache_)
+        return nullptr;
+
+    cache_->FillOnce(
+        cache_->hasFaceData,
+        [this]()
+        {
+            const auto numTriangles = triangles.size();
+
+            cache_->faceNormals.resize(numTriangles);
+            cache_->faceAreas.resize(numTriangles);
+
+            GetSharedThreadPool().ParallelFor(
+                numTriangles, faceDataGrainSize,
+                [this](std::size_t begin, std::size_t end)
+                {
+                    for (auto i = begin; i < end; ++i)
+                    {
+                        auto n = TriangleCrossProduct(*this, i);
+                        cache_->faceNormals[i]  = n.Normalized();
+                        cache_->faceAreas[i]    = n.Length() * Gs::Real(0.5);
+                    }
+                }
+            );
+        }
+    );
+
+    /* Ignore the cache if triangles have been added directly to the array list */
+    return (cache_->faceNormals.size() == triangles.size() ? cache_.get() : nullptr);
+}
+
+const TriangleMesh::DerivedCache* TriangleMesh::CacheWithBoundingBox() const
+{
+    if (!cache_)
+        return nullptr;
+
+    cache_->FillOnce(
+        cache_->hasBoundingBox,
+        [this]()
+        {
+            cache_->boundingBox = ParallelBoundingBox(
+                vertices.size(), boundingBoxGrainSize,
+                [this](std::size_t begin, std::size_t end)
+                {
+                    return VertexRangeBoundingBox(vertices.data() + begin, end - begin);
+                }
+            );
+            cache_->boundingBoxVertices = vertices.size();
+        }
+    );
+
+    /* Ignore the cache if vertices have been added directly to the array list */
+    return (cache_->boundingBoxVertices == vertices.size() ? cache_.get() : nullptr);
+}
+
+const TriangleMesh::DerivedCache* TriangleMesh::CacheWithEdges() const
+{
+    if (!cache_)
+        return nullptr;
+
+    cache_->FillOnce(
+        cache_->hasEdges,
+        [this]()
+        {
+            /* Take the edges from the adjacency index if present, since they are equal (both skip degenerated edges) */
+            if (auto adjacency = GetAdjacency())
+                cache_->edges = adjacency->GetEdges();
+            else
+                cache_->edges = SortedUniqueEdges(triangles);
+            cache_->edgesTriangles = triangles.size();
+        }
+    );
+
+    /* Ignore the cache if triangles have been added directly to the array list */
+    return (cache_->edgesTriangles == triangles.size() ? cache_.get() : nullptr);
+}
+
+std::set<TriangleMesh::TriangleIndex> TriangleMesh::TriangleNeighborsWithAdjacency(
+    const MeshAdjacency&            adjacency,
+    const TriangleArray&            adjacencyTriangles,
+    std::set<TriangleIndex>         triangleIndices,
+    std::size_t                     searchDepth,
+    bool                            edgeBondOnly) const
+{
+    /* Expand the search front only, since all other triangles have already been visited */
+    std::vector<TriangleIndex> front(triangleIndices.begin(), triangleIndices.end()), nextFront;
+
+    auto Visit = [&](TriangleIndex i)
+    {
+        if (triangleIndices.insert(i).second)
+            nextFront.push_back(i);
+    };
+
+    for (; searchDepth > 0 && !front.empty(); --searchDepth)
+    {
+        for (auto j : front)
+        {
+            if (!edgeBondOnly)
+            {
+                /* Visit all triangles with a corner bond */
+                const auto& tri = adjacencyTriangles[j];
+                for (std::size_t k = 0; k < 3; ++k)
+                {
+                    for (auto i : adjacency.VertexTriangles(tri[k]))
+                        Visit(i);
+                }
+            }
+            else
+            {
+                /* Visit all triangles with an edge bond */
+                for (auto edgeIndex : adjacency.TriangleEdges(j))
+                {
+                    if (edgeIndex != MeshAdjacency::invalidEdge)
+                    {
+                        for (auto i : adjacency.EdgeTriangles(edgeIndex))
+                            Visit(i);
+                    }
+                }
+            }
+        }
+
+        /* Continue with the new neighbors only */
+        front.swap(nextFront);
+        nextFront.clear();
+    }
+
+    return triangleIndices;
 }
 
 
@@ -0,0 +1,303 @@
+/*
+ * TriangleMeshSoA.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Geom/TriangleMeshSoA.h>
+#include <Geom/ThreadPool.h>
+#include "SIMDDetails.h"
+#include "Except.h"
+
+#include <limits>
+#include <mutex>
+
+
+namespace Gm
+{
+
+
+/* ----- Internal functions ----- */
+
+// Minimal number of vertices per chunk for the parallel stream passes.
+static const std::size_t streamGrainSize = 16384;
+
+using Packet = Details::SIMDPacket<Gs::Real>;
+
+// Bounding box of the transformed points (x[i], y[i], z[i]) for i in [begin, end), where the transformation is given by the 3x4 matrix 'm' (in row-major order).
+template <bool Transformed>
+static AABB3 StreamRangeBoundingBox(const Gs::Real* x, const Gs::Real* y, const Gs::Real* z, std::size_t begin, std::size_t end, const Gs::Real* m)
+{
+    auto Transform = [m](const Packet& px, const Packet& py, const Packet& pz, std::size_t row) -> Packet
+    {
+        return
+        (
+            px * Packet::Splat(m[row*4    ]) +
+            py * Packet::Splat(m[row*4 + 1]) +
+            pz * Packet::Splat(m[row*4 + 2]) +
+            Packet::Splat(m[row*4 + 3])
+        );
+    };
+
+    auto minX = Packet::Splat(std::numeric_limits<Gs::Real>::max());
+    auto minY = minX;
+    auto minZ = minX;
+
+    auto maxX = Packet::Splat(std::numeric_limits<Gs::Real>::lowest());
+    auto maxY = maxX;
+    auto maxZ = maxX;
+
+    /* Process full packets */
+    auto i = begin;
+
+    for (; i + Packet::width <= end; i += Packet::width)
+    {
+        auto px = Packet::Load(x + i);
+        auto py = Packet::Load(y + i);
+        auto pz = Packet::Load(z + i);
+
+        if (Transformed)
+        {
+            auto tx = Transform(px, py, pz, 0);
+            auto ty = Transform(px, py, pz, 1);
+            auto tz = Transform(px, py, pz, 2);
+            px = tx;
+            py = ty;
+            pz = tz;
+        }
+
+        minX = Packet::Min(px, minX);
+        minY = Packet::Min(py, minY);
+        minZ = Packet::Min(pz, minZ);
+
+        maxX = Packet::Max(px, maxX);
+        maxY = Packet::Max(py, maxY);
+        maxZ = Packet::Max(pz, maxZ);
+    }
+
+    AABB3 box;
+
+    box.min = Gs::Vector3(minX.ReduceMin(), minY.ReduceMin(), minZ.ReduceMin());
+    box.max = Gs::Vector3(maxX.ReduceMax(), maxY.ReduceMax(), maxZ.ReduceMax());
+
+    /* Process remaining scalars */
+    for (; i < end; ++i)
+    {
+        Gs::Vector3 p(x[i], y[i], z[i]);
+
+        if (Transformed)
+        {
+            p = Gs::Vector3(
+                p.x*m[0] + p.y*m[1] + p.z*m[ 2] + m[ 3],
+                p.x*m[4] + p.y*m[5] + p.z*m[ 6] + m[ 7],
+                p.x*m[8] + p.y*m[9] + p.z*m[10] + m[11]
+            );
+        }
+
+        box.Insert(p);
+    }
+
+    return box;
+}
+
+template <bool Transformed>
+static AABB3 StreamBoundingBox(const TriangleMeshSoA::Vector3Streams& positions, const Gs::Real* m)
+{
+    AABB3 box;
+    std::mutex boxMutex;
+
+    GetSharedThreadPool().ParallelFor(
+        positions.x.size(), streamGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            auto subBox = StreamRangeBoundingBox<Transformed>(
+                positions.x.data(), positions.y.data(), positions.z.data(), begin, end, m
+            );
+            std::lock_guard<std::mutex> guard { boxMutex };
+            box.Insert(subBox);
+        }
+    );
+
+    return box;
+}
+
+
+/* ----- TriangleMeshSoA class ----- */
+
+TriangleMeshSoA::TriangleMeshSoA(const TriangleMesh& mesh)
+{
+    FromMesh(mesh);
+}
+
+void TriangleMeshSoA::Clear()
+{
+    ResizeVertices(0);
+    triangles.clear();
+}
+
+void TriangleMeshSoA::ResizeVertices(std::size_t numVertices)
+{
+    positions.x.resize(numVertices);
+    positions.y.resize(numVertices);
+    positions.z.resize(numVertices);
+    normals.x.resize(numVertices);
+    normals.y.resize(numVertices);
+    normals.z.resize(numVertices);
+    texCoords.x.resize(numVertices);
+    texCoords.y.resize(numVertices);
+}
+
+void TriangleMeshSoA::ReserveVertices(std::size_t numVertices)
+{
+    positions.x.reserve(numVertices);
+    positions.y.reserve(numVertices);
+    positions.z.reserve(numVertices);
+    normals.x.reserve(numVertices);
+    normals.y.reserve(numVertices);
+    normals.z.reserve(numVertices);
+    texCoords.x.reserve(numVertices);
+    texCoords.y.reserve(numVertices);
+}
+
+TriangleMeshSoA::VertexIndex TriangleMeshSoA::AddVertex(const Gs::Vector3& position, const Gs::Vector3& normal, const Gs::Vector2& texCoord)
+{
+    if (NumVertices() >= TriangleMesh::MaxNumVertices())
+        throw std::overflow_error(GM_EXCEPT_INFO("number of vertices exceeds the range of the mesh index type"));
+
+    auto idx = static_cast<VertexIndex>(NumVertices());
+
+    positions.x.push_back(position.x);
+    positions.y.push_back(position.y);
+    positions.z.push_back(position.z);
+    normals.x.push_back(normal.x);
+    normals.y.push_back(normal.y);
+    normals.z.push_back(normal.z);
+    texCoords.x.push_back(texCoord.x);
+    texCoords.y.push_back(texCoord.y);
+
+    return idx;
+}
+
+TriangleMeshSoA::VertexIndex TriangleMeshSoA::AddVertex(const Vertex& vertex)
+{
+    return AddVertex(vertex.position, vertex.normal, vertex.texCoord);
+}
+
+TriangleMeshSoA::TriangleIndex TriangleMeshSoA::AddTriangle(VertexIndex v0, VertexIndex v1, VertexIndex v2)
+{
+    auto idx = triangles.size();
+    triangles.push_back({ v0, v1, v2 });
+    return idx;
+}
+
+TriangleMeshSoA::Vertex TriangleMeshSoA::GetVertex(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+    return Vertex(
+        Gs::Vector3(positions.x[vertexIndex], positions.y[vertexIndex], positions.z[vertexIndex]),
+        Gs::Vector3(normals.x[vertexIndex], normals.y[vertexIndex], normals.z[vertexIndex]),
+        Gs::Vector2(texCoords.x[vertexIndex], texCoords.y[vertexIndex])
+    );
+}
+
+void TriangleMeshSoA::SetVertex(VertexIndex vertexIndex, const Vertex& vertex)
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+
+    positions.x[vertexIndex] = vertex.position.x;
+    positions.y[vertexIndex] = vertex.position.y;
+    positions.z[vertexIndex] = vertex.position.z;
+    normals.x[vertexIndex] = vertex.normal.x;
+    normals.y[vertexIndex] = vertex.normal.y;
+    normals.z[vertexIndex] = vertex.normal.z;
+    texCoords.x[vertexIndex] = vertex.texCoord.x;
+    texCoords.y[vertexIndex] = vertex.texCoord.y;
+}
+
+Gs::Vector3 TriangleMeshSoA::GetPosition(VertexIndex vertexIndex) const
+{
+    GS_ASSERT(vertexIndex < NumVertices());
+    return Gs::Vector3(positions.x[vertexIndex], positions.y[vertexIndex], positions.z[vertexIndex]);
+}
+
+TriangleMeshSoA::Vertex TriangleMeshSoA::Barycentric(TriangleIndex triangleIndex, const Gs::Vector3& barycentricCoords) const
+{
+    GS_ASSERT(triangleIndex < triangles.size());
+
+    const auto& tri = triangles[triangleIndex];
+
+    auto Interp = [&tri, &barycentricCoords](const Stream& s)
+    {
+        return (s[tri.a] * barycentricCoords.x + s[tri.b] * barycentricCoords.y + s[tri.c] * barycentricCoords.z);
+    };
+
+    return Vertex(
+        Gs::Vector3(Interp(positions.x), Interp(positions.y), Interp(positions.z)),
+        Gs::Vector3(Interp(normals.x), Interp(normals.y), Interp(normals.z)),
+        Gs::Vector2(Interp(texCoords.x), Interp(texCoords.y))
+    );
+}
+
+void TriangleMeshSoA::FromMesh(const TriangleMesh& mesh)
+{
+    ResizeVertices(mesh.vertices.size());
+    triangles.assign(mesh.triangles.begin(), mesh.triangles.end());
+
+    /* Scatter vertices into the streams */
+    GetSharedThreadPool().ParallelFor(
+        mesh.vertices.size(), streamGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                SetVertex(i, mesh.vertices[i]);
+        }
+    );
+}
+
+void TriangleMeshSoA::ToMesh(TriangleMesh& mesh) const
+{
+    mesh.Clear();
+    mesh.vertices.resize(NumVertices());
+    mesh.triangles.assign(triangles.begin(), triangles.end());
+
+    /* Gather vertices from the streams */
+    GetSharedThreadPool().ParallelFor(
+        NumVertices(), streamGrainSize,
+        [&](std::size_t begin, std::size_t end)
+        {
+            for (auto i = begin; i < end; ++i)
+                mesh.vertices[i] = GetVertex(i);
+        }
+    );
+}
+
+TriangleMesh TriangleMeshSoA::ToMesh() const
+{
+    TriangleMesh mesh;
+    ToMesh(mesh);
+    return mesh;
+}
+
+AABB3 TriangleMeshSoA::BoundingBox() const
+{
+    return StreamBoundingBox<false>(positions, nullptr);
+}
+
+AABB3 TriangleMeshSoA::BoundingBox(const Gs::AffineMatrix4& matrix) const
+{
+    const Gs::Real m[12] =
+    {
+        matrix(0, 0), matrix(0, 1), matrix(0, 2), matrix(0, 3),
+        matrix(1, 0), matrix(1, 1), matrix(1, 2), matrix(1, 3),
+        matrix(2, 0), matrix(2, 1), matrix(2, 2), matrix(2, 3),
+    };
+    return StreamBoundingBox<true>(positions, m);
+}
+
+
+} // /namespace Gm
+
+
+
+// ================================================================================
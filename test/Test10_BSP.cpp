@@ -0,0 +1,168 @@
+/*
+ * Test10_BSP.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Gauss/Gauss.h>
+#include <Geom/Geom.h>
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <cstdlib>
+#include <cmath>
+
+
+using namespace Gm;
+
+class Timer
+{
+
+public:
+
+    void Start()
+    {
+        t0_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double Stop() const
+    {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(t1 - t0_).count();
+    }
+
+private:
+
+    std::chrono::high_resolution_clock::time_point t0_;
+
+};
+
+// Returns the signed volume of a closed mesh (divergence theorem).
+static double meshVolume(const TriangleMesh& mesh)
+{
+    double volume = 0.0;
+
+    for (const auto& tri : mesh.triangles)
+    {
+        const auto& a = mesh.vertices[tri.a].position;
+        const auto& b = mesh.vertices[tri.b].position;
+        const auto& c = mesh.vertices[tri.c].position;
+        volume += static_cast<double>(Gs::Dot(a, Gs::Cross(b, c)));
+    }
+
+    return volume / 6.0;
+}
+
+static void translateMesh(TriangleMesh& mesh, const Gs::Vector3& offset)
+{
+    for (auto& vertex : mesh.vertices)
+        vertex.position += offset;
+}
+
+// Returns true if the volumes of the boolean operations match |A u B| = |A| + |B| - |A n B| and |A - B| = |A| - |A n B|.
+static bool testBoolean(const std::string& name, const TriangleMesh& lhs, const TriangleMesh& rhs)
+{
+    std::cout << name << ": triangles = " << lhs.triangles.size() << " + " << rhs.triangles.size() << std::endl;
+
+    Timer timer;
+
+    // Build trees
+    timer.Start();
+    MeshBSPTree tree(lhs);
+    auto buildTime = timer.Stop();
+
+    std::cout << "  Tree:         t = " << buildTime << " sec. (nodes = " << tree.NumNodes() << ", depth = " << tree.Depth() << ")" << std::endl;
+
+    // Measure all boolean operations
+    const struct
+    {
+        const char*                     name;
+        MeshModifier::BooleanOperation  operation;
+    }
+    operations[] =
+    {
+        { "Union:       ", MeshModifier::BooleanOperation::Union        },
+        { "Intersection:", MeshModifier::BooleanOperation::Intersection },
+        { "Difference:  ", MeshModifier::BooleanOperation::Difference   },
+    };
+
+    double volumes[3] = { 0.0, 0.0, 0.0 };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        TriangleMesh result;
+
+        timer.Start();
+        MeshModifier::BooleanMesh(lhs, rhs, operations[i].operation, result);
+        auto time = timer.Stop();
+
+        volumes[i] = meshVolume(result);
+
+        std::cout << "  " << operations[i].name << " t = " << time << " sec. (triangles = " << result.triangles.size() << ", volume = " << volumes[i] << ")" << std::endl;
+    }
+
+    // Evaluate volumes: |A u B| = |A| + |B| - |A n B|, and |A - B| = |A| - |A n B|
+    const auto volumeLhs = meshVolume(lhs);
+    const auto volumeRhs = meshVolume(rhs);
+
+    const auto expectedUnion        = volumeLhs + volumeRhs - volumes[1];
+    const auto expectedDifference   = volumeLhs - volumes[1];
+    const auto tolerance            = (std::abs(volumeLhs) + std::abs(volumeRhs)) * 1e-3;
+
+    const bool passed = (std::abs(volumes[0] - expectedUnion) <= tolerance && std::abs(volumes[2] - expectedDifference) <= tolerance);
+
+    std::cout << "  Expected:     union volume = " << expectedUnion << ", difference volume = " << expectedDifference << (passed ? " (passed)" : " (FAILED)") << std::endl;
+    std::cout << std::endl;
+
+    return passed;
+}
+
+int main()
+{
+    std::cout << "GeometronLib Test 10" << std::endl;
+    std::cout << "====================" << std::endl;
+    std::cout << "Threads = " << (GetSharedThreadPool().NumThreads() + 1) << std::endl;
+    std::cout << std::endl;
+
+    bool passed = true;
+
+    // Cuboid minus cylinder
+    {
+        TriangleMesh cuboid, cylinder;
+
+        MeshGenerator::CuboidDescriptor cuboidDesc;
+        cuboidDesc.segments = Gs::Vector3ui(48, 48, 48);
+        MeshGenerator::GenerateCuboid(cuboidDesc, cuboid);
+
+        MeshGenerator::CylinderDescriptor cylinderDesc;
+        cylinderDesc.radius                 = Gs::Vector2(Gs::Real(0.3));
+        cylinderDesc.height                 = Gs::Real(1.5);
+        cylinderDesc.mantleSegments         = Gs::Vector2ui(256, 16);
+        cylinderDesc.topCoverSegments       = 8;
+        cylinderDesc.bottomCoverSegments    = 8;
+        MeshGenerator::GenerateCylinder(cylinderDesc, cylinder);
+
+        passed = testBoolean("Cuboid and cylinder", cuboid, cylinder) && passed;
+    }
+
+    // Two overlapping spheres
+    {
+        TriangleMesh sphereA, sphereB;
+
+        MeshGenerator::EllipsoidDescriptor sphereDesc;
+        sphereDesc.segments = Gs::Vector2ui(128, 64);
+
+        MeshGenerator::GenerateEllipsoid(sphereDesc, sphereA);
+        MeshGenerator::GenerateEllipsoid(sphereDesc, sphereB);
+        translateMesh(sphereB, Gs::Vector3(Gs::Real(0.3), Gs::Real(0.1), Gs::Real(0.05)));
+
+        passed = testBoolean("Two spheres", sphereA, sphereB) && passed;
+    }
+
+    #ifdef _WIN32
+    system("pause");
+    #endif
+
+    return (passed ? 0 : 1);
+}
@@ -117,6 +117,55 @@ static void meshTest1()
     writeOBJFile(mesh, "TestMesh.obj");
 }
 
+// Compares the edges of a mesh with a degenerated triangle without cache, with cache, and with cache and adjacency index.
+static bool meshEdgesTest1()
+{
+    TriangleMesh mesh;
+
+    for (int i = 0; i < 4; ++i)
+        mesh.AddVertex(Gs::Vector3(Real(i), Real(i % 2), 0), Gs::Vector3(0, 0, 1), Gs::Vector2());
+
+    mesh.AddTriangle(0, 1, 2);
+    mesh.AddTriangle(2, 2, 3);
+    mesh.AddTriangle(3, 1, 0);
+
+    auto EqualEdges = [](const std::vector<TriangleMesh::Edge>& lhs, const std::vector<TriangleMesh::Edge>& rhs)
+    {
+        if (lhs.size() != rhs.size())
+            return false;
+        for (std::size_t i = 0; i < lhs.size(); ++i)
+        {
+            if (lhs[i].a != rhs[i].a || lhs[i].b != rhs[i].b)
+                return false;
+        }
+        return true;
+    };
+
+    auto plainEdges = mesh.Edges();
+
+    mesh.EnableCache();
+    auto cachedEdges = mesh.Edges();
+
+    mesh.EnableCache(false);
+    mesh.BuildAdjacency();
+    mesh.EnableCache();
+    auto adjacencyEdges = mesh.Edges();
+
+    bool degenerated = false;
+    for (const auto& edge : plainEdges)
+    {
+        if (edge.a == edge.b)
+            degenerated = true;
+    }
+
+    const bool passed = (!degenerated && plainEdges.size() == 6 && EqualEdges(plainEdges, cachedEdges) && EqualEdges(plainEdges, adjacencyEdges));
+
+    std::cout << "Mesh Edges: plain = " << plainEdges.size() << ", cached = " << cachedEdges.size()
+              << ", with adjacency = " << adjacencyEdges.size() << (passed ? " (passed)" : " (FAILED)") << std::endl;
+
+    return passed;
+}
+
 static void sphereTest1()
 {
     Sphere s;
@@ -244,10 +293,12 @@ int main()
     //testAABBCollision();
     testConeCollision();
 
+    bool passed = meshEdgesTest1();
+
     #ifdef _WIN32
     system("pause");
     #endif
 
-    return 0;
+    return (passed ? 0 : 1);
 }
 
@@ -0,0 +1,268 @@
+/*
+ * Test9_MeshIO.cpp
+ * 
+ * This file is part of the "GeometronLib" project (Copyright (c) 2015 by Lukas Hermanns)
+ * See "LICENSE.txt" for license information.
+ */
+
+#include <Gauss/Gauss.h>
+#include <Geom/Geom.h>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+
+using namespace Gm;
+
+using WriteFunction = std::function<void(const std::string&, const TriangleMesh&)>;
+using ReadFunction  = std::function<void(const std::string&, TriangleMesh&)>;
+
+class Timer
+{
+
+public:
+
+    void Start()
+    {
+        t0_ = std::chrono::high_resolution_clock::now();
+    }
+
+    double Stop() const
+    {
+        auto t1 = std::chrono::high_resolution_clock::now();
+        return std::chrono::duration<double>(t1 - t0_).count();
+    }
+
+private:
+
+    std::chrono::high_resolution_clock::time_point t0_;
+
+};
+
+static Gs::Real randomReal()
+{
+    return static_cast<Gs::Real>(rand()) / static_cast<Gs::Real>(RAND_MAX);
+}
+
+static TriangleMesh generateMesh(std::size_t numVertices)
+{
+    TriangleMesh mesh;
+
+    mesh.vertices.resize(numVertices);
+
+    for (auto& vertex : mesh.vertices)
+    {
+        vertex.position = Gs::Vector3(randomReal(), randomReal(), randomReal()) * Gs::Real(100);
+        vertex.normal   = Gs::Vector3(randomReal(), randomReal(), randomReal());
+        vertex.texCoord = Gs::Vector2(randomReal(), randomReal());
+    }
+
+    for (std::size_t i = 0; i + 2 < numVertices; ++i)
+    {
+        mesh.triangles.push_back(
+            TriangleMesh::Triangle(
+                static_cast<TriangleMesh::VertexIndex>(i),
+                static_cast<TriangleMesh::VertexIndex>(rand() % numVertices),
+                static_cast<TriangleMesh::VertexIndex>(i + 2)
+            )
+        );
+    }
+
+    return mesh;
+}
+
+static double fileSizeInMB(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+    return static_cast<double>(file.tellg()) / 1.0e6;
+}
+
+static bool compareVectors(const Gs::Vector3& lhs, const Gs::Vector3& rhs)
+{
+    return (lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z);
+}
+
+static bool compareMeshes(const TriangleMesh& lhs, const TriangleMesh& rhs)
+{
+    if (lhs.vertices.size() != rhs.vertices.size() || lhs.triangles.size() != rhs.triangles.size())
+        return false;
+
+    for (std::size_t i = 0; i < lhs.vertices.size(); ++i)
+    {
+        const auto& a = lhs.vertices[i];
+        const auto& b = rhs.vertices[i];
+        if (!compareVectors(a.position, b.position) || !compareVectors(a.normal, b.normal) || a.texCoord.x != b.texCoord.x || a.texCoord.y != b.texCoord.y)
+            return false;
+    }
+
+    for (std::size_t i = 0; i < lhs.triangles.size(); ++i)
+    {
+        const auto& a = lhs.triangles[i];
+        const auto& b = rhs.triangles[i];
+        if (a.a != b.a || a.b != b.b || a.c != b.c)
+            return false;
+    }
+
+    return true;
+}
+
+static void testFormat(const std::string& name, const TriangleMesh& mesh, const WriteFunction& writeFunc, const ReadFunction& readFunc)
+{
+    const auto filename = "Test9_MeshIO." + name;
+
+    Timer timer;
+
+    // Write mesh
+    timer.Start();
+    writeFunc(filename, mesh);
+    auto writeTime = timer.Stop();
+
+    // Read mesh
+    TriangleMesh result;
+
+    timer.Start();
+    readFunc(filename, result);
+    auto readTime = timer.Stop();
+
+    // Evaluate
+    auto size = fileSizeInMB(filename);
+
+    std::cout << name << ": " << size << " MB" << std::endl;
+    std::cout << "  Write: t = " << writeTime << " sec. (" << size / writeTime << " MB/s)" << std::endl;
+    std::cout << "  Read:  t = " << readTime << " sec. (" << size / readTime << " MB/s)" << std::endl;
+    std::cout << "  Equal: " << (compareMeshes(mesh, result) ? "yes" : "NO") << std::endl;
+    std::cout << std::endl;
+
+    std::remove(filename.c_str());
+}
+
+static void writeTextFile(const std::string& filename, const std::string& content)
+{
+    std::ofstream file(filename, std::ios::out | std::ios::binary);
+    file << content;
+}
+
+// Returns true if reading the specified file content is rejected with an exception.
+static bool isRejected(const std::string& filename, const std::string& content, const ReadFunction& readFunc)
+{
+    writeTextFile(filename, content);
+
+    bool rejected = false;
+
+    try
+    {
+        TriangleMesh mesh;
+        readFunc(filename, mesh);
+    }
+    catch (const std::exception&)
+    {
+        rejected = true;
+    }
+
+    std::remove(filename.c_str());
+
+    return rejected;
+}
+
+static bool testInvalidIndices()
+{
+    // Indices with 20 digits exceed the 64-bit integer range and must be rejected instead of wrapping around
+    const std::string hugeIndex = "99999999999999999999";
+
+    bool passed = true;
+
+    if (!isRejected("invalid.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 " + hugeIndex + "\n", MeshIO::ReadOBJ))
+    {
+        std::cerr << "OBJ face with 20-digit index was not rejected" << std::endl;
+        passed = false;
+    }
+
+    const std::string plyHeader =
+        "ply\nformat ascii 1.0\n"
+        "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+        "element face 1\nproperty list uchar int vertex_indices\nend_header\n"
+        "0 0 0\n1 0 0\n0 1 0\n";
+
+    if (!isRejected("invalid.ply", plyHeader + "3 0 1 " + hugeIndex + "\n", MeshIO::ReadPLY))
+    {
+        std::cerr << "PLY face with 20-digit index was not rejected" << std::endl;
+        passed = false;
+    }
+
+    if (!isRejected("invalid.ply", plyHeader + "3000000000000 0 1 2\n", MeshIO::ReadPLY))
+    {
+        std::cerr << "PLY face with huge list size was not rejected" << std::endl;
+        passed = false;
+    }
+
+    // Binary PLY with floating-point indices, where the last index is NaN
+    const char binaryPLY[] =
+        "ply\nformat binary_little_endian 1.0\n"
+        "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+        "element face 1\nproperty list uchar float vertex_indices\nend_header\n";
+
+    std::string binaryContent(binaryPLY);
+    binaryContent.append(3 * 3 * sizeof(float), '\0');
+
+    const unsigned char binaryFace[] = { 3, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x3F, 0x00, 0x00, 0xC0, 0x7F };
+    binaryContent.append(reinterpret_cast<const char*>(binaryFace), sizeof(binaryFace));
+
+    if (!isRejected("invalid.ply", binaryContent, MeshIO::ReadPLY))
+    {
+        std::cerr << "binary PLY face with NaN index was not rejected" << std::endl;
+        passed = false;
+    }
+
+    std::cout << "Invalid indices rejected: " << (passed ? "yes" : "NO") << std::endl;
+    std::cout << std::endl;
+
+    return passed;
+}
+
+int main()
+{
+    std::cout << "GeometronLib Test 9" << std::endl;
+    std::cout << "===================" << std::endl;
+
+    // Seed random
+    srand(static_cast<unsigned>(time(0)));
+
+    bool passed = testInvalidIndices();
+
+    // Measure throughput of all formats with a large synthetic mesh
+    const std::size_t n = 2000000;
+
+    std::cout << "Mesh: vertices = " << n << ", threads = " << (GetSharedThreadPool().NumThreads() + 1) << std::endl;
+    std::cout << std::endl;
+
+    auto mesh = generateMesh(n);
+
+    testFormat("obj", mesh, MeshIO::WriteOBJ, MeshIO::ReadOBJ);
+
+    testFormat(
+        "ascii.ply", mesh,
+        [](const std::string& filename, const TriangleMesh& mesh)
+        {
+            MeshIO::WritePLY(filename, mesh, MeshIO::PLYFormat::ASCII);
+        },
+        MeshIO::ReadPLY
+    );
+
+    testFormat(
+        "binary.ply", mesh,
+        [](const std::string& filename, const TriangleMesh& mesh)
+        {
+            MeshIO::WritePLY(filename, mesh, MeshIO::PLYFormat::BinaryLittleEndian);
+        },
+        MeshIO::ReadPLY
+    );
+
+    #ifdef _WIN32
+    system("pause");
+    #endif
+
+    return (passed ? 0 : 1);
+}